@@ -0,0 +1,207 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#include "log.h"
+#include "batchmanifest.h"
+#include "folderscanner.h"
+#include "folderwatcher.h"
+#include <algorithm>
+#include <filesystem>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+using namespace std;
+namespace fs = std::filesystem;
+namespace pt = boost::property_tree;
+
+static bool HasWildcard( const string &str )
+{
+    return string::npos != str.find_first_of( "*?" );
+}
+
+namespace gc
+{
+
+GC_STATUS BatchManifest::Load( const std::string jsonFilepath )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        m_sites.clear();
+
+        pt::ptree top;
+        pt::json_parser::read_json( jsonFilepath, top );
+        for ( const pt::ptree::value_type &node : top.get_child( "sites" ) )
+        {
+            BatchSite site;
+            site.source = node.second.get< string >( "source", "" );
+            site.calibPath = node.second.get< string >( "calib_json", "" );
+            site.name = node.second.get< string >( "name", site.source );
+            site.csvPath = node.second.get< string >( "csv_file", "" );
+            site.resultLogPath = node.second.get< string >( "result_log", "" );
+            site.resultFolder = node.second.get< string >( "result_folder", "" );
+            if ( site.source.empty() || site.calibPath.empty() )
+            {
+                FILE_LOG( logERROR ) << "[BatchManifest::Load] Site " << m_sites.size() << " of " << jsonFilepath << " needs a source and a calib_json";
+                retVal = GC_ERR;
+                break;
+            }
+            m_sites.push_back( site );
+        }
+        if ( GC_OK == retVal && m_sites.empty() )
+        {
+            FILE_LOG( logERROR ) << "[BatchManifest::Load] No sites in " << jsonFilepath;
+            retVal = GC_ERR;
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[BatchManifest::Load] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+bool BatchManifest::MatchGlob( const std::string &pattern, const std::string &name )
+{
+    // case is folded like the image extension check, so *.jpg also takes IMG_001.JPG
+    auto sameChar = []( const char a, const char b )
+    {
+        return tolower( static_cast< unsigned char >( a ) ) == tolower( static_cast< unsigned char >( b ) );
+    };
+
+    // greedy match that backtracks to the last * on a mismatch
+    size_t p = 0, n = 0, starP = string::npos, starN = 0;
+    while ( n < name.size() )
+    {
+        if ( p < pattern.size() && ( '?' == pattern[ p ] || sameChar( pattern[ p ], name[ n ] ) ) )
+        {
+            ++p;
+            ++n;
+        }
+        else if ( p < pattern.size() && '*' == pattern[ p ] )
+        {
+            starP = p++;
+            starN = n;
+        }
+        else if ( string::npos != starP )
+        {
+            p = starP + 1;
+            n = ++starN;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    while ( p < pattern.size() && '*' == pattern[ p ] )
+        ++p;
+    return p == pattern.size();
+}
+std::string BatchManifest::SourceFolder( const std::string &source )
+{
+    if ( !HasWildcard( source ) )
+        return source;
+
+    fs::path folder;
+    for ( const fs::path &part : fs::path( source ).parent_path() )
+    {
+        if ( HasWildcard( part.string() ) )
+            break;
+        folder /= part;
+    }
+    return folder.string();
+}
+GC_STATUS BatchManifest::ExpandSource( const std::string source, std::vector< std::string > &images, const int scanThreads )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        images.clear();
+
+        // split the source into the folder to list, whether to recurse, and the filename pattern
+        fs::path folder;
+        string pattern = "*";
+        bool isRecursive = true;
+        if ( !HasWildcard( source ) )
+        {
+            folder = source;
+        }
+        else
+        {
+            fs::path srcPath( source );
+            pattern = srcPath.filename().string();
+            isRecursive = false;
+            for ( const fs::path &part : srcPath.parent_path() )
+            {
+                if ( "**" == part.string() && !isRecursive )
+                {
+                    isRecursive = true;
+                }
+                else if ( HasWildcard( part.string() ) || isRecursive )
+                {
+                    FILE_LOG( logERROR ) << "[BatchManifest::ExpandSource] Wildcards must be in the last path component, after an optional **: " << source;
+                    return GC_ERR;
+                }
+                else
+                {
+                    folder /= part;
+                }
+            }
+        }
+
+        if ( !fs::is_directory( folder ) )
+        {
+            FILE_LOG( logERROR ) << "[BatchManifest::ExpandSource] Not a folder: " << folder.string();
+            retVal = GC_ERR;
+        }
+        else if ( isRecursive )
+        {
+            FolderScanner scanner;
+            retVal = scanner.Start( folder.string(), scanThreads );
+            if ( GC_OK == retVal )
+            {
+                string imgPath;
+                while ( scanner.Next( imgPath ) )
+                {
+                    if ( MatchGlob( pattern, fs::path( imgPath ).filename().string() ) )
+                        images.push_back( imgPath );
+                }
+                scanner.Stop();
+            }
+        }
+        else
+        {
+            error_code ec;
+            for ( fs::directory_iterator iter( folder, ec ), end; !ec && iter != end; iter.increment( ec ) )
+            {
+                string name = iter->path().filename().string();
+                if ( iter->is_regular_file( ec ) && FolderWatcher::IsImageFile( name ) && MatchGlob( pattern, name ) )
+                    images.push_back( iter->path().string() );
+                ec.clear();
+            }
+            sort( images.begin(), images.end() );
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[BatchManifest::ExpandSource] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+
+} // namespace gc
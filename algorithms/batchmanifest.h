@@ -0,0 +1,118 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/** \file batchmanifest.h
+ * @brief A file for a class that reads the list of camera sites of a multi-site batch run
+ *
+ * The batch manifest is a json file with one entry per site. Each entry pairs an image source
+ * with the calibration of that site. The result files are optional:
+ *
+ *   { "sites": [ { "name": "kola", "source": "/data/kola/2024/img_*.jpg", "calib_json": "/cfg/kola.json",
+ *                  "csv_file": "/out/kola.csv", "result_log": "/out/kola.gclog", "result_folder": "/out/kola/" } ] }
+ *
+ * A source is a folder (all images below it), or a glob whose wildcards (*, ?) are in the last
+ * path component. A component of two asterisks just before the last one searches the folder
+ * and all of its subfolders.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef BATCHMANIFEST_H
+#define BATCHMANIFEST_H
+
+#include "gc_types.h"
+#include <string>
+#include <vector>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief Data class that holds one site of a batch run
+ */
+class BatchSite
+{
+public:
+    std::string name;           ///< Site name used in messages (defaults to the source)
+    std::string source;         ///< Folder or glob of the site images
+    std::string calibPath;      ///< Calibration json file of the site
+    std::string csvPath;        ///< Result csv file of the site (empty=use the command line value)
+    std::string resultLogPath;  ///< Binary result log of the site (empty=use the command line value)
+    std::string resultFolder;   ///< Overlay image folder of the site (empty=use the command line value)
+};
+
+/**
+ * @brief Reads a batch manifest and expands the image sources of its sites
+ */
+class BatchManifest
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    BatchManifest() {}
+
+    /**
+     * @brief Read a batch manifest json file
+     * @param jsonFilepath Path of the manifest
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Load( const std::string jsonFilepath );
+
+    /**
+     * @brief Sites of the last loaded manifest in file order
+     */
+    const std::vector< BatchSite > &Sites() const { return m_sites; }
+
+    /**
+     * @brief List the images of a site source, folder by folder with the entries of each folder
+     *        sorted by name (the order of --run_folder)
+     * @param source Folder or glob of the site images
+     * @param images Vector to hold the image paths
+     * @param scanThreads Number of folder listing threads for recursive sources (0=automatic)
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    static GC_STATUS ExpandSource( const std::string source, std::vector< std::string > &images, const int scanThreads = 0 );
+
+    /**
+     * @brief Match a filename against a pattern with * (any run of characters) and ? (any one character),
+     *        ignoring case
+     * @param pattern Pattern to match
+     * @param name Filename to test
+     * @return true=Match, false=No match
+     */
+    static bool MatchGlob( const std::string &pattern, const std::string &name );
+
+    /**
+     * @brief Folder part of a site source: the source itself if it is a folder, otherwise the path
+     *        components before the first one with a wildcard
+     * @param source Folder or glob of the site images
+     * @return Folder path
+     */
+    static std::string SourceFolder( const std::string &source );
+
+private:
+    std::vector< BatchSite > m_sites;
+};
+
+} // namespace gc
+
+#endif // BATCHMANIFEST_H
@@ -0,0 +1,157 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/** \file boundedqueue.h
+ * @brief Include file that holds a fixed capacity, blocking queue used to hand work
+ *        between the stages of a multi-threaded processing pipeline
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <deque>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief Thread safe FIFO queue with a fixed capacity. Push() blocks while the queue is full
+ *        and Pop() blocks while it is empty, so a fast producer can never get more than
+ *        capacity items ahead of its consumer. Close() releases all waiting threads.
+ */
+template< typename T >
+class BoundedQueue
+{
+public:
+    /**
+     * @brief Constructor
+     * @param maxItems Maximum number of items the queue can hold before Push() blocks
+     */
+    explicit BoundedQueue( const size_t maxItems = 8 ) :
+        m_capacity( 0 == maxItems ? 1 : maxItems ),
+        m_isClosed( false )
+    {}
+
+    /**
+     * @brief Add an item to the back of the queue, waiting for room if the queue is full
+     * @param item Item to be moved into the queue
+     * @return true=Item added, false=Queue was closed before the item could be added
+     */
+    bool Push( T &&item )
+    {
+        std::unique_lock< std::mutex > lock( m_mutex );
+        m_notFull.wait( lock, [ this ]{ return m_isClosed || m_items.size() < m_capacity; } );
+        if ( m_isClosed )
+            return false;
+        m_items.push_back( std::move( item ) );
+        lock.unlock();
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Remove the item at the front of the queue, waiting for one if the queue is empty
+     * @param item Receives the removed item
+     * @return true=Item retrieved, false=Queue is closed and there are no more items
+     */
+    bool Pop( T &item )
+    {
+        std::unique_lock< std::mutex > lock( m_mutex );
+        m_notEmpty.wait( lock, [ this ]{ return m_isClosed || !m_items.empty(); } );
+        if ( m_items.empty() )
+            return false;
+        item = std::move( m_items.front() );
+        m_items.pop_front();
+        lock.unlock();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Remove the item at the front of the queue, waiting at most timeout for one
+     * @param item Receives the removed item
+     * @param timeout Longest time to wait for an item
+     * @param isTimeout Set to true if no item arrived before the timeout
+     * @return true=Item retrieved or timeout, false=Queue is closed and there are no more items
+     */
+    bool PopFor( T &item, const std::chrono::milliseconds timeout, bool &isTimeout )
+    {
+        std::unique_lock< std::mutex > lock( m_mutex );
+        isTimeout = !m_notEmpty.wait_for( lock, timeout, [ this ]{ return m_isClosed || !m_items.empty(); } );
+        if ( isTimeout )
+            return true;
+        if ( m_items.empty() )
+            return false;
+        item = std::move( m_items.front() );
+        m_items.pop_front();
+        lock.unlock();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Stop accepting new items. Items already queued can still be popped.
+     */
+    void Close()
+    {
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+            m_isClosed = true;
+        }
+        m_notFull.notify_all();
+        m_notEmpty.notify_all();
+    }
+
+    /**
+     * @brief Reopen a closed, empty queue for reuse
+     */
+    void Reset()
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        m_items.clear();
+        m_isClosed = false;
+    }
+
+    /**
+     * @brief Number of items currently in the queue
+     */
+    size_t Size()
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        return m_items.size();
+    }
+
+private:
+    size_t m_capacity;
+    bool m_isClosed;
+    std::deque< T > m_items;
+    std::mutex m_mutex;
+    std::condition_variable m_notFull;
+    std::condition_variable m_notEmpty;
+};
+
+} // namespace gc
+
+#endif // BOUNDEDQUEUE_H
@@ -0,0 +1,395 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#include "log.h"
+#include "calibcache.h"
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <filesystem>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace cv;
+using namespace std;
+namespace fs = std::filesystem;
+
+static const char CACHE_MAGIC[ 8 ] = { 'G', 'C', 'C', 'A', 'L', 'I', 'B', '\0' };
+static const uint32_t CACHE_VERSION = 1;
+
+// native byte order, the file is rebuilt on a machine that reads it differently
+struct CalibCacheHeader
+{
+    char magic[ 8 ];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t jsonSize;
+    uint64_t jsonChecksum;
+    uint64_t payloadSize;
+    uint64_t payloadChecksum;
+};
+
+static_assert( sizeof( Point2d ) == 2 * sizeof( double ), "Point2d arrays are copied as packed doubles" );
+static_assert( sizeof( Point ) == 2 * sizeof( int32_t ), "Point arrays are copied as packed int32 pairs" );
+static_assert( sizeof( gc::LineEnds ) == 2 * sizeof( Point ), "LineEnds arrays are copied as packed point pairs" );
+
+// read only view of a whole file mapped into memory
+class MappedFile
+{
+public:
+    MappedFile() : data( nullptr ), size( 0 )
+#ifdef _WIN32
+      , file( INVALID_HANDLE_VALUE ), mapping( nullptr )
+#endif
+    {}
+    ~MappedFile() { Close(); }
+    MappedFile( const MappedFile & ) = delete;
+    MappedFile &operator=( const MappedFile & ) = delete;
+
+    bool Open( const string &filepath )
+    {
+        Close();
+#ifdef _WIN32
+        file = CreateFileA( filepath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+        if ( INVALID_HANDLE_VALUE == file )
+            return false;
+        LARGE_INTEGER fileSize;
+        if ( !GetFileSizeEx( file, &fileSize ) || 0 == fileSize.QuadPart )
+            return false;
+        mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+        if ( nullptr == mapping )
+            return false;
+        data = static_cast< const char * >( MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) );
+        size = static_cast< size_t >( fileSize.QuadPart );
+#else
+        int fd = open( filepath.c_str(), O_RDONLY );
+        if ( 0 > fd )
+            return false;
+        struct stat st;
+        if ( 0 == fstat( fd, &st ) && 0 < st.st_size )
+        {
+            void *addr = mmap( nullptr, static_cast< size_t >( st.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+            if ( MAP_FAILED != addr )
+            {
+                data = static_cast< const char * >( addr );
+                size = static_cast< size_t >( st.st_size );
+            }
+        }
+        close( fd );
+#endif
+        return nullptr != data;
+    }
+    void Close()
+    {
+#ifdef _WIN32
+        if ( nullptr != data )
+            UnmapViewOfFile( data );
+        if ( nullptr != mapping )
+            CloseHandle( mapping );
+        if ( INVALID_HANDLE_VALUE != file )
+            CloseHandle( file );
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if ( nullptr != data )
+            munmap( const_cast< char * >( data ), size );
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    const char *data;
+    size_t size;
+private:
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+};
+
+// appends fixed size values and counted arrays to a byte buffer
+class CacheWriter
+{
+public:
+    template< typename T >
+    void Put( const T &value )
+    {
+        const char *p = reinterpret_cast< const char * >( &value );
+        bytes.insert( bytes.end(), p, p + sizeof( T ) );
+    }
+    template< typename T >
+    void PutArray( const vector< T > &values )
+    {
+        Put( static_cast< uint64_t >( values.size() ) );
+        const char *p = reinterpret_cast< const char * >( values.data() );
+        bytes.insert( bytes.end(), p, p + values.size() * sizeof( T ) );
+    }
+    void PutString( const string &str )
+    {
+        Put( static_cast< uint64_t >( str.size() ) );
+        bytes.insert( bytes.end(), str.begin(), str.end() );
+    }
+    vector< char > bytes;
+};
+
+// reads the values of a CacheWriter back, failing instead of reading past the end
+class CacheReader
+{
+public:
+    CacheReader( const char *data, const size_t size ) : pos( data ), end( data + size ) {}
+    template< typename T >
+    bool Get( T &value )
+    {
+        if ( static_cast< size_t >( end - pos ) < sizeof( T ) )
+            return false;
+        memcpy( &value, pos, sizeof( T ) );
+        pos += sizeof( T );
+        return true;
+    }
+    template< typename T >
+    bool GetArray( vector< T > &values )
+    {
+        uint64_t count = 0;
+        if ( !Get( count ) || static_cast< uint64_t >( end - pos ) / sizeof( T ) < count )
+            return false;
+        values.resize( static_cast< size_t >( count ) );
+        memcpy( values.data(), pos, values.size() * sizeof( T ) );
+        pos += values.size() * sizeof( T );
+        return true;
+    }
+    bool GetString( string &str )
+    {
+        uint64_t len = 0;
+        if ( !Get( len ) || static_cast< uint64_t >( end - pos ) < len )
+            return false;
+        str.assign( pos, static_cast< size_t >( len ) );
+        pos += len;
+        return true;
+    }
+    bool AtEnd() const { return pos == end; }
+private:
+    const char *pos;
+    const char *end;
+};
+
+static void PutRect( CacheWriter &writer, const Rect &rect )
+{
+    writer.Put( static_cast< int32_t >( rect.x ) );
+    writer.Put( static_cast< int32_t >( rect.y ) );
+    writer.Put( static_cast< int32_t >( rect.width ) );
+    writer.Put( static_cast< int32_t >( rect.height ) );
+}
+static bool GetRect( CacheReader &reader, Rect &rect )
+{
+    int32_t vals[ 4 ];
+    for ( int i = 0; i < 4; ++i )
+    {
+        if ( !reader.Get( vals[ i ] ) )
+            return false;
+    }
+    rect = Rect( vals[ 0 ], vals[ 1 ], vals[ 2 ], vals[ 3 ] );
+    return true;
+}
+
+namespace gc
+{
+
+std::string CalibCache::CachePath( const std::string &jsonFilepath )
+{
+    return jsonFilepath + ".gcbin";
+}
+uint64_t CalibCache::Checksum( const void *data, const size_t len )
+{
+    const unsigned char *p = static_cast< const unsigned char * >( data );
+    uint64_t hash = 14695981039346656037ULL;
+    for ( size_t i = 0; i < len; ++i )
+    {
+        hash ^= p[ i ];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+GC_STATUS CalibCache::Read( const std::string &cachePath, const std::string &jsonString,
+                            CalibModelOctagon &model, CalibExecParams &params )
+{
+    GC_STATUS retVal = GC_WARN;
+    try
+    {
+        MappedFile file;
+        if ( file.Open( cachePath ) && sizeof( CalibCacheHeader ) <= file.size )
+        {
+            CalibCacheHeader header;
+            memcpy( &header, file.data, sizeof( header ) );
+            const char *payload = file.data + sizeof( header );
+            if ( 0 != memcmp( header.magic, CACHE_MAGIC, sizeof( CACHE_MAGIC ) ) ||
+                 CACHE_VERSION != header.version || sizeof( header ) != header.headerSize ||
+                 jsonString.size() != header.jsonSize ||
+                 Checksum( jsonString.data(), jsonString.size() ) != header.jsonChecksum ||
+                 file.size - sizeof( header ) != header.payloadSize ||
+                 Checksum( payload, static_cast< size_t >( header.payloadSize ) ) != header.payloadChecksum )
+            {
+                FILE_LOG( logINFO ) << "[CalibCache::Read] Binary calibration is out of date: " << cachePath;
+            }
+            else
+            {
+                CalibModelOctagon cachedModel;
+                CalibExecParams cachedParams;
+                CacheReader reader( payload, static_cast< size_t >( header.payloadSize ) );
+                uint8_t validCalib = 0, drawFlags = 0;
+                int32_t width = 0, height = 0;
+                bool isOk = reader.Get( validCalib ) && reader.Get( width ) && reader.Get( height ) &&
+                            reader.GetArray( cachedModel.oldPixelPoints ) &&
+                            reader.GetArray( cachedModel.pixelPoints ) &&
+                            reader.GetArray( cachedModel.worldPoints ) &&
+                            reader.GetArray( cachedModel.waterlineSearchCorners ) &&
+                            reader.GetArray( cachedModel.waterlineSearchCornersAdj ) &&
+                            reader.GetArray( cachedModel.searchLineSet ) &&
+                            GetRect( reader, cachedModel.targetSearchRegion ) &&
+                            reader.Get( cachedModel.facetLength ) && reader.Get( cachedModel.zeroOffset ) &&
+                            reader.Get( cachedModel.OctoCenterPixel ) && reader.Get( cachedModel.OctoCenterWorld ) &&
+                            reader.Get( cachedModel.angle ) && reader.GetString( cachedModel.controlJson ) &&
+                            reader.GetString( cachedParams.calibType ) &&
+                            reader.Get( cachedParams.facetLength ) && reader.Get( cachedParams.zeroOffset ) &&
+                            reader.Get( cachedParams.botLftPtToLft ) && reader.Get( cachedParams.botLftPtToTop ) &&
+                            reader.Get( cachedParams.botLftPtToRgt ) && reader.Get( cachedParams.botLftPtToBot ) &&
+                            reader.GetString( cachedParams.calibResultJsonFilepath ) &&
+                            reader.Get( drawFlags ) && GetRect( reader, cachedParams.targetSearchROI ) &&
+                            reader.Get( cachedParams.lineSearch_lftTop ) && reader.Get( cachedParams.lineSearch_rgtTop ) &&
+                            reader.Get( cachedParams.lineSearch_lftBot ) && reader.Get( cachedParams.lineSearch_rgtBot ) &&
+                            reader.AtEnd();
+                if ( !isOk )
+                {
+                    FILE_LOG( logWARNING ) << "[CalibCache::Read] Binary calibration is invalid: " << cachePath;
+                }
+                else
+                {
+                    cachedModel.validCalib = 0 != validCalib;
+                    cachedModel.imgSize = Size( width, height );
+                    cachedParams.drawCalibScale = 0 != ( drawFlags & 1 );
+                    cachedParams.drawCalibGrid = 0 != ( drawFlags & 2 );
+                    cachedParams.drawWaterLineSearchROI = 0 != ( drawFlags & 4 );
+                    cachedParams.drawTargetSearchROI = 0 != ( drawFlags & 8 );
+                    model = cachedModel;
+                    params = cachedParams;
+                    retVal = GC_OK;
+                }
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[CalibCache::Read] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS CalibCache::Write( const std::string &cachePath, const std::string &jsonString,
+                             const CalibModelOctagon &model, const CalibExecParams &params )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        CacheWriter writer;
+        writer.Put( static_cast< uint8_t >( model.validCalib ? 1 : 0 ) );
+        writer.Put( static_cast< int32_t >( model.imgSize.width ) );
+        writer.Put( static_cast< int32_t >( model.imgSize.height ) );
+        writer.PutArray( model.oldPixelPoints );
+        writer.PutArray( model.pixelPoints );
+        writer.PutArray( model.worldPoints );
+        writer.PutArray( model.waterlineSearchCorners );
+        writer.PutArray( model.waterlineSearchCornersAdj );
+        writer.PutArray( model.searchLineSet );
+        PutRect( writer, model.targetSearchRegion );
+        writer.Put( model.facetLength );
+        writer.Put( model.zeroOffset );
+        writer.Put( model.OctoCenterPixel );
+        writer.Put( model.OctoCenterWorld );
+        writer.Put( model.angle );
+        writer.PutString( model.controlJson );
+        writer.PutString( params.calibType );
+        writer.Put( params.facetLength );
+        writer.Put( params.zeroOffset );
+        writer.Put( params.botLftPtToLft );
+        writer.Put( params.botLftPtToTop );
+        writer.Put( params.botLftPtToRgt );
+        writer.Put( params.botLftPtToBot );
+        writer.PutString( params.calibResultJsonFilepath );
+        writer.Put( static_cast< uint8_t >( ( params.drawCalibScale ? 1 : 0 ) | ( params.drawCalibGrid ? 2 : 0 ) |
+                                            ( params.drawWaterLineSearchROI ? 4 : 0 ) | ( params.drawTargetSearchROI ? 8 : 0 ) ) );
+        PutRect( writer, params.targetSearchROI );
+        writer.Put( params.lineSearch_lftTop );
+        writer.Put( params.lineSearch_rgtTop );
+        writer.Put( params.lineSearch_lftBot );
+        writer.Put( params.lineSearch_rgtBot );
+
+        CalibCacheHeader header;
+        memset( &header, 0, sizeof( header ) );
+        memcpy( header.magic, CACHE_MAGIC, sizeof( CACHE_MAGIC ) );
+        header.version = CACHE_VERSION;
+        header.headerSize = sizeof( header );
+        header.jsonSize = jsonString.size();
+        header.jsonChecksum = Checksum( jsonString.data(), jsonString.size() );
+        header.payloadSize = writer.bytes.size();
+        header.payloadChecksum = Checksum( writer.bytes.data(), writer.bytes.size() );
+
+        // other processes may be reading or writing the same file, so write a private copy and rename it over
+        string tmpPath = cachePath + ".tmp" +
+                to_string( hash< thread::id >()( this_thread::get_id() ) ^
+                           static_cast< size_t >( chrono::steady_clock::now().time_since_epoch().count() ) );
+        {
+            ofstream file( tmpPath, ios::binary | ios::trunc );
+            file.write( reinterpret_cast< const char * >( &header ), sizeof( header ) );
+            file.write( writer.bytes.data(), static_cast< streamsize >( writer.bytes.size() ) );
+            if ( !file )
+            {
+                FILE_LOG( logWARNING ) << "[CalibCache::Write] Could not write binary calibration " << tmpPath;
+                retVal = GC_ERR;
+            }
+        }
+        std::error_code ec;
+        if ( GC_OK == retVal )
+        {
+            fs::rename( tmpPath, cachePath, ec );
+            if ( ec )
+            {
+                FILE_LOG( logWARNING ) << "[CalibCache::Write] Could not replace binary calibration " << cachePath << ": " << ec.message();
+                retVal = GC_ERR;
+            }
+        }
+        if ( GC_OK != retVal )
+        {
+            fs::remove( tmpPath, ec );
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[CalibCache::Write] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+
+} // namespace gc
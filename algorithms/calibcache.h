@@ -0,0 +1,91 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/** \file calibcache.h
+ * @brief A file for the compiled binary form of an octagon calibration json file
+ *
+ * The binary file is kept next to the json file (calib.json -> calib.json.gcbin). It holds the
+ * calibration model and settings as they are after the json is parsed, with the size and a
+ * checksum of the json it was compiled from. A load maps the file into memory and copies the
+ * point and search line arrays out of it without parsing. The file is rebuilt when the json
+ * changes or the format version does not match.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef CALIBCACHE_H
+#define CALIBCACHE_H
+
+#include "gc_types.h"
+#include "calibexecutive.h"
+#include <string>
+#include <cstdint>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief Reads and writes the binary calibration file of a calibration json file
+ */
+class CalibCache
+{
+public:
+    /**
+     * @brief Path of the binary calibration file of a calibration json file
+     * @param jsonFilepath Path of the calibration json file
+     * @return Path of the binary calibration file
+     */
+    static std::string CachePath( const std::string &jsonFilepath );
+
+    /**
+     * @brief Read the calibration from a binary calibration file
+     * @param cachePath Path of the binary calibration file
+     * @param jsonString Contents of the calibration json file the binary file must have been compiled from
+     * @param model Object to hold the octagon calibration model
+     * @param params Object to hold the calibration settings
+     * @return GC_OK=Success, GC_WARN=File missing, out of date, or invalid, GC_EXCEPT=Exception thrown
+     */
+    static GC_STATUS Read( const std::string &cachePath, const std::string &jsonString,
+                           CalibModelOctagon &model, CalibExecParams &params );
+
+    /**
+     * @brief Write a binary calibration file, replacing any existing one in a single rename
+     * @param cachePath Path of the binary calibration file
+     * @param jsonString Contents of the calibration json file the model and settings were read from
+     * @param model Octagon calibration model
+     * @param params Calibration settings
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    static GC_STATUS Write( const std::string &cachePath, const std::string &jsonString,
+                            const CalibModelOctagon &model, const CalibExecParams &params );
+
+    /**
+     * @brief 64 bit FNV-1a checksum
+     * @param data Bytes to sum
+     * @param len Number of bytes
+     * @return Checksum
+     */
+    static uint64_t Checksum( const void *data, const size_t len );
+};
+
+} // namespace gc
+
+#endif // CALIBCACHE_H
@@ -1,5 +1,6 @@
 #include "log.h"
 #include "calibexecutive.h"
+#include "calibcache.h"
 #include <iostream>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgcodecs.hpp>
@@ -54,6 +55,7 @@ void CalibExecutive::clear()
 {
     octagon.clear();
     calibFileJson.clear();
+    loadedFilepath.clear();
 }
 GC_STATUS CalibExecutive::GetTargetSearchROI( cv::Rect &rect )
 {
@@ -381,12 +383,12 @@ GC_STATUS CalibExecutive::DrawOverlay( const cv::Mat matIn, cv::Mat &imgMatOut,
     }
     return retVal;
 }
-GC_STATUS CalibExecutive::PixelToWorld( const cv::Point2d pixelPt, cv::Point2d &worldPt )
+GC_STATUS CalibExecutive::PixelToWorld( const cv::Point2d *pixelPts, cv::Point2d *worldPts, const size_t count )
 {
     GC_STATUS retVal = GC_OK;
     if ( "Octagon" == paramsCurrent.calibType )
     {
-        retVal = octagon.PixelToWorld( pixelPt, worldPt );
+        retVal = octagon.PixelToWorld( pixelPts, worldPts, count );
     }
     else
     {
@@ -395,12 +397,12 @@ GC_STATUS CalibExecutive::PixelToWorld( const cv::Point2d pixelPt, cv::Point2d &
     }
     return retVal;
 }
-GC_STATUS CalibExecutive::WorldToPixel( const cv::Point2d worldPt, cv::Point2d &pixelPt )
+GC_STATUS CalibExecutive::WorldToPixel( const cv::Point2d *worldPts, cv::Point2d *pixelPts, const size_t count )
 {
     GC_STATUS retVal = GC_OK;
     if ( "Octagon" == paramsCurrent.calibType )
     {
-        retVal = octagon.WorldToPixel( worldPt, pixelPt );
+        retVal = octagon.WorldToPixel( worldPts, pixelPts, count );
     }
     else
     {
@@ -549,8 +551,37 @@ GC_STATUS CalibExecutive::Load( const string jsonFilepath )
             buffer << t.rdbuf();
             jsonString = buffer.str();
 
-            retVal = LoadFromJsonString( jsonString, jsonFilepath );
+            // the binary form next to the json holds the parsed model, so use it while it matches the json
+            string cachePath = CalibCache::CachePath( jsonFilepath );
+            CalibModelOctagon cachedModel;
+            CalibExecParams cachedParams;
+            if ( GC_OK == CalibCache::Read( cachePath, jsonString, cachedModel, cachedParams ) )
+            {
+                paramsCurrent = cachedParams;
+                retVal = octagon.SetCalibModel( cachedModel );
+                if ( GC_OK == retVal )
+                {
+                    retVal = octagon.CalcHomographies();
+                }
+            }
+            else
+            {
+                retVal = LoadFromJsonString( jsonString, jsonFilepath );
+                if ( GC_OK == retVal && "Octagon" == paramsCurrent.calibType )
+                {
+                    // a read-only calibration folder only costs the parse on the next load
+                    CalibCache::Write( cachePath, jsonString, octagon.Model(), paramsCurrent );
+                }
+            }
             calibFileJson = GC_OK == retVal ? jsonString : "";
+            if ( GC_OK == retVal )
+            {
+                loadedFilepath = jsonFilepath;
+                loadedFileTime = fs::last_write_time( jsonFilepath );
+                loadedFileJson = calibFileJson;
+                loadedModel = octagon.Model();
+                loadedParams = paramsCurrent;
+            }
         }
     }
     catch( boost::exception &e )
@@ -558,6 +589,68 @@ GC_STATUS CalibExecutive::Load( const string jsonFilepath )
         FILE_LOG( logERROR ) << "[CalibExecutive::Load] " << diagnostic_information( e );
         retVal = GC_EXCEPT;
     }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[CalibExecutive::Load] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS CalibExecutive::LoadCached( const string jsonFilepath )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        std::error_code ec;
+        fs::file_time_type fileTime = fs::last_write_time( jsonFilepath, ec );
+        if ( loadedFilepath.empty() || jsonFilepath != loadedFilepath || ec || fileTime != loadedFileTime )
+        {
+            retVal = Load( jsonFilepath );
+        }
+        else
+        {
+            // per image octagon calibrations move the model, so put back the one read from the file
+            paramsCurrent = loadedParams;
+            calibFileJson = loadedFileJson;
+            retVal = octagon.SetCalibModel( loadedModel );
+            if ( GC_OK == retVal )
+            {
+                retVal = octagon.CalcHomographies();
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[CalibExecutive::LoadCached] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS CalibExecutive::Restore( const CalibExecutive &source )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        paramsCurrent = source.paramsCurrent;
+        calibFileJson = source.calibFileJson;
+
+        // the homographies are recalculated rather than copied so they never share data with the source
+        retVal = octagon.SetCalibModel( source.octagon.Model() );
+        if ( GC_OK == retVal )
+        {
+            retVal = octagon.CalcHomographies();
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[CalibExecutive::Restore] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS CalibExecutive::InitTargetSearch()
+{
+    GC_STATUS retVal = octagon.SearchObj().Init( GC_OCTAGON_TEMPLATE_DIM, 5 );
     return retVal;
 }
 cv::Rect &CalibExecutive::TargetRoi()
@@ -2,6 +2,7 @@
 #define CALIBEXECUTIVE_H
 
 #include <string>
+#include <filesystem>
 #include "caliboctagon.h"
 
 namespace gc
@@ -146,8 +147,24 @@ public:
     CalibExecutive();
 
     void clear();
-    bool isCalibrated() { return octagon.isCalibrated(); }
+    bool isCalibrated() const { return octagon.isCalibrated(); }
     GC_STATUS Load( const std::string jsonFilepath );
+    GC_STATUS LoadCached( const std::string jsonFilepath );
+
+    /**
+     * @brief Put back the calibration of another executive, e.g. a shared one loaded once, without
+     *        touching the other executive. The octagon templates already built are kept
+     * @param source Executive that holds the calibration as it was loaded
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Restore( const CalibExecutive &source );
+
+    /**
+     * @brief Build the octagon search templates now rather than on the first calibration, so that
+     *        copies of this executive share them instead of each building their own
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS InitTargetSearch();
     GC_STATUS LoadFromJsonString( const std::string jsonString , const std::string jsonFilepath = "" );
     GC_STATUS LoadFromJsonString();
     GC_STATUS CalibSaveOctagon( const std::string jsonFilepath );
@@ -156,8 +173,10 @@ public:
     GC_STATUS Calibrate( const cv::Mat &img, const std::string jsonParams, cv::Mat &imgResult,
                          double &rmseDist, double &rmseX, double &rmseY, std::string &err_msg, const bool save = false,
                          const bool drawAll = false );
-    GC_STATUS PixelToWorld( const cv::Point2d pixelPt, cv::Point2d &worldPt );
-    GC_STATUS WorldToPixel( const cv::Point2d worldPt, cv::Point2d &pixelPt );
+    GC_STATUS PixelToWorld( const cv::Point2d pixelPt, cv::Point2d &worldPt ) { return PixelToWorld( &pixelPt, &worldPt, 1 ); }
+    GC_STATUS WorldToPixel( const cv::Point2d worldPt, cv::Point2d &pixelPt ) { return WorldToPixel( &worldPt, &pixelPt, 1 ); }
+    GC_STATUS PixelToWorld( const cv::Point2d *pixelPts, cv::Point2d *worldPts, const size_t count );
+    GC_STATUS WorldToPixel( const cv::Point2d *worldPts, cv::Point2d *pixelPts, const size_t count );
     GC_STATUS DrawOverlay( const cv::Mat matIn, cv::Mat &imgMatOut , const bool drawAll = false );
     GC_STATUS DrawOverlay( const cv::Mat matIn, cv::Mat &imgMatOut, const bool drawCalibScale,
                            const bool drawCalibGrid, const bool drawSearchROI, const bool drawTargetROI );
@@ -165,10 +184,12 @@ public:
     GC_STATUS AdjustOctagonForRotation( const cv::Size imgSize, const FindPointSet &calcLinePts, double &offsetAngle );
 
     CalibModelOctagon &CalibModel() { return octagon.Model(); }
+    const CalibModelOctagon &CalibModel() const { return octagon.Model(); }
     GC_STATUS SetCalibModel( CalibModelOctagon newModel );
     std::vector< LineEnds > &SearchLines();
     cv::Rect &TargetRoi();
     std::string &GetCalibType() { return paramsCurrent.calibType; }
+    const std::string &GetCalibType() const { return paramsCurrent.calibType; }
     GC_STATUS GetCalibParams( std::string &calibParams );
     GC_STATUS GetCalibControlJson( std::string &calibJson );
     GC_STATUS SetCalibFromJson( const std::string &jsonParams );
@@ -193,6 +214,14 @@ private:
     cv::Rect nullRect = cv::Rect( -1, -1, -1, -1 );
     std::string calibFileJson;
 
+    // state as it was after the last successful Load(), so an unchanged calibration file
+    // can be restored without being read and parsed again
+    std::string loadedFilepath;
+    std::filesystem::file_time_type loadedFileTime;
+    std::string loadedFileJson;
+    CalibModelOctagon loadedModel;
+    CalibExecParams loadedParams;
+
     GC_STATUS CalibrateOctagon( const cv::Mat &img, const std::string &controlJson, std::string &err_msg );
     GC_STATUS CalculateRMSE( const std::vector< cv::Point2d > &foundPts, std::vector< cv::Point2d > &reprojectedPts,
                              double &rmseEuclideanDist, double &rmseX, double &rmseY );
@@ -15,6 +15,7 @@
 #include <iostream>
 #include <algorithm>
 #include "searchlines.h"
+#include "stagetimer.h"
 
 #ifdef DEBUG_FIND_CALIB_SYMBOL
 #undef DEBUG_FIND_CALIB_SYMBOL
@@ -73,8 +74,14 @@ void CalibOctagon::clear()
 {
     matHomogPixToWorld = Mat();
     matHomogWorldToPix = Mat();
+    CacheHomographies();
     model.clear();
 }
+void CalibOctagon::CacheHomographies()
+{
+    homogPixToWorld.Set( matHomogPixToWorld );
+    homogWorldToPix.Set( matHomogWorldToPix );
+}
 GC_STATUS CalibOctagon::GetCalibParams( std::string &calibParams )
 {
     GC_STATUS retVal = GC_OK;
@@ -147,6 +154,7 @@ GC_STATUS CalibOctagon::DrawAssocPts( const cv::Mat &img, cv::Mat &overlay, stri
 // symbolPoints are clockwise ordered with 0 being the topmost left point
 GC_STATUS CalibOctagon::Calibrate( const cv::Mat &img, const std::string &controlJson, string &err_msg )
 {
+    GC_STAGE_TIMER( "calibrate" );
     GC_STATUS retVal = GC_OK;
 
     CalibModelOctagon oldModel;
@@ -342,6 +350,7 @@ GC_STATUS CalibOctagon::Calibrate( const cv::Mat &img, const std::string &contro
     {
         oldHomogPixToWorld.copyTo( matHomogPixToWorld );
         oldHomogWorldToPix.copyTo( matHomogWorldToPix );
+        CacheHomographies();
         model = oldModel;
     }
 
@@ -523,6 +532,7 @@ GC_STATUS CalibOctagon::CreateCalibration( const std::vector< cv::Point2d > &pix
         FILE_LOG( logERROR ) << "[CalibOctagon::Calibrate] " << e.what();
         retVal = GC_EXCEPT;
     }
+    CacheHomographies();
 
     return retVal;
 }
@@ -1271,59 +1281,32 @@ GC_STATUS CalibOctagon::GetNonZeroPoints( cv::Mat &img, std::vector< cv::Point >
 
     return retVal;
 }
-GC_STATUS CalibOctagon::PixelToWorld( const Point2d ptPixel, Point2d &ptWorld )
+GC_STATUS CalibOctagon::PixelToWorld( const cv::Point2d *ptsPixel, cv::Point2d *ptsWorld, const size_t count ) const
 {
     GC_STATUS retVal = GC_OK;
-
-    try
+    if ( !homogPixToWorld.IsSet() )
     {
-        if ( matHomogPixToWorld.empty() )
-        {
-            FILE_LOG( logERROR ) << "[CalibOctagon::PixelToWorld] No calibration for pixel to world conversion";
-            retVal = GC_ERR;
-        }
-        else
-        {
-            vector< Point2d > vecIn, vecOut;
-            vecIn.push_back( ptPixel );
-            perspectiveTransform( vecIn, vecOut, matHomogPixToWorld );
-            ptWorld = vecOut[ 0 ];
-        }
+        FILE_LOG( logERROR ) << "[CalibOctagon::PixelToWorld] No calibration for pixel to world conversion";
+        retVal = GC_ERR;
     }
-    catch( Exception &e )
+    else
     {
-        FILE_LOG( logERROR ) << "[CalibOctagon::PixelToWorld] " << e.what();
-        retVal = GC_EXCEPT;
+        homogPixToWorld.Apply( ptsPixel, ptsWorld, count );
     }
-
     return retVal;
 }
-GC_STATUS CalibOctagon::WorldToPixel( const Point2d ptWorld, Point2d &ptPixel )
+GC_STATUS CalibOctagon::WorldToPixel( const cv::Point2d *ptsWorld, cv::Point2d *ptsPixel, const size_t count ) const
 {
     GC_STATUS retVal = GC_OK;
-
-    try
+    if ( !homogWorldToPix.IsSet() )
     {
-        if ( matHomogWorldToPix.empty() )
-        {
-            FILE_LOG( logERROR ) << "[CalibOctagon::WorldToPixel]"
-                                    "No calibration for world to pixel conversion";
-            retVal = GC_ERR;
-        }
-        else
-        {
-            vector< Point2d > vecIn, vecOut;
-            vecIn.push_back( ptWorld );
-            perspectiveTransform( vecIn, vecOut, matHomogWorldToPix );
-            ptPixel = vecOut[ 0 ];
-        }
+        FILE_LOG( logERROR ) << "[CalibOctagon::WorldToPixel] No calibration for world to pixel conversion";
+        retVal = GC_ERR;
     }
-    catch( Exception &e )
+    else
     {
-        FILE_LOG( logERROR ) << "[CalibOctagon::WorldToPixel] " << e.what();
-        retVal = GC_EXCEPT;
+        homogWorldToPix.Apply( ptsWorld, ptsPixel, count );
     }
-
     return retVal;
 }
 GC_STATUS CalibOctagon::DrawOverlay( const cv::Mat &img, cv::Mat &result, const bool drawCalibScale,
@@ -1561,25 +1544,23 @@ GC_STATUS CalibOctagon::GetXEdgeMinDiffX(const double xWorld, cv::Point2d &ptPix
         if ( GC_OK == retVal )
         {
             minDiff = fabs( xWorld - ptWorld.y );
+
+            // the whole image row in one transform
+            vector< Point2d > rowPts;
             for ( int i = 1; i < model.imgSize.width; ++i )
+                rowPts.push_back( Point2d( i, y_pos ) );
+            retVal = PixelToWorld( rowPts.data(), rowPts.data(), rowPts.size() );
+            if ( GC_OK == retVal )
             {
-                retVal = PixelToWorld( Point2d( i, y_pos ), ptWorld );
-                if ( GC_OK == retVal )
+                for ( size_t i = 0; i < rowPts.size(); ++i )
                 {
-                    diff = fabs( xWorld - ptWorld.x );
+                    diff = fabs( xWorld - rowPts[ i ].x );
                     if ( minDiff > diff )
                     {
-                        x_min = i;
+                        x_min = static_cast< double >( i + 1 );
                         minDiff = diff;
                     }
                 }
-                else
-                {
-                    break;
-                }
-            }
-            if ( GC_OK == retVal )
-            {
                 ptPix = Point2d( x_min, y_pos );
             }
         }
@@ -1606,25 +1587,23 @@ GC_STATUS CalibOctagon::GetXEdgeMinDiffY(const double yWorld, cv::Point2d &ptPix
         if ( GC_OK == retVal )
         {
             minDiff = fabs( yWorld - ptWorld.y );
+
+            // the whole image column in one transform
+            vector< Point2d > colPts;
             for ( int i = 1; i < model.imgSize.height; ++i )
+                colPts.push_back( Point2d( x_pos, i ) );
+            retVal = PixelToWorld( colPts.data(), colPts.data(), colPts.size() );
+            if ( GC_OK == retVal )
             {
-                retVal = PixelToWorld( Point2d( x_pos, i ), ptWorld );
-                if ( GC_OK == retVal )
+                for ( size_t i = 0; i < colPts.size(); ++i )
                 {
-                    diff = fabs( yWorld - ptWorld.y );
+                    diff = fabs( yWorld - colPts[ i ].y );
                     if ( minDiff > diff )
                     {
-                        y_min = i;
+                        y_min = static_cast< double >( i + 1 );
                         minDiff = diff;
                     }
                 }
-                else
-                {
-                    break;
-                }
-            }
-            if ( GC_OK == retVal )
-            {
                 ptPix = Point2d( x_pos, y_min );
             }
         }
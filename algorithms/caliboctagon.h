@@ -4,6 +4,7 @@
 #include "gc_types.h"
 #include <opencv2/core.hpp>
 #include "octagonsearch.h"
+#include "homography.h"
 
 // TODO -- add doxygen comments KWC
 namespace gc
@@ -63,15 +64,34 @@ class CalibOctagon
 {
 public:
     CalibOctagon();
-    bool isCalibrated() { return model.validCalib; }
+    bool isCalibrated() const { return model.validCalib; }
     GC_STATUS Load( const std::string jsonCalString );
     GC_STATUS Save( const std::string jsonCalFilepath );
     GC_STATUS CalcHomographies();
     GC_STATUS Calibrate( const cv::Mat &img, const std::string &controlJson, std::string &err_msg );
     GC_STATUS AdjustOctagonForRotation( const cv::Size imgSize, const FindPointSet &calcLinePts, double &offsetAngle );
 
-    GC_STATUS PixelToWorld( const cv::Point2d ptPixel, cv::Point2d &ptWorld );
-    GC_STATUS WorldToPixel( const cv::Point2d ptWorld, cv::Point2d &ptPixel );
+
+    /**
+     * @brief Transform an array of pixel points to world coordinates with the cached homography
+     * @param ptsPixel Pixel points
+     * @param ptsWorld Array of at least count points to hold the world points (may be ptsPixel)
+     * @param count Number of points
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS PixelToWorld( const cv::Point2d *ptsPixel, cv::Point2d *ptsWorld, const size_t count ) const;
+
+    /**
+     * @brief Transform an array of world points to pixel coordinates with the cached homography
+     * @param ptsWorld World points
+     * @param ptsPixel Array of at least count points to hold the pixel points (may be ptsWorld)
+     * @param count Number of points
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS WorldToPixel( const cv::Point2d *ptsWorld, cv::Point2d *ptsPixel, const size_t count ) const;
+
+    GC_STATUS PixelToWorld( const cv::Point2d ptPixel, cv::Point2d &ptWorld ) const { return PixelToWorld( &ptPixel, &ptWorld, 1 ); }
+    GC_STATUS WorldToPixel( const cv::Point2d ptWorld, cv::Point2d &ptPixel ) const { return WorldToPixel( &ptWorld, &ptPixel, 1 ); }
     GC_STATUS DrawOverlay( const cv::Mat &img, cv::Mat &result, const bool drawCalibScale,
                            const bool drawCalibGrid, const bool drawSearchROI , const bool drawTargetSearchROI );
     GC_STATUS DrawAssocPts( const cv::Mat &img, cv::Mat &overlay, std::string &err_msg );
@@ -87,6 +107,7 @@ public:
     std::vector< LineEnds > &SearchLineSet() { return model.searchLineSet; }
     std::string ControlJson() { return model.controlJson; }
     CalibModelOctagon &Model() { return model; }
+    const CalibModelOctagon &Model() const { return model; }
     OctagonSearch &SearchObj() { return octagonSearch; }
     GC_STATUS GetSearchRegionBoundingRect( cv::Rect &rect );
 
@@ -95,6 +116,8 @@ public:
 private:
     cv::Mat matHomogPixToWorld;
     cv::Mat matHomogWorldToPix;
+    Homography homogPixToWorld;         ///< matHomogPixToWorld as doubles for the point transforms
+    Homography homogWorldToPix;         ///< matHomogWorldToPix as doubles for the point transforms
     CalibModelOctagon model;
     OctagonSearch octagonSearch;
 
@@ -112,6 +135,7 @@ private:
     GC_STATUS CalcGridDrawPoints (std::vector< OctagonLine > &horzLines, std::vector< OctagonLine > &vertLines );
     GC_STATUS GetXEdgeMinDiffX( const double xWorld, cv::Point2d &ptPix, const bool isTopSideY );
     GC_STATUS GetXEdgeMinDiffY( const double yWorld, cv::Point2d &ptPix, const bool isRightSideX );
+    void CacheHomographies();
     GC_STATUS CalcSearchROI( const double botLftPtToLft, const double botLftPtToTop,
                              const double botLftPtToRgt, const double botLftPtToBot, cv::Point2d &lftTop,
                              cv::Point2d &rgtTop, cv::Point2d &lftBot, cv::Point2d &rgtBot );
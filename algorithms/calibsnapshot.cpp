@@ -0,0 +1,113 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#include "log.h"
+#include "calibsnapshot.h"
+
+using namespace std;
+
+namespace gc
+{
+
+GC_STATUS CalibrationSnapshot::Create( const std::string calibPath, std::shared_ptr< const CalibrationSnapshot > &snapshot )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        shared_ptr< CalibrationSnapshot > created( new CalibrationSnapshot() );
+        retVal = created->m_calib.Load( calibPath );
+        if ( GC_OK != retVal )
+        {
+            FILE_LOG( logERROR ) << "[CalibrationSnapshot::Create] Could not load calibration " << calibPath;
+        }
+        else if ( !created->m_calib.isCalibrated() )
+        {
+            FILE_LOG( logERROR ) << "[CalibrationSnapshot::Create] No valid calibration in " << calibPath;
+            retVal = GC_ERR;
+        }
+        else
+        {
+            retVal = created->m_calib.InitTargetSearch();
+            if ( GC_OK != retVal )
+            {
+                FILE_LOG( logERROR ) << "[CalibrationSnapshot::Create] Could not build octagon search templates";
+            }
+            else
+            {
+                created->m_calibPath = calibPath;
+                snapshot = created;
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[CalibrationSnapshot::Create] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS FindLineContext::Bind( const std::shared_ptr< const CalibrationSnapshot > &newSnapshot )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( nullptr == newSnapshot )
+        {
+            FILE_LOG( logERROR ) << "[FindLineContext::Bind] No calibration snapshot";
+            retVal = GC_ERR;
+        }
+        else
+        {
+            if ( newSnapshot != snapshot )
+            {
+                // cv::Mat copies share their pixels, so the templates are not duplicated
+                calib = newSnapshot->Calib();
+                snapshot = newSnapshot;
+            }
+            // recalculated homographies keep the per image calibration from writing into shared data
+            retVal = calib.Restore( snapshot->Calib() );
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FindLineContext::Bind] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+
+std::unique_ptr< FindLineContext > FindLineContextPool::Acquire()
+{
+    lock_guard< mutex > lock( m_mutex );
+    if ( m_contexts.empty() )
+    {
+        return make_unique< FindLineContext >();
+    }
+    unique_ptr< FindLineContext > context = std::move( m_contexts.back() );
+    m_contexts.pop_back();
+    return context;
+}
+void FindLineContextPool::Release( std::unique_ptr< FindLineContext > context )
+{
+    if ( nullptr != context )
+    {
+        lock_guard< mutex > lock( m_mutex );
+        m_contexts.push_back( std::move( context ) );
+    }
+}
+
+} // namespace gc
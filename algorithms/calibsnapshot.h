@@ -0,0 +1,169 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/** \file calibsnapshot.h
+ * @brief A file for an immutable calibration that any number of threads can find lines against
+ *        at the same time, and the per request state each of those finds works in
+ *
+ * A CalibrationSnapshot is loaded once and only ever read, so it is handed around as a
+ * std::shared_ptr< const CalibrationSnapshot > without locks. Each image is calibrated
+ * against the octagon it shows, which moves the model, so every request works in a
+ * FindLineContext that holds its own copy of the small per image state. The octagon search
+ * templates, the costly part, are built once in the snapshot and shared by the contexts.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef CALIBSNAPSHOT_H
+#define CALIBSNAPSHOT_H
+
+#include "gc_types.h"
+#include "calibexecutive.h"
+#include "findline.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief Calibration and octagon search templates loaded from one calibration file. Immutable
+ *        once created, so one snapshot can be shared by all threads
+ */
+class CalibrationSnapshot
+{
+public:
+    /**
+     * @brief Load a calibration file and build its octagon search templates
+     * @param calibPath Path of the calibration json file
+     * @param snapshot Pointer to hold the new snapshot
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    static GC_STATUS Create( const std::string calibPath, std::shared_ptr< const CalibrationSnapshot > &snapshot );
+
+    /**
+     * @brief Calibration as it was loaded from the file
+     */
+    const CalibExecutive &Calib() const { return m_calib; }
+
+    /**
+     * @brief Path of the calibration file the snapshot was loaded from
+     */
+    const std::string &CalibPath() const { return m_calibPath; }
+
+private:
+    CalibrationSnapshot() {}
+
+    CalibExecutive m_calib;
+    std::string m_calibPath;
+};
+
+/**
+ * @brief Per request state of a line find against a CalibrationSnapshot. Not thread safe, each
+ *        thread (or each request in flight) uses its own context, which can be reused from one
+ *        image to the next
+ */
+class FindLineContext
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    FindLineContext() {}
+
+    /**
+     * @brief Make the context ready for an image. The working calibration is copied from the
+     *        snapshot the first time the context sees it and put back to the snapshot calibration
+     *        on later calls
+     * @param snapshot Calibration the next image is to be found against
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Bind( const std::shared_ptr< const CalibrationSnapshot > &snapshot );
+
+    CalibExecutive calib;                                   ///< Working calibration, moved by the per image octagon calibration
+    FindLine findLine;                                      ///< Line finder with its own RANSAC random engine
+    std::shared_ptr< const CalibrationSnapshot > snapshot;  ///< Snapshot the working calibration was copied from
+};
+
+/**
+ * @brief Thread safe pool of contexts for callers that serve requests on threads they do not
+ *        own. Contexts are kept when they are given back, so they stay bound to their snapshot
+ */
+class FindLineContextPool
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    FindLineContextPool() {}
+
+    /**
+     * @brief Take a context from the pool, or a new one if the pool is empty
+     * @return Context for the exclusive use of the caller until it is given back
+     */
+    std::unique_ptr< FindLineContext > Acquire();
+
+    /**
+     * @brief Give a context back to the pool
+     * @param context Context taken with Acquire()
+     */
+    void Release( std::unique_ptr< FindLineContext > context );
+
+private:
+    std::mutex m_mutex;
+    std::vector< std::unique_ptr< FindLineContext > > m_contexts;
+};
+
+/**
+ * @brief Holds a context of a FindLineContextPool for the scope it is declared in
+ */
+class FindLineContextLease
+{
+public:
+    /**
+     * @brief Constructor, takes a context from the pool
+     * @param pool Pool to take the context from
+     */
+    explicit FindLineContextLease( FindLineContextPool &pool ) : m_pool( pool ), m_context( pool.Acquire() ) {}
+
+    /**
+     * @brief Destructor, gives the context back to the pool
+     */
+    ~FindLineContextLease() { m_pool.Release( std::move( m_context ) ); }
+
+    FindLineContextLease( const FindLineContextLease & ) = delete;
+    FindLineContextLease &operator=( const FindLineContextLease & ) = delete;
+
+    /**
+     * @brief The leased context
+     */
+    FindLineContext &Context() { return *m_context; }
+
+private:
+    FindLineContextPool &m_pool;
+    std::unique_ptr< FindLineContext > m_context;
+};
+
+} // namespace gc
+
+#endif // CALIBSNAPSHOT_H
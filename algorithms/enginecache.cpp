@@ -0,0 +1,76 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#include "log.h"
+#include "enginecache.h"
+#include "visapp.h"
+#include "calibsnapshot.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace gc
+{
+
+EngineCache::EngineCache( const size_t capacity ) :
+    m_capacity( std::max( static_cast< size_t >( 1 ), capacity ) ),
+    m_evictionCount( 0 )
+{
+}
+VisApp *EngineCache::Get( const std::string &calibKey, std::string &calibPath, bool &isCreated )
+{
+    auto found = m_index.find( calibKey );
+    if ( m_index.end() != found )
+    {
+        // most recently used engines are kept at the front
+        m_entries.splice( m_entries.begin(), m_entries, found->second );
+        calibPath = m_entries.front().calibPath;
+        isCreated = false;
+        return m_entries.front().engine.get();
+    }
+
+    if ( m_entries.size() >= m_capacity )
+    {
+        m_index.erase( m_entries.back().calibKey );
+        m_entries.pop_back();
+        ++m_evictionCount;
+    }
+
+    EngineCacheEntry entry;
+    entry.calibKey = calibKey;
+    entry.calibPath = calibPath;
+    entry.engine = make_shared< VisApp >();
+    m_entries.push_front( entry );
+    m_index[ calibKey ] = m_entries.begin();
+    isCreated = true;
+    return m_entries.front().engine.get();
+}
+void EngineCache::HoldSnapshot( const std::string &calibKey, const std::shared_ptr< const CalibrationSnapshot > &snapshot )
+{
+    auto found = m_index.find( calibKey );
+    if ( m_index.end() != found )
+    {
+        found->second->snapshot = snapshot;
+    }
+}
+void EngineCache::Clear()
+{
+    m_index.clear();
+    m_entries.clear();
+}
+
+} // namespace gc
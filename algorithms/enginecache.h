@@ -0,0 +1,114 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/** \file enginecache.h
+ * @brief A file for a least recently used cache of calibrated VisApp engines
+ *
+ * Loading a calibration builds the octagon model and its search templates, which costs far more
+ * than a line find. A worker that serves images from several camera sites keeps one engine per
+ * calibration, so switching sites does not reload a calibration that was used recently.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef ENGINECACHE_H
+#define ENGINECACHE_H
+
+#include "gc_types.h"
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+class VisApp;
+class CalibrationSnapshot;
+
+/**
+ * @brief Data class that holds one cached engine
+ */
+class EngineCacheEntry
+{
+public:
+    std::string calibKey;               ///< Hash of the calibration file contents
+    std::string calibPath;              ///< Calibration path the engine loads (the first path seen with the key)
+    std::shared_ptr< VisApp > engine;   ///< Engine that keeps the loaded calibration between images
+    std::shared_ptr< const CalibrationSnapshot > snapshot;  ///< Shared calibration the engine started from, kept alive while the engine is cached
+};
+
+/**
+ * @brief Least recently used cache of VisApp engines keyed by calibration hash. Not thread safe,
+ *        each worker thread owns its own cache.
+ */
+class EngineCache
+{
+public:
+    /**
+     * @brief Constructor
+     * @param capacity Maximum number of engines kept (at least one)
+     */
+    EngineCache( const size_t capacity = 1 );
+
+    /**
+     * @brief Get the engine for a calibration, creating it and evicting the least recently used
+     *        engine if it is not in the cache
+     * @param calibKey Hash of the calibration file contents
+     * @param calibPath Path of the calibration file, replaced with the path the cached engine loaded
+     *        so that files with the same contents share one engine
+     * @param isCreated Set true if a new engine was created
+     * @return Engine for the calibration
+     */
+    VisApp *Get( const std::string &calibKey, std::string &calibPath, bool &isCreated );
+
+    /**
+     * @brief Keep the shared calibration snapshot of a cached engine alive until the engine is evicted
+     * @param calibKey Hash of the calibration file contents
+     * @param snapshot Snapshot the engine was attached to
+     */
+    void HoldSnapshot( const std::string &calibKey, const std::shared_ptr< const CalibrationSnapshot > &snapshot );
+
+    /**
+     * @brief Remove all engines
+     */
+    void Clear();
+
+    /**
+     * @brief Number of engines currently cached
+     */
+    size_t Size() const { return m_entries.size(); }
+
+    /**
+     * @brief Number of engines evicted to make room for another calibration
+     */
+    size_t EvictionCount() const { return m_evictionCount; }
+
+private:
+    size_t m_capacity;
+    size_t m_evictionCount;
+    std::list< EngineCacheEntry > m_entries;
+    std::unordered_map< std::string, std::list< EngineCacheEntry >::iterator > m_index;
+};
+
+} // namespace gc
+
+#endif // ENGINECACHE_H
@@ -16,6 +16,7 @@
 
 #include "log.h"
 #include "findline.h"
+#include "stagetimer.h"
 #include <iostream>
 #include <chrono>
 #include <opencv2/imgproc.hpp>
@@ -40,12 +41,31 @@ namespace fs = std::filesystem;
 
 static const int MEDIAN_FILTER_KERN_SIZE = 9;
 
+// the preprocessing filters (11x11 gaussian, 23x23 median, two 5x11 dilations and erosions) reach
+// 36 pixels, so a region this much larger than the search lines preprocesses them as the whole frame would
+static const int SEARCH_ROI_MARGIN = 40;
+
+static cv::Rect SearchLinesRoi( const std::vector< gc::LineEnds > &lines, const cv::Size imgSize )
+{
+    std::vector< cv::Point > ends;
+    for ( const auto &line : lines )
+    {
+        ends.push_back( line.top );
+        ends.push_back( line.bot );
+    }
+    cv::Rect roi = cv::boundingRect( ends );
+    roi = cv::Rect( roi.x - SEARCH_ROI_MARGIN, roi.y - SEARCH_ROI_MARGIN,
+                    roi.width + 2 * SEARCH_ROI_MARGIN, roi.height + 2 * SEARCH_ROI_MARGIN ) & cv::Rect( cv::Point( 0, 0 ), imgSize );
+    return roi.empty() ? cv::Rect( cv::Point( 0, 0 ), imgSize ) : roi;
+}
+
 namespace gc
 {
 
 FindLine::FindLine() :
     m_minLineFindAngle( DEFAULT_MIN_LINE_ANGLE ),
-    m_maxLineFindAngle( DEFAULT_MAX_LINE_ANGLE )
+    m_maxLineFindAngle( DEFAULT_MAX_LINE_ANGLE ),
+    m_memoryMode( GC_MEMORY_FULL )
 {
 #ifdef DEBUG_FIND_LINE
     if ( !fs::exists( DEBUG_RESULT_FOLDER ) )
@@ -168,8 +188,16 @@ GC_STATUS FindLine::TriagePoints( vector< Point2d > &pts )
 }
 GC_STATUS FindLine::Find( const Mat &img, const vector< LineEnds > &lines, FindLineResult &result )
 {
+    FrameContext frame( img );
+    GC_STATUS retVal = Find( frame, lines, result );
+    return retVal;
+}
+GC_STATUS FindLine::Find( FrameContext &frame, const vector< LineEnds > &lines, FindLineResult &result )
+{
+    GC_STAGE_TIMER( "find_line" );
     result.findSuccess = false;
     GC_STATUS retVal = GC_OK;
+    const Mat &img = frame.Source();
     if ( lines.empty() || img.empty() )
     {
         FILE_LOG( logERROR ) << "[FindLine::Find] Cannot find lines with no search lines defined or in a NULL image";
@@ -192,78 +220,118 @@ GC_STATUS FindLine::Find( const Mat &img, const vector< LineEnds > &lines, FindL
             }
 #endif
 
-            Mat inImg;
-            if ( CV_8UC3 == img.type() )
-                cvtColor( img, inImg, COLOR_BGR2GRAY );
-            else if ( CV_8UC1 == img.type() )
-                inImg = img.clone();
-            else
+            // clean-up a little, unless an earlier find on this frame already did. In GC_MEMORY_ROI
+            // only the region around the search lines is preprocessed
+            Rect roi( 0, 0, img.cols, img.rows );
+            if ( GC_MEMORY_ROI == m_memoryMode )
             {
-                FILE_LOG( logERROR ) << "[FindLine::Find] Invalid image type for find. Must be 8-bit gray or 8-bit bgr";
-                retVal = GC_ERR;
+                roi = SearchLinesRoi( lines, img.size() );
             }
-
-            if ( GC_OK == retVal )
+            Mat scratch = frame.Preprocessed();
+            Rect scratchRoi = frame.PreprocessedRoi();
+            if ( scratch.empty() || ( scratchRoi & roi ) != roi )
             {
-                // clean-up a little
-                Mat scratch;
-                retVal = Preprocess( inImg, scratch );
+                Mat inImg;
+                retVal = frame.Gray( inImg );
                 if ( GC_OK == retVal )
                 {
-#ifdef DEBUG_FIND_LINE
-                    bool isOK = imwrite( DEBUG_RESULT_FOLDER + "preprocess.png", scratch );
-#endif
-                    size_t start;
-                    Point2d linePt;
-                    string timestamp = result.timestamp;
-                    result.timestamp = timestamp;
-                    size_t linesPerSwath = lines.size() / 10;
-                    for ( size_t i = 0; i < 9; ++i )
+                    retVal = Preprocess( inImg( roi ), scratch );
+                    if ( GC_OK == retVal )
                     {
-                        start = i * linesPerSwath;
-                        retVal = EvaluateSwath( scratch, lines, start, start + linesPerSwath, linePt, result );
-                        if ( GC_OK == retVal )
-                            result.foundPoints.push_back( linePt );
+                        scratchRoi = roi;
+                        frame.SetPreprocessed( scratch, scratchRoi );
                     }
-                    start = lines.size() - linesPerSwath - 1;
-                    retVal = EvaluateSwath( scratch, lines, start, lines.size() - 1, linePt, result );
+                }
+            }
+
+            if ( GC_OK == retVal )
+            {
+#ifdef DEBUG_FIND_LINE
+                bool isOK = imwrite( DEBUG_RESULT_FOLDER + "preprocess.png", scratch );
+#endif
+                // the swaths are searched in the coordinates of the preprocessed region and their
+                // points moved back to the frame afterwards
+                const Point offset = scratchRoi.tl();
+                vector< LineEnds > roiLines;
+                if ( Point( 0, 0 ) != offset )
+                {
+                    for ( const auto &searchLine : lines )
+                        roiLines.push_back( LineEnds( searchLine.top - offset, searchLine.bot - offset ) );
+                }
+                const vector< LineEnds > &swathLines = roiLines.empty() ? lines : roiLines;
+                const size_t foundStart = result.foundPoints.size();
+                const size_t diagStart = result.diagRowSums.size();
+                const size_t diag1stStart = result.diag1stDeriv.size();
+                const size_t diag2ndStart = result.diag2ndDeriv.size();
+
+                size_t start;
+                Point2d linePt;
+                string timestamp = result.timestamp;
+                result.timestamp = timestamp;
+                size_t linesPerSwath = swathLines.size() / 10;
+                for ( size_t i = 0; i < 9; ++i )
+                {
+                    start = i * linesPerSwath;
+                    retVal = EvaluateSwath( scratch, swathLines, start, start + linesPerSwath, linePt, result );
                     if ( GC_OK == retVal )
                         result.foundPoints.push_back( linePt );
+                }
+                start = swathLines.size() - linesPerSwath - 1;
+                retVal = EvaluateSwath( scratch, swathLines, start, swathLines.size() - 1, linePt, result );
+                if ( GC_OK == retVal )
+                    result.foundPoints.push_back( linePt );
 
-#ifdef DEBUG_FIND_LINE
-                    line( outImg, lines[ 0 ].top, lines[ 0 ].bot, Scalar( 0, 255, 255 ), 3 );
-                    line( outImg, lines[ lines.size() - 1 ].top, lines[ lines.size() - 1 ].bot, Scalar( 0, 255, 255 ), 3 );
-                    isOK = imwrite( DEBUG_RESULT_FOLDER + "rowsums.png", outImg );
-                    if ( !isOK )
+                if ( Point( 0, 0 ) != offset )
+                {
+                    for ( size_t i = foundStart; i < result.foundPoints.size(); ++i )
+                        result.foundPoints[ i ] += Point2d( offset );
+                    auto shiftDiag = [ &offset ]( vector< vector< Point > > &diag, const size_t from )
                     {
-                        FILE_LOG( logERROR ) << "[FindLine::Find] Could not write debug image " << DEBUG_RESULT_FOLDER << "rowsums.png";
-                    }
+                        for ( size_t i = from; i < diag.size(); ++i )
+                        {
+                            for ( auto &pt : diag[ i ] )
+                                pt += offset;
+                        }
+                    };
+                    shiftDiag( result.diagRowSums, diagStart );
+                    shiftDiag( result.diag1stDeriv, diag1stStart );
+                    shiftDiag( result.diag2ndDeriv, diag2ndStart );
+                }
+
+#ifdef DEBUG_FIND_LINE
+                line( outImg, lines[ 0 ].top, lines[ 0 ].bot, Scalar( 0, 255, 255 ), 3 );
+                line( outImg, lines[ lines.size() - 1 ].top, lines[ lines.size() - 1 ].bot, Scalar( 0, 255, 255 ), 3 );
+                isOK = imwrite( DEBUG_RESULT_FOLDER + "rowsums.png", outImg );
+                if ( !isOK )
+                {
+                    FILE_LOG( logERROR ) << "[FindLine::Find] Could not write debug image " << DEBUG_RESULT_FOLDER << "rowsums.png";
+                }
 #endif
 
-                    double xCenter = ( lines[ 0 ].bot.x + lines[ lines.size() - 1 ].bot.x ) / 2.0;
-                    retVal = TriagePoints( result.foundPoints );
+                // the line is fit in frame coordinates, so it spans the frame width, not the preprocessed region
+                double xCenter = ( lines[ 0 ].bot.x + lines[ lines.size() - 1 ].bot.x ) / 2.0;
+                retVal = TriagePoints( result.foundPoints );
+                if ( GC_OK == retVal )
+                {
+                    retVal = FitLineRANSAC( result.foundPoints, result.calcLinePts, xCenter, img );
                     if ( GC_OK == retVal )
                     {
-                        retVal = FitLineRANSAC( result.foundPoints, result.calcLinePts, xCenter, scratch );
+                        result.findSuccess = true;
+                    }
+                }
+                if ( GC_OK != retVal )
+                {
+                    retVal = RemoveOutliers( result.foundPoints, 5 );
+                    if ( GC_OK == retVal )
+                    {
+                        retVal = FitLineRANSAC( result.foundPoints, result.calcLinePts, xCenter, img );
                         if ( GC_OK == retVal )
                         {
                             result.findSuccess = true;
                         }
-                    }
-                    if ( GC_OK != retVal )
-                    {
-                        retVal = RemoveOutliers( result.foundPoints, 5 );
-                        if ( GC_OK == retVal )
+                        else
                         {
-                            retVal = FitLineRANSAC( result.foundPoints, result.calcLinePts, xCenter, scratch );
-                            if ( GC_OK == retVal )
-                            {
-                                result.findSuccess = true;
-                            }
-                            else
-                            {
-                                result.clear();
-                            }
+                            result.clear();
                         }
                     }
                 }
@@ -281,6 +349,7 @@ GC_STATUS FindLine::Find( const Mat &img, const vector< LineEnds > &lines, FindL
 }
 GC_STATUS FindLine::Preprocess( const cv::Mat &src, cv::Mat &dst )
 {
+    GC_STAGE_TIMER( "preprocess" );
     GC_STATUS retVal = GC_OK;
     if ( src.empty() )
     {
@@ -310,6 +379,7 @@ GC_STATUS FindLine::Preprocess( const cv::Mat &src, cv::Mat &dst )
 GC_STATUS FindLine::FitLineRANSAC( const std::vector< Point2d > &pts, FindPointSet &findPtSet,
                                    const double xCenter, const cv::Mat &img )
 {
+    GC_STAGE_TIMER( "ransac" );
     GC_STATUS retVal = 5 > pts.size() ? GC_ERR : GC_OK;
     if ( GC_OK != retVal )
     {
@@ -721,6 +791,7 @@ GC_STATUS FindLine::CalcSwathPoint( const vector< LineEnds > &swath, const vecto
 }
 GC_STATUS FindLine::CalcRowSums( const Mat &img, const vector< LineEnds > &lines, vector< uint > &rowSums )
 {
+    GC_STAGE_TIMER( "row_sums" );
     GC_STATUS retVal = lines.empty() || img.empty() ? GC_ERR : GC_OK;
     if ( GC_OK != retVal )
     {
@@ -40,6 +40,7 @@
 #define FINDLINE_H
 
 #include "gc_types.h"
+#include "framecontext.h"
 #include <vector>
 #include <random>
 #include <opencv2/core.hpp>
@@ -84,6 +85,18 @@ public:
      */
     GC_STATUS SetLineFindAngleBounds( const double minAngle, const double maxAngle );
 
+    /**
+     * @brief Sets how much of a frame the line find preprocesses
+     * @param mode GC_MEMORY_FULL=Whole frame, GC_MEMORY_ROI=Only the region around the search lines
+     *        (same result, less memory)
+     */
+    void SetMemoryMode( const GC_MEMORY_MODE mode ) { m_memoryMode = mode; }
+
+    /**
+     * @brief How much of a frame the line find preprocesses
+     */
+    GC_MEMORY_MODE MemoryMode() const { return m_memoryMode; }
+
     /**
      * @brief Initializes the bowtie target templates in this objects instance of the calibration object
      * @param bowTieTemplateDim The template dimension will create an nxn template
@@ -101,13 +114,23 @@ public:
      */
     GC_STATUS Find( const cv::Mat &img, const std::vector< LineEnds > &lines, FindLineResult &result );
 
+    /**
+     * @brief Given a frame with a calibration target find the water level in it. The grayscale and
+     *        preprocessed images are taken from the frame, and the preprocessed image is left in it
+     * @param frame The frame to be searched
+     * @param lines a vector of vertical lines that pass over the water line along which to be searched
+     * @param result The result of the line search
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Find( FrameContext &frame, const std::vector< LineEnds > &lines, FindLineResult &result );
+
 
     /**
      * @brief Perform a RANSAC line fit to
      * @param pts Candidate points for RANSAC line fit
      * @param findPtSet Object that holds line ends, center, and angle
      * @param xCenter Search roi vertical center
-     * @param img Image in which the line fit occurred
+     * @param img Full frame in which the line fit occurred (its width sets the right line end)
      * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
      */
     GC_STATUS FitLineRANSAC( const std::vector< cv::Point2d > &pts, FindPointSet &findPtSet, const double xCenter, const cv::Mat &img );
@@ -140,20 +163,37 @@ public:
      */
     GC_STATUS Preprocess( const cv::Mat &src, cv::Mat &dst );
 
+    /**
+     * @brief Calculate the sum of the pixel values of each row of a swath of search lines
+     * @param img Preprocessed image to be searched
+     * @param lines Search lines of the swath
+     * @param rowSums Vector to hold one sum per position along the search lines
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS CalcRowSums( const cv::Mat &img, const std::vector< LineEnds > &lines, std::vector< uint > &rowSums );
+
+    /**
+     * @brief Median filter a vector of row sums
+     * @param kernSize Filter kernel size
+     * @param values Values to be filtered
+     * @param valuesOut Vector to hold the filtered values
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS MedianFilter( const size_t kernSize, const std::vector< uint > values, std::vector< uint > &valuesOut );
+
 private:
     double m_minLineFindAngle;
     double m_maxLineFindAngle;
     std::default_random_engine m_randomEngine;
+    GC_MEMORY_MODE m_memoryMode;
 
     GC_STATUS TriagePoints( std::vector< cv::Point2d > &pts );
     GC_STATUS RemoveOutliers( std::vector< cv::Point2d > &pts, const size_t numToKeep );
     GC_STATUS GetRandomNumbers( const int low_bound, const int high_bound, const int cnt_to_generate,
                                 std::vector< int > &numbers, const bool isFirst );
-    GC_STATUS CalcRowSums( const cv::Mat &img, const std::vector< LineEnds > &lines, std::vector< uint > &rowSums );
     GC_STATUS EvaluateSwath( const cv::Mat &img, const std::vector< LineEnds > &lines, const size_t startIndex,
                              const size_t endIndex, cv::Point2d &resultPt, FindLineResult &result );
     GC_STATUS CalcSwathPoint( const std::vector< LineEnds > &swath, const std::vector< uint > &rowSums, cv::Point2d &resultPt );
-    GC_STATUS MedianFilter( const size_t kernSize, const std::vector< uint > values, std::vector< uint > &valuesOut );
 
     GC_STATUS GetSlopeIntercept( const cv::Point2d one, const cv::Point2d two, double &slope, double &intercept );
     GC_STATUS CalculateRowSumsLines( const std::vector< uint > rowSums, const std::vector< LineEnds > lines, std::vector< std::vector< cv::Point > > &rowSumsLines,
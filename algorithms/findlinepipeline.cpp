@@ -0,0 +1,579 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "log.h"
+#include "findlinepipeline.h"
+#include "visapp.h"
+#include "resultsink.h"
+#include "resultlog.h"
+#include "runmanifest.h"
+#include "enginecache.h"
+#include <map>
+#include <algorithm>
+#include <chrono>
+
+using namespace cv;
+using namespace std;
+
+static const size_t MANIFEST_FLUSH_COUNT = 256;
+
+static double SecondsSince( const chrono::steady_clock::time_point start )
+{
+    return chrono::duration< double >( chrono::steady_clock::now() - start ).count();
+}
+
+namespace gc
+{
+
+FindLinePipeline::FindLinePipeline() :
+    m_isRunning( false ),
+    m_pushCount( 0 ),
+    m_writtenCount( 0 ),
+    m_runStatus( GC_OK ),
+    m_callback( nullptr )
+{
+}
+FindLinePipeline::~FindLinePipeline()
+{
+    if ( m_isRunning )
+    {
+        Finish();
+    }
+}
+GC_STATUS FindLinePipeline::Start( const FindLinePipelineConfig config, FindLineResultCallback callback )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( m_isRunning )
+        {
+            FILE_LOG( logERROR ) << "[FindLinePipeline::Start] Pipeline is already running";
+            retVal = GC_ERR;
+        }
+        else
+        {
+            int hwThreads = std::max( 1, static_cast< int >( thread::hardware_concurrency() ) );
+
+            m_config = config;
+            if ( 0 >= m_config.workerThreads )
+                m_config.workerThreads = hwThreads;
+            if ( 0 >= m_config.readThreads )
+                m_config.readThreads = std::max( 1, hwThreads >> 1 );
+            if ( 0 >= m_config.queueDepth )
+            {
+                // decoded images wait in the queues, so a memory budget keeps fewer of them
+                m_config.queueDepth = 0 < m_config.memoryBudgetBytes ? m_config.workerThreads : m_config.workerThreads << 1;
+            }
+            if ( 0 < m_config.memoryBudgetBytes || m_config.trackMemory )
+            {
+                MatMemoryTracker::Instance().Install();
+            }
+            if ( GC_EXCEPT == m_memoryBudget.SetTarget( m_config.memoryBudgetBytes ) )
+            {
+                FILE_LOG( logWARNING ) << "[FindLinePipeline::Start] Could not set the memory budget, finds are not limited";
+            }
+
+            m_callback = callback;
+            m_pushCount = 0;
+            m_writtenCount = 0;
+            m_runStatus = GC_OK;
+            m_stats = FindLinePipelineStats();
+            m_calibKeys.clear();
+            m_snapshots.clear();
+            m_startTime = chrono::steady_clock::now();
+
+            m_readQueue = make_unique< BoundedQueue< FindLinePipelineItem > >( static_cast< size_t >( m_config.queueDepth ) );
+            m_findQueue = make_unique< BoundedQueue< FindLinePipelineItem > >( static_cast< size_t >( m_config.queueDepth ) );
+            m_writeQueue = make_unique< BoundedQueue< FindLinePipelineItem > >( static_cast< size_t >( m_config.queueDepth ) );
+
+            m_isRunning = true;
+            m_writerThread = thread( &FindLinePipeline::WriterThreadFunc, this );
+            for ( int i = 0; i < m_config.workerThreads; ++i )
+            {
+                m_workerThreads.push_back( thread( &FindLinePipeline::WorkerThreadFunc, this ) );
+            }
+            for ( int i = 0; i < m_config.readThreads; ++i )
+            {
+                m_readThreads.push_back( thread( &FindLinePipeline::ReadThreadFunc, this ) );
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FindLinePipeline::Start] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS FindLinePipeline::Push( const FindLineParams &params, const std::string &manifestKey )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( !m_isRunning )
+        {
+            FILE_LOG( logERROR ) << "[FindLinePipeline::Push] Pipeline not started";
+            retVal = GC_ERR;
+        }
+        else
+        {
+            FindLinePipelineItem item;
+            item.index = m_pushCount++;
+            item.params = params;
+            item.manifestKey = manifestKey;
+            if ( !m_readQueue->Push( std::move( item ) ) )
+            {
+                FILE_LOG( logERROR ) << "[FindLinePipeline::Push] Could not queue " << params.imagePath;
+                retVal = GC_ERR;
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FindLinePipeline::Push] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS FindLinePipeline::Finish()
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( m_isRunning )
+        {
+            // each stage is drained and joined before the queue feeding the next stage is closed
+            m_readQueue->Close();
+            for ( size_t i = 0; i < m_readThreads.size(); ++i )
+                m_readThreads[ i ].join();
+            m_readThreads.clear();
+
+            m_findQueue->Close();
+            for ( size_t i = 0; i < m_workerThreads.size(); ++i )
+                m_workerThreads[ i ].join();
+            m_workerThreads.clear();
+            m_snapshots.clear();
+
+            m_writeQueue->Close();
+            if ( m_writerThread.joinable() )
+                m_writerThread.join();
+
+            m_stats.imageCount = m_writtenCount;
+            m_stats.runSecs = SecondsSince( m_startTime );
+            if ( MatMemoryTracker::Instance().IsInstalled() )
+            {
+                m_stats.peakImageBytes = MatMemoryTracker::Instance().PeakBytes();
+            }
+            m_stats.peakRssBytes = ProcessPeakRssBytes();
+            m_isRunning = false;
+        }
+        retVal = m_runStatus;
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FindLinePipeline::Finish] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS FindLinePipeline::PushImage( const FindLineParams &params, const cv::Mat &img, const std::string &timestamp )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( !m_isRunning )
+        {
+            FILE_LOG( logERROR ) << "[FindLinePipeline::PushImage] Pipeline not started";
+            retVal = GC_ERR;
+        }
+        else
+        {
+            FindLinePipelineItem item;
+            item.index = m_pushCount++;
+            item.params = params;
+            item.img = img;
+            item.result.timestamp = timestamp;
+            item.result.illum_state = "N/A";
+            item.isRead = !img.empty();
+            item.status = item.isRead ? GC_OK : GC_ERR;
+            if ( !m_readQueue->Push( std::move( item ) ) )
+            {
+                FILE_LOG( logERROR ) << "[FindLinePipeline::PushImage] Could not queue " << params.imagePath;
+                retVal = GC_ERR;
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FindLinePipeline::PushImage] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS FindLinePipeline::PushEncoded( const FindLineParams &params, std::vector< uchar > &&encoded )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( !m_isRunning )
+        {
+            FILE_LOG( logERROR ) << "[FindLinePipeline::PushEncoded] Pipeline not started";
+            retVal = GC_ERR;
+        }
+        else
+        {
+            FindLinePipelineItem item;
+            item.index = m_pushCount++;
+            item.params = params;
+            item.encoded = std::move( encoded );
+            if ( !m_readQueue->Push( std::move( item ) ) )
+            {
+                FILE_LOG( logERROR ) << "[FindLinePipeline::PushEncoded] Could not queue " << params.imagePath;
+                retVal = GC_ERR;
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FindLinePipeline::PushEncoded] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+void FindLinePipeline::ReadThreadFunc()
+{
+    VisApp visApp;
+    FindLinePipelineItem item;
+    while ( m_readQueue->Pop( item ) )
+    {
+        try
+        {
+            // decoded images pushed from memory arrive already read
+            if ( !item.encoded.empty() )
+            {
+                auto start = chrono::steady_clock::now();
+                item.status = visApp.DecodeFindLineImage( item.encoded, item.params, item.img, item.result );
+                item.isRead = GC_OK == item.status;
+                item.readSecs = SecondsSince( start );
+                std::vector< uchar >().swap( item.encoded );
+            }
+            else if ( item.img.empty() )
+            {
+                auto start = chrono::steady_clock::now();
+                item.status = visApp.ReadFindLineImage( item.params, item.img, item.result );
+                item.isRead = GC_OK == item.status;
+                item.readSecs = SecondsSince( start );
+            }
+        }
+        catch( std::exception &e )
+        {
+            FILE_LOG( logERROR ) << "[FindLinePipeline::ReadThreadFunc] " << e.what();
+            item.status = GC_EXCEPT;
+        }
+        m_findQueue->Push( std::move( item ) );
+        item = FindLinePipelineItem();
+    }
+}
+void FindLinePipeline::CreateEngine( std::unique_ptr< VisApp > &visApp )
+{
+    auto start = chrono::steady_clock::now();
+    visApp = make_unique< VisApp >();
+    AddEngineStats( SecondsSince( start ) );
+}
+void FindLinePipeline::AddEngineStats( const double secs )
+{
+    lock_guard< mutex > lock( m_statsMutex );
+    ++m_stats.engineCount;
+    m_stats.engineSecs += secs;
+}
+GC_STATUS FindLinePipeline::CalibKey( const std::string &calibPath, std::string &calibKey )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        // the hash of each calibration file is computed once and again only if the file changes
+        error_code ec;
+        filesystem::file_time_type fileTime = filesystem::last_write_time( calibPath, ec );
+        lock_guard< mutex > lock( m_calibKeyMutex );
+        auto iter = m_calibKeys.find( calibPath );
+        if ( m_calibKeys.end() != iter && !ec && fileTime == iter->second.first )
+        {
+            calibKey = iter->second.second;
+        }
+        else
+        {
+            retVal = RunManifest::HashFile( calibPath, calibKey );
+            if ( GC_OK == retVal )
+            {
+                m_calibKeys[ calibPath ] = make_pair( fileTime, calibKey );
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FindLinePipeline::CalibKey] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS FindLinePipeline::CalibSnapshot( const std::string &calibKey, const std::string &calibPath,
+                                           std::shared_ptr< const CalibrationSnapshot > &snapshot )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        // the first worker to need a calibration loads it, the others wait for it and share it. The
+        // worker engine caches own the snapshots, so a calibration whose engines have all been
+        // evicted is freed and loaded again if it comes back
+        lock_guard< mutex > lock( m_snapshotMutex );
+        auto iter = m_snapshots.find( calibKey );
+        if ( m_snapshots.end() != iter )
+        {
+            snapshot = iter->second.lock();
+        }
+        if ( nullptr == snapshot )
+        {
+            retVal = CalibrationSnapshot::Create( calibPath, snapshot );
+            if ( GC_OK == retVal )
+            {
+                for ( auto expired = m_snapshots.begin(); expired != m_snapshots.end(); )
+                {
+                    expired = expired->second.expired() ? m_snapshots.erase( expired ) : std::next( expired );
+                }
+                m_snapshots[ calibKey ] = snapshot;
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FindLinePipeline::CalibSnapshot] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+void FindLinePipeline::WorkerThreadFunc()
+{
+    // each engine keeps its calibration from one image to the next, one engine per calibration,
+    // unless a fresh engine per image has been asked for to measure what that costs. New engines
+    // start from the shared snapshot of the calibration, so the file is parsed and the octagon
+    // templates are built once for all of the workers
+    EngineCache engines( static_cast< size_t >( std::max( 1, m_config.engineCacheSize ) ) );
+    unique_ptr< VisApp > freshApp;
+    FindLinePipelineItem item;
+    while ( m_findQueue->Pop( item ) )
+    {
+        try
+        {
+            GC_STAGE_SINK( item.result.stageTimes );
+            VisApp *visApp = nullptr;
+            FindLineParams calcParams = item.params;
+            if ( m_config.freshEngine )
+            {
+                CreateEngine( freshApp );
+                visApp = freshApp.get();
+            }
+            else
+            {
+                string calibKey;
+                if ( GC_OK != CalibKey( item.params.calibFilepath, calibKey ) )
+                {
+                    calibKey = item.params.calibFilepath;
+                }
+                bool isCreated = false;
+                auto start = chrono::steady_clock::now();
+                visApp = engines.Get( calibKey, calcParams.calibFilepath, isCreated );
+                if ( isCreated )
+                {
+                    // without a snapshot the engine loads the calibration itself and reports why it could not
+                    shared_ptr< const CalibrationSnapshot > snapshot;
+                    if ( GC_OK == CalibSnapshot( calibKey, calcParams.calibFilepath, snapshot ) )
+                    {
+                        visApp->AttachCalibration( snapshot );
+                        engines.HoldSnapshot( calibKey, snapshot );
+                    }
+                    AddEngineStats( SecondsSince( start ) );
+                }
+            }
+            auto start = chrono::steady_clock::now();
+            if ( item.isRead )
+            {
+                // under a memory budget the find waits until its frame fits beside the finds already
+                // running, and preprocesses only the search region when the whole frame would not fit
+                item.memoryMode = m_memoryBudget.ChooseMode( item.img.size(), item.img.channels() );
+                visApp->SetMemoryMode( item.memoryMode );
+                {
+                    MemoryBudgetLease lease( m_memoryBudget, m_memoryBudget.IsLimited() ?
+                                             m_memoryBudget.Estimate( item.img.size(), item.img.channels(), item.memoryMode ) : 0 );
+                    item.status = visApp->CalcLine( item.img, calcParams, item.result );
+                    if ( !item.params.resultImagePath.empty() || !item.params.lineSearchROIFolder.empty() )
+                    {
+                        GC_STATUS retSave = visApp->SaveFindLineImages( item.img, calcParams, item.result );
+                        item.status = GC_OK == item.status ? retSave : item.status;
+                    }
+                }
+                m_memoryBudget.Measured( item.img.size(), item.memoryMode, item.result.stageMemory.peakBytes );
+            }
+            GC_STATUS retVal = visApp->ResultToJsonString( item.result, item.params, item.resultJson );
+            if ( GC_OK != retVal )
+            {
+                item.status = retVal;
+            }
+            item.findSecs = SecondsSince( start );
+        }
+        catch( std::exception &e )
+        {
+            FILE_LOG( logERROR ) << "[FindLinePipeline::WorkerThreadFunc] " << e.what();
+            item.status = GC_EXCEPT;
+        }
+        item.img.release();
+        m_writeQueue->Push( std::move( item ) );
+        item = FindLinePipelineItem();
+    }
+
+    lock_guard< mutex > lock( m_statsMutex );
+    m_stats.engineEvictions += engines.EvictionCount();
+}
+void FindLinePipeline::WriterThreadFunc()
+{
+    CsvResultSink csvSink;
+    ResultLogWriter logWriter;
+    size_t nextIndex = 0;
+    map< size_t, FindLinePipelineItem > pending;
+    bool isTimeout = false;
+    FindLinePipelineItem item;
+    while ( m_writeQueue->PopFor( item, chrono::milliseconds( 1000 ), isTimeout ) )
+    {
+        if ( isTimeout )
+        {
+            // nothing has arrived for a while (e.g. a watched folder is quiet), so put what
+            // is buffered on disk instead of waiting for more rows
+            csvSink.Flush();
+            logWriter.Flush();
+            if ( nullptr != m_config.manifest )
+                m_config.manifest->Flush();
+            continue;
+        }
+        pending[ item.index ] = std::move( item );
+        item = FindLinePipelineItem();
+
+        // results arrive in completion order, so hold them until the next one in input order is here
+        auto iter = pending.find( nextIndex );
+        while ( pending.end() != iter )
+        {
+            FindLinePipelineItem &ready = iter->second;
+            auto start = chrono::steady_clock::now();
+            GC_STATUS retWrite = GC_OK;
+            try
+            {
+                if ( ready.isRead && !ready.params.resultCSVPath.empty() )
+                {
+                    if ( ready.params.resultCSVPath != csvSink.Filepath() || !csvSink.IsOpen() )
+                    {
+                        retWrite = csvSink.Open( ready.params.resultCSVPath );
+                    }
+                    if ( GC_OK == retWrite )
+                    {
+                        retWrite = csvSink.Write( ready.params.imagePath, ready.result );
+                    }
+                }
+                if ( ready.isRead && !ready.params.resultLogPath.empty() )
+                {
+                    GC_STATUS retLog = GC_OK;
+                    if ( ready.params.resultLogPath != logWriter.Filepath() || !logWriter.IsOpen() )
+                    {
+                        retLog = logWriter.Open( ready.params.resultLogPath );
+                    }
+                    if ( GC_OK == retLog )
+                    {
+                        retLog = logWriter.Append( ready.params.imagePath, ready.result );
+                    }
+                    retWrite = GC_OK == retWrite ? retLog : retWrite;
+                }
+                if ( GC_OK != retWrite )
+                {
+                    FILE_LOG( logERROR ) << "[FindLinePipeline::WriterThreadFunc] Could not write result of " << ready.params.imagePath;
+                }
+                if ( nullptr != m_callback )
+                {
+                    m_callback( ready.params, ready.result, ready.resultJson, ready.status );
+                }
+            }
+            catch( std::exception &e )
+            {
+                FILE_LOG( logERROR ) << "[FindLinePipeline::WriterThreadFunc] " << e.what();
+                retWrite = GC_EXCEPT;
+            }
+            if ( GC_OK != retWrite )
+            {
+                // a result that is not on disk must not be marked done, so a rerun finds it again
+                m_runStatus = GC_OK == m_runStatus ? retWrite : m_runStatus;
+            }
+            else if ( GC_EXCEPT == ready.status )
+            {
+                m_runStatus = GC_EXCEPT;
+            }
+            else if ( ready.isRead && nullptr != m_config.manifest && !ready.manifestKey.empty() )
+            {
+                m_config.manifest->Record( ready.manifestKey );
+
+                // manifest records only reach the disk after the results they stand for
+                if ( MANIFEST_FLUSH_COUNT <= m_config.manifest->PendingCount() )
+                {
+                    csvSink.Flush();
+                    logWriter.Flush();
+                    m_config.manifest->Flush();
+                }
+            }
+            m_stats.readSecs += ready.readSecs;
+            m_stats.findSecs += ready.findSecs;
+            m_stats.writeSecs += SecondsSince( start );
+            for ( const auto &stage : ready.result.stageTimes )
+            {
+                auto stageIter = find_if( m_stats.stageTimes.begin(), m_stats.stageTimes.end(),
+                                          [ &stage ]( const pair< string, StageTimeSummary > &s ) { return s.first == stage.first; } );
+                if ( m_stats.stageTimes.end() == stageIter )
+                {
+                    m_stats.stageTimes.emplace_back( stage.first, StageTimeSummary() );
+                    stageIter = m_stats.stageTimes.end() - 1;
+                }
+                stageIter->second.Add( stage.second );
+            }
+            for ( const auto &stage : ready.result.stageMemory.stageBytes )
+            {
+                auto stageIter = find_if( m_stats.stageBytes.begin(), m_stats.stageBytes.end(),
+                                          [ &stage ]( const pair< string, size_t > &s ) { return s.first == stage.first; } );
+                if ( m_stats.stageBytes.end() == stageIter )
+                    m_stats.stageBytes.push_back( stage );
+                else
+                    stageIter->second = std::max( stageIter->second, stage.second );
+            }
+            m_stats.peakFindBytes = std::max( m_stats.peakFindBytes, ready.result.stageMemory.peakBytes );
+            if ( GC_MEMORY_ROI == ready.memoryMode )
+            {
+                ++m_stats.roiFindCount;
+            }
+            ++m_writtenCount;
+            pending.erase( iter );
+            iter = pending.find( ++nextIndex );
+        }
+    }
+    csvSink.Close();
+    logWriter.Close();
+    if ( nullptr != m_config.manifest )
+        m_config.manifest->Flush();
+}
+
+} // namespace gc
@@ -0,0 +1,269 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/** \file findlinepipeline.h
+ * @brief A file for a class that runs line finds on a sequence of images with a staged,
+ *        multi-threaded read -> find -> write pipeline
+ *
+ * Images are read and decoded by a set of reader threads, searched for the water line by a
+ * set of worker threads that each own a calibrated VisApp, and the results are handed to a
+ * single writer thread in the same order the images were pushed into the pipeline. Each
+ * calibration is loaded once into a snapshot that all of the workers share.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef FINDLINEPIPELINE_H
+#define FINDLINEPIPELINE_H
+
+#include "gc_types.h"
+#include "boundedqueue.h"
+#include "stagetimer.h"
+#include "memorybudget.h"
+#include <memory>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <chrono>
+#include <map>
+#include <filesystem>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+class VisApp;
+class RunManifest;
+class CalibrationSnapshot;
+
+/**
+ * @brief Data class that holds the thread and queue settings of a FindLinePipeline
+ */
+class FindLinePipelineConfig
+{
+public:
+    /**
+     * @brief Constructor sets all values to automatic (chosen from the hardware thread count)
+     */
+    FindLinePipelineConfig() :
+        readThreads( 0 ),
+        workerThreads( 0 ),
+        queueDepth( 0 ),
+        freshEngine( false ),
+        engineCacheSize( 1 ),
+        manifest( nullptr ),
+        memoryBudgetBytes( 0 ),
+        trackMemory( false )
+    {}
+
+    int readThreads;        ///< Number of image read/decode threads (0=automatic)
+    int workerThreads;      ///< Number of line find threads, each with its own calibrated VisApp (0=automatic)
+    int queueDepth;         ///< Maximum number of images waiting between two stages (0=automatic)
+    bool freshEngine;       ///< true=Construct and calibrate a new VisApp for every image (for overhead comparison)
+    int engineCacheSize;    ///< Number of calibrated engines each find thread keeps, one per calibration file contents
+    RunManifest *manifest;  ///< Optional open manifest that completed images are recorded in (not owned)
+    size_t memoryBudgetBytes; ///< Target resident memory of the process in bytes, finds wait for room and preprocess less of large frames to stay under it (0=no limit)
+    bool trackMemory;       ///< true=Count the image memory each stage allocates (always on with a memory budget)
+};
+
+/**
+ * @brief Data class that holds the timing of a FindLinePipeline run
+ */
+class FindLinePipelineStats
+{
+public:
+    FindLinePipelineStats() :
+        imageCount( 0 ),
+        engineCount( 0 ),
+        engineSecs( 0.0 ),
+        engineEvictions( 0 ),
+        readSecs( 0.0 ),
+        findSecs( 0.0 ),
+        writeSecs( 0.0 ),
+        runSecs( 0.0 ),
+        roiFindCount( 0 ),
+        peakFindBytes( 0 ),
+        peakImageBytes( 0 ),
+        peakRssBytes( 0 )
+    {}
+
+    size_t imageCount;      ///< Number of images written
+    size_t engineCount;     ///< Number of VisApp engines constructed by the worker threads
+    double engineSecs;      ///< Total seconds spent constructing worker engines
+    size_t engineEvictions; ///< Number of engines dropped from full worker engine caches
+    double readSecs;        ///< Total seconds spent reading images, timestamps, and illumination
+    double findSecs;        ///< Total seconds spent on calibration and line finds (includes result images)
+    double writeSecs;       ///< Total seconds spent writing csv rows and calling the result callback
+    double runSecs;         ///< Seconds from Start() to the end of Finish()
+    std::vector< std::pair< std::string, StageTimeSummary > > stageTimes; ///< Per stage time distributions in the order the stages first ran (empty without GC_STAGE_TIMING)
+    size_t roiFindCount;    ///< Number of finds that preprocessed only the search region to fit the memory budget
+    StageByteList stageBytes; ///< Largest image memory one find allocated in each stage (empty without memory tracking)
+    size_t peakFindBytes;   ///< Largest image memory one find held at once (0 without memory tracking)
+    size_t peakImageBytes;  ///< Largest image memory the process held at once (0 without memory tracking)
+    size_t peakRssBytes;    ///< Largest resident memory of the process (0=not available on this platform)
+};
+
+/**
+ * @brief Data class that carries one image through the stages of a FindLinePipeline
+ */
+class FindLinePipelineItem
+{
+public:
+    FindLinePipelineItem() :
+        index( 0 ),
+        isRead( false ),
+        status( GC_OK ),
+        readSecs( 0.0 ),
+        findSecs( 0.0 ),
+        memoryMode( GC_MEMORY_FULL )
+    {}
+
+    size_t index;               ///< Position of the image in the input sequence
+    FindLineParams params;      ///< Line find parameters for this image
+    cv::Mat img;                ///< Decoded image (released after the line find)
+    std::vector< uchar > encoded; ///< Encoded image bytes pushed from memory (released after decode)
+    FindLineResult result;      ///< Line find result
+    std::string resultJson;     ///< Line find result as a json string
+    bool isRead;                ///< true=image and timestamp read successfully
+    GC_STATUS status;           ///< Status of the read and find
+    double readSecs;            ///< Seconds spent in the read stage
+    double findSecs;            ///< Seconds spent in the find stage
+    GC_MEMORY_MODE memoryMode;  ///< How much of the image the find preprocessed
+    std::string manifestKey;    ///< Run manifest key of the image (empty=not recorded)
+};
+
+/**
+ * @brief Function called by the writer thread for each image, in input order, after the
+ *        result has been added to the csv file and result log specified in the FindLineParams.
+ *        Both are buffered, are flushed when no result has arrived for a second, and are
+ *        only guaranteed to be on disk after Finish() returns.
+ */
+typedef std::function< void( const FindLineParams &params, const FindLineResult &result,
+                             const std::string &resultJson, const GC_STATUS status ) > FindLineResultCallback;
+
+/**
+ * @brief Runs VisApp line finds on a sequence of images using bounded queues between a
+ *        read stage, a find stage, and an ordered write stage
+ */
+class FindLinePipeline
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    FindLinePipeline();
+
+    /**
+     * @brief Destructor, finishes the images already pushed if the pipeline is still running
+     */
+    ~FindLinePipeline();
+
+    /**
+     * @brief Start the read, find, and write threads
+     * @param config Thread counts and queue depth
+     * @param callback Optional function to be called in input order with each result
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Start( const FindLinePipelineConfig config, FindLineResultCallback callback = nullptr );
+
+    /**
+     * @brief Add an image to the pipeline. Blocks while the read queue is full.
+     * @param params Line find parameters of the image (image path, calibration, result paths)
+     * @param manifestKey Key to record in the configured run manifest once the results of the
+     *        image have been written to disk (empty=do not record)
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Push( const FindLineParams &params, const std::string &manifestKey = "" );
+
+    /**
+     * @brief Add an image that is already in memory (e.g. a video frame) to the pipeline. The read
+     *        stage is skipped. Blocks while the read queue is full.
+     * @param params Line find parameters of the image (imagePath only identifies the image in results)
+     * @param img Image to be searched
+     * @param timestamp Timestamp of the image in the form yyyy-mm-ddTHH:MM:SS
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS PushImage( const FindLineParams &params, const cv::Mat &img, const std::string &timestamp );
+
+    /**
+     * @brief Add an encoded image that is already in memory (e.g. a tar archive entry) to the pipeline.
+     *        The read stage decodes it and takes its timestamp from the filename of params.imagePath.
+     *        Blocks while the read queue is full.
+     * @param params Line find parameters of the image (imagePath only identifies the image in results)
+     * @param encoded Encoded .png or .jpg bytes, moved into the pipeline
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS PushEncoded( const FindLineParams &params, std::vector< uchar > &&encoded );
+
+    /**
+     * @brief Wait for all pushed images to be processed and written, then stop the threads
+     * @return GC_OK=Success, GC_EXCEPT=Exception thrown while processing an image (per image find
+     *         failures are reported through the result callback)
+     */
+    GC_STATUS Finish();
+
+    /**
+     * @brief Number of images written so far
+     */
+    size_t WrittenCount() const { return m_writtenCount; }
+
+    /**
+     * @brief Timing of the last run, complete after Finish() returns
+     */
+    const FindLinePipelineStats &Stats() const { return m_stats; }
+
+private:
+    bool m_isRunning;
+    size_t m_pushCount;
+    std::atomic< size_t > m_writtenCount;
+    GC_STATUS m_runStatus;
+    FindLinePipelineConfig m_config;
+    FindLineResultCallback m_callback;
+    FindLinePipelineStats m_stats;
+    std::mutex m_statsMutex;
+    std::chrono::steady_clock::time_point m_startTime;
+    std::mutex m_calibKeyMutex;
+    std::map< std::string, std::pair< std::filesystem::file_time_type, std::string > > m_calibKeys;
+    std::mutex m_snapshotMutex;
+    std::map< std::string, std::weak_ptr< const CalibrationSnapshot > > m_snapshots;
+    MemoryBudget m_memoryBudget;
+
+    std::unique_ptr< BoundedQueue< FindLinePipelineItem > > m_readQueue;
+    std::unique_ptr< BoundedQueue< FindLinePipelineItem > > m_findQueue;
+    std::unique_ptr< BoundedQueue< FindLinePipelineItem > > m_writeQueue;
+
+    std::vector< std::thread > m_readThreads;
+    std::vector< std::thread > m_workerThreads;
+    std::thread m_writerThread;
+
+    void CreateEngine( std::unique_ptr< VisApp > &visApp );
+    void AddEngineStats( const double secs );
+    GC_STATUS CalibKey( const std::string &calibPath, std::string &calibKey );
+    GC_STATUS CalibSnapshot( const std::string &calibKey, const std::string &calibPath,
+                             std::shared_ptr< const CalibrationSnapshot > &snapshot );
+    void ReadThreadFunc();
+    void WorkerThreadFunc();
+    void WriterThreadFunc();
+};
+
+} // namespace gc
+
+#endif // FINDLINEPIPELINE_H
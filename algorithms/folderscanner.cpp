@@ -0,0 +1,203 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "log.h"
+#include "folderscanner.h"
+#include <algorithm>
+#include <filesystem>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static string ToLower( string str )
+{
+    transform( str.begin(), str.end(), str.begin(), []( unsigned char c ) { return static_cast< char >( tolower( c ) ); } );
+    return str;
+}
+
+namespace gc
+{
+
+FolderScanner::FolderScanner() :
+    m_isStopped( true ),
+    m_busyCount( 0 ),
+    m_folderCount( 0 )
+{
+}
+FolderScanner::~FolderScanner()
+{
+    Stop();
+}
+GC_STATUS FolderScanner::Start( const std::string folder, const int threadCount, const std::vector< std::string > &extensions )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        Stop();
+        if ( !fs::is_directory( folder ) )
+        {
+            FILE_LOG( logERROR ) << "[FolderScanner::Start] Not a folder: " << folder;
+            retVal = GC_ERR;
+        }
+        else
+        {
+            // listing is mostly waiting on the file system, so use more threads than cores
+            int threads = 0 < threadCount ? threadCount : 8;
+
+            m_extensions.clear();
+            for ( size_t i = 0; i < extensions.size(); ++i )
+                m_extensions.insert( ToLower( extensions[ i ] ) );
+
+            auto top = make_shared< FolderScanNode >();
+            top->path = folder;
+            m_toList.clear();
+            m_toList.push_back( top );
+            m_stack.clear();
+            m_stack.push_back( make_pair( top, 0 ) );
+            m_busyCount = 0;
+            m_folderCount = 0;
+            m_isStopped = false;
+            for ( int i = 0; i < threads; ++i )
+            {
+                m_threads.push_back( thread( &FolderScanner::ListThreadFunc, this ) );
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FolderScanner::Start] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+bool FolderScanner::Next( std::string &filepath )
+{
+    unique_lock< mutex > lock( m_mutex );
+    while ( !m_stack.empty() && !m_isStopped )
+    {
+        auto &top = m_stack.back();
+        m_listed.wait( lock, [ this, &top ]{ return m_isStopped || top.first->isListed; } );
+        if ( m_isStopped )
+            break;
+
+        if ( top.second >= top.first->entries.size() )
+        {
+            m_stack.pop_back();
+            continue;
+        }
+
+        const FolderScanEntry &entry = top.first->entries[ top.second++ ];
+        if ( nullptr != entry.child )
+        {
+            m_stack.push_back( make_pair( entry.child, 0 ) );
+        }
+        else
+        {
+            filepath = ( fs::path( top.first->path ) / entry.name ).string();
+            return true;
+        }
+    }
+    return false;
+}
+void FolderScanner::Stop()
+{
+    {
+        lock_guard< mutex > lock( m_mutex );
+        m_isStopped = true;
+    }
+    m_workReady.notify_all();
+    m_listed.notify_all();
+    for ( size_t i = 0; i < m_threads.size(); ++i )
+        m_threads[ i ].join();
+    m_threads.clear();
+    m_toList.clear();
+}
+size_t FolderScanner::FolderCount()
+{
+    lock_guard< mutex > lock( m_mutex );
+    return m_folderCount;
+}
+void FolderScanner::ListThreadFunc()
+{
+    while ( true )
+    {
+        shared_ptr< FolderScanNode > node;
+        {
+            unique_lock< mutex > lock( m_mutex );
+            m_workReady.wait( lock, [ this ]{ return m_isStopped || !m_toList.empty() || 0 == m_busyCount; } );
+            if ( m_isStopped || m_toList.empty() )
+                break;
+            node = m_toList.front();
+            m_toList.pop_front();
+            ++m_busyCount;
+        }
+
+        List( *node );
+
+        {
+            lock_guard< mutex > lock( m_mutex );
+            node->isListed = true;
+            ++m_folderCount;
+
+            // subfolders go to the front of the queue so listing runs just ahead of Next()
+            for ( auto iter = node->entries.rbegin(); iter != node->entries.rend(); ++iter )
+            {
+                if ( nullptr != iter->child )
+                    m_toList.push_front( iter->child );
+            }
+            --m_busyCount;
+        }
+        m_workReady.notify_all();
+        m_listed.notify_all();
+    }
+}
+void FolderScanner::List( FolderScanNode &node )
+{
+    try
+    {
+        error_code ec;
+        for ( fs::directory_iterator iter( node.path, ec ), end; !ec && iter != end; iter.increment( ec ) )
+        {
+            // the entry type usually comes with the listing, so most entries need no extra stat call
+            const fs::directory_entry &dirEntry = *iter;
+            FolderScanEntry entry;
+            entry.name = dirEntry.path().filename().string();
+            if ( dirEntry.is_directory( ec ) && !dirEntry.is_symlink( ec ) )
+            {
+                entry.child = make_shared< FolderScanNode >();
+                entry.child->path = dirEntry.path().string();
+                node.entries.push_back( entry );
+            }
+            else if ( m_extensions.end() != m_extensions.find( ToLower( dirEntry.path().extension().string() ) ) )
+            {
+                node.entries.push_back( entry );
+            }
+            ec.clear();
+        }
+        if ( ec )
+        {
+            FILE_LOG( logWARNING ) << "[FolderScanner::List] Could not list all of " << node.path << ": " << ec.message();
+        }
+        sort( node.entries.begin(), node.entries.end(),
+              []( const FolderScanEntry &a, const FolderScanEntry &b ) { return a.name < b.name; } );
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FolderScanner::List] " << e.what();
+    }
+}
+
+} // namespace gc
@@ -0,0 +1,138 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/** \file folderscanner.h
+ * @brief A file for a class that lists the image files of a folder tree with several threads
+ *        and hands them out in sorted order while the listing is still going on
+ *
+ * Files are returned in depth first order with the entries of each folder sorted by name. For
+ * archives whose folder and file names start with their timestamps this is time order. Folders
+ * are listed by a pool of threads in roughly the order they will be needed, so the first files
+ * can be processed while the rest of a large (e.g. network mounted) archive is being read.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef FOLDERSCANNER_H
+#define FOLDERSCANNER_H
+
+#include "gc_types.h"
+#include <set>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+class FolderScanNode;
+
+/**
+ * @brief One entry of a listed folder
+ */
+class FolderScanEntry
+{
+public:
+    std::string name;                       ///< File or folder name
+    std::shared_ptr< FolderScanNode > child; ///< Listing of the folder (nullptr for a file)
+};
+
+/**
+ * @brief Listing of one folder, filled in by a scanner thread
+ */
+class FolderScanNode
+{
+public:
+    FolderScanNode() : isListed( false ) {}
+
+    std::string path;                       ///< Path of the folder
+    bool isListed;                          ///< true=entries are complete
+    std::vector< FolderScanEntry > entries; ///< Matching files and subfolders, sorted by name
+};
+
+/**
+ * @brief Lists the files with given extensions in a folder tree with a pool of threads
+ */
+class FolderScanner
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    FolderScanner();
+
+    /**
+     * @brief Destructor, stops the scanner threads
+     */
+    ~FolderScanner();
+
+    FolderScanner( const FolderScanner & ) = delete;
+    FolderScanner &operator=( const FolderScanner & ) = delete;
+
+    /**
+     * @brief Start listing a folder tree
+     * @param folder Top folder of the tree
+     * @param threadCount Number of listing threads (0=automatic)
+     * @param extensions File extensions to return, compared without regard to case
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Start( const std::string folder, const int threadCount = 0,
+                     const std::vector< std::string > &extensions = { ".png", ".jpg" } );
+
+    /**
+     * @brief Get the next file in sorted order, waiting for its folder to be listed if needed
+     * @param filepath String to hold the path of the file
+     * @return true=File returned, false=All files have been returned or the scanner was stopped
+     */
+    bool Next( std::string &filepath );
+
+    /**
+     * @brief Stop the listing threads
+     */
+    void Stop();
+
+    /**
+     * @brief Number of folders listed so far
+     */
+    size_t FolderCount();
+
+private:
+    bool m_isStopped;
+    size_t m_busyCount;
+    size_t m_folderCount;
+    std::set< std::string > m_extensions;
+    std::deque< std::shared_ptr< FolderScanNode > > m_toList;
+    std::vector< std::pair< std::shared_ptr< FolderScanNode >, size_t > > m_stack;
+    std::vector< std::thread > m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_workReady;
+    std::condition_variable m_listed;
+
+    void ListThreadFunc();
+    void List( FolderScanNode &node );
+};
+
+} // namespace gc
+
+#endif // FOLDERSCANNER_H
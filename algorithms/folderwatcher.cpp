@@ -0,0 +1,368 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "log.h"
+#include "folderwatcher.h"
+#include <filesystem>
+#include <algorithm>
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#else
+#include <thread>
+#include <chrono>
+#endif
+
+using namespace std;
+namespace fs = std::filesystem;
+
+#ifdef __linux__
+static const size_t MAX_REPORTED = 100000;
+static const int CANDIDATE_CHECK_MS = 500;
+#endif
+
+namespace gc
+{
+
+FolderWatcher::FolderWatcher()
+#ifdef __linux__
+    : m_inotifyFd( -1 )
+#endif
+{
+}
+FolderWatcher::~FolderWatcher()
+{
+    Stop();
+}
+bool FolderWatcher::IsImageFile( const std::string &filepath )
+{
+    string ext = fs::path( filepath ).extension().string();
+    transform( ext.begin(), ext.end(), ext.begin(), []( unsigned char c ) { return static_cast< char >( tolower( c ) ); } );
+    return ".png" == ext || ".jpg" == ext;
+}
+void FolderWatcher::Report( const std::string &filepath, std::vector< std::string > &files )
+{
+    m_candidates.erase( filepath );
+    if ( IsImageFile( filepath ) && m_reported.insert( filepath ).second )
+    {
+        files.push_back( filepath );
+#ifdef __linux__
+        // events only repeat a path shortly after it is reported, so the oldest paths are let go
+        // to keep a long running watch from growing without bound
+        m_reportOrder.push_back( filepath );
+        if ( MAX_REPORTED < m_reportOrder.size() )
+        {
+            m_reported.erase( m_reportOrder.front() );
+            m_reportOrder.pop_front();
+        }
+#endif
+    }
+}
+bool FolderWatcher::IsStable( const std::string &filepath )
+{
+    // without a close event, a file is taken to be complete once it stops changing
+    error_code ec;
+    pair< uintmax_t, int64_t > state( fs::file_size( filepath, ec ),
+                                      static_cast< int64_t >( fs::last_write_time( filepath, ec ).time_since_epoch().count() ) );
+    auto iter = m_candidates.find( filepath );
+    if ( m_candidates.end() != iter && iter->second == state )
+    {
+        return true;
+    }
+    m_candidates[ filepath ] = state;
+    return false;
+}
+#ifdef __linux__
+GC_STATUS FolderWatcher::Start( const std::string folder )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        Stop();
+        if ( !fs::is_directory( folder ) )
+        {
+            FILE_LOG( logERROR ) << "[FolderWatcher::Start] Not a folder: " << folder;
+            retVal = GC_ERR;
+        }
+        else
+        {
+            m_inotifyFd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+            if ( 0 > m_inotifyFd )
+            {
+                FILE_LOG( logERROR ) << "[FolderWatcher::Start] Could not initialize inotify";
+                retVal = GC_ERR;
+            }
+            else
+            {
+                m_folder = folder;
+                vector< string > ignored;
+                retVal = AddWatch( folder, ignored, EXISTING_IGNORE );
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FolderWatcher::Start] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS FolderWatcher::AddWatch( const std::string &folder, std::vector< std::string > &files, const EXISTING_FILES existing )
+{
+    GC_STATUS retVal = GC_OK;
+    int wd = inotify_add_watch( m_inotifyFd, folder.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR );
+    if ( 0 > wd )
+    {
+        FILE_LOG( logERROR ) << "[FolderWatcher::AddWatch] Could not watch " << folder;
+        retVal = GC_ERR;
+    }
+    else
+    {
+        m_watchFolders[ wd ] = folder;
+
+        // a folder copied in whole can already hold files by the time its watch is added. Those of
+        // a moved folder are complete, but those of a new folder may still be written, so they wait
+        // for their close event or until they stop changing
+        error_code ec;
+        for ( auto &entry : fs::directory_iterator( folder, ec ) )
+        {
+            string filepath = entry.path().string();
+            if ( entry.is_directory( ec ) )
+            {
+                AddWatch( filepath, files, existing );
+            }
+            else if ( entry.is_regular_file( ec ) && IsImageFile( filepath ) )
+            {
+                if ( EXISTING_REPORT == existing )
+                {
+                    Report( filepath, files );
+                }
+                else if ( EXISTING_DEFER == existing && m_reported.end() == m_reported.find( filepath ) )
+                {
+                    IsStable( filepath );
+                }
+            }
+        }
+    }
+    return retVal;
+}
+GC_STATUS FolderWatcher::WaitForFiles( std::vector< std::string > &files, const int timeoutMs )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        files.clear();
+        if ( 0 > m_inotifyFd )
+        {
+            FILE_LOG( logERROR ) << "[FolderWatcher::WaitForFiles] Watcher not started";
+            retVal = GC_ERR;
+        }
+        else
+        {
+            pollfd pfd = { m_inotifyFd, POLLIN, 0 };
+            int ret = poll( &pfd, 1, m_candidates.empty() ? timeoutMs : std::min( timeoutMs, CANDIDATE_CHECK_MS ) );
+            if ( 0 < ret && ( pfd.revents & POLLIN ) )
+            {
+                alignas( inotify_event ) char buffer[ 64 * 1024 ];
+                ssize_t len;
+                while ( 0 < ( len = read( m_inotifyFd, buffer, sizeof( buffer ) ) ) )
+                {
+                    for ( char *ptr = buffer; ptr < buffer + len; )
+                    {
+                        const inotify_event *event = reinterpret_cast< const inotify_event * >( ptr );
+                        ptr += sizeof( inotify_event ) + event->len;
+
+                        if ( event->mask & IN_Q_OVERFLOW )
+                        {
+                            FILE_LOG( logWARNING ) << "[FolderWatcher::WaitForFiles] Event queue overflow, files may have been missed";
+                            continue;
+                        }
+                        if ( event->mask & IN_IGNORED )
+                        {
+                            m_watchFolders.erase( event->wd );
+                            continue;
+                        }
+
+                        auto iter = m_watchFolders.find( event->wd );
+                        if ( m_watchFolders.end() == iter || 0 == event->len )
+                            continue;
+
+                        string filepath = ( fs::path( iter->second ) / event->name ).string();
+                        if ( event->mask & IN_ISDIR )
+                        {
+                            if ( event->mask & ( IN_CREATE | IN_MOVED_TO ) )
+                            {
+                                AddWatch( filepath, files, ( event->mask & IN_MOVED_TO ) ? EXISTING_REPORT : EXISTING_DEFER );
+                            }
+                        }
+                        else if ( event->mask & ( IN_CLOSE_WRITE | IN_MOVED_TO ) )
+                        {
+                            Report( filepath, files );
+                        }
+                    }
+                }
+            }
+            else if ( 0 > ret && EINTR != errno )
+            {
+                FILE_LOG( logERROR ) << "[FolderWatcher::WaitForFiles] Could not wait for folder events";
+                retVal = GC_ERR;
+            }
+            ReportStableCandidates( files );
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FolderWatcher::WaitForFiles] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+void FolderWatcher::ReportStableCandidates( std::vector< std::string > &files )
+{
+    vector< string > paths;
+    for ( const auto &candidate : m_candidates )
+    {
+        paths.push_back( candidate.first );
+    }
+    error_code ec;
+    for ( const auto &filepath : paths )
+    {
+        if ( !fs::is_regular_file( filepath, ec ) )
+        {
+            m_candidates.erase( filepath );
+        }
+        else if ( IsStable( filepath ) )
+        {
+            Report( filepath, files );
+        }
+    }
+}
+void FolderWatcher::Stop()
+{
+    if ( 0 <= m_inotifyFd )
+    {
+        close( m_inotifyFd );
+        m_inotifyFd = -1;
+    }
+    m_watchFolders.clear();
+    m_candidates.clear();
+    m_reported.clear();
+    m_reportOrder.clear();
+    m_folder.clear();
+}
+#else
+GC_STATUS FolderWatcher::Start( const std::string folder )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        Stop();
+        if ( !fs::is_directory( folder ) )
+        {
+            FILE_LOG( logERROR ) << "[FolderWatcher::Start] Not a folder: " << folder;
+            retVal = GC_ERR;
+        }
+        else
+        {
+            m_folder = folder;
+            for ( auto &entry : fs::recursive_directory_iterator( folder ) )
+            {
+                if ( entry.is_regular_file() )
+                {
+                    m_reported.insert( entry.path().string() );
+                }
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FolderWatcher::Start] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS FolderWatcher::Poll( std::vector< std::string > &files )
+{
+    error_code ec;
+    set< string > present;
+    for ( auto &entry : fs::recursive_directory_iterator( m_folder, ec ) )
+    {
+        string filepath = entry.path().string();
+        if ( !entry.is_regular_file( ec ) )
+            continue;
+        present.insert( filepath );
+        if ( !IsImageFile( filepath ) || m_reported.end() != m_reported.find( filepath ) )
+            continue;
+
+        if ( IsStable( filepath ) )
+        {
+            Report( filepath, files );
+        }
+    }
+    if ( !ec )
+    {
+        PruneReported( present );
+    }
+    return GC_OK;
+}
+void FolderWatcher::PruneReported( const std::set< std::string > &present )
+{
+    // files that were moved or deleted after they were reported are let go so a long running
+    // watch does not grow without bound (an incomplete scan must not prune, or files would repeat)
+    for ( auto iter = m_reported.begin(); iter != m_reported.end(); )
+    {
+        iter = present.end() == present.find( *iter ) ? m_reported.erase( iter ) : std::next( iter );
+    }
+    for ( auto iter = m_candidates.begin(); iter != m_candidates.end(); )
+    {
+        iter = present.end() == present.find( iter->first ) ? m_candidates.erase( iter ) : std::next( iter );
+    }
+}
+GC_STATUS FolderWatcher::WaitForFiles( std::vector< std::string > &files, const int timeoutMs )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        files.clear();
+        if ( m_folder.empty() )
+        {
+            FILE_LOG( logERROR ) << "[FolderWatcher::WaitForFiles] Watcher not started";
+            retVal = GC_ERR;
+        }
+        else
+        {
+            this_thread::sleep_for( chrono::milliseconds( timeoutMs ) );
+            retVal = Poll( files );
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FolderWatcher::WaitForFiles] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+void FolderWatcher::Stop()
+{
+    m_candidates.clear();
+    m_reported.clear();
+    m_folder.clear();
+}
+#endif
+
+} // namespace gc
@@ -0,0 +1,121 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/** \file folderwatcher.h
+ * @brief A file for a class that reports image files as they are completed in a folder tree
+ *
+ * On Linux, inotify close_write and moved_to events are used, so a file is reported once the
+ * program writing it has closed it or once it has been renamed into the folder. On other
+ * platforms the folder tree is polled and a file is reported when its size and modification
+ * time are unchanged between two polls.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef FOLDERWATCHER_H
+#define FOLDERWATCHER_H
+
+#include "gc_types.h"
+#include <map>
+#include <set>
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief Reports each completed image file (.png, .jpg) written into a folder or one of its
+ *        subfolders exactly once
+ */
+class FolderWatcher
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    FolderWatcher();
+
+    /**
+     * @brief Destructor, stops watching
+     */
+    ~FolderWatcher();
+
+    FolderWatcher( const FolderWatcher & ) = delete;
+    FolderWatcher &operator=( const FolderWatcher & ) = delete;
+
+    /**
+     * @brief Start watching a folder and its subfolders. Files already in the folder are not reported.
+     * @param folder Folder to watch
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Start( const std::string folder );
+
+    /**
+     * @brief Wait for completed image files
+     * @param files Vector to hold the paths of the files completed since the last call (may be empty)
+     * @param timeoutMs Longest time to wait for a file
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS WaitForFiles( std::vector< std::string > &files, const int timeoutMs );
+
+    /**
+     * @brief Stop watching
+     */
+    void Stop();
+
+    /**
+     * @brief true if the path has an image extension the line find can read
+     * @param filepath Path to test
+     */
+    static bool IsImageFile( const std::string &filepath );
+
+private:
+    std::string m_folder;
+    std::set< std::string > m_reported;
+    std::map< std::string, std::pair< uintmax_t, int64_t > > m_candidates;
+#ifdef __linux__
+    /// What to do with the files already in a folder when its watch is added
+    enum EXISTING_FILES
+    {
+        EXISTING_IGNORE = 0,    ///< Files that were there before the watch started
+        EXISTING_REPORT,        ///< Complete files of a folder moved in whole
+        EXISTING_DEFER          ///< Files of a new folder that may still be written, reported once they stop changing
+    };
+
+    int m_inotifyFd;
+    std::map< int, std::string > m_watchFolders;
+    std::deque< std::string > m_reportOrder;
+
+    GC_STATUS AddWatch( const std::string &folder, std::vector< std::string > &files, const EXISTING_FILES existing );
+    void ReportStableCandidates( std::vector< std::string > &files );
+#else
+    GC_STATUS Poll( std::vector< std::string > &files );
+    void PruneReported( const std::set< std::string > &present );
+#endif
+    bool IsStable( const std::string &filepath );
+    void Report( const std::string &filepath, std::vector< std::string > &files );
+};
+
+} // namespace gc
+
+#endif // FOLDERWATCHER_H
@@ -0,0 +1,123 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#include "log.h"
+#include "framecontext.h"
+#include "stagetimer.h"
+#include <opencv2/imgproc.hpp>
+
+using namespace cv;
+using namespace std;
+
+namespace gc
+{
+
+void FrameContext::Reset( const cv::Mat &img )
+{
+    m_source = img;
+    m_gray.release();
+    m_pyramid.clear();
+    m_preprocessed.release();
+    m_preprocessedRoi = Rect();
+}
+GC_STATUS FrameContext::Gray( cv::Mat &gray )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( m_gray.empty() )
+        {
+            if ( m_source.empty() )
+            {
+                FILE_LOG( logERROR ) << "[FrameContext::Gray] Empty frame";
+                retVal = GC_ERR;
+            }
+            else if ( CV_8UC1 == m_source.type() )
+            {
+                m_gray = m_source;
+            }
+            else if ( CV_8UC3 == m_source.type() )
+            {
+                GC_STAGE_TIMER( "gray_convert" );
+                cvtColor( m_source, m_gray, COLOR_BGR2GRAY );
+            }
+            else if ( CV_8UC4 == m_source.type() )
+            {
+                GC_STAGE_TIMER( "gray_convert" );
+                cvtColor( m_source, m_gray, COLOR_BGRA2GRAY );
+            }
+            else
+            {
+                FILE_LOG( logERROR ) << "[FrameContext::Gray] Invalid image type. Must be 8-bit gray, bgr, or bgra";
+                retVal = GC_ERR;
+            }
+        }
+        if ( GC_OK == retVal )
+        {
+            gray = m_gray;
+        }
+    }
+    catch( cv::Exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FrameContext::Gray] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS FrameContext::PyramidLevel( const size_t level, cv::Mat &img )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( m_pyramid.empty() )
+        {
+            Mat gray;
+            retVal = Gray( gray );
+            if ( GC_OK == retVal )
+            {
+                m_pyramid.push_back( gray );
+            }
+        }
+        while ( GC_OK == retVal && m_pyramid.size() <= level )
+        {
+            const Mat &prev = m_pyramid.back();
+            if ( 2 > prev.cols || 2 > prev.rows )
+            {
+                FILE_LOG( logERROR ) << "[FrameContext::PyramidLevel] Image too small for pyramid level " << level;
+                retVal = GC_ERR;
+            }
+            else
+            {
+                Mat next;
+                pyrDown( prev, next );
+                m_pyramid.push_back( next );
+            }
+        }
+        if ( GC_OK == retVal )
+        {
+            img = m_pyramid[ level ];
+        }
+    }
+    catch( cv::Exception &e )
+    {
+        FILE_LOG( logERROR ) << "[FrameContext::PyramidLevel] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+
+} // namespace gc
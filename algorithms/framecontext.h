@@ -0,0 +1,121 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/** \file framecontext.h
+ * @brief A file for a class that holds one image and the planes derived from it while the image
+ *        goes through the stages of a line find
+ *
+ * The octagon calibration and the line find both work on the grayscale image, and the line find
+ * works on a preprocessed copy of it. A FrameContext is created once per image, makes each of
+ * these planes the first time a stage asks for it, and hands the same plane to every later
+ * stage, so no stage converts or copies the full frame again.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef FRAMECONTEXT_H
+#define FRAMECONTEXT_H
+
+#include "gc_types.h"
+#include <vector>
+#include <opencv2/core.hpp>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief Image of one line find and the planes derived from it, each made at most once. Not
+ *        thread safe, a frame belongs to the request that created it
+ */
+class FrameContext
+{
+public:
+    /**
+     * @brief Constructor for an empty frame
+     */
+    FrameContext() {}
+
+    /**
+     * @brief Constructor
+     * @param img 8-bit gray, bgr, or bgra source image (borrowed, not copied)
+     */
+    explicit FrameContext( const cv::Mat &img ) : m_source( img ) {}
+
+    /**
+     * @brief Start over with another image, dropping the planes of the last one
+     * @param img 8-bit gray, bgr, or bgra source image (borrowed, not copied)
+     */
+    void Reset( const cv::Mat &img );
+
+    /**
+     * @brief Source image as it was given
+     */
+    const cv::Mat &Source() const { return m_source; }
+
+    /**
+     * @brief Get the 8-bit grayscale image, converted from the source on the first call. A gray
+     *        source is returned as is. Stages must not write into it
+     * @param gray Mat to hold the grayscale image (shares the cached data)
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Gray( cv::Mat &gray );
+
+    /**
+     * @brief Get a level of the grayscale image pyramid, level 0 being the grayscale image and
+     *        each level after it half the size of the one before. Levels are built on request
+     * @param level Pyramid level
+     * @param img Mat to hold the level (shares the cached data)
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS PyramidLevel( const size_t level, cv::Mat &img );
+
+    /**
+     * @brief Preprocessed image of the line find, empty until SetPreprocessed() is called
+     */
+    const cv::Mat &Preprocessed() const { return m_preprocessed; }
+
+    /**
+     * @brief Region of the source image the preprocessed image covers
+     */
+    const cv::Rect &PreprocessedRoi() const { return m_preprocessedRoi; }
+
+    /**
+     * @brief Keep the preprocessed image of the line find for the stages that follow it
+     * @param img Preprocessed image
+     * @param roi Region of the source image it covers (the whole image unless the find ran in GC_MEMORY_ROI)
+     */
+    void SetPreprocessed( const cv::Mat &img, const cv::Rect &roi )
+    {
+        m_preprocessed = img;
+        m_preprocessedRoi = roi;
+    }
+
+private:
+    cv::Mat m_source;
+    cv::Mat m_gray;
+    std::vector< cv::Mat > m_pyramid;
+    cv::Mat m_preprocessed;
+    cv::Rect m_preprocessedRoi;
+};
+
+} // namespace gc
+
+#endif // FRAMECONTEXT_H
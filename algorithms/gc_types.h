@@ -28,6 +28,8 @@
 
 #include <string>
 #include <limits>
+#include <vector>
+#include <utility>
 #include <opencv2/core.hpp>
 
 namespace gc
@@ -75,6 +77,45 @@ enum IMG_DISPLAY_OVERLAYS
     SEARCH_ROI = 2048
 };
 
+/// Named stage durations in milliseconds, in the order the stages first ran
+typedef std::vector< std::pair< std::string, double > > StageTimeList;
+
+/// Named stage image allocations in bytes, in the order the stages first allocated
+typedef std::vector< std::pair< std::string, size_t > > StageByteList;
+
+/// enum for how much of a frame the line find keeps in memory
+enum GC_MEMORY_MODE
+{
+    GC_MEMORY_FULL = 0,     ///< Preprocess the whole frame
+    GC_MEMORY_ROI           ///< Preprocess only the region around the search lines
+};
+
+/**
+ * @brief Image memory allocated by one line find, filled while a MatMemoryTracker is installed
+ */
+class StageMemory
+{
+public:
+    StageMemory() :
+        liveBytes( 0 ),
+        peakBytes( 0 )
+    {}
+
+    /**
+     * @brief Reset the object to hold no allocations
+     */
+    void clear()
+    {
+        stageBytes.clear();
+        liveBytes = 0;
+        peakBytes = 0;
+    }
+
+    StageByteList stageBytes;   ///< Bytes allocated in each stage (allocations outside a timed stage are listed as "other")
+    size_t liveBytes;           ///< Bytes allocated by the find that have not been freed yet
+    size_t peakBytes;           ///< Largest liveBytes reached during the find
+};
+
 static const double DEFAULT_MIN_LINE_ANGLE = -9.0;                              ///< Default minimum line find angle
 static const double DEFAULT_MAX_LINE_ANGLE = 9.0;                               ///< Default maximum line find angle
 static const int FIT_LINE_RANSAC_TRIES_TOTAL = 100;                             ///< Fit line RANSAC total tries
@@ -217,7 +258,9 @@ public:
         datetimeOriginal( std::string( "1955-09-24T12:05:00" ) ),
         datetimeProcessing( std::string( "1955-09-24T12:05:01" ) ),
         timeStampType( FROM_EXIF ),
-        timeStampStartPos( -1 )
+        timeStampStartPos( -1 ),
+        isOctagonCalib( true ),
+        octagonZeroOffset( 0.0 )
     {}
 
     /**
@@ -260,6 +303,7 @@ public:
         imagePath.clear();
         resultImagePath.clear();
         resultCSVPath.clear();
+        resultLogPath.clear();
         lineSearchROIFolder.clear();
         timeStampType = FROM_EXIF;
         timeStampStartPos = -1;
@@ -278,6 +322,7 @@ public:
     std::string calibFilepath;          ///< Input pixel to world coordinate calibration model filepath
     std::string resultImagePath;        ///< Optional result image created from input image with found line and move detection overlays
     std::string resultCSVPath;          ///< Optional result csv file path to hold timestamps and stage measurements
+    std::string resultLogPath;          ///< Optional binary result log path (see resultlog.h)
     std::string lineSearchROIFolder;    ///< Folder to save the find line search roi raw and label images
     GC_TIMESTAMP_TYPE timeStampType;    ///< Specifies where to get timestamp (filename, exif, or dateTimeOriginal)
     int timeStampStartPos;              ///< start position of timestamp string in filename (not whole path)
@@ -451,6 +496,8 @@ public:
         calibReprojectOffset_y = -9999999.0;
         calibReprojectOffset_dist = -9999999.0;
         symbolToWaterLineAngle = 0.0;
+        stageTimes.clear();
+        stageMemory.clear();
         msgs.clear();
     }
 
@@ -472,6 +519,8 @@ public:
     double calibReprojectOffset_x;          ///< Reprojection offset x
     double calibReprojectOffset_y;          ///< Reprojection offset y
     double calibReprojectOffset_dist;       ///< Reprojection offset Euclidean distance
+    StageTimeList stageTimes;               ///< Milliseconds spent in each stage (only filled when built with GC_STAGE_TIMING)
+    StageMemory stageMemory;                ///< Image memory allocated by the find (only filled while a MatMemoryTracker is installed)
     std::vector< std::string > msgs;        ///< Vector of strings with messages about the line find
 };
 
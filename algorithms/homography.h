@@ -0,0 +1,135 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/** \file homography.h
+ * @brief Include file that holds a 3x3 projective transform applied to arrays of points
+ *
+ * The result matches cv::perspectiveTransform, including (0,0) for points whose homogeneous
+ * scale is within FLT_EPSILON of zero, but the matrix is held as nine doubles and the points
+ * are transformed in place in the caller's arrays without cv::Mat wrapping. On x86-64 two
+ * points are transformed per SSE2 instruction sequence.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef HOMOGRAPHY_H
+#define HOMOGRAPHY_H
+
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <opencv2/core.hpp>
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && 2 <= _M_IX86_FP )
+#include <emmintrin.h>
+#define GC_HOMOGRAPHY_SSE2
+#endif
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief A cached 3x3 homography
+ */
+class Homography
+{
+public:
+    Homography() : m_isSet( false ), m_h{ 0.0 } {}
+
+    /**
+     * @brief Set the transform from a 3x3 matrix, or clear it if the matrix is empty
+     * @param mat 3x3 homography such as returned by cv::findHomography
+     */
+    void Set( const cv::Mat &mat )
+    {
+        m_isSet = 3 == mat.rows && 3 == mat.cols;
+        if ( m_isSet )
+        {
+            cv::Mat mat64;
+            mat.convertTo( mat64, CV_64F );
+            for ( int i = 0; i < 9; ++i )
+                m_h[ i ] = mat64.at< double >( i / 3, i % 3 );
+        }
+    }
+    void Clear() { m_isSet = false; }
+    bool IsSet() const { return m_isSet; }
+
+    /**
+     * @brief Transform an array of points, src and dst may be the same array
+     * @param src Points to transform
+     * @param dst Array of at least count points to hold the transformed points
+     * @param count Number of points
+     */
+    void Apply( const cv::Point2d *src, cv::Point2d *dst, const size_t count ) const
+    {
+        const double *h = m_h;
+        size_t i = 0;
+#ifdef GC_HOMOGRAPHY_SSE2
+        const __m128d h0 = _mm_set1_pd( h[ 0 ] ), h1 = _mm_set1_pd( h[ 1 ] ), h2 = _mm_set1_pd( h[ 2 ] );
+        const __m128d h3 = _mm_set1_pd( h[ 3 ] ), h4 = _mm_set1_pd( h[ 4 ] ), h5 = _mm_set1_pd( h[ 5 ] );
+        const __m128d h6 = _mm_set1_pd( h[ 6 ] ), h7 = _mm_set1_pd( h[ 7 ] ), h8 = _mm_set1_pd( h[ 8 ] );
+        const __m128d eps = _mm_set1_pd( FLT_EPSILON );
+        const __m128d one = _mm_set1_pd( 1.0 );
+        const __m128d signBit = _mm_set1_pd( -0.0 );
+        for ( ; i + 2 <= count; i += 2 )
+        {
+            // Point2d is two packed doubles, so two points load as (x0,y0) (x1,y1)
+            __m128d p0 = _mm_loadu_pd( &src[ i ].x );
+            __m128d p1 = _mm_loadu_pd( &src[ i + 1 ].x );
+            __m128d x = _mm_unpacklo_pd( p0, p1 );
+            __m128d y = _mm_unpackhi_pd( p0, p1 );
+            __m128d w = _mm_add_pd( _mm_add_pd( _mm_mul_pd( h6, x ), _mm_mul_pd( h7, y ) ), h8 );
+            __m128d valid = _mm_cmpgt_pd( _mm_andnot_pd( signBit, w ), eps );
+            w = _mm_and_pd( valid, _mm_div_pd( one, w ) );
+            __m128d X = _mm_mul_pd( _mm_add_pd( _mm_add_pd( _mm_mul_pd( h0, x ), _mm_mul_pd( h1, y ) ), h2 ), w );
+            __m128d Y = _mm_mul_pd( _mm_add_pd( _mm_add_pd( _mm_mul_pd( h3, x ), _mm_mul_pd( h4, y ) ), h5 ), w );
+            _mm_storeu_pd( &dst[ i ].x, _mm_unpacklo_pd( X, Y ) );
+            _mm_storeu_pd( &dst[ i + 1 ].x, _mm_unpackhi_pd( X, Y ) );
+        }
+#endif
+        for ( ; i < count; ++i )
+        {
+            const double x = src[ i ].x, y = src[ i ].y;
+            double w = h[ 6 ] * x + h[ 7 ] * y + h[ 8 ];
+            w = std::fabs( w ) > FLT_EPSILON ? 1.0 / w : 0.0;
+            dst[ i ] = cv::Point2d( ( h[ 0 ] * x + h[ 1 ] * y + h[ 2 ] ) * w, ( h[ 3 ] * x + h[ 4 ] * y + h[ 5 ] ) * w );
+        }
+    }
+
+    /**
+     * @brief Transform one point
+     * @param pt Point to transform
+     * @return Transformed point
+     */
+    cv::Point2d Apply( const cv::Point2d &pt ) const
+    {
+        cv::Point2d out;
+        Apply( &pt, &out, 1 );
+        return out;
+    }
+
+private:
+    bool m_isSet;
+    double m_h[ 9 ];
+};
+
+} // namespace gc
+
+#endif // HOMOGRAPHY_H
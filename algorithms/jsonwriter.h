@@ -0,0 +1,186 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/** \file jsonwriter.h
+ * @brief Include file that holds a small streaming json writer over a reusable character buffer
+ *
+ * Doubles are written in the shortest form that reads back to the same value (std::to_chars),
+ * independent of the global locale. Non-finite doubles are written as null. Strings are
+ * escaped. The buffer keeps its capacity across Clear(), so a writer reused for every image
+ * stops allocating once it has grown to the size of the largest result.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <cmath>
+#include <string>
+#include <cstdint>
+#include <charconv>
+#include <string_view>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief Appends json tokens to a character buffer, adding the commas between members and
+ *        array elements. Calls must be properly nested, there is no validation.
+ */
+class JsonWriter
+{
+public:
+    /**
+     * @brief Constructor
+     * @param reserveBytes Initial capacity of the buffer
+     */
+    explicit JsonWriter( const size_t reserveBytes = 4096 ) :
+        m_needComma( false )
+    {
+        m_buf.reserve( reserveBytes );
+    }
+
+    /**
+     * @brief Empty the buffer, keeping its capacity
+     */
+    void Clear()
+    {
+        m_buf.clear();
+        m_needComma = false;
+    }
+
+    JsonWriter &BeginObject() { Separate(); m_buf.push_back( '{' ); m_needComma = false; return *this; }
+    JsonWriter &EndObject() { m_buf.push_back( '}' ); m_needComma = true; return *this; }
+    JsonWriter &BeginArray() { Separate(); m_buf.push_back( '[' ); m_needComma = false; return *this; }
+    JsonWriter &EndArray() { m_buf.push_back( ']' ); m_needComma = true; return *this; }
+
+    /**
+     * @brief Write an object member name. The name is written as is, without escaping.
+     * @param key Member name
+     */
+    JsonWriter &Key( const std::string_view key )
+    {
+        Separate();
+        m_buf.push_back( '"' );
+        m_buf.append( key.data(), key.size() );
+        m_buf.append( "\": ", 3 );
+        m_needComma = false;
+        return *this;
+    }
+
+    JsonWriter &Value( const std::string_view str )
+    {
+        Separate();
+        m_buf.push_back( '"' );
+        for ( const char c : str )
+        {
+            switch ( c )
+            {
+                case '"': m_buf.append( "\\\"", 2 ); break;
+                case '\\': m_buf.append( "\\\\", 2 ); break;
+                case '\n': m_buf.append( "\\n", 2 ); break;
+                case '\r': m_buf.append( "\\r", 2 ); break;
+                case '\t': m_buf.append( "\\t", 2 ); break;
+                default:
+                    if ( 0x20 > static_cast< unsigned char >( c ) )
+                    {
+                        static const char hex[] = "0123456789abcdef";
+                        char esc[] = { '\\', 'u', '0', '0', hex[ ( c >> 4 ) & 0xf ], hex[ c & 0xf ] };
+                        m_buf.append( esc, sizeof( esc ) );
+                    }
+                    else
+                    {
+                        m_buf.push_back( c );
+                    }
+                    break;
+            }
+        }
+        m_buf.push_back( '"' );
+        m_needComma = true;
+        return *this;
+    }
+    JsonWriter &Value( const char *str ) { return Value( std::string_view( str ) ); }
+    JsonWriter &Value( const std::string &str ) { return Value( std::string_view( str ) ); }
+    JsonWriter &Value( const double value )
+    {
+        Separate();
+        if ( std::isfinite( value ) )
+        {
+            char num[ 32 ];
+            std::to_chars_result res = std::to_chars( num, num + sizeof( num ), value );
+            m_buf.append( num, static_cast< size_t >( res.ptr - num ) );
+        }
+        else
+        {
+            m_buf.append( "null", 4 );
+        }
+        m_needComma = true;
+        return *this;
+    }
+    JsonWriter &Value( const int64_t value )
+    {
+        Separate();
+        char num[ 24 ];
+        std::to_chars_result res = std::to_chars( num, num + sizeof( num ), value );
+        m_buf.append( num, static_cast< size_t >( res.ptr - num ) );
+        m_needComma = true;
+        return *this;
+    }
+    JsonWriter &Value( const int value ) { return Value( static_cast< int64_t >( value ) ); }
+    JsonWriter &Value( const bool value )
+    {
+        Separate();
+        m_buf.append( value ? "true" : "false" );
+        m_needComma = true;
+        return *this;
+    }
+
+    /**
+     * @brief Write a member name and its value
+     * @param key Member name
+     * @param value Member value
+     */
+    template< typename T >
+    JsonWriter &Member( const std::string_view key, const T &value )
+    {
+        Key( key );
+        return Value( value );
+    }
+
+    const char *data() const { return m_buf.data(); }
+    size_t size() const { return m_buf.size(); }
+    const std::string &str() const { return m_buf; }
+
+private:
+    std::string m_buf;
+    bool m_needComma;
+
+    void Separate()
+    {
+        if ( m_needComma )
+            m_buf.push_back( ',' );
+    }
+};
+
+} // namespace gc
+
+#endif // JSONWRITER_H
@@ -15,6 +15,17 @@
 #include <sstream>
 #include <string>
 #include <stdio.h>
+#ifndef FILELOG_SYNCHRONOUS
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
 
 inline std::string NowTime();
 
@@ -33,19 +44,21 @@ public:
     static TLogLevel FromString(const std::string& level);
 protected:
     std::ostringstream os;
+    TLogLevel messageLevel;
 private:
     Log(const Log&);
     Log& operator =(const Log&);
 };
 
 template <typename T>
-Log<T>::Log()
+Log<T>::Log() : messageLevel(logINFO)
 {
 }
 
 template <typename T>
 std::ostringstream& Log<T>::Get(TLogLevel level)
 {
+    messageLevel = level;
     os << NowTime();
     os << " " << ToString(level) << ": ";
     os << std::string(level > logDEBUG ? level - logDEBUG : 0, '\t');
@@ -56,7 +69,7 @@ template <typename T>
 Log<T>::~Log()
 {
     os << std::endl;
-    T::Output(os.str());
+    T::Output(os.str(), messageLevel);
 }
 
 template <typename T>
@@ -100,7 +113,8 @@ class Output2FILE
 {
 public:
     static FILE*& Stream();
-    static void Output(const std::string& msg);
+    static void Output(const std::string& msg, TLogLevel level = logINFO);
+    static void Flush();
 };
 
 inline FILE*& Output2FILE::Stream()
@@ -109,8 +123,10 @@ inline FILE*& Output2FILE::Stream()
     return pStream;
 }
 
-inline void Output2FILE::Output(const std::string& msg)
-{   
+#ifdef FILELOG_SYNCHRONOUS
+
+inline void Output2FILE::Output(const std::string& msg, TLogLevel)
+{
     FILE* pStream = Stream();
     if (!pStream)
         return;
@@ -118,6 +134,206 @@ inline void Output2FILE::Output(const std::string& msg)
     fflush(pStream);
 }
 
+inline void Output2FILE::Flush()
+{
+}
+
+#else
+
+// Messages are copied into a ring buffer owned by the logging thread and written to
+// Output2FILE::Stream() by a background drain thread, so FILE_LOG never waits on the
+// file or on other threads. A message that does not fit in a full ring is dropped and
+// counted. ERROR messages are not queued: the logging thread writes everything queued
+// before them and then the message itself, so they reach the file before a crash or
+// _exit can lose them. The drain thread is stopped by a function static destructor at
+// exit, which is not safe inside a shared library (loader lock, at-exit order against the
+// file), so libgrime2 and grime2py define FILELOG_SYNCHRONOUS, and so must anything that
+// includes this header into the same binary. Define FILELOG_SYNCHRONOUS to write each
+// message from the logging thread.
+
+// single producer (the logging thread), single consumer (the drain thread)
+class LogRing
+{
+public:
+    static const size_t CAPACITY = 64 * 1024;
+
+    LogRing() : head(0), tail(0) {}
+
+    bool Push(const std::string& msg)
+    {
+        uint32_t len = static_cast<uint32_t>(msg.size());
+        size_t need = sizeof(len) + len;
+        size_t h = head.load(std::memory_order_relaxed);
+        if (CAPACITY - (h - tail.load(std::memory_order_acquire)) < need)
+            return false;
+        Copy(h, &len, sizeof(len));
+        Copy(h + sizeof(len), msg.data(), len);
+        head.store(h + need, std::memory_order_release);
+        return true;
+    }
+    bool Empty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed);
+    }
+    void Drain(std::string& out)
+    {
+        size_t h = head.load(std::memory_order_acquire);
+        size_t t = tail.load(std::memory_order_relaxed);
+        while (t < h)
+        {
+            uint32_t len = 0;
+            Read(t, &len, sizeof(len));
+            size_t start = out.size();
+            out.resize(start + len);
+            Read(t + sizeof(len), &out[start], len);
+            t += sizeof(len) + len;
+        }
+        tail.store(t, std::memory_order_release);
+    }
+private:
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+    char buffer[CAPACITY];
+
+    void Copy(size_t pos, const void* src, size_t len)
+    {
+        size_t offset = pos % CAPACITY;
+        size_t first = len < CAPACITY - offset ? len : CAPACITY - offset;
+        memcpy(buffer + offset, src, first);
+        memcpy(buffer, static_cast<const char*>(src) + first, len - first);
+    }
+    void Read(size_t pos, void* dst, size_t len) const
+    {
+        size_t offset = pos % CAPACITY;
+        size_t first = len < CAPACITY - offset ? len : CAPACITY - offset;
+        memcpy(dst, buffer + offset, first);
+        memcpy(static_cast<char*>(dst) + first, buffer, len - first);
+    }
+};
+
+class LogDrain
+{
+public:
+    static LogDrain& Instance()
+    {
+        static LogDrain drain;
+        return drain;
+    }
+    void Write(const std::string& msg, TLogLevel level)
+    {
+        if (logERROR >= level)
+        {
+            DrainAll(&msg);
+            return;
+        }
+        thread_local std::shared_ptr<LogRing> ring = Register();
+        if (ring->Push(msg))
+            wake.notify_one();
+        else
+            dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    // writes everything queued so far before returning
+    void Flush()
+    {
+        DrainAll();
+    }
+    ~LogDrain()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stop = true;
+        }
+        wake.notify_one();
+        if (drainThread.joinable())
+            drainThread.join();
+        DrainAll();
+    }
+private:
+    std::mutex ringsMutex;
+    std::vector<std::shared_ptr<LogRing> > rings;
+    std::mutex drainMutex;
+    std::string pending;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<uint64_t> dropped;
+    bool stop;
+    std::thread drainThread;
+
+    LogDrain() : dropped(0), stop(false)
+    {
+        drainThread = std::thread(&LogDrain::Run, this);
+    }
+    LogDrain(const LogDrain&);
+    LogDrain& operator =(const LogDrain&);
+
+    std::shared_ptr<LogRing> Register()
+    {
+        std::shared_ptr<LogRing> ring = std::make_shared<LogRing>();
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.push_back(ring);
+        return ring;
+    }
+    void Run()
+    {
+        // producers wake the drain without taking the mutex, so a missed wakeup
+        // only delays output until the timeout
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        while (!stop)
+        {
+            wake.wait_for(lock, std::chrono::milliseconds(50));
+            lock.unlock();
+            DrainAll();
+            lock.lock();
+        }
+    }
+    // urgent, when given, is written after everything already queued
+    void DrainAll(const std::string* urgent = nullptr)
+    {
+        std::lock_guard<std::mutex> drainLock(drainMutex);
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            for (size_t i = 0; i < rings.size(); )
+            {
+                rings[i]->Drain(pending);
+                // the registry holds the last reference once the logging thread has exited
+                if (1 == rings[i].use_count() && rings[i]->Empty())
+                {
+                    rings[i] = rings.back();
+                    rings.pop_back();
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+        }
+        uint64_t lost = dropped.exchange(0, std::memory_order_relaxed);
+        if (0 < lost)
+            pending += "WARNING: " + std::to_string(lost) + " log messages dropped (log buffer full)\n";
+        if (urgent)
+            pending += *urgent;
+        FILE* pStream = Output2FILE::Stream();
+        if (pStream && !pending.empty())
+        {
+            fwrite(pending.data(), 1, pending.size(), pStream);
+            fflush(pStream);
+        }
+        pending.clear();
+    }
+};
+
+inline void Output2FILE::Output(const std::string& msg, TLogLevel level)
+{
+    LogDrain::Instance().Write(msg, level);
+}
+
+inline void Output2FILE::Flush()
+{
+    LogDrain::Instance().Flush();
+}
+
+#endif // FILELOG_SYNCHRONOUS
+
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
 #   if defined (BUILDING_FILELOG_DLL)
 #       define FILELOG_DECLSPEC   __declspec (dllexport)
@@ -166,11 +382,20 @@ inline std::string NowTime()
 
 inline std::string NowTime()
 {
+    // the timestamp has a resolution of one second, so each thread formats it once per second
+    thread_local time_t lastTime = static_cast< time_t >( -1 );
+    thread_local std::string lastStamp;
     time_t t = time( 0 );   // get time now
-    char szBuffer[ 64 ];
-    struct tm *pDt = localtime( &t );
-    strftime( szBuffer, sizeof( szBuffer ), "[%Y-%b-%d %T]", pDt );
-    return std::string( szBuffer );
+    if ( t != lastTime )
+    {
+        char szBuffer[ 64 ];
+        struct tm dt;
+        localtime_r( &t, &dt );
+        strftime( szBuffer, sizeof( szBuffer ), "[%Y-%b-%d %T]", &dt );
+        lastStamp = szBuffer;
+        lastTime = t;
+    }
+    return lastStamp;
 }
 
 #endif //WIN32
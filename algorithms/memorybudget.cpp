@@ -0,0 +1,265 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#include "log.h"
+#include "memorybudget.h"
+#include "stagetimer.h"
+#include <algorithm>
+#include <cstring>
+#ifdef _WIN32
+#ifndef PSAPI_VERSION
+#define PSAPI_VERSION 2     // GetProcessMemoryInfo from kernel32, no psapi.lib needed
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <cstdio>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+using namespace cv;
+using namespace std;
+
+// bytes per frame pixel of the planes a find allocates, besides the frame itself, until a find
+// of the mode has been measured: the gray plane, the line find preprocessing planes (a quarter
+// of the frame is assumed around the search lines in GC_MEMORY_ROI), and the float template
+// match planes of the octagon search
+static const double GRAY_PER_PIXEL = 1.0;
+static const double PREPROCESS_PER_PIXEL = 3.0;
+static const double ROI_FRACTION = 0.25;
+static const double OCTAGON_SEARCH_PER_PIXEL = 16.0;
+
+static void UpdateMax( atomic< size_t > &maxVal, const size_t value )
+{
+    size_t prev = maxVal.load();
+    while ( value > prev && !maxVal.compare_exchange_weak( prev, value ) )
+    {
+    }
+}
+
+namespace gc
+{
+
+MatMemoryTracker::MatMemoryTracker() :
+    m_inner( nullptr ),
+    m_installed( false ),
+    m_liveBytes( 0 ),
+    m_peakBytes( 0 )
+{
+}
+MatMemoryTracker &MatMemoryTracker::Instance()
+{
+    // never destroyed, Mats freed during static destruction still come back to it
+    static MatMemoryTracker *tracker = new MatMemoryTracker();
+    return *tracker;
+}
+StageMemory *&MatMemoryTracker::Sink()
+{
+    static thread_local StageMemory *sink = nullptr;
+    return sink;
+}
+void MatMemoryTracker::Install()
+{
+    lock_guard< mutex > lock( m_installMutex );
+    if ( !m_installed )
+    {
+        m_inner = Mat::getDefaultAllocator();
+        Mat::setDefaultAllocator( this );
+        m_installed = true;
+    }
+}
+UMatData *MatMemoryTracker::allocate( int dims, const int *sizes, int type, void *data, size_t *step,
+                                      AccessFlag flags, UMatUsageFlags usageFlags ) const
+{
+    UMatData *u = m_inner->allocate( dims, sizes, type, data, step, flags, usageFlags );
+    if ( nullptr != u && nullptr == data )
+    {
+        // the Mat frees through currAllocator, which brings the block back here to be counted out
+        u->currAllocator = this;
+        UpdateMax( m_peakBytes, m_liveBytes.fetch_add( u->size ) + u->size );
+
+        StageMemory *sink = Sink();
+        if ( nullptr != sink )
+        {
+            const char *stage = ScopedStageTimer::CurrentStage();
+            if ( nullptr == stage )
+                stage = "other";
+            auto iter = find_if( sink->stageBytes.begin(), sink->stageBytes.end(),
+                                 [ stage ]( const pair< string, size_t > &s ) { return s.first == stage; } );
+            if ( sink->stageBytes.end() == iter )
+                sink->stageBytes.emplace_back( stage, u->size );
+            else
+                iter->second += u->size;
+            sink->liveBytes += u->size;
+            sink->peakBytes = std::max( sink->peakBytes, sink->liveBytes );
+            u->userdata = sink;
+        }
+    }
+    return u;
+}
+bool MatMemoryTracker::allocate( UMatData *data, AccessFlag accessflags, UMatUsageFlags usageFlags ) const
+{
+    return m_inner->allocate( data, accessflags, usageFlags );
+}
+void MatMemoryTracker::deallocate( UMatData *u ) const
+{
+    if ( nullptr != u )
+    {
+        m_liveBytes.fetch_sub( u->size );
+
+        // a block freed by the find that allocated it comes off its live count, blocks that
+        // outlive the find (e.g. the result image) stay counted in its peak
+        StageMemory *sink = Sink();
+        if ( nullptr != sink && sink == u->userdata )
+            sink->liveBytes -= std::min( sink->liveBytes, u->size );
+        u->userdata = nullptr;
+
+        u->currAllocator = m_inner;
+        m_inner->deallocate( u );
+    }
+}
+
+size_t ProcessRssBytes()
+{
+    size_t bytes = 0;
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if ( GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) )
+        bytes = counters.WorkingSetSize;
+#else
+    FILE *statm = fopen( "/proc/self/statm", "r" );
+    if ( nullptr != statm )
+    {
+        unsigned long sizePages = 0, residentPages = 0;
+        if ( 2 == fscanf( statm, "%lu %lu", &sizePages, &residentPages ) )
+            bytes = static_cast< size_t >( residentPages ) * static_cast< size_t >( sysconf( _SC_PAGESIZE ) );
+        fclose( statm );
+    }
+#endif
+    return bytes;
+}
+size_t ProcessPeakRssBytes()
+{
+    size_t bytes = 0;
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if ( GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) )
+        bytes = counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if ( 0 == getrusage( RUSAGE_SELF, &usage ) )
+        bytes = static_cast< size_t >( usage.ru_maxrss ) * 1024;    // kilobytes on Linux
+#endif
+    return bytes;
+}
+
+MemoryBudget::MemoryBudget() :
+    m_limitBytes( 0 ),
+    m_inUseBytes( 0 ),
+    m_runningCount( 0 ),
+    m_measuredPerPixel{ 0.0, 0.0 }
+{
+}
+GC_STATUS MemoryBudget::SetTarget( const size_t targetBytes )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        lock_guard< mutex > lock( m_mutex );
+        m_limitBytes = 0;
+        if ( 0 < targetBytes )
+        {
+            size_t baseBytes = ProcessRssBytes();
+            if ( baseBytes >= targetBytes )
+            {
+                FILE_LOG( logWARNING ) << "[MemoryBudget::SetTarget] The process already holds " << ( baseBytes >> 20 )
+                                       << " MB of the " << ( targetBytes >> 20 ) << " MB target, finds will run one at a time";
+                m_limitBytes = 1;
+                retVal = GC_WARN;
+            }
+            else
+            {
+                m_limitBytes = targetBytes - baseBytes;
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[MemoryBudget::SetTarget] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+size_t MemoryBudget::Estimate( const cv::Size frameSize, const int channels, const GC_MEMORY_MODE mode ) const
+{
+    const double pixels = static_cast< double >( frameSize.area() );
+    double perPixel = 0.0;
+    {
+        lock_guard< mutex > lock( m_mutex );
+        perPixel = m_measuredPerPixel[ GC_MEMORY_ROI == mode ? 1 : 0 ];
+    }
+    if ( 0.0 >= perPixel )
+    {
+        perPixel = ( 1 < channels ? GRAY_PER_PIXEL : 0.0 ) + OCTAGON_SEARCH_PER_PIXEL +
+                   PREPROCESS_PER_PIXEL * ( GC_MEMORY_ROI == mode ? ROI_FRACTION : 1.0 );
+    }
+    return static_cast< size_t >( pixels * ( static_cast< double >( channels ) + perPixel ) );
+}
+GC_MEMORY_MODE MemoryBudget::ChooseMode( const cv::Size frameSize, const int channels ) const
+{
+    GC_MEMORY_MODE mode = GC_MEMORY_FULL;
+    if ( IsLimited() && Estimate( frameSize, channels, GC_MEMORY_FULL ) > m_limitBytes )
+    {
+        mode = GC_MEMORY_ROI;
+    }
+    return mode;
+}
+void MemoryBudget::Measured( const cv::Size frameSize, const GC_MEMORY_MODE mode, const size_t peakBytes )
+{
+    if ( 0 < frameSize.area() && 0 < peakBytes )
+    {
+        double perPixel = static_cast< double >( peakBytes ) / static_cast< double >( frameSize.area() );
+        lock_guard< mutex > lock( m_mutex );
+        double &measured = m_measuredPerPixel[ GC_MEMORY_ROI == mode ? 1 : 0 ];
+        measured = std::max( measured, perPixel );
+    }
+}
+void MemoryBudget::Acquire( const size_t bytes )
+{
+    if ( IsLimited() )
+    {
+        unique_lock< mutex > lock( m_mutex );
+        m_released.wait( lock, [ this, bytes ]() { return 0 == m_runningCount || m_inUseBytes + bytes <= m_limitBytes; } );
+        m_inUseBytes += bytes;
+        ++m_runningCount;
+    }
+}
+void MemoryBudget::Release( const size_t bytes )
+{
+    if ( IsLimited() )
+    {
+        {
+            lock_guard< mutex > lock( m_mutex );
+            m_inUseBytes -= std::min( m_inUseBytes, bytes );
+            --m_runningCount;
+        }
+        m_released.notify_all();
+    }
+}
+
+} // namespace gc
@@ -0,0 +1,259 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/** \file memorybudget.h
+ * @brief A file for the accounting of the image memory used by line finds and for a budget
+ *        that keeps the finds of a run inside a target resident memory size
+ *
+ * MatMemoryTracker is installed as the OpenCV default allocator and counts the bytes of every
+ * cv::Mat it allocates. Allocations made on a thread with a StageMemory bound by
+ * GC_MEMORY_SINK( usage ) are also added to the stage that is running (the GC_STAGE_TIMER
+ * names, so stages are only told apart when built with GC_STAGE_TIMING).
+ *
+ * MemoryBudget uses those measurements to choose how much of a frame a find keeps in memory
+ * and how many finds may run at the same time.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+#include "gc_types.h"
+#include "stagetimer.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <opencv2/core.hpp>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief cv::MatAllocator that counts the bytes allocated through it and passes the allocations
+ *        on to the allocator that was the default before it was installed
+ */
+class MatMemoryTracker : public cv::MatAllocator
+{
+public:
+    /**
+     * @brief The tracker of the process
+     */
+    static MatMemoryTracker &Instance();
+
+    /**
+     * @brief Make the tracker the OpenCV default allocator. Calls after the first do nothing
+     */
+    void Install();
+
+    /**
+     * @brief true once Install() has been called
+     */
+    bool IsInstalled() const { return m_installed; }
+
+    /**
+     * @brief Bytes allocated through the tracker and not yet freed
+     */
+    size_t LiveBytes() const { return m_liveBytes; }
+
+    /**
+     * @brief Largest LiveBytes() since the tracker was installed
+     */
+    size_t PeakBytes() const { return m_peakBytes; }
+
+    /**
+     * @brief Image memory record the allocations of the current thread are added to (nullptr=none)
+     */
+    static StageMemory *&Sink();
+
+    cv::UMatData *allocate( int dims, const int *sizes, int type, void *data, size_t *step,
+                            cv::AccessFlag flags, cv::UMatUsageFlags usageFlags ) const override;
+    bool allocate( cv::UMatData *data, cv::AccessFlag accessflags, cv::UMatUsageFlags usageFlags ) const override;
+    void deallocate( cv::UMatData *data ) const override;
+
+private:
+    MatMemoryTracker();
+
+    const cv::MatAllocator *m_inner;
+    std::atomic< bool > m_installed;
+    mutable std::atomic< size_t > m_liveBytes;
+    mutable std::atomic< size_t > m_peakBytes;
+    std::mutex m_installMutex;
+};
+
+/**
+ * @brief Binds an image memory record to the current thread for the lifetime of the object
+ */
+class StageMemorySink
+{
+public:
+    /**
+     * @brief Constructor binds the record
+     * @param usage Record the allocations of this thread are added to
+     */
+    explicit StageMemorySink( StageMemory &usage ) :
+        m_prev( MatMemoryTracker::Sink() )
+    {
+        MatMemoryTracker::Sink() = &usage;
+    }
+
+    /**
+     * @brief Destructor restores the record that was bound before
+     */
+    ~StageMemorySink()
+    {
+        MatMemoryTracker::Sink() = m_prev;
+    }
+
+    StageMemorySink( const StageMemorySink & ) = delete;
+    StageMemorySink &operator=( const StageMemorySink & ) = delete;
+
+private:
+    StageMemory *m_prev;
+};
+
+/**
+ * @brief Resident memory of the process in bytes (0=not available on this platform)
+ */
+size_t ProcessRssBytes();
+
+/**
+ * @brief Largest resident memory of the process so far in bytes (0=not available on this platform)
+ */
+size_t ProcessPeakRssBytes();
+
+/**
+ * @brief Shares a number of bytes between the line finds of a run. Each find reserves what its
+ *        frame is expected to need before it starts and waits while the reservations of the finds
+ *        already running leave too little, so fewer finds run at once as frames get larger.
+ *        One find may always run, even when its frame alone is larger than the budget
+ */
+class MemoryBudget
+{
+public:
+    /**
+     * @brief Constructor for a budget without a limit
+     */
+    MemoryBudget();
+
+    /**
+     * @brief Set the target resident memory of the process. What the process already holds
+     *        when this is called is taken off the target to give the bytes the finds share
+     * @param targetBytes Target resident memory in bytes (0=no limit)
+     * @return GC_OK=Success, GC_WARN=The process already holds more than the target (the finds run one at a time)
+     */
+    GC_STATUS SetTarget( const size_t targetBytes );
+
+    /**
+     * @brief true if a target has been set
+     */
+    bool IsLimited() const { return 0 < m_limitBytes; }
+
+    /**
+     * @brief Bytes the finds share (0=no limit)
+     */
+    size_t Limit() const { return m_limitBytes; }
+
+    /**
+     * @brief Bytes a find of a frame is expected to need, from the largest measured find of the
+     *        mode once one has been measured, otherwise from the size of the planes it allocates
+     * @param frameSize Size of the frame
+     * @param channels Number of channels of the frame
+     * @param mode How much of the frame is preprocessed
+     */
+    size_t Estimate( const cv::Size frameSize, const int channels, const GC_MEMORY_MODE mode ) const;
+
+    /**
+     * @brief Mode a find of a frame should use: GC_MEMORY_FULL if it fits in the budget on its
+     *        own (or there is no limit), otherwise GC_MEMORY_ROI
+     * @param frameSize Size of the frame
+     * @param channels Number of channels of the frame
+     */
+    GC_MEMORY_MODE ChooseMode( const cv::Size frameSize, const int channels ) const;
+
+    /**
+     * @brief Record the image memory a find of a frame really allocated
+     * @param frameSize Size of the frame
+     * @param mode Mode the find used
+     * @param peakBytes Largest image memory the find held (StageMemory::peakBytes)
+     */
+    void Measured( const cv::Size frameSize, const GC_MEMORY_MODE mode, const size_t peakBytes );
+
+    /**
+     * @brief Reserve bytes for a find, waiting until they fit beside the finds already running
+     * @param bytes Bytes to reserve
+     */
+    void Acquire( const size_t bytes );
+
+    /**
+     * @brief Give back bytes reserved with Acquire()
+     * @param bytes Bytes to give back
+     */
+    void Release( const size_t bytes );
+
+private:
+    size_t m_limitBytes;
+    size_t m_inUseBytes;
+    size_t m_runningCount;
+    double m_measuredPerPixel[ 2 ];
+    mutable std::mutex m_mutex;
+    std::condition_variable m_released;
+};
+
+/**
+ * @brief Holds a MemoryBudget reservation for the lifetime of the object
+ */
+class MemoryBudgetLease
+{
+public:
+    /**
+     * @brief Constructor reserves the bytes, waiting until they fit
+     * @param budget Budget to reserve from
+     * @param bytes Bytes to reserve
+     */
+    MemoryBudgetLease( MemoryBudget &budget, const size_t bytes ) :
+        m_budget( budget ),
+        m_bytes( bytes )
+    {
+        m_budget.Acquire( m_bytes );
+    }
+
+    /**
+     * @brief Destructor gives the bytes back
+     */
+    ~MemoryBudgetLease()
+    {
+        m_budget.Release( m_bytes );
+    }
+
+    MemoryBudgetLease( const MemoryBudgetLease & ) = delete;
+    MemoryBudgetLease &operator=( const MemoryBudgetLease & ) = delete;
+
+private:
+    MemoryBudget &m_budget;
+    size_t m_bytes;
+};
+
+} // namespace gc
+
+#define GC_MEMORY_SINK( usage ) gc::StageMemorySink GC_STAGE_CONCAT( gcMemorySink_, __LINE__ )( usage )
+
+#endif // MEMORYBUDGET_H
@@ -15,6 +15,7 @@
 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 #include "log.h"
 #include "octagonsearch.h"
+#include "stagetimer.h"
 #include <random>
 #include <iostream>
 #include <algorithm>
@@ -256,6 +257,7 @@ GC_STATUS OctagonSearch::AdjustResponseSpace( Mat &response, const size_t j )
 }
 GC_STATUS OctagonSearch::Find( const cv::Mat &img, std::vector< cv::Point2d > &pts, const bool do_coarse_prefind )
 {
+    GC_STAGE_TIMER( "octagon_search" );
     GC_STATUS retVal = GC_OK;
     try
     {
@@ -281,7 +283,8 @@ GC_STATUS OctagonSearch::Find( const cv::Mat &img, std::vector< cv::Point2d > &p
                 if ( img.type() == CV_8UC3 )
                     cvtColor( img, matIn, COLOR_BGR2GRAY );
 
-                Mat  mask = Mat::ones( img.size(), CV_8UC1 ) * 255;
+                // only the coarse prefind limits the search, without it no frame sized mask is needed
+                Mat mask;
 
                 int radBeg = static_cast< int >( round( std::min( img.cols, img.rows ) * 0.2 ) );
                 int radEnd = static_cast< int >( round( std::min( img.cols, img.rows ) * 0.45 ) );
@@ -322,9 +325,12 @@ GC_STATUS OctagonSearch::Find( const cv::Mat &img, std::vector< cv::Point2d > &p
 #ifdef DEBUG_OCTAGON_TEMPL
                         imwrite("/var/tmp/gaugecam/response_001.png", response);
 #endif
-                        int l = ( mask.cols - response.cols ) >> 1;
-                        int r = ( mask.rows - response.rows ) >> 1;
-                        response.setTo( 0.0, mask( Rect( l, r, response.cols, response.rows ) ) == 0 );
+                        if ( !mask.empty() )
+                        {
+                            int l = ( mask.cols - response.cols ) >> 1;
+                            int r = ( mask.rows - response.rows ) >> 1;
+                            response.setTo( 0.0, mask( Rect( l, r, response.cols, response.rows ) ) == 0 );
+                        }
 #ifdef DEBUG_OCTAGON_TEMPL
                         cv::Mat float_image_normalized, img8u;
                         cv::normalize(response, float_image_normalized, 0.0, 1.0, cv::NORM_MINMAX, CV_32F);
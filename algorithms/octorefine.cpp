@@ -1,5 +1,6 @@
 #include "log.h"
 #include "octorefine.h"
+#include "stagetimer.h"
 #include <opencv2/imgproc.hpp>
 #include <opencv2/core.hpp>
 #include <cmath>
@@ -25,6 +26,7 @@ OctoRefine::OctoRefine() {}
 gc::GC_STATUS OctoRefine::RefinePoints( const cv::Mat &img, const std::vector< cv::Point2d > &pts,
                                         std::vector< cv::Point2d > &vertices, int minFacetPts, double sigma )
 {
+    GC_STAGE_TIMER( "octo_refine" );
     gc::GC_STATUS retVal = gc::GC_OK;
     try
     {
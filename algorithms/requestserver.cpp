@@ -0,0 +1,599 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "log.h"
+#include "requestserver.h"
+#include "visapp.h"
+#include "resultsink.h"
+#include "resultlog.h"
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <opencv2/imgcodecs.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/socket.h>
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+using namespace cv;
+using namespace std;
+namespace pt = boost::property_tree;
+
+namespace gc
+{
+
+#ifndef _WIN32
+/**
+ * @brief One client connection of the socket server. The socket is closed when the reader
+ *        thread and every responder of the requests still in flight have let go of it.
+ */
+class SocketConnection
+{
+public:
+    explicit SocketConnection( const int fd ) : m_fd( fd ) {}
+    ~SocketConnection() { close( m_fd ); }
+
+    int Fd() const { return m_fd; }
+
+    void Send( const std::string &response )
+    {
+        lock_guard< mutex > lock( m_mutex );
+        string line = response + "\n";
+        size_t sent = 0;
+        while ( sent < line.size() )
+        {
+            ssize_t ret = send( m_fd, line.data() + sent, line.size() - sent, MSG_NOSIGNAL );
+            if ( 0 > ret )
+            {
+                if ( EINTR == errno )
+                    continue;
+                FILE_LOG( logWARNING ) << "[SocketConnection::Send] Client went away before its response was sent";
+                break;
+            }
+            sent += static_cast< size_t >( ret );
+        }
+    }
+
+private:
+    int m_fd;
+    std::mutex m_mutex;
+};
+
+static void ReadConnection( RequestServer *server, shared_ptr< SocketConnection > conn,
+                            StopRequestedFunc stopRequested, shared_ptr< atomic< bool > > isDone )
+{
+    string pending;
+    vector< char > buffer( 64 * 1024 );
+    while ( !stopRequested() )
+    {
+        pollfd pfd = { conn->Fd(), POLLIN, 0 };
+        int ret = poll( &pfd, 1, 250 );
+        if ( 0 == ret || ( 0 > ret && EINTR == errno ) )
+            continue;
+        if ( 0 > ret )
+            break;
+
+        ssize_t len = recv( conn->Fd(), buffer.data(), buffer.size(), 0 );
+        if ( 0 > len && EINTR == errno )
+            continue;
+        if ( 0 >= len )
+            break;
+
+        pending.append( buffer.data(), static_cast< size_t >( len ) );
+        size_t start = 0;
+        size_t pos;
+        while ( string::npos != ( pos = pending.find( '\n', start ) ) )
+        {
+            string line = pending.substr( start, pos - start );
+            start = pos + 1;
+            if ( !line.empty() && '\r' == line[ line.size() - 1 ] )
+                line.pop_back();
+            if ( !line.empty() )
+            {
+                server->Submit( line, [ conn ]( const string &response ) { conn->Send( response ); } );
+            }
+        }
+        pending.erase( 0, start );
+    }
+    *isDone = true;
+}
+#endif
+
+RequestServer::RequestServer() :
+    m_isRunning( false ),
+    m_answeredCount( 0 )
+{
+}
+RequestServer::~RequestServer()
+{
+    if ( m_isRunning )
+    {
+        Finish();
+    }
+}
+GC_STATUS RequestServer::Start( const RequestServerConfig config )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( m_isRunning )
+        {
+            FILE_LOG( logERROR ) << "[RequestServer::Start] Server is already running";
+            retVal = GC_ERR;
+        }
+        else
+        {
+            int workerThreads = config.workerThreads;
+            if ( 0 >= workerThreads )
+                workerThreads = std::max( 1, static_cast< int >( thread::hardware_concurrency() ) );
+            int queueDepth = 0 >= config.queueDepth ? workerThreads << 1 : config.queueDepth;
+
+            m_answeredCount = 0;
+            m_requestQueue = make_unique< BoundedQueue< ServerRequest > >( static_cast< size_t >( queueDepth ) );
+
+            m_isRunning = true;
+            for ( int i = 0; i < workerThreads; ++i )
+            {
+                m_workerThreads.push_back( thread( &RequestServer::WorkerThreadFunc, this ) );
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[RequestServer::Start] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS RequestServer::Submit( const std::string &requestLine, RequestResponder responder )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( !m_isRunning )
+        {
+            FILE_LOG( logERROR ) << "[RequestServer::Submit] Server is not running";
+            retVal = GC_ERR;
+        }
+        else
+        {
+            ServerRequest request;
+            request.line = requestLine;
+            request.responder = responder;
+            if ( !m_requestQueue->Push( std::move( request ) ) )
+            {
+                FILE_LOG( logERROR ) << "[RequestServer::Submit] Server is shutting down";
+                retVal = GC_ERR;
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[RequestServer::Submit] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS RequestServer::Finish()
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( m_isRunning )
+        {
+            m_requestQueue->Close();
+            for ( size_t i = 0; i < m_workerThreads.size(); ++i )
+                m_workerThreads[ i ].join();
+            m_workerThreads.clear();
+
+            lock_guard< mutex > lock( m_sinkMutex );
+            for ( auto &sink : m_csvSinks )
+            {
+                if ( GC_OK != sink.second->Close() )
+                    retVal = GC_ERR;
+            }
+            for ( auto &writer : m_logWriters )
+            {
+                if ( GC_OK != writer.second->Close() )
+                    retVal = GC_ERR;
+            }
+            m_csvSinks.clear();
+            m_logWriters.clear();
+            m_isRunning = false;
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[RequestServer::Finish] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS RequestServer::ServeStream( std::istream &in, std::ostream &out, const RequestServerConfig config )
+{
+    GC_STATUS retVal = Start( config );
+    if ( GC_OK == retVal )
+    {
+        mutex outMutex;
+        string line;
+        while ( getline( in, line ) )
+        {
+            if ( !line.empty() && '\r' == line[ line.size() - 1 ] )
+                line.pop_back();
+            if ( line.empty() )
+                continue;
+
+            retVal = Submit( line, [ &out, &outMutex ]( const string &response )
+                                   {
+                                       lock_guard< mutex > lock( outMutex );
+                                       out << response << '\n';
+                                       out.flush();
+                                   } );
+            if ( GC_OK != retVal )
+                break;
+        }
+        GC_STATUS retFinish = Finish();
+        retVal = GC_OK == retVal ? retFinish : retVal;
+    }
+    return retVal;
+}
+GC_STATUS RequestServer::ServeSocket( const std::string socketPath, const RequestServerConfig config, StopRequestedFunc stopRequested )
+{
+    GC_STATUS retVal = GC_OK;
+#ifdef _WIN32
+    FILE_LOG( logERROR ) << "[RequestServer::ServeSocket] Local sockets are not supported on this platform: " << socketPath;
+    retVal = GC_ERR;
+#else
+    try
+    {
+        sockaddr_un addr;
+        memset( &addr, 0, sizeof( addr ) );
+        addr.sun_family = AF_UNIX;
+        if ( socketPath.empty() || sizeof( addr.sun_path ) <= socketPath.size() )
+        {
+            FILE_LOG( logERROR ) << "[RequestServer::ServeSocket] Invalid socket path: " << socketPath;
+            retVal = GC_ERR;
+        }
+        else
+        {
+            strncpy( addr.sun_path, socketPath.c_str(), sizeof( addr.sun_path ) - 1 );
+            unlink( socketPath.c_str() );
+
+            int listenFd = socket( AF_UNIX, SOCK_STREAM, 0 );
+            if ( 0 > listenFd ||
+                 0 != ::bind( listenFd, reinterpret_cast< sockaddr * >( &addr ), sizeof( addr ) ) ||
+                 0 != listen( listenFd, 16 ) )
+            {
+                FILE_LOG( logERROR ) << "[RequestServer::ServeSocket] Could not listen on " << socketPath;
+                if ( 0 <= listenFd )
+                    close( listenFd );
+                retVal = GC_ERR;
+            }
+            else
+            {
+                retVal = Start( config );
+                if ( GC_OK == retVal )
+                {
+                    FILE_LOG( logINFO ) << "[RequestServer::ServeSocket] Listening on " << socketPath;
+
+                    vector< pair< thread, shared_ptr< atomic< bool > > > > readers;
+                    while ( !stopRequested() )
+                    {
+                        // join the readers of connections that have been closed by their clients
+                        for ( auto iter = readers.begin(); iter != readers.end(); )
+                        {
+                            if ( *iter->second )
+                            {
+                                iter->first.join();
+                                iter = readers.erase( iter );
+                            }
+                            else
+                            {
+                                ++iter;
+                            }
+                        }
+
+                        pollfd pfd = { listenFd, POLLIN, 0 };
+                        int ret = poll( &pfd, 1, 250 );
+                        if ( 0 >= ret )
+                            continue;
+
+                        int connFd = accept( listenFd, nullptr, nullptr );
+                        if ( 0 <= connFd )
+                        {
+                            auto isDone = make_shared< atomic< bool > >( false );
+                            readers.push_back( make_pair( thread( ReadConnection, this, make_shared< SocketConnection >( connFd ),
+                                                                  stopRequested, isDone ), isDone ) );
+                        }
+                    }
+                    for ( auto &reader : readers )
+                        reader.first.join();
+
+                    retVal = Finish();
+                }
+                close( listenFd );
+                unlink( socketPath.c_str() );
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[RequestServer::ServeSocket] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+#endif
+    return retVal;
+}
+void RequestServer::WorkerThreadFunc()
+{
+    // the engine keeps its calibration and octagon templates from one request to the next
+    unique_ptr< VisApp > visApp = make_unique< VisApp >();
+    ServerRequest request;
+    bool isTimeout = false;
+    while ( m_requestQueue->PopFor( request, chrono::milliseconds( 1000 ), isTimeout ) )
+    {
+        if ( isTimeout )
+        {
+            // nothing to do, so push buffered results to disk
+            FlushSinks();
+            continue;
+        }
+        string response = Process( *visApp, request.line );
+        try
+        {
+            if ( request.responder )
+                request.responder( response );
+        }
+        catch( std::exception &e )
+        {
+            FILE_LOG( logERROR ) << "[RequestServer::WorkerThreadFunc] " << e.what();
+        }
+        ++m_answeredCount;
+        request = ServerRequest();
+    }
+}
+std::string RequestServer::Process( VisApp &visApp, const std::string &requestLine )
+{
+    string id = "null";
+    string op;
+    string result = "{}";
+    bool isOk = false;
+    try
+    {
+        pt::ptree top_level;
+        stringstream ss( requestLine );
+        pt::json_parser::read_json( ss, top_level );
+
+        boost::optional< string > idValue = top_level.get_optional< string >( "id" );
+        if ( idValue )
+        {
+            // the json parser keeps numbers as strings, so numeric ids are returned unquoted
+            bool isNumber = !idValue->empty() && string::npos == idValue->find_first_not_of( "-0123456789" );
+            id = isNumber ? *idValue : "\"" + EscapeJson( *idValue ) + "\"";
+        }
+        op = top_level.get< string >( "op", "" );
+
+        if ( "find_line" == op )
+        {
+            FindLineParams params;
+            params.imagePath = top_level.get< string >( "source", "" );
+            params.calibFilepath = top_level.get< string >( "calib_json", "" );
+            params.resultImagePath = top_level.get< string >( "result_image", "" );
+            params.resultCSVPath = top_level.get< string >( "csv_file", "" );
+            params.resultLogPath = top_level.get< string >( "result_log", "" );
+            params.lineSearchROIFolder = top_level.get< string >( "line_roi_folder", "" );
+            params.timeStampFormat = top_level.get< string >( "timestamp_format", "" );
+            params.timeStampType = "from_filename" == top_level.get< string >( "timestamp_type", "" ) ? FROM_FILENAME : FROM_EXIF;
+            params.timeStampStartPos = top_level.get< int >( "timestamp_start_pos", 0 );
+            result = FindLine( visApp, params, isOk );
+        }
+        else if ( "calibrate" == op )
+        {
+            result = Calibrate( visApp, top_level.get< string >( "source", "" ), top_level.get< string >( "calib_json", "" ),
+                                top_level.get< string >( "result_image", "" ), isOk );
+        }
+        else if ( "show_metadata" == op )
+        {
+            result = ShowMetadata( visApp, top_level.get< string >( "source", "" ), isOk );
+        }
+        else
+        {
+            result = "{\"error\": \"Unknown op: " + EscapeJson( op ) + "\"}";
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[RequestServer::Process] " << e.what();
+        result = "{\"error\": \"" + EscapeJson( e.what() ) + "\"}";
+        isOk = false;
+    }
+    return "{\"id\": " + id + ", \"op\": \"" + EscapeJson( op ) + "\", \"status\": \"" +
+            ( isOk ? "SUCCESS" : "FAILURE" ) + "\", \"result\": " + result + "}";
+}
+std::string RequestServer::FindLine( VisApp &visApp, const FindLineParams &params, bool &isOk )
+{
+    Mat img;
+    FindLineResult result;
+    GC_STATUS retVal = visApp.ReadFindLineImage( params, img, result );
+    if ( GC_OK == retVal )
+    {
+        retVal = visApp.CalcLine( img, params, result );
+        GC_STATUS retWrite = WriteSinks( params, result );
+        retVal = GC_OK == retVal ? retWrite : retVal;
+        if ( !params.resultImagePath.empty() || !params.lineSearchROIFolder.empty() )
+        {
+            GC_STATUS retSave = visApp.SaveFindLineImages( img, params, result );
+            retVal = GC_OK == retVal ? retSave : retVal;
+        }
+    }
+
+    string resultJson;
+    if ( GC_OK != visApp.ResultToJsonString( result, params, resultJson ) )
+    {
+        resultJson = "{}";
+    }
+    isOk = GC_OK == retVal && result.findSuccess;
+    return resultJson;
+}
+std::string RequestServer::Calibrate( VisApp &visApp, const std::string imgPath, const std::string calibPath,
+                                      const std::string resultImgPath, bool &isOk )
+{
+    string err_msg;
+    double rmseDist = -1.0, rmseX = -1.0, rmseY = -1.0;
+    GC_STATUS retVal = GC_OK;
+    Mat img = imread( imgPath, IMREAD_COLOR );
+    if ( img.empty() )
+    {
+        err_msg = "Could not read calibration image " + imgPath;
+        retVal = GC_ERR;
+    }
+    else
+    {
+        retVal = visApp.CalibLoad( calibPath );
+        if ( GC_OK != retVal )
+        {
+            err_msg = "Could not load calibration file " + calibPath;
+        }
+        else
+        {
+            string jsonControl;
+            retVal = visApp.GetCalibControlJson( jsonControl );
+            if ( GC_OK == retVal )
+            {
+                retVal = visApp.Calibrate( img, jsonControl, rmseDist, rmseX, rmseY, err_msg );
+                if ( GC_OK == retVal && !resultImgPath.empty() )
+                {
+                    Mat calibOverlay;
+                    retVal = visApp.DrawCalibOverlay( img, calibOverlay, false, true, true, true );
+                    if ( GC_OK == retVal && !imwrite( resultImgPath, calibOverlay ) )
+                    {
+                        err_msg = "Could not write calibration result image " + resultImgPath;
+                        retVal = GC_ERR;
+                    }
+                }
+            }
+        }
+    }
+    isOk = GC_OK == retVal;
+
+    stringstream ss;
+    ss << "{\"calib_path\": \"" << EscapeJson( calibPath ) << "\",";
+    ss << "\"rmse_dist\": " << rmseDist << ",";
+    ss << "\"rmse_x\": " << rmseX << ",";
+    ss << "\"rmse_y\": " << rmseY << ",";
+    ss << "\"messages\": \"" << EscapeJson( err_msg ) << "\"}";
+    return ss.str();
+}
+std::string RequestServer::ShowMetadata( VisApp &visApp, const std::string imgPath, bool &isOk )
+{
+    string data;
+    isOk = GC_OK == visApp.GetImageData( imgPath, data );
+    return "{\"image_path\": \"" + EscapeJson( imgPath ) + "\", \"metadata\": \"" + EscapeJson( data ) + "\"}";
+}
+GC_STATUS RequestServer::WriteSinks( const FindLineParams &params, const FindLineResult &result )
+{
+    // a sink that could not be opened is dropped, so every request for its path fails and the
+    // next one tries to open it again instead of the results being lost without an error
+    GC_STATUS retVal = GC_OK;
+    lock_guard< mutex > lock( m_sinkMutex );
+    if ( !params.resultCSVPath.empty() )
+    {
+        unique_ptr< CsvResultSink > &sink = m_csvSinks[ params.resultCSVPath ];
+        if ( nullptr == sink )
+        {
+            sink = make_unique< CsvResultSink >();
+            sink->Open( params.resultCSVPath );
+        }
+        if ( sink->IsOpen() )
+        {
+            retVal = sink->Write( params.imagePath, result );
+        }
+        else
+        {
+            m_csvSinks.erase( params.resultCSVPath );
+            retVal = GC_ERR;
+        }
+    }
+    if ( !params.resultLogPath.empty() )
+    {
+        GC_STATUS retAppend = GC_OK;
+        unique_ptr< ResultLogWriter > &writer = m_logWriters[ params.resultLogPath ];
+        if ( nullptr == writer )
+        {
+            writer = make_unique< ResultLogWriter >();
+            writer->Open( params.resultLogPath );
+        }
+        if ( writer->IsOpen() )
+        {
+            retAppend = writer->Append( params.imagePath, result );
+        }
+        else
+        {
+            m_logWriters.erase( params.resultLogPath );
+            retAppend = GC_ERR;
+        }
+        retVal = GC_OK == retVal ? retAppend : retVal;
+    }
+    return retVal;
+}
+void RequestServer::FlushSinks()
+{
+    lock_guard< mutex > lock( m_sinkMutex );
+    for ( auto &sink : m_csvSinks )
+        sink.second->Flush();
+    for ( auto &writer : m_logWriters )
+        writer.second->Flush();
+}
+std::string RequestServer::EscapeJson( const std::string &str )
+{
+    string escaped;
+    escaped.reserve( str.size() );
+    for ( char c : str )
+    {
+        switch ( c )
+        {
+            case '"':  escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if ( 0x20 > static_cast< unsigned char >( c ) )
+                {
+                    stringstream ss;
+                    ss << "\\u" << hex << setw( 4 ) << setfill( '0' ) << static_cast< int >( c );
+                    escaped += ss.str();
+                }
+                else
+                {
+                    escaped += c;
+                }
+                break;
+        }
+    }
+    return escaped;
+}
+
+} // namespace gc
@@ -0,0 +1,193 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/** \file requestserver.h
+ * @brief A file for a class that answers newline delimited json requests with a pool of
+ *        long-lived, calibrated VisApp engines
+ *
+ * Each request is one json object on one line. The "op" member selects the operation and the
+ * remaining members mirror the grime2cli command line options:
+ *
+ *   {"id": 1, "op": "find_line", "source": "<image>", "calib_json": "<calib>",
+ *    "timestamp_type": "from_filename"|"from_exif", "timestamp_format": "yyyy-mm-dd-HH-MM",
+ *    "timestamp_start_pos": 0, "csv_file": "<csv>", "result_log": "<log>",
+ *    "result_image": "<overlay>", "line_roi_folder": "<folder>"}
+ *   {"id": 2, "op": "calibrate", "source": "<image>", "calib_json": "<calib>", "result_image": "<overlay>"}
+ *   {"id": 3, "op": "show_metadata", "source": "<image>"}
+ *
+ * Each response is one json object on one line with the id of its request:
+ *
+ *   {"id": 1, "op": "find_line", "status": "SUCCESS"|"FAILURE", "result": {...}}
+ *
+ * Requests are processed concurrently, so responses arrive in completion order rather than
+ * request order.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef REQUESTSERVER_H
+#define REQUESTSERVER_H
+
+#include "gc_types.h"
+#include "boundedqueue.h"
+#include <map>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <functional>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+class VisApp;
+class CsvResultSink;
+class ResultLogWriter;
+
+/**
+ * @brief Function called with the json response line (without the newline) of a request
+ */
+typedef std::function< void( const std::string &response ) > RequestResponder;
+
+/**
+ * @brief Function polled by the socket server, returns true when the server should stop
+ */
+typedef std::function< bool() > StopRequestedFunc;
+
+/**
+ * @brief Data class that holds the thread and queue settings of a RequestServer
+ */
+class RequestServerConfig
+{
+public:
+    /**
+     * @brief Constructor sets all values to automatic (chosen from the hardware thread count)
+     */
+    RequestServerConfig() :
+        workerThreads( 0 ),
+        queueDepth( 0 )
+    {}
+
+    int workerThreads;      ///< Number of request threads, each with its own calibrated VisApp (0=automatic)
+    int queueDepth;         ///< Maximum number of requests waiting for a thread (0=automatic)
+};
+
+/**
+ * @brief Data class that carries one request to a worker thread
+ */
+class ServerRequest
+{
+public:
+    std::string line;               ///< Json request line
+    RequestResponder responder;     ///< Function to be called with the response
+};
+
+/**
+ * @brief Answers json line requests with a pool of worker threads that keep their calibrations
+ *        and templates loaded between requests
+ */
+class RequestServer
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    RequestServer();
+
+    /**
+     * @brief Destructor, finishes the requests already submitted if the server is still running
+     */
+    ~RequestServer();
+
+    RequestServer( const RequestServer & ) = delete;
+    RequestServer &operator=( const RequestServer & ) = delete;
+
+    /**
+     * @brief Start the worker threads
+     * @param config Thread count and queue depth
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Start( const RequestServerConfig config );
+
+    /**
+     * @brief Queue a request. Blocks while the request queue is full.
+     * @param requestLine Json request line
+     * @param responder Function to be called from a worker thread with the response
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Submit( const std::string &requestLine, RequestResponder responder );
+
+    /**
+     * @brief Wait for all submitted requests to be answered, then stop the worker threads
+     *        and close the csv files and result logs written by find_line requests
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Finish();
+
+    /**
+     * @brief Read requests from a stream until end of file and write the responses to another
+     * @param in Stream of json request lines
+     * @param out Stream to receive the json response lines
+     * @param config Thread count and queue depth
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS ServeStream( std::istream &in, std::ostream &out, const RequestServerConfig config );
+
+    /**
+     * @brief Accept connections on a local (UNIX domain) socket and answer the requests of each
+     *        connection on that connection until a stop is requested. Not supported on Windows.
+     * @param socketPath Filesystem path of the socket (an existing socket file is replaced)
+     * @param config Thread count and queue depth
+     * @param stopRequested Function polled a few times a second, returns true to stop the server
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS ServeSocket( const std::string socketPath, const RequestServerConfig config, StopRequestedFunc stopRequested );
+
+    /**
+     * @brief Number of requests answered since Start()
+     */
+    size_t AnsweredCount() const { return m_answeredCount; }
+
+private:
+    bool m_isRunning;
+    std::atomic< size_t > m_answeredCount;
+    std::unique_ptr< BoundedQueue< ServerRequest > > m_requestQueue;
+    std::vector< std::thread > m_workerThreads;
+
+    std::mutex m_sinkMutex;
+    std::map< std::string, std::unique_ptr< CsvResultSink > > m_csvSinks;
+    std::map< std::string, std::unique_ptr< ResultLogWriter > > m_logWriters;
+
+    void WorkerThreadFunc();
+    std::string Process( VisApp &visApp, const std::string &requestLine );
+    std::string FindLine( VisApp &visApp, const FindLineParams &params, bool &isOk );
+    std::string Calibrate( VisApp &visApp, const std::string imgPath, const std::string calibPath,
+                           const std::string resultImgPath, bool &isOk );
+    std::string ShowMetadata( VisApp &visApp, const std::string imgPath, bool &isOk );
+    GC_STATUS WriteSinks( const FindLineParams &params, const FindLineResult &result );
+    void FlushSinks();
+    static std::string EscapeJson( const std::string &str );
+};
+
+} // namespace gc
+
+#endif // REQUESTSERVER_H
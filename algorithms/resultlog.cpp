@@ -0,0 +1,573 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "log.h"
+#include "resultlog.h"
+#include <cstring>
+#include <iomanip>
+#include <algorithm>
+#include <filesystem>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static const char RESULT_LOG_MAGIC[ 8 ] = { 'G', 'C', 'R', 'S', 'L', 'T', '0', '1' };
+static const uint64_t RESULT_LOG_HEADER_SIZE = 16;
+
+static_assert( 80 == sizeof( gc::ResultLogRecord ), "ResultLogRecord must have no padding" );
+static_assert( 24 == sizeof( gc::ResultLogIndexEntry ), "ResultLogIndexEntry must have no padding" );
+
+// days from 1970-01-01 of a proleptic gregorian date and back again (H. Hinnant)
+static int64_t DaysFromCivil( int64_t y, const unsigned m, const unsigned d )
+{
+    y -= m <= 2 ? 1 : 0;
+    const int64_t era = ( y >= 0 ? y : y - 399 ) / 400;
+    const unsigned yoe = static_cast< unsigned >( y - era * 400 );
+    const unsigned doy = ( 153 * ( m > 2 ? m - 3 : m + 9 ) + 2 ) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast< int64_t >( doe ) - 719468;
+}
+static void CivilFromDays( int64_t z, int64_t &y, unsigned &m, unsigned &d )
+{
+    z += 719468;
+    const int64_t era = ( z >= 0 ? z : z - 146096 ) / 146097;
+    const unsigned doe = static_cast< unsigned >( z - era * 146097 );
+    const unsigned yoe = ( doe - doe / 1460 + doe / 36524 - doe / 146096 ) / 365;
+    const unsigned doy = doe - ( 365 * yoe + yoe / 4 - yoe / 100 );
+    const unsigned mp = ( 5 * doy + 2 ) / 153;
+    d = doy - ( 153 * mp + 2 ) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast< int64_t >( yoe ) + era * 400 + ( m <= 2 ? 1 : 0 );
+}
+static bool ReadHeader( std::istream &stream )
+{
+    char magic[ 8 ];
+    uint32_t recordSize = 0, blockSize = 0;
+    stream.read( magic, sizeof( magic ) );
+    stream.read( reinterpret_cast< char * >( &recordSize ), sizeof( recordSize ) );
+    stream.read( reinterpret_cast< char * >( &blockSize ), sizeof( blockSize ) );
+    return stream.good() && 0 == memcmp( magic, RESULT_LOG_MAGIC, sizeof( magic ) ) &&
+           sizeof( gc::ResultLogRecord ) == recordSize && gc::RESULT_LOG_BLOCK_SIZE == blockSize;
+}
+
+namespace gc
+{
+
+ResultLogWriter::ResultLogWriter() :
+    m_dataFile( nullptr ),
+    m_indexFile( nullptr ),
+    m_pathFile( nullptr ),
+    m_recordCount( 0 )
+{
+}
+ResultLogWriter::~ResultLogWriter()
+{
+    if ( nullptr != m_dataFile )
+    {
+        Close();
+    }
+}
+GC_STATUS ResultLogWriter::Open( const std::string logFilepath )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( nullptr != m_dataFile )
+        {
+            Close();
+        }
+        m_filepath = logFilepath;
+        m_recordCount = 0;
+        m_block = ResultLogIndexEntry();
+        m_pathIds.clear();
+
+        if ( !fs::exists( logFilepath ) || RESULT_LOG_HEADER_SIZE > fs::file_size( logFilepath ) )
+        {
+            m_dataFile = fopen( logFilepath.c_str(), "wb" );
+            if ( nullptr != m_dataFile )
+            {
+                uint32_t recordSize = sizeof( ResultLogRecord );
+                uint32_t blockSize = RESULT_LOG_BLOCK_SIZE;
+                fwrite( RESULT_LOG_MAGIC, 1, sizeof( RESULT_LOG_MAGIC ), m_dataFile );
+                fwrite( &recordSize, sizeof( recordSize ), 1, m_dataFile );
+                fwrite( &blockSize, sizeof( blockSize ), 1, m_dataFile );
+                m_indexFile = fopen( ( logFilepath + ".idx" ).c_str(), "wb" );
+                m_pathFile = fopen( ( logFilepath + ".paths" ).c_str(), "wb" );
+            }
+        }
+        else
+        {
+            retVal = Recover();
+            if ( GC_OK == retVal )
+            {
+                m_dataFile = fopen( logFilepath.c_str(), "ab" );
+                m_indexFile = fopen( ( logFilepath + ".idx" ).c_str(), "ab" );
+                m_pathFile = fopen( ( logFilepath + ".paths" ).c_str(), "ab" );
+            }
+        }
+
+        if ( GC_OK == retVal && ( nullptr == m_dataFile || nullptr == m_indexFile || nullptr == m_pathFile ) )
+        {
+            FILE_LOG( logERROR ) << "[ResultLogWriter::Open] Could not open result log " << logFilepath;
+            Close();
+            retVal = GC_ERR;
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[ResultLogWriter::Open] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS ResultLogWriter::Recover()
+{
+    GC_STATUS retVal = GC_OK;
+    ifstream dataFile( m_filepath, ios::binary );
+    if ( !ReadHeader( dataFile ) )
+    {
+        FILE_LOG( logERROR ) << "[ResultLogWriter::Recover] " << m_filepath << " is not a result log of this version";
+        retVal = GC_ERR;
+    }
+    else
+    {
+        // drop a record that was only partly written when a previous run stopped
+        uint64_t fileSize = fs::file_size( m_filepath );
+        m_recordCount = ( fileSize - RESULT_LOG_HEADER_SIZE ) / sizeof( ResultLogRecord );
+        uint64_t goodSize = RESULT_LOG_HEADER_SIZE + m_recordCount * sizeof( ResultLogRecord );
+        if ( goodSize != fileSize )
+        {
+            FILE_LOG( logWARNING ) << "[ResultLogWriter::Recover] Dropping partial record at end of " << m_filepath;
+            dataFile.close();
+            fs::resize_file( m_filepath, goodSize );
+            dataFile.open( m_filepath, ios::binary );
+        }
+
+        string line;
+        uint32_t pathId = 0;
+        ifstream pathFile( m_filepath + ".paths" );
+        while ( getline( pathFile, line ) )
+        {
+            m_pathIds[ line ] = pathId++;
+        }
+
+        ResultLogRecord rec;
+        uint64_t fullBlocks = m_recordCount / RESULT_LOG_BLOCK_SIZE;
+        string indexPath = m_filepath + ".idx";
+        uint64_t indexSize = fs::exists( indexPath ) ? fs::file_size( indexPath ) : 0;
+        if ( indexSize != fullBlocks * sizeof( ResultLogIndexEntry ) )
+        {
+            FILE_LOG( logWARNING ) << "[ResultLogWriter::Recover] Rebuilding time index of " << m_filepath;
+            FILE *indexFile = fopen( indexPath.c_str(), "wb" );
+            if ( nullptr == indexFile )
+            {
+                FILE_LOG( logERROR ) << "[ResultLogWriter::Recover] Could not create " << indexPath;
+                retVal = GC_ERR;
+            }
+            else
+            {
+                dataFile.seekg( RESULT_LOG_HEADER_SIZE );
+                for ( uint64_t b = 0; b < fullBlocks; ++b )
+                {
+                    ResultLogIndexEntry entry;
+                    entry.firstRecord = b * RESULT_LOG_BLOCK_SIZE;
+                    for ( uint32_t i = 0; i < RESULT_LOG_BLOCK_SIZE; ++i )
+                    {
+                        dataFile.read( reinterpret_cast< char * >( &rec ), sizeof( rec ) );
+                        entry.minTimestamp = 0 == i ? rec.timestamp : std::min( entry.minTimestamp, rec.timestamp );
+                        entry.maxTimestamp = 0 == i ? rec.timestamp : std::max( entry.maxTimestamp, rec.timestamp );
+                    }
+                    fwrite( &entry, sizeof( entry ), 1, indexFile );
+                }
+                fclose( indexFile );
+            }
+        }
+
+        // time range of the block that is still being filled
+        m_block.firstRecord = fullBlocks * RESULT_LOG_BLOCK_SIZE;
+        dataFile.seekg( RESULT_LOG_HEADER_SIZE + m_block.firstRecord * sizeof( ResultLogRecord ) );
+        for ( uint64_t i = m_block.firstRecord; i < m_recordCount; ++i )
+        {
+            dataFile.read( reinterpret_cast< char * >( &rec ), sizeof( rec ) );
+            m_block.minTimestamp = m_block.firstRecord == i ? rec.timestamp : std::min( m_block.minTimestamp, rec.timestamp );
+            m_block.maxTimestamp = m_block.firstRecord == i ? rec.timestamp : std::max( m_block.maxTimestamp, rec.timestamp );
+        }
+    }
+    return retVal;
+}
+GC_STATUS ResultLogWriter::Append( const std::string &imgPath, const FindLineResult &result )
+{
+    ResultLogRecord rec;
+    if ( GC_OK != ResultLogReader::TimestampToSeconds( result.timestamp, rec.timestamp ) )
+    {
+        // a zero timestamp would sort first and land in the wrong time range queries
+        FILE_LOG( logERROR ) << "[ResultLogWriter::Append] Skipped " << imgPath << " with invalid timestamp " << result.timestamp;
+        return GC_ERR;
+    }
+    rec.level = result.calcLinePts.ctrWorld.y;
+    rec.levelAdjusted = result.waterLevelAdjusted.y;
+    rec.angle = result.calcLinePts.angleWorld;
+    rec.ctrPixelX = result.calcLinePts.ctrPixel.x;
+    rec.ctrPixelY = result.calcLinePts.ctrPixel.y;
+    rec.reprojectOffsetX = result.calibReprojectOffset_x;
+    rec.reprojectOffsetY = result.calibReprojectOffset_y;
+    rec.reprojectOffsetDist = result.calibReprojectOffset_dist;
+    rec.flags = ( result.findSuccess ? RESULT_LOG_FIND_SUCCESS : 0 ) |
+                ( result.calibSuccess ? RESULT_LOG_CALIB_SUCCESS : 0 );
+    return AppendRecord( imgPath, rec );
+}
+GC_STATUS ResultLogWriter::AppendRecord( const std::string &imgPath, const ResultLogRecord &record )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( nullptr == m_dataFile )
+        {
+            FILE_LOG( logERROR ) << "[ResultLogWriter::AppendRecord] No result log open";
+            retVal = GC_ERR;
+        }
+        else
+        {
+            ResultLogRecord rec = record;
+
+            auto iter = m_pathIds.find( imgPath );
+            if ( m_pathIds.end() != iter )
+            {
+                rec.pathId = iter->second;
+            }
+            else
+            {
+                // buffered with the records, Flush and Close write the paths before the records
+                rec.pathId = static_cast< uint32_t >( m_pathIds.size() );
+                m_pathIds[ imgPath ] = rec.pathId;
+                fprintf( m_pathFile, "%s\n", imgPath.c_str() );
+            }
+
+            if ( 1 != fwrite( &rec, sizeof( rec ), 1, m_dataFile ) )
+            {
+                FILE_LOG( logERROR ) << "[ResultLogWriter::AppendRecord] Could not write to " << m_filepath;
+                retVal = GC_ERR;
+            }
+            else
+            {
+                if ( 0 == m_recordCount % RESULT_LOG_BLOCK_SIZE )
+                {
+                    m_block.firstRecord = m_recordCount;
+                    m_block.minTimestamp = m_block.maxTimestamp = rec.timestamp;
+                }
+                else
+                {
+                    m_block.minTimestamp = std::min( m_block.minTimestamp, rec.timestamp );
+                    m_block.maxTimestamp = std::max( m_block.maxTimestamp, rec.timestamp );
+                }
+                ++m_recordCount;
+                if ( 0 == m_recordCount % RESULT_LOG_BLOCK_SIZE )
+                {
+                    fwrite( &m_block, sizeof( m_block ), 1, m_indexFile );
+                }
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[ResultLogWriter::AppendRecord] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS ResultLogWriter::Flush()
+{
+    GC_STATUS retVal = GC_OK;
+    if ( nullptr != m_dataFile )
+    {
+        // paths first so no record on disk refers to a path that is not yet in the .paths file
+        if ( 0 != fflush( m_pathFile ) || 0 != fflush( m_dataFile ) || 0 != fflush( m_indexFile ) )
+        {
+            FILE_LOG( logERROR ) << "[ResultLogWriter::Flush] Could not write to " << m_filepath;
+            retVal = GC_ERR;
+        }
+    }
+    return retVal;
+}
+GC_STATUS ResultLogWriter::Close()
+{
+    GC_STATUS retVal = GC_OK;
+    FILE **files[] = { &m_pathFile, &m_dataFile, &m_indexFile };
+    for ( FILE **file : files )
+    {
+        if ( nullptr != *file )
+        {
+            if ( 0 != fclose( *file ) )
+            {
+                FILE_LOG( logERROR ) << "[ResultLogWriter::Close] Could not close " << m_filepath;
+                retVal = GC_ERR;
+            }
+            *file = nullptr;
+        }
+    }
+    m_filepath.clear();
+    m_pathIds.clear();
+    return retVal;
+}
+
+ResultLogReader::ResultLogReader() :
+    m_recordCount( 0 ),
+    m_isTimeOrdered( true )
+{
+}
+GC_STATUS ResultLogReader::Open( const std::string logFilepath )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        Close();
+        m_dataFile.open( logFilepath, ios::binary );
+        if ( !m_dataFile.is_open() )
+        {
+            FILE_LOG( logERROR ) << "[ResultLogReader::Open] Could not open " << logFilepath;
+            retVal = GC_ERR;
+        }
+        else if ( !ReadHeader( m_dataFile ) )
+        {
+            FILE_LOG( logERROR ) << "[ResultLogReader::Open] " << logFilepath << " is not a result log of this version";
+            retVal = GC_ERR;
+        }
+        else
+        {
+            m_recordCount = ( fs::file_size( logFilepath ) - RESULT_LOG_HEADER_SIZE ) / sizeof( ResultLogRecord );
+            uint64_t fullBlocks = m_recordCount / RESULT_LOG_BLOCK_SIZE;
+
+            ResultLogIndexEntry entry;
+            ifstream indexFile( logFilepath + ".idx", ios::binary );
+            while ( m_index.size() < fullBlocks && indexFile.read( reinterpret_cast< char * >( &entry ), sizeof( entry ) ) )
+            {
+                m_index.push_back( entry );
+            }
+
+            // a log that is still being written can be a block ahead of its index
+            vector< ResultLogRecord > block;
+            while ( m_index.size() < fullBlocks && GC_OK == retVal )
+            {
+                entry.firstRecord = m_index.size() * RESULT_LOG_BLOCK_SIZE;
+                retVal = ReadRecords( entry.firstRecord, RESULT_LOG_BLOCK_SIZE, block );
+                if ( GC_OK == retVal )
+                {
+                    auto minmax = minmax_element( block.begin(), block.end(),
+                                                  []( const ResultLogRecord &a, const ResultLogRecord &b ) { return a.timestamp < b.timestamp; } );
+                    entry.minTimestamp = minmax.first->timestamp;
+                    entry.maxTimestamp = minmax.second->timestamp;
+                    m_index.push_back( entry );
+                }
+            }
+
+            m_isTimeOrdered = true;
+            for ( size_t i = 1; i < m_index.size(); ++i )
+            {
+                if ( m_index[ i ].minTimestamp < m_index[ i - 1 ].maxTimestamp )
+                {
+                    m_isTimeOrdered = false;
+                    break;
+                }
+            }
+
+            string line;
+            ifstream pathFile( logFilepath + ".paths" );
+            while ( getline( pathFile, line ) )
+            {
+                m_paths.push_back( line );
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[ResultLogReader::Open] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+void ResultLogReader::Close()
+{
+    if ( m_dataFile.is_open() )
+    {
+        m_dataFile.close();
+    }
+    m_recordCount = 0;
+    m_isTimeOrdered = true;
+    m_index.clear();
+    m_paths.clear();
+}
+GC_STATUS ResultLogReader::ReadRecords( const uint64_t first, const uint64_t count, std::vector< ResultLogRecord > &records )
+{
+    GC_STATUS retVal = GC_OK;
+    records.resize( static_cast< size_t >( count ) );
+    if ( 0 < count )
+    {
+        m_dataFile.clear();
+        m_dataFile.seekg( static_cast< streamoff >( RESULT_LOG_HEADER_SIZE + first * sizeof( ResultLogRecord ) ) );
+        m_dataFile.read( reinterpret_cast< char * >( records.data() ), static_cast< streamsize >( count * sizeof( ResultLogRecord ) ) );
+        if ( !m_dataFile.good() )
+        {
+            FILE_LOG( logERROR ) << "[ResultLogReader::ReadRecords] Could not read records " << first << " to " << first + count - 1;
+            records.clear();
+            retVal = GC_ERR;
+        }
+    }
+    return retVal;
+}
+GC_STATUS ResultLogReader::Query( const int64_t startSecs, const int64_t endSecs, std::vector< ResultLogRecord > &records )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        records.clear();
+        if ( !m_dataFile.is_open() )
+        {
+            FILE_LOG( logERROR ) << "[ResultLogReader::Query] No result log open";
+            retVal = GC_ERR;
+        }
+        else
+        {
+            size_t blockIdx = 0;
+            if ( m_isTimeOrdered )
+            {
+                blockIdx = lower_bound( m_index.begin(), m_index.end(), startSecs,
+                                        []( const ResultLogIndexEntry &a, const int64_t t ) { return a.maxTimestamp < t; } ) - m_index.begin();
+            }
+
+            bool isPastEnd = false;
+            vector< ResultLogRecord > block;
+            for ( ; blockIdx < m_index.size() && GC_OK == retVal; ++blockIdx )
+            {
+                const ResultLogIndexEntry &entry = m_index[ blockIdx ];
+                if ( m_isTimeOrdered && entry.minTimestamp > endSecs )
+                {
+                    isPastEnd = true;
+                    break;
+                }
+                if ( entry.maxTimestamp >= startSecs && entry.minTimestamp <= endSecs )
+                {
+                    retVal = ReadRecords( entry.firstRecord, RESULT_LOG_BLOCK_SIZE, block );
+                    for ( size_t i = 0; i < block.size(); ++i )
+                    {
+                        if ( block[ i ].timestamp >= startSecs && block[ i ].timestamp <= endSecs )
+                            records.push_back( block[ i ] );
+                    }
+                }
+            }
+
+            // records after the last full block are not in the index
+            uint64_t tailFirst = static_cast< uint64_t >( m_index.size() ) * RESULT_LOG_BLOCK_SIZE;
+            if ( !isPastEnd && GC_OK == retVal && tailFirst < m_recordCount )
+            {
+                retVal = ReadRecords( tailFirst, m_recordCount - tailFirst, block );
+                for ( size_t i = 0; i < block.size(); ++i )
+                {
+                    if ( block[ i ].timestamp >= startSecs && block[ i ].timestamp <= endSecs )
+                        records.push_back( block[ i ] );
+                }
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[ResultLogReader::Query] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+std::string ResultLogReader::PathFromId( const uint32_t pathId ) const
+{
+    return pathId < m_paths.size() ? m_paths[ pathId ] : string();
+}
+GC_STATUS ResultLogReader::ExportCSV( const std::string csvFilepath, const int64_t startSecs, const int64_t endSecs )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        vector< ResultLogRecord > records;
+        retVal = Query( startSecs, endSecs, records );
+        if ( GC_OK == retVal )
+        {
+            ofstream csvFile( csvFilepath );
+            if ( !csvFile.is_open() )
+            {
+                FILE_LOG( logERROR ) << "[ResultLogReader::ExportCSV] Could not open to write " << csvFilepath;
+                retVal = GC_ERR;
+            }
+            else
+            {
+                csvFile << "imgPath,timestamp,findSuccess,calibSuccess,waterLevel,waterLevelAdjusted,angle,";
+                csvFile << "ctrPixel-x,ctrPixel-y,reprojectOffset-x,reprojectOffset-y,reprojectOffset-dist" << endl;
+                csvFile << fixed << setprecision( 3 );
+                for ( size_t i = 0; i < records.size(); ++i )
+                {
+                    const ResultLogRecord &rec = records[ i ];
+                    csvFile << PathFromId( rec.pathId ) << ",";
+                    csvFile << SecondsToTimestamp( rec.timestamp ) << ",";
+                    csvFile << ( ( rec.flags & RESULT_LOG_FIND_SUCCESS ) ? "true" : "false" ) << ",";
+                    csvFile << ( ( rec.flags & RESULT_LOG_CALIB_SUCCESS ) ? "true" : "false" ) << ",";
+                    csvFile << rec.level << "," << rec.levelAdjusted << "," << rec.angle << ",";
+                    csvFile << rec.ctrPixelX << "," << rec.ctrPixelY << ",";
+                    csvFile << rec.reprojectOffsetX << "," << rec.reprojectOffsetY << "," << rec.reprojectOffsetDist << "\n";
+                }
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[ResultLogReader::ExportCSV] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS ResultLogReader::TimestampToSeconds( const std::string &timestamp, int64_t &secs )
+{
+    GC_STATUS retVal = GC_OK;
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    int cnt = sscanf( timestamp.c_str(), "%d-%d-%d%*c%d:%d:%d", &year, &month, &day, &hour, &minute, &second );
+    if ( 3 > cnt || 1 > month || 12 < month || 1 > day || 31 < day )
+    {
+        FILE_LOG( logERROR ) << "[ResultLogReader::TimestampToSeconds] Invalid timestamp " << timestamp;
+        secs = 0;
+        retVal = GC_ERR;
+    }
+    else
+    {
+        secs = DaysFromCivil( year, static_cast< unsigned >( month ), static_cast< unsigned >( day ) ) * 86400 +
+               hour * 3600 + minute * 60 + second;
+    }
+    return retVal;
+}
+std::string ResultLogReader::SecondsToTimestamp( const int64_t secs )
+{
+    int64_t days = secs / 86400;
+    int64_t rem = secs % 86400;
+    if ( 0 > rem )
+    {
+        rem += 86400;
+        --days;
+    }
+    int64_t year;
+    unsigned month, day;
+    CivilFromDays( days, year, month, day );
+
+    char buf[ 64 ];
+    snprintf( buf, sizeof( buf ), "%04lld-%02u-%02uT%02d:%02d:%02d", static_cast< long long >( year ), month, day,
+              static_cast< int >( rem / 3600 ), static_cast< int >( ( rem % 3600 ) / 60 ), static_cast< int >( rem % 60 ) );
+    return string( buf );
+}
+
+} // namespace gc
@@ -0,0 +1,260 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/** \file resultlog.h
+ * @brief A file for classes that write and query an append-only binary log of find line results
+ *
+ * A result log is three files that share a base path:
+ *   - <path>       16 byte header followed by fixed width ResultLogRecord records
+ *   - <path>.idx   one ResultLogIndexEntry with the time range of each full block of records
+ *   - <path>.paths image paths, one per line, where the line number is the path id of a record
+ *
+ * Values are stored in the native byte order of the machine (little endian on all supported
+ * platforms). Timestamps are seconds from 1970-01-01T00:00:00 with no time zone adjustment.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef RESULTLOG_H
+#define RESULTLOG_H
+
+#include "gc_types.h"
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <unordered_map>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+static const uint32_t RESULT_LOG_FIND_SUCCESS = 0x01;   ///< Record flag: line find succeeded
+static const uint32_t RESULT_LOG_CALIB_SUCCESS = 0x02;  ///< Record flag: calibration succeeded
+static const uint32_t RESULT_LOG_BLOCK_SIZE = 256;      ///< Records covered by one time index entry
+
+/**
+ * @brief Fixed width record for one find line result
+ */
+class ResultLogRecord
+{
+public:
+    ResultLogRecord() :
+        timestamp( 0 ),
+        level( -9999999.0 ),
+        levelAdjusted( -9999999.0 ),
+        angle( -9999999.0 ),
+        ctrPixelX( -9999999.0 ),
+        ctrPixelY( -9999999.0 ),
+        reprojectOffsetX( -9999999.0 ),
+        reprojectOffsetY( -9999999.0 ),
+        reprojectOffsetDist( -9999999.0 ),
+        flags( 0 ),
+        pathId( 0 )
+    {}
+
+    int64_t timestamp;              ///< Image timestamp in seconds from the epoch
+    double level;                   ///< World coordinate water level at the center of the found line
+    double levelAdjusted;           ///< World coordinate water level adjusted for target movement
+    double angle;                   ///< World coordinate angle of the found line
+    double ctrPixelX;               ///< Pixel x position of the center of the found line
+    double ctrPixelY;               ///< Pixel y position of the center of the found line
+    double reprojectOffsetX;        ///< Calibration reprojection offset in x
+    double reprojectOffsetY;        ///< Calibration reprojection offset in y
+    double reprojectOffsetDist;     ///< Calibration reprojection offset distance
+    uint32_t flags;                 ///< RESULT_LOG_FIND_SUCCESS | RESULT_LOG_CALIB_SUCCESS
+    uint32_t pathId;                ///< Line number of the image path in the .paths file
+};
+
+/**
+ * @brief Time range of one block of RESULT_LOG_BLOCK_SIZE records
+ */
+class ResultLogIndexEntry
+{
+public:
+    ResultLogIndexEntry() :
+        minTimestamp( 0 ),
+        maxTimestamp( 0 ),
+        firstRecord( 0 )
+    {}
+
+    int64_t minTimestamp;           ///< Earliest timestamp in the block
+    int64_t maxTimestamp;           ///< Latest timestamp in the block
+    uint64_t firstRecord;           ///< Index of the first record of the block
+};
+
+/**
+ * @brief Appends find line results to a binary result log
+ */
+class ResultLogWriter
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    ResultLogWriter();
+
+    /**
+     * @brief Destructor, closes the log if it is still open
+     */
+    ~ResultLogWriter();
+
+    ResultLogWriter( const ResultLogWriter & ) = delete;
+    ResultLogWriter &operator=( const ResultLogWriter & ) = delete;
+
+    /**
+     * @brief Open a result log for appending, creating it if it does not exist. A partial record
+     *        left by an interrupted write is dropped and a stale index is rebuilt.
+     * @param logFilepath Path of the result log
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Open( const std::string logFilepath );
+
+    /**
+     * @brief Append a find line result to the log. A result with an invalid timestamp is not
+     *        appended because it could not be found by a time range query
+     * @param imgPath Path of the image the result was calculated from
+     * @param result Find line result
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Append( const std::string &imgPath, const FindLineResult &result );
+
+    /**
+     * @brief Append a record read from another result log (the path id of the record is ignored)
+     * @param imgPath Path of the image the record was calculated from
+     * @param record Result record
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS AppendRecord( const std::string &imgPath, const ResultLogRecord &record );
+
+    /**
+     * @brief Write buffered records, index entries, and paths to their files
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Flush();
+
+    /**
+     * @brief Flush and close the log files
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Close();
+
+    /**
+     * @brief true if a result log is open
+     */
+    bool IsOpen() const { return nullptr != m_dataFile; }
+
+    /**
+     * @brief Path of the open result log (empty if none)
+     */
+    const std::string &Filepath() const { return m_filepath; }
+
+private:
+    FILE *m_dataFile;
+    FILE *m_indexFile;
+    FILE *m_pathFile;
+    std::string m_filepath;
+    uint64_t m_recordCount;
+    ResultLogIndexEntry m_block;
+    std::unordered_map< std::string, uint32_t > m_pathIds;
+
+    GC_STATUS Recover();
+};
+
+/**
+ * @brief Reads a binary result log, answers time range queries, and exports to csv
+ */
+class ResultLogReader
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    ResultLogReader();
+
+    /**
+     * @brief Open a result log for reading. Only the index and the path list are read.
+     * @param logFilepath Path of the result log
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Open( const std::string logFilepath );
+
+    /**
+     * @brief Close the log
+     */
+    void Close();
+
+    /**
+     * @brief Number of records in the log
+     */
+    uint64_t RecordCount() const { return m_recordCount; }
+
+    /**
+     * @brief Retrieve the records with timestamps in a closed time range. When the records were
+     *        appended in time order, the first block is found with a binary search of the index.
+     * @param startSecs Earliest timestamp to retrieve
+     * @param endSecs Latest timestamp to retrieve
+     * @param records Vector to hold the records, in log order
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Query( const int64_t startSecs, const int64_t endSecs, std::vector< ResultLogRecord > &records );
+
+    /**
+     * @brief Image path of a record
+     * @param pathId Path id of the record
+     * @return Image path (empty if the id is unknown)
+     */
+    std::string PathFromId( const uint32_t pathId ) const;
+
+    /**
+     * @brief Write the records in a time range to a csv file
+     * @param csvFilepath Path of the csv file to create
+     * @param startSecs Earliest timestamp to export
+     * @param endSecs Latest timestamp to export
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS ExportCSV( const std::string csvFilepath, const int64_t startSecs, const int64_t endSecs );
+
+    /**
+     * @brief Convert a timestamp string in the form yyyy-mm-ddTHH:MM:SS to seconds from the epoch
+     * @param timestamp Timestamp string (a space may be used instead of the T)
+     * @param secs Variable to hold the seconds from the epoch
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    static GC_STATUS TimestampToSeconds( const std::string &timestamp, int64_t &secs );
+
+    /**
+     * @brief Convert seconds from the epoch to a timestamp string in the form yyyy-mm-ddTHH:MM:SS
+     * @param secs Seconds from the epoch
+     * @return Timestamp string
+     */
+    static std::string SecondsToTimestamp( const int64_t secs );
+
+private:
+    std::ifstream m_dataFile;
+    uint64_t m_recordCount;
+    bool m_isTimeOrdered;
+    std::vector< ResultLogIndexEntry > m_index;
+    std::vector< std::string > m_paths;
+
+    GC_STATUS ReadRecords( const uint64_t first, const uint64_t count, std::vector< ResultLogRecord > &records );
+};
+
+} // namespace gc
+
+#endif // RESULTLOG_H
@@ -0,0 +1,251 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#include "log.h"
+#include "resultmerge.h"
+#include "resultlog.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <fstream>
+#include <filesystem>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static vector< string > SplitCSV( const string &line )
+{
+    vector< string > fields;
+    size_t start = 0;
+    while ( true )
+    {
+        size_t comma = line.find( ',', start );
+        fields.push_back( line.substr( start, string::npos == comma ? string::npos : comma - start ) );
+        if ( string::npos == comma )
+            break;
+        start = comma + 1;
+    }
+    return fields;
+}
+static string Trim( const string &str )
+{
+    size_t first = str.find_first_not_of( " \t\r" );
+    size_t last = str.find_last_not_of( " \t\r" );
+    return string::npos == first ? string() : str.substr( first, last - first + 1 );
+}
+
+namespace gc
+{
+
+class MergeRow
+{
+public:
+    int64_t timestamp;
+    string path;
+    string line;
+};
+class MergeRecord
+{
+public:
+    string path;
+    ResultLogRecord record;
+};
+
+GC_STATUS ResultMerger::MergeCSV( const std::vector< std::string > &inputs, const std::string outputFilepath, ResultMergeStats &stats )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        stats = ResultMergeStats();
+        if ( fs::exists( outputFilepath ) )
+        {
+            FILE_LOG( logERROR ) << "[ResultMerger::MergeCSV] Output already exists: " << outputFilepath;
+            return GC_ERR;
+        }
+
+        string header;
+        size_t pathCol = 0, timeCol = 0;
+        vector< MergeRow > rows;
+        for ( size_t i = 0; i < inputs.size() && GC_OK == retVal; ++i )
+        {
+            ifstream inFile( inputs[ i ] );
+            string line;
+            if ( !inFile.is_open() || !getline( inFile, line ) )
+            {
+                FILE_LOG( logERROR ) << "[ResultMerger::MergeCSV] Could not read " << inputs[ i ];
+                retVal = GC_ERR;
+                break;
+            }
+            line = Trim( line );
+            if ( header.empty() )
+            {
+                header = line;
+                vector< string > cols = SplitCSV( header );
+                auto pathIter = find( cols.begin(), cols.end(), "imgPath" );
+                auto timeIter = find( cols.begin(), cols.end(), "timestamp" );
+                if ( cols.end() == pathIter || cols.end() == timeIter )
+                {
+                    FILE_LOG( logERROR ) << "[ResultMerger::MergeCSV] No imgPath and timestamp columns in " << inputs[ i ];
+                    retVal = GC_ERR;
+                    break;
+                }
+                pathCol = static_cast< size_t >( pathIter - cols.begin() );
+                timeCol = static_cast< size_t >( timeIter - cols.begin() );
+            }
+            else if ( line != header )
+            {
+                FILE_LOG( logERROR ) << "[ResultMerger::MergeCSV] Column header of " << inputs[ i ] << " differs from " << inputs[ 0 ];
+                retVal = GC_ERR;
+                break;
+            }
+
+            while ( getline( inFile, line ) )
+            {
+                line = Trim( line );
+                if ( line.empty() )
+                    continue;
+                ++stats.inputRows;
+                vector< string > fields = SplitCSV( line );
+                MergeRow row;
+                row.timestamp = 0;
+                if ( fields.size() > std::max( pathCol, timeCol ) )
+                {
+                    row.path = fields[ pathCol ];
+                    ResultLogReader::TimestampToSeconds( fields[ timeCol ], row.timestamp );
+                }
+                row.line = line;
+                rows.push_back( row );
+            }
+        }
+
+        if ( GC_OK == retVal )
+        {
+            // stable, so of two rows for the same image the one from the earlier input is kept
+            stable_sort( rows.begin(), rows.end(), []( const MergeRow &a, const MergeRow &b )
+                         { return a.timestamp < b.timestamp || ( a.timestamp == b.timestamp && a.path < b.path ); } );
+
+            ofstream outFile( outputFilepath );
+            if ( !outFile.is_open() )
+            {
+                FILE_LOG( logERROR ) << "[ResultMerger::MergeCSV] Could not open to write " << outputFilepath;
+                retVal = GC_ERR;
+            }
+            else
+            {
+                outFile << header << "\n";
+                size_t kept = 0;
+                for ( size_t i = 0; i < rows.size(); ++i )
+                {
+                    if ( 0 < i && rows[ kept ].timestamp == rows[ i ].timestamp && rows[ kept ].path == rows[ i ].path )
+                    {
+                        if ( rows[ kept ].line == rows[ i ].line )
+                            ++stats.duplicateRows;
+                        else
+                            ++stats.conflictRows;
+                        continue;
+                    }
+                    kept = i;
+                    outFile << rows[ i ].line << "\n";
+                    ++stats.outputRows;
+                }
+                outFile.close();
+                if ( !outFile )
+                {
+                    FILE_LOG( logERROR ) << "[ResultMerger::MergeCSV] Could not write " << outputFilepath;
+                    retVal = GC_ERR;
+                }
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[ResultMerger::MergeCSV] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS ResultMerger::MergeLogs( const std::vector< std::string > &inputs, const std::string outputFilepath, ResultMergeStats &stats )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        stats = ResultMergeStats();
+        if ( fs::exists( outputFilepath ) )
+        {
+            FILE_LOG( logERROR ) << "[ResultMerger::MergeLogs] Output already exists: " << outputFilepath;
+            return GC_ERR;
+        }
+
+        vector< MergeRecord > rows;
+        for ( size_t i = 0; i < inputs.size() && GC_OK == retVal; ++i )
+        {
+            ResultLogReader reader;
+            retVal = reader.Open( inputs[ i ] );
+            if ( GC_OK == retVal )
+            {
+                vector< ResultLogRecord > records;
+                retVal = reader.Query( numeric_limits< int64_t >::min(), numeric_limits< int64_t >::max(), records );
+                for ( size_t j = 0; j < records.size(); ++j )
+                {
+                    MergeRecord row;
+                    row.path = reader.PathFromId( records[ j ].pathId );
+                    row.record = records[ j ];
+                    rows.push_back( row );
+                }
+                stats.inputRows += records.size();
+                reader.Close();
+            }
+        }
+
+        if ( GC_OK == retVal )
+        {
+            stable_sort( rows.begin(), rows.end(), []( const MergeRecord &a, const MergeRecord &b )
+                         { return a.record.timestamp < b.record.timestamp ||
+                                  ( a.record.timestamp == b.record.timestamp && a.path < b.path ); } );
+
+            ResultLogWriter writer;
+            retVal = writer.Open( outputFilepath );
+            size_t kept = 0;
+            for ( size_t i = 0; i < rows.size() && GC_OK == retVal; ++i )
+            {
+                if ( 0 < i && rows[ kept ].record.timestamp == rows[ i ].record.timestamp && rows[ kept ].path == rows[ i ].path )
+                {
+                    // path ids differ between inputs, so compare everything before the path id
+                    if ( 0 == memcmp( &rows[ kept ].record, &rows[ i ].record, offsetof( ResultLogRecord, pathId ) ) )
+                        ++stats.duplicateRows;
+                    else
+                        ++stats.conflictRows;
+                    continue;
+                }
+                kept = i;
+                retVal = writer.AppendRecord( rows[ i ].path, rows[ i ].record );
+                ++stats.outputRows;
+            }
+            GC_STATUS retClose = writer.Close();
+            retVal = GC_OK == retVal ? retClose : retVal;
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[ResultMerger::MergeLogs] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+
+} // namespace gc
@@ -0,0 +1,90 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/** \file resultmerge.h
+ * @brief A file for a class that merges the result csv files or binary result logs of the shards
+ *        of a run into one timestamp ordered output
+ *
+ * Rows are ordered by timestamp, then image path. A row with the same image path and timestamp as
+ * an earlier row is a duplicate (e.g. an image run by two shards) and is dropped. Duplicates whose
+ * values differ from the kept row are counted separately as conflicts and reported.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef RESULTMERGE_H
+#define RESULTMERGE_H
+
+#include "gc_types.h"
+#include <string>
+#include <vector>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief Data class that holds the row counts of a merge
+ */
+class ResultMergeStats
+{
+public:
+    ResultMergeStats() :
+        inputRows( 0 ),
+        outputRows( 0 ),
+        duplicateRows( 0 ),
+        conflictRows( 0 )
+    {}
+
+    size_t inputRows;       ///< Rows read from all inputs
+    size_t outputRows;      ///< Rows written to the output
+    size_t duplicateRows;   ///< Rows dropped because an identical row was already kept
+    size_t conflictRows;    ///< Rows dropped with the same image and timestamp but different values
+};
+
+/**
+ * @brief Merges per shard result files
+ */
+class ResultMerger
+{
+public:
+    /**
+     * @brief Merge result csv files written by --csv_file or --export_log. All inputs must have the
+     *        same column header, which must contain imgPath and timestamp columns
+     * @param inputs Paths of the csv files to merge
+     * @param outputFilepath Path of the merged csv file to create (must not exist)
+     * @param stats Row counts of the merge
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    static GC_STATUS MergeCSV( const std::vector< std::string > &inputs, const std::string outputFilepath, ResultMergeStats &stats );
+
+    /**
+     * @brief Merge binary result logs
+     * @param inputs Paths of the result logs to merge
+     * @param outputFilepath Path of the merged result log to create (must not exist)
+     * @param stats Row counts of the merge
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    static GC_STATUS MergeLogs( const std::vector< std::string > &inputs, const std::string outputFilepath, ResultMergeStats &stats );
+};
+
+} // namespace gc
+
+#endif // RESULTMERGE_H
@@ -0,0 +1,247 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "log.h"
+#include "resultsink.h"
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace gc
+{
+
+CsvResultSink::CsvResultSink() :
+    m_file( nullptr ),
+    m_bufferedRows( 0 )
+{
+}
+CsvResultSink::~CsvResultSink()
+{
+    if ( nullptr != m_file )
+    {
+        Close();
+    }
+}
+GC_STATUS CsvResultSink::Open( const std::string csvFilepath, const bool overwrite, const CsvResultSinkConfig config )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( nullptr != m_file )
+        {
+            retVal = Close();
+        }
+
+        lock_guard< mutex > lock( m_mutex );
+        error_code ec;
+        bool addHeader = overwrite || !fs::exists( csvFilepath ) || 0 == fs::file_size( csvFilepath, ec );
+        m_file = fopen( csvFilepath.c_str(), overwrite ? "w" : "a" );
+        if ( nullptr == m_file )
+        {
+            FILE_LOG( logERROR ) << "[CsvResultSink::Open] Could not open to write " << csvFilepath;
+            retVal = GC_ERR;
+        }
+        else
+        {
+            m_filepath = csvFilepath;
+            m_config = config;
+            m_buffer.clear();
+            m_buffer.reserve( m_config.bufferBytes + 4096 );
+            m_bufferedRows = 0;
+            m_lastFlush = chrono::steady_clock::now();
+            if ( addHeader )
+            {
+                FormatHeader( m_buffer );
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[CsvResultSink::Open] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS CsvResultSink::Write( const std::string &imgPath, const FindLineResult &result )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        lock_guard< mutex > lock( m_mutex );
+        if ( nullptr == m_file )
+        {
+            FILE_LOG( logERROR ) << "[CsvResultSink::Write] No csv file open";
+            retVal = GC_ERR;
+        }
+        else
+        {
+            FormatRow( imgPath, result, m_buffer );
+            ++m_bufferedRows;
+
+            if ( m_config.bufferBytes <= m_buffer.size() ||
+                 ( 0 < m_config.flushRowCount && m_config.flushRowCount <= m_bufferedRows ) ||
+                 ( 0.0 < m_config.flushSeconds &&
+                   m_config.flushSeconds <= chrono::duration< double >( chrono::steady_clock::now() - m_lastFlush ).count() ) )
+            {
+                retVal = FlushBuffer();
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[CsvResultSink::Write] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS CsvResultSink::Flush()
+{
+    lock_guard< mutex > lock( m_mutex );
+    GC_STATUS retVal = FlushBuffer();
+    return retVal;
+}
+GC_STATUS CsvResultSink::FlushBuffer()
+{
+    GC_STATUS retVal = GC_OK;
+    if ( nullptr != m_file && !m_buffer.empty() )
+    {
+        size_t written = fwrite( m_buffer.data(), 1, m_buffer.size(), m_file );
+        if ( written != m_buffer.size() || 0 != fflush( m_file ) )
+        {
+            FILE_LOG( logERROR ) << "[CsvResultSink::FlushBuffer] Could not write to " << m_filepath;
+            retVal = GC_ERR;
+        }
+    }
+    m_buffer.clear();
+    m_bufferedRows = 0;
+    m_lastFlush = chrono::steady_clock::now();
+    return retVal;
+}
+GC_STATUS CsvResultSink::Close()
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        lock_guard< mutex > lock( m_mutex );
+        if ( nullptr != m_file )
+        {
+            retVal = FlushBuffer();
+
+            // make sure the rows of a finished run survive a power loss or crash
+#ifdef _WIN32
+            int syncRet = _commit( _fileno( m_file ) );
+#else
+            int syncRet = fsync( fileno( m_file ) );
+#endif
+            if ( 0 != syncRet )
+            {
+                FILE_LOG( logWARNING ) << "[CsvResultSink::Close] Could not sync " << m_filepath << " to disk";
+            }
+            if ( 0 != fclose( m_file ) )
+            {
+                FILE_LOG( logERROR ) << "[CsvResultSink::Close] Could not close " << m_filepath;
+                retVal = GC_ERR;
+            }
+            m_file = nullptr;
+            m_filepath.clear();
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[CsvResultSink::Close] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+void CsvResultSink::FormatHeader( std::string &line )
+{
+    line += "imgPath,";
+    line += "findSuccess,";
+
+    line += "timestamp,";
+    line += "illum_state,";
+    line += "waterLevel,";
+    line += "waterLevelAdjusted,";
+    line += "xRMSE, yRMSE, EuclidDistRMSE,";
+
+    line += "waterLine-octagon-angle-diff,";
+    line += "calcLinePts-angle,";
+    line += "calcLinePts-lftPixel-x,"; line += "calcLinePts-lftPixel-y,";
+    line += "calcLinePts-ctrPixel-x,"; line += "calcLinePts-ctrPixel-y,";
+    line += "calcLinePts-rgtPixel-x,"; line += "calcLinePts-rgtPixel-y,";
+    line += "calcLinePts-lftWorld-x,"; line += "calcLinePts-lftWorld-y,";
+    line += "calcLinePts-ctrWorld-x,"; line += "calcLinePts-ctrWorld-y,";
+    line += "calcLinePts-rgtWorld-x,"; line += "calcLinePts-rgtWorld-y,";
+
+    line += "octoCenter-x,"; line += "octoCenter-y,";
+    line += "octoToSearchROIOffset-pixel,"; line += "octoToSearchROIOffset-world,";
+
+    line += "foundPts[0]-x,"; line += "foundPts[0]-y,"; line += "foundPts[1]-x,"; line += "foundPts[1]-y,";
+    line += "foundPts[2]-x,"; line += "foundPts[2]-y,"; line += "foundPts[3]-x,"; line += "foundPts[3]-y,";
+    line += "foundPts[4]-x,"; line += "foundPts[4]-y,"; line += "foundPts[5]-x,"; line += "foundPts[5]-y,";
+    line += "foundPts[6]-x,"; line += "foundPts[6]-y,"; line += "foundPts[7]-x,"; line += "foundPts[7]-y,";
+    line += "foundPts[8]-x,"; line += "foundPts[8]-y,"; line += "foundPts[9]-x,"; line += "foundPts[9]-y,";
+    line += "...";
+    line += "\n";
+}
+void CsvResultSink::FormatRow( const std::string &imgPath, const FindLineResult &result, std::string &line )
+{
+    ostringstream csvRow;
+    csvRow << imgPath << ",";
+    csvRow << ( result.findSuccess ? "true" : "false" ) << ",";
+    csvRow << result.timestamp << ",";
+    csvRow << result.illum_state << ",";
+
+    csvRow << fixed << setprecision( 3 );
+    csvRow << result.calcLinePts.ctrWorld.y << ",";
+    csvRow << result.waterLevelAdjusted.y << ",";
+
+    csvRow << result.calibReprojectOffset_x << ",";
+    csvRow << result.calibReprojectOffset_y << ",";
+    csvRow << result.calibReprojectOffset_dist << ",";
+
+    csvRow << result.symbolToWaterLineAngle << ",";
+
+    csvRow << result.calcLinePts.angleWorld << ",";
+    csvRow << result.calcLinePts.lftPixel.x << ","; csvRow << result.calcLinePts.lftPixel.y << ",";
+    csvRow << result.calcLinePts.ctrPixel.x << ","; csvRow << result.calcLinePts.ctrPixel.y << ",";
+    csvRow << result.calcLinePts.rgtPixel.x << ","; csvRow << result.calcLinePts.rgtPixel.y << ",";
+    csvRow << result.calcLinePts.lftWorld.x << ","; csvRow << result.calcLinePts.lftWorld.y << ",";
+    csvRow << result.calcLinePts.ctrWorld.x << ","; csvRow << result.calcLinePts.ctrWorld.y << ",";
+    csvRow << result.calcLinePts.rgtWorld.x << ","; csvRow << result.calcLinePts.rgtWorld.y << ",";
+
+    csvRow << result.octoCenter.x << ","; csvRow << result.octoCenter.y << ",";
+    csvRow << result.octoToSearchROIOffsetPixel << ","; csvRow << result.octoToSearchROIOffsetWorld << ",";
+
+    for ( size_t i = 0; i < result.foundPoints.size(); ++i )
+    {
+        csvRow << result.foundPoints[ i ].x << ","; csvRow << result.foundPoints[ i ].y;
+        if ( result.foundPoints.size() - 1 > i )
+            csvRow << ",";
+    }
+    csvRow << "\n";
+    line += csvRow.str();
+}
+
+} // namespace gc
@@ -0,0 +1,148 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/** \file resultsink.h
+ * @brief A file for a class that appends find line results to a csv file through a single
+ *        long-lived file handle and an in-memory write buffer
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef RESULTSINK_H
+#define RESULTSINK_H
+
+#include "gc_types.h"
+#include <cstdio>
+#include <mutex>
+#include <chrono>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief Data class that holds the buffering and flush policy of a CsvResultSink
+ */
+class CsvResultSinkConfig
+{
+public:
+    /**
+     * @brief Constructor sets the default buffer size and flush policy
+     */
+    CsvResultSinkConfig() :
+        bufferBytes( 1 << 20 ),
+        flushRowCount( 1000 ),
+        flushSeconds( 10.0 )
+    {}
+
+    size_t bufferBytes;         ///< Buffered bytes that force a write to the file
+    size_t flushRowCount;       ///< Buffered rows that force a write to the file (0=no row limit)
+    double flushSeconds;        ///< Seconds since the last write to the file that force a write (0=no time limit)
+};
+
+/**
+ * @brief Writes find line result rows to a csv file that stays open for the life of a run.
+ *        Rows are buffered in memory and written to the file by count, size, or age. Close()
+ *        writes the remaining rows and syncs the file to disk.
+ */
+class CsvResultSink
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    CsvResultSink();
+
+    /**
+     * @brief Destructor, closes the file if it is still open
+     */
+    ~CsvResultSink();
+
+    CsvResultSink( const CsvResultSink & ) = delete;
+    CsvResultSink &operator=( const CsvResultSink & ) = delete;
+
+    /**
+     * @brief Open a csv file for writing, writing the column header if the file is new or empty
+     * @param csvFilepath Path of the csv file
+     * @param overwrite true=Truncate an existing file, false=Append to an existing file
+     * @param config Buffer size and flush policy
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Open( const std::string csvFilepath, const bool overwrite = false,
+                    const CsvResultSinkConfig config = CsvResultSinkConfig() );
+
+    /**
+     * @brief Add a result row to the buffer, writing the buffer to the file if the flush policy says so
+     * @param imgPath Path of the image the result was calculated from
+     * @param result Find line result
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Write( const std::string &imgPath, const FindLineResult &result );
+
+    /**
+     * @brief Write the buffered rows to the file
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Flush();
+
+    /**
+     * @brief Write the buffered rows, sync the file to disk, and close it
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Close();
+
+    /**
+     * @brief true if a csv file is open
+     */
+    bool IsOpen() const { return nullptr != m_file; }
+
+    /**
+     * @brief Path of the open csv file (empty if none)
+     */
+    const std::string &Filepath() const { return m_filepath; }
+
+    /**
+     * @brief Append the csv column header line to a string
+     * @param line String to which the header is appended
+     */
+    static void FormatHeader( std::string &line );
+
+    /**
+     * @brief Append a csv row for a find line result to a string
+     * @param imgPath Path of the image the result was calculated from
+     * @param result Find line result
+     * @param line String to which the row is appended
+     */
+    static void FormatRow( const std::string &imgPath, const FindLineResult &result, std::string &line );
+
+private:
+    FILE *m_file;
+    std::string m_filepath;
+    std::string m_buffer;
+    size_t m_bufferedRows;
+    CsvResultSinkConfig m_config;
+    std::chrono::steady_clock::time_point m_lastFlush;
+    std::mutex m_mutex;
+
+    GC_STATUS FlushBuffer();
+};
+
+} // namespace gc
+
+#endif // RESULTSINK_H
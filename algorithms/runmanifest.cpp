@@ -0,0 +1,273 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "log.h"
+#include "runmanifest.h"
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static const char MANIFEST_HEADER[] = "# grime2 run manifest v1: calib_hash\tsize\tmtime\tpath\n";
+
+namespace gc
+{
+
+RunManifest::RunManifest() :
+    m_file( nullptr ),
+    m_pendingCount( 0 )
+{
+}
+RunManifest::~RunManifest()
+{
+    if ( nullptr != m_file )
+    {
+        Close();
+    }
+}
+GC_STATUS RunManifest::Open( const std::string manifestFilepath )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( nullptr != m_file )
+        {
+            retVal = Close();
+        }
+
+        lock_guard< mutex > lock( m_mutex );
+        m_completed.clear();
+        m_buffer.clear();
+        m_pendingCount = 0;
+
+        error_code ec;
+        bool isNew = !fs::exists( manifestFilepath ) || 0 == fs::file_size( manifestFilepath, ec );
+        if ( !isNew )
+        {
+            ifstream inFile( manifestFilepath, ios::binary );
+            string contents( ( istreambuf_iterator< char >( inFile ) ), istreambuf_iterator< char >() );
+            inFile.close();
+
+            // a line without its newline was cut short by a crash, so it does not count
+            size_t validSize = contents.rfind( '\n' );
+            validSize = string::npos == validSize ? 0 : validSize + 1;
+            if ( validSize < contents.size() )
+            {
+                FILE_LOG( logWARNING ) << "[RunManifest::Open] Dropping partial last line of " << manifestFilepath;
+                fs::resize_file( manifestFilepath, validSize );
+                isNew = 0 == validSize;
+            }
+
+            size_t start = 0;
+            while ( start < validSize )
+            {
+                size_t end = contents.find( '\n', start );
+                if ( '#' != contents[ start ] && end > start )
+                {
+                    m_completed.insert( contents.substr( start, end - start ) );
+                }
+                start = end + 1;
+            }
+        }
+
+        m_file = fopen( manifestFilepath.c_str(), "ab" );
+        if ( nullptr == m_file )
+        {
+            FILE_LOG( logERROR ) << "[RunManifest::Open] Could not open to write " << manifestFilepath;
+            retVal = GC_ERR;
+        }
+        else
+        {
+            m_filepath = manifestFilepath;
+            if ( isNew )
+            {
+                m_buffer = MANIFEST_HEADER;
+                retVal = FlushBuffer();
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[RunManifest::Open] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+bool RunManifest::IsComplete( const std::string &key )
+{
+    lock_guard< mutex > lock( m_mutex );
+    return m_completed.end() != m_completed.find( key );
+}
+GC_STATUS RunManifest::Record( const std::string &key )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        lock_guard< mutex > lock( m_mutex );
+        if ( nullptr == m_file )
+        {
+            FILE_LOG( logERROR ) << "[RunManifest::Record] No manifest open";
+            retVal = GC_ERR;
+        }
+        else if ( m_completed.insert( key ).second )
+        {
+            m_buffer += key;
+            m_buffer += '\n';
+            ++m_pendingCount;
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[RunManifest::Record] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+size_t RunManifest::PendingCount()
+{
+    lock_guard< mutex > lock( m_mutex );
+    return m_pendingCount;
+}
+GC_STATUS RunManifest::Flush()
+{
+    lock_guard< mutex > lock( m_mutex );
+    GC_STATUS retVal = FlushBuffer();
+    return retVal;
+}
+GC_STATUS RunManifest::FlushBuffer()
+{
+    GC_STATUS retVal = GC_OK;
+    if ( nullptr != m_file && !m_buffer.empty() )
+    {
+        size_t written = fwrite( m_buffer.data(), 1, m_buffer.size(), m_file );
+        if ( written != m_buffer.size() || 0 != fflush( m_file ) )
+        {
+            FILE_LOG( logERROR ) << "[RunManifest::FlushBuffer] Could not write to " << m_filepath;
+            retVal = GC_ERR;
+        }
+    }
+    m_buffer.clear();
+    m_pendingCount = 0;
+    return retVal;
+}
+GC_STATUS RunManifest::Close()
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        lock_guard< mutex > lock( m_mutex );
+        if ( nullptr != m_file )
+        {
+            retVal = FlushBuffer();
+#ifdef _WIN32
+            int syncRet = _commit( _fileno( m_file ) );
+#else
+            int syncRet = fsync( fileno( m_file ) );
+#endif
+            if ( 0 != syncRet )
+            {
+                FILE_LOG( logWARNING ) << "[RunManifest::Close] Could not sync " << m_filepath << " to disk";
+            }
+            if ( 0 != fclose( m_file ) )
+            {
+                FILE_LOG( logERROR ) << "[RunManifest::Close] Could not close " << m_filepath;
+                retVal = GC_ERR;
+            }
+            m_file = nullptr;
+            m_filepath.clear();
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[RunManifest::Close] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS RunManifest::MakeKey( const std::string &imgPath, const std::string &calibHash, std::string &key )
+{
+    GC_STATUS retVal = GC_OK;
+    error_code ec;
+    uintmax_t size = fs::file_size( imgPath, ec );
+    if ( ec )
+    {
+        FILE_LOG( logERROR ) << "[RunManifest::MakeKey] Could not get size of " << imgPath;
+        retVal = GC_ERR;
+    }
+    else
+    {
+        fs::file_time_type mtime = fs::last_write_time( imgPath, ec );
+        if ( ec )
+        {
+            FILE_LOG( logERROR ) << "[RunManifest::MakeKey] Could not get modification time of " << imgPath;
+            retVal = GC_ERR;
+        }
+        else
+        {
+            key = calibHash + '\t' + to_string( size ) + '\t' +
+                  to_string( static_cast< long long >( mtime.time_since_epoch().count() ) ) + '\t' + imgPath;
+        }
+    }
+    return retVal;
+}
+GC_STATUS RunManifest::HashFile( const std::string &filepath, std::string &hash )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        ifstream inFile( filepath, ios::binary );
+        if ( !inFile.is_open() )
+        {
+            FILE_LOG( logERROR ) << "[RunManifest::HashFile] Could not open " << filepath;
+            retVal = GC_ERR;
+        }
+        else
+        {
+            uint64_t fnv = 0xcbf29ce484222325ULL;
+            vector< char > buffer( 64 * 1024 );
+            while ( inFile )
+            {
+                inFile.read( buffer.data(), static_cast< streamsize >( buffer.size() ) );
+                streamsize count = inFile.gcount();
+                for ( streamsize i = 0; i < count; ++i )
+                {
+                    fnv ^= static_cast< unsigned char >( buffer[ static_cast< size_t >( i ) ] );
+                    fnv *= 0x100000001b3ULL;
+                }
+            }
+            stringstream ss;
+            ss << hex << setw( 16 ) << setfill( '0' ) << fnv;
+            hash = ss.str();
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[RunManifest::HashFile] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+
+} // namespace gc
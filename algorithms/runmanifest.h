@@ -0,0 +1,139 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/** \file runmanifest.h
+ * @brief A file for a class that records which images of a folder run have been completed
+ *
+ * The manifest is a text file with one line per completed image:
+ *
+ *   <calibration hash>\t<file size>\t<file modification time>\t<image path>\n
+ *
+ * An image is skipped on a rerun only if all four match, so new images, images that have been
+ * replaced, and images processed with a different calibration file are run again. Lines are
+ * only appended, and a line cut short by a crash is dropped the next time the manifest is opened.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef RUNMANIFEST_H
+#define RUNMANIFEST_H
+
+#include "gc_types.h"
+#include <mutex>
+#include <string>
+#include <cstdio>
+#include <unordered_set>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief Append-only record of the images completed by folder runs
+ */
+class RunManifest
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    RunManifest();
+
+    /**
+     * @brief Destructor, closes the manifest if it is still open
+     */
+    ~RunManifest();
+
+    RunManifest( const RunManifest & ) = delete;
+    RunManifest &operator=( const RunManifest & ) = delete;
+
+    /**
+     * @brief Open a manifest, creating it if it does not exist, and read the completed images
+     * @param manifestFilepath Path of the manifest file
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Open( const std::string manifestFilepath );
+
+    /**
+     * @brief true if an image with this key has already been completed
+     * @param key Key created with MakeKey()
+     */
+    bool IsComplete( const std::string &key );
+
+    /**
+     * @brief Record an image as completed. The record is buffered until Flush() so that it can be
+     *        written after the results of the image are on disk.
+     * @param key Key created with MakeKey()
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Record( const std::string &key );
+
+    /**
+     * @brief Number of records waiting for Flush()
+     */
+    size_t PendingCount();
+
+    /**
+     * @brief Append the buffered records to the manifest file
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Flush();
+
+    /**
+     * @brief Flush and close the manifest file
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Close();
+
+    /**
+     * @brief true if a manifest is open
+     */
+    bool IsOpen() const { return nullptr != m_file; }
+
+    /**
+     * @brief Create the manifest key of an image from its path, size, and modification time
+     * @param imgPath Path of the image
+     * @param calibHash Hash of the calibration file used for the image (see HashFile())
+     * @param key String to hold the key
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    static GC_STATUS MakeKey( const std::string &imgPath, const std::string &calibHash, std::string &key );
+
+    /**
+     * @brief Calculate a 64-bit FNV-1a hash of the contents of a file
+     * @param filepath Path of the file
+     * @param hash String to hold the hash as 16 hex digits
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    static GC_STATUS HashFile( const std::string &filepath, std::string &hash );
+
+private:
+    FILE *m_file;
+    std::string m_filepath;
+    std::string m_buffer;
+    size_t m_pendingCount;
+    std::unordered_set< std::string > m_completed;
+    std::mutex m_mutex;
+
+    GC_STATUS FlushBuffer();
+};
+
+} // namespace gc
+
+#endif // RUNMANIFEST_H
@@ -0,0 +1,82 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#include "log.h"
+#include "shardspec.h"
+#include <algorithm>
+#include <filesystem>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace gc
+{
+
+GC_STATUS ShardSpec::Parse( const std::string spec, ShardSpec &shard )
+{
+    GC_STATUS retVal = GC_OK;
+    int idx = -1, cnt = 0;
+    char extra = '\0';
+    if ( 2 != sscanf( spec.c_str(), "%d/%d%c", &idx, &cnt, &extra ) || 0 > idx || idx >= cnt )
+    {
+        FILE_LOG( logERROR ) << "[ShardSpec::Parse] Invalid shard " << spec << ", expected i/N with 0 <= i < N";
+        retVal = GC_ERR;
+    }
+    else
+    {
+        shard.index = idx;
+        shard.count = cnt;
+    }
+    return retVal;
+}
+std::string ShardSpec::ShardKey( const std::string &imgPath, const std::string &sourceFolder )
+{
+    fs::path rel = fs::path( imgPath ).lexically_relative( sourceFolder );
+    if ( rel.empty() || "." == rel.string() || 0 == rel.generic_string().compare( 0, 2, ".." ) )
+    {
+        return fs::path( imgPath ).generic_string();
+    }
+    return rel.generic_string();
+}
+bool ShardSpec::OwnsHash( const std::string &key ) const
+{
+    if ( !IsSharded() )
+        return true;
+
+    // FNV-1a, written out so that every build and platform agrees on the shard of a path
+    uint64_t fnv = 0xcbf29ce484222325ULL;
+    for ( size_t i = 0; i < key.size(); ++i )
+    {
+        fnv ^= static_cast< unsigned char >( key[ i ] );
+        fnv *= 0x100000001b3ULL;
+    }
+    return static_cast< uint64_t >( index ) == fnv % static_cast< uint64_t >( count );
+}
+void ShardSpec::SelectTimeRange( std::vector< ShardItem > &items ) const
+{
+    sort( items.begin(), items.end(), []( const ShardItem &a, const ShardItem &b )
+          { return a.timestamp < b.timestamp || ( a.timestamp == b.timestamp && a.key < b.key ); } );
+    if ( IsSharded() )
+    {
+        size_t first = items.size() * static_cast< size_t >( index ) / static_cast< size_t >( count );
+        size_t last = items.size() * static_cast< size_t >( index + 1 ) / static_cast< size_t >( count );
+        items.erase( items.begin() + static_cast< ptrdiff_t >( last ), items.end() );
+        items.erase( items.begin(), items.begin() + static_cast< ptrdiff_t >( first ) );
+    }
+}
+
+} // namespace gc
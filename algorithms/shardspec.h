@@ -0,0 +1,117 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/** \file shardspec.h
+ * @brief A file for a class that splits the images of a run between several processes or machines
+ *
+ * Shard i of N is chosen by one of two rules. Both give the same answer on every machine that
+ * sees the same set of files:
+ *   - hash: an image belongs to the shard given by a hash of its path relative to the source
+ *     folder, so mount points do not matter and shards stay balanced for any file layout
+ *   - time: the images are sorted by filename timestamp and cut into N contiguous ranges of
+ *     (nearly) equal size, so each shard covers one stretch of time
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef SHARDSPEC_H
+#define SHARDSPEC_H
+
+#include "gc_types.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief Data class that holds an image path with its timestamp for time sharding
+ */
+class ShardItem
+{
+public:
+    ShardItem() : timestamp( 0 ) {}
+    ShardItem( const int64_t secs, const std::string &filepath, const std::string &shardKey ) :
+        timestamp( secs ), path( filepath ), key( shardKey ) {}
+
+    int64_t timestamp;      ///< Image timestamp in seconds from the epoch
+    std::string path;       ///< Image path
+    std::string key;        ///< Path relative to the source folder (tie breaker for equal timestamps)
+};
+
+/**
+ * @brief Which part of a run this process handles
+ */
+class ShardSpec
+{
+public:
+    /**
+     * @brief Constructor for an unsharded run (shard 0 of 1)
+     */
+    ShardSpec() :
+        index( 0 ),
+        count( 1 ),
+        byTime( false )
+    {}
+
+    int index;      ///< Zero based shard of this process
+    int count;      ///< Number of shards
+    bool byTime;    ///< true=Contiguous time ranges, false=Path hash
+
+    /**
+     * @brief true if the run is split into more than one shard
+     */
+    bool IsSharded() const { return 1 < count; }
+
+    /**
+     * @brief Parse a shard specification in the form i/N with 0 <= i < N
+     * @param spec Specification string
+     * @param shard Shard to set (byTime is not changed)
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    static GC_STATUS Parse( const std::string spec, ShardSpec &shard );
+
+    /**
+     * @brief Form the key an image is sharded by: its path relative to the source folder with
+     *        forward slashes, or the whole path if it is not below the folder
+     * @param imgPath Image path
+     * @param sourceFolder Folder the run was started on
+     * @return Shard key
+     */
+    static std::string ShardKey( const std::string &imgPath, const std::string &sourceFolder );
+
+    /**
+     * @brief true if an image belongs to this shard by the hash rule (also true when unsharded)
+     * @param key Shard key of the image (see ShardKey())
+     */
+    bool OwnsHash( const std::string &key ) const;
+
+    /**
+     * @brief Sort images by timestamp and keep the contiguous range that belongs to this shard
+     * @param items Images of the whole run, replaced by the images of this shard in time order
+     */
+    void SelectTimeRange( std::vector< ShardItem > &items ) const;
+};
+
+} // namespace gc
+
+#endif // SHARDSPEC_H
@@ -0,0 +1,255 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/** \file stagetimer.h
+ * @brief A file for scoped timers that record how long each stage of a line find takes
+ *
+ * Timers are placed with GC_STAGE_TIMER( "name" ) and record into the stage time list bound
+ * to the calling thread with GC_STAGE_SINK( list ). Time spent in a nested timer is only counted
+ * against the inner stage, so the stage times of an image add up to the timed total. Without
+ * GC_STAGE_TIMING defined both macros compile to nothing.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef STAGETIMER_H
+#define STAGETIMER_H
+
+#include "gc_types.h"
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <utility>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief Scoped timer that adds its duration, less the time of the timers nested inside it,
+ *        to the stage time list bound to the current thread
+ */
+class ScopedStageTimer
+{
+public:
+    /**
+     * @brief Constructor starts the timer
+     * @param name Stage name (must be a string literal)
+     */
+    explicit ScopedStageTimer( const char *name ) :
+        m_name( name ),
+        m_childMs( 0.0 ),
+        m_parent( Current() ),
+        m_start( std::chrono::steady_clock::now() )
+    {
+        Current() = this;
+    }
+
+    /**
+     * @brief Destructor stops the timer and records the stage time
+     */
+    ~ScopedStageTimer()
+    {
+        double elapsedMs = std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - m_start ).count();
+        Current() = m_parent;
+        if ( nullptr != m_parent )
+        {
+            m_parent->m_childMs += elapsedMs;
+        }
+        if ( nullptr != Sink() )
+        {
+            Add( *Sink(), m_name, elapsedMs - m_childMs );
+        }
+    }
+
+    ScopedStageTimer( const ScopedStageTimer & ) = delete;
+    ScopedStageTimer &operator=( const ScopedStageTimer & ) = delete;
+
+    /**
+     * @brief Add a duration to a stage time list, summing it with earlier times of the same stage
+     * @param times Stage time list
+     * @param name Stage name
+     * @param ms Duration in milliseconds
+     */
+    static void Add( StageTimeList &times, const char *name, const double ms )
+    {
+        for ( auto &stage : times )
+        {
+            if ( stage.first == name )
+            {
+                stage.second += ms;
+                return;
+            }
+        }
+        times.emplace_back( name, ms );
+    }
+
+    /**
+     * @brief Name of the innermost stage running on the current thread (nullptr=none)
+     */
+    static const char *CurrentStage()
+    {
+        return nullptr == Current() ? nullptr : Current()->m_name;
+    }
+
+    /**
+     * @brief Stage time list the timers of the current thread record into (nullptr=none)
+     */
+    static StageTimeList *&Sink()
+    {
+        static thread_local StageTimeList *sink = nullptr;
+        return sink;
+    }
+
+private:
+    const char *m_name;
+    double m_childMs;
+    ScopedStageTimer *m_parent;
+    std::chrono::steady_clock::time_point m_start;
+
+    static ScopedStageTimer *&Current()
+    {
+        static thread_local ScopedStageTimer *current = nullptr;
+        return current;
+    }
+};
+
+/**
+ * @brief Binds a stage time list to the current thread for the lifetime of the object
+ */
+class StageTimerSink
+{
+public:
+    /**
+     * @brief Constructor binds the list
+     * @param times Stage time list the timers of this thread record into
+     */
+    explicit StageTimerSink( StageTimeList &times ) :
+        m_prev( ScopedStageTimer::Sink() )
+    {
+        ScopedStageTimer::Sink() = &times;
+    }
+
+    /**
+     * @brief Destructor restores the list that was bound before
+     */
+    ~StageTimerSink()
+    {
+        ScopedStageTimer::Sink() = m_prev;
+    }
+
+    StageTimerSink( const StageTimerSink & ) = delete;
+    StageTimerSink &operator=( const StageTimerSink & ) = delete;
+
+private:
+    StageTimeList *m_prev;
+};
+
+/**
+ * @brief Collects the times of one stage over many images in a fixed size log scale histogram
+ *        so percentiles of runs of any length can be reported to within one percent
+ */
+class StageTimeSummary
+{
+public:
+    /**
+     * @brief Constructor sets the summary to hold no times
+     */
+    StageTimeSummary() :
+        m_count( 0 ),
+        m_maxMs( 0.0 ),
+        m_bins( BIN_COUNT, 0 )
+    {}
+
+    /**
+     * @brief Add the time of one image
+     * @param ms Duration in milliseconds
+     */
+    void Add( const double ms )
+    {
+        size_t bin = 0;
+        if ( MIN_MS < ms )
+        {
+            bin = std::min( BIN_COUNT - 1, static_cast< size_t >( std::log( ms / MIN_MS ) / std::log( BIN_RATIO ) ) + 1 );
+        }
+        ++m_bins[ bin ];
+        ++m_count;
+        m_maxMs = std::max( m_maxMs, ms );
+    }
+
+    /**
+     * @brief Number of times added
+     */
+    size_t Count() const { return m_count; }
+
+    /**
+     * @brief Largest time added in milliseconds
+     */
+    double Max() const { return m_maxMs; }
+
+    /**
+     * @brief Time in milliseconds that the given fraction of the added times do not exceed
+     * @param fraction Fraction between 0.0 and 1.0 (e.g. 0.95 for the 95th percentile)
+     */
+    double Percentile( const double fraction ) const
+    {
+        if ( 0 == m_count )
+            return 0.0;
+        size_t rank = static_cast< size_t >( std::ceil( fraction * static_cast< double >( m_count ) ) );
+        rank = std::max< size_t >( 1, rank );
+        size_t total = 0;
+        for ( size_t i = 0; i < m_bins.size(); ++i )
+        {
+            total += m_bins[ i ];
+            if ( total >= rank )
+            {
+                // upper edge of the bin, but never more than the largest time seen
+                return 0 == i ? MIN_MS : std::min( m_maxMs, MIN_MS * std::pow( BIN_RATIO, static_cast< double >( i ) ) );
+            }
+        }
+        return m_maxMs;
+    }
+
+private:
+    static constexpr double MIN_MS = 0.001;
+    static constexpr double BIN_RATIO = 1.01;
+    static constexpr size_t BIN_COUNT = 2100;   // 1 microsecond to about 20 minutes
+
+    size_t m_count;
+    double m_maxMs;
+    std::vector< size_t > m_bins;
+};
+
+} // namespace gc
+
+#define GC_STAGE_CONCAT_INNER( a, b ) a##b
+#define GC_STAGE_CONCAT( a, b ) GC_STAGE_CONCAT_INNER( a, b )
+
+#ifdef GC_STAGE_TIMING
+#define GC_STAGE_TIMER( name ) gc::ScopedStageTimer GC_STAGE_CONCAT( gcStageTimer_, __LINE__ )( name )
+#define GC_STAGE_SINK( times ) gc::StageTimerSink GC_STAGE_CONCAT( gcStageSink_, __LINE__ )( times )
+#else
+#define GC_STAGE_TIMER( name )
+#define GC_STAGE_SINK( times )
+#endif
+
+#endif // STAGETIMER_H
@@ -0,0 +1,494 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#include "log.h"
+#include "syntheticscene.h"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <filesystem>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+using namespace cv;
+using namespace std;
+namespace fs = std::filesystem;
+namespace pt = boost::property_tree;
+
+static const int POLY_SHIFT = 8;                    // fractional bits of the polygon vertices
+static const double RIM_FRACTION = 0.08;            // dark rim outside the octagon edge (fraction of a side)
+static const double BORDER_FRACTION = 0.07;         // white border inside the octagon edge (fraction of a side)
+static const int BACKGROUND_CELL = 16;              // pixels per random background sample
+static const int NOISE_BAND_ROWS = 256;             // rows of noise generated at a time
+
+static Point2d Project( const Matx33d &H, const Point2d pt )
+{
+    Vec3d p = H * Vec3d( pt.x, pt.y, 1.0 );
+    return Point2d( p[ 0 ] / p[ 2 ], p[ 1 ] / p[ 2 ] );
+}
+static vector< Point2d > OctagonWorldPoints( const double side, const double zeroOffset, const double scale )
+{
+    // same vertex order and orientation as CalibOctagon::CalcOctoWorldPoints, scaled about the center
+    double corner = sqrt( side * side / 2.0 );
+    vector< Point2d > pts = { Point2d( 0.0, 0.0 ), Point2d( side, 0.0 ),
+                              Point2d( side + corner, -corner ), Point2d( side + corner, -side - corner ),
+                              Point2d( side, -corner - corner - side ), Point2d( 0.0, -corner - corner - side ),
+                              Point2d( -corner, -corner - side ), Point2d( -corner, -corner ) };
+    Point2d center( side / 2.0, -corner - side / 2.0 );
+    for ( auto &pt : pts )
+    {
+        pt = center + ( pt - center ) * scale + Point2d( 0.0, zeroOffset );
+    }
+    return pts;
+}
+static void FillPolygon( Mat &img, const vector< Point2d > &pts, const Scalar color )
+{
+    vector< Point > fixedPts;
+    for ( const auto &pt : pts )
+    {
+        fixedPts.push_back( Point( cvRound( pt.x * ( 1 << POLY_SHIFT ) ), cvRound( pt.y * ( 1 << POLY_SHIFT ) ) ) );
+    }
+    if ( 3 <= fixedPts.size() )
+    {
+        fillConvexPoly( img, fixedPts, color, LINE_AA, POLY_SHIFT );
+    }
+}
+static vector< Point2d > WaterPolygon( const Matx33d &worldToPixel, const double waterLevel, const Size size )
+{
+    // pixels whose world point lies below the water level, clipped to the image
+    Matx33d pixelToWorld = worldToPixel.inv();
+    Vec3d line( pixelToWorld( 1, 0 ) - waterLevel * pixelToWorld( 2, 0 ),
+                pixelToWorld( 1, 1 ) - waterLevel * pixelToWorld( 2, 1 ),
+                pixelToWorld( 1, 2 ) - waterLevel * pixelToWorld( 2, 2 ) );
+    double w = pixelToWorld( 2, 0 ) * size.width / 2.0 + pixelToWorld( 2, 1 ) * size.height / 2.0 + pixelToWorld( 2, 2 );
+    double sign = 0.0 > w ? -1.0 : 1.0;
+    auto below = [ & ]( const Point2d &p ) { return sign * ( line[ 0 ] * p.x + line[ 1 ] * p.y + line[ 2 ] ); };
+
+    vector< Point2d > corners = { Point2d( 0.0, 0.0 ), Point2d( size.width, 0.0 ),
+                                  Point2d( size.width, size.height ), Point2d( 0.0, size.height ) };
+    vector< Point2d > poly;
+    for ( size_t i = 0; i < corners.size(); ++i )
+    {
+        const Point2d &a = corners[ i ];
+        const Point2d &b = corners[ ( i + 1 ) % corners.size() ];
+        double da = below( a ), db = below( b );
+        if ( 0.0 > da )
+            poly.push_back( a );
+        if ( ( 0.0 > da ) != ( 0.0 > db ) )
+            poly.push_back( a + ( b - a ) * ( da / ( da - db ) ) );
+    }
+    return poly;
+}
+static string FrameTimestamp( const string &startTime, const int minutes )
+{
+    string start = startTime;
+    replace( start.begin(), start.end(), 'T', ' ' );
+    boost::posix_time::ptime tm = boost::posix_time::time_from_string( start ) + boost::posix_time::minutes( minutes );
+    return boost::posix_time::to_iso_extended_string( tm );
+}
+
+namespace gc
+{
+
+GC_STATUS SyntheticScene::ReadParams( const std::string jsonPath, SyntheticSceneParams &params )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        pt::ptree top;
+        pt::read_json( jsonPath, top );
+        params.imageSize.width = top.get< int >( "width", params.imageSize.width );
+        params.imageSize.height = top.get< int >( "height", params.imageSize.height );
+        params.frames = top.get< int >( "frames", params.frames );
+        params.facetLength = top.get< double >( "facet_length", params.facetLength );
+        params.zeroOffset = top.get< double >( "zero_offset", params.zeroOffset );
+        params.pixelsPerUnit = top.get< double >( "pixels_per_unit", params.pixelsPerUnit );
+        params.targetCenter.x = top.get< double >( "target_x", params.imageSize.width / 2.0 );
+        params.targetCenter.y = top.get< double >( "target_y", params.imageSize.height * 0.4 );
+        params.rollDeg = top.get< double >( "roll_deg", params.rollDeg );
+        params.tiltDeg = top.get< double >( "tilt_deg", params.tiltDeg );
+        params.panDeg = top.get< double >( "pan_deg", params.panDeg );
+        params.waterLevelStart = top.get< double >( "water_level_start", params.waterLevelStart );
+        params.waterLevelEnd = top.get< double >( "water_level_end", params.waterLevelStart );
+        params.blurSigma = top.get< double >( "blur_sigma", params.blurSigma );
+        params.noiseSigma = top.get< double >( "noise_sigma", params.noiseSigma );
+        params.illumGainStart = top.get< double >( "illum_gain_start", params.illumGainStart );
+        params.illumGainEnd = top.get< double >( "illum_gain_end", params.illumGainStart );
+        params.illumGradient = top.get< double >( "illum_gradient", params.illumGradient );
+        params.jitterPixels = top.get< double >( "jitter_pixels", params.jitterPixels );
+        params.seed = top.get< int >( "seed", params.seed );
+        params.imageFormat = top.get< string >( "image_format", params.imageFormat );
+        params.startTime = top.get< string >( "start_time", params.startTime );
+        params.intervalMinutes = top.get< int >( "interval_minutes", params.intervalMinutes );
+
+        if ( 16 > params.imageSize.width || 16 > params.imageSize.height || 1 > params.frames ||
+             0.0 >= params.facetLength || 0.0 >= params.pixelsPerUnit )
+        {
+            FILE_LOG( logERROR ) << "[SyntheticScene::ReadParams] Invalid size, frame count, facet length, or scale in " << jsonPath;
+            retVal = GC_ERR;
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[SyntheticScene::ReadParams] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS SyntheticScene::WorldToPixelHomography( const SyntheticSceneParams &params, const cv::Point2d targetShift,
+                                                  cv::Matx33d &worldToPixel )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        // pinhole camera with a focal length of the larger image dimension, placed so one world
+        // unit at the octagon center is pixelsPerUnit pixels when the target faces the camera
+        double focal = static_cast< double >( std::max( params.imageSize.width, params.imageSize.height ) );
+        Matx33d K( focal, 0.0, params.imageSize.width / 2.0,
+                   0.0, focal, params.imageSize.height / 2.0,
+                   0.0, 0.0, 1.0 );
+
+        double roll = params.rollDeg * CV_PI / 180.0;
+        double tilt = params.tiltDeg * CV_PI / 180.0;
+        double pan = params.panDeg * CV_PI / 180.0;
+        Matx33d Rx( 1.0, 0.0, 0.0, 0.0, cos( tilt ), -sin( tilt ), 0.0, sin( tilt ), cos( tilt ) );
+        Matx33d Ry( cos( pan ), 0.0, sin( pan ), 0.0, 1.0, 0.0, -sin( pan ), 0.0, cos( pan ) );
+        Matx33d Rz( cos( roll ), -sin( roll ), 0.0, sin( roll ), cos( roll ), 0.0, 0.0, 0.0, 1.0 );
+        Matx33d R = Rz * Ry * Rx;
+
+        double distance = focal / params.pixelsPerUnit;
+        Point2d center = params.targetCenter + targetShift;
+        Vec3d T( distance * ( center.x - params.imageSize.width / 2.0 ) / focal,
+                 distance * ( center.y - params.imageSize.height / 2.0 ) / focal, distance );
+
+        // world x right and y up, relative to the octagon center, to camera x right and y down
+        double corner = sqrt( params.facetLength * params.facetLength / 2.0 );
+        Point2d worldCenter( params.facetLength / 2.0, params.zeroOffset - corner - params.facetLength / 2.0 );
+        Matx33d A( 1.0, 0.0, -worldCenter.x,
+                   0.0, -1.0, worldCenter.y,
+                   0.0, 0.0, 1.0 );
+        Matx33d M( R( 0, 0 ), R( 0, 1 ), T[ 0 ],
+                   R( 1, 0 ), R( 1, 1 ), T[ 1 ],
+                   R( 2, 0 ), R( 2, 1 ), T[ 2 ] );
+        worldToPixel = K * M * A;
+        worldToPixel *= 1.0 / worldToPixel( 2, 2 );
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[SyntheticScene::WorldToPixelHomography] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS SyntheticScene::Render( const SyntheticSceneParams &params, const double waterLevel, const double illumGain,
+                                  const cv::Point2d targetShift, const int seed, cv::Mat &img, SyntheticFrameTruth &truth )
+{
+    GC_STATUS retVal = WorldToPixelHomography( params, targetShift, truth.worldToPixel );
+    try
+    {
+        if ( GC_OK == retVal )
+        {
+            const Matx33d &H = truth.worldToPixel;
+            const double side = params.facetLength;
+            const double corner = sqrt( side * side / 2.0 );
+            const double apothem = side / 2.0 + corner;
+            truth.waterLevel = waterLevel;
+
+            // a smooth random bank texture, kept between images of the same size and seed
+            if ( m_background.size() != params.imageSize || m_backgroundSeed != params.seed )
+            {
+                RNG rng( static_cast< uint64 >( params.seed ) );
+                Mat cells( params.imageSize.height / BACKGROUND_CELL + 2, params.imageSize.width / BACKGROUND_CELL + 2, CV_8UC3 );
+                rng.fill( cells, RNG::UNIFORM, Scalar( 40, 70, 50 ), Scalar( 110, 150, 120 ) );
+                resize( cells, m_background, params.imageSize, 0.0, 0.0, INTER_CUBIC );
+                m_backgroundSeed = params.seed;
+            }
+            m_background.copyTo( img );
+
+            // light backboard behind and below the target, down past the line search region
+            Rect calibRoi;
+            LineSearchRoi waterlineRoi;
+            double boardBottom = std::min( params.waterLevelStart, params.waterLevelEnd ) - 2.5 * side;
+            vector< Point2d > board = { Point2d( -corner, params.zeroOffset - apothem ), Point2d( side + corner, params.zeroOffset - apothem ),
+                                        Point2d( side + corner, boardBottom ), Point2d( -corner, boardBottom ) };
+            for ( auto &pt : board )
+                pt = Project( H, pt );
+            FillPolygon( img, board, Scalar( 195, 200, 200 ) );
+
+            // dark rim, white octagon whose outer edge holds the calibration points, red interior
+            vector< Point2d > rim = OctagonWorldPoints( side, params.zeroOffset, ( apothem + RIM_FRACTION * side ) / apothem );
+            vector< Point2d > edge = OctagonWorldPoints( side, params.zeroOffset, 1.0 );
+            vector< Point2d > inner = OctagonWorldPoints( side, params.zeroOffset, ( apothem - BORDER_FRACTION * side ) / apothem );
+            truth.octagonPixel.clear();
+            for ( size_t i = 0; i < edge.size(); ++i )
+            {
+                rim[ i ] = Project( H, rim[ i ] );
+                edge[ i ] = Project( H, edge[ i ] );
+                inner[ i ] = Project( H, inner[ i ] );
+                truth.octagonPixel.push_back( edge[ i ] );
+            }
+            FillPolygon( img, rim, Scalar( 25, 25, 25 ) );
+            FillPolygon( img, edge, Scalar( 235, 235, 235 ) );
+            FillPolygon( img, inner, Scalar( 40, 40, 190 ) );
+
+            FillPolygon( img, WaterPolygon( H, waterLevel, params.imageSize ), Scalar( 95, 80, 60 ) );
+
+            // waterline across the width of the line search region
+            double lft = -corner / 2.0, rgt = side + corner / 2.0;
+            truth.waterline.lftWorld = Point2d( lft, waterLevel );
+            truth.waterline.ctrWorld = Point2d( ( lft + rgt ) / 2.0, waterLevel );
+            truth.waterline.rgtWorld = Point2d( rgt, waterLevel );
+            truth.waterline.lftPixel = Project( H, truth.waterline.lftWorld );
+            truth.waterline.ctrPixel = Project( H, truth.waterline.ctrWorld );
+            truth.waterline.rgtPixel = Project( H, truth.waterline.rgtWorld );
+            truth.waterline.anglePixel = atan2( truth.waterline.rgtPixel.y - truth.waterline.lftPixel.y,
+                                                truth.waterline.rgtPixel.x - truth.waterline.lftPixel.x ) * 180.0 / CV_PI;
+            truth.waterline.angleWorld = 0.0;
+
+            // illumination level and left to right gradient
+            if ( 1.0 != illumGain || 0.0 != params.illumGradient )
+            {
+                vector< float > gains( static_cast< size_t >( img.cols ) );
+                for ( int c = 0; c < img.cols; ++c )
+                {
+                    double ramp = 2.0 * c / std::max( 1, img.cols - 1 ) - 1.0;
+                    gains[ static_cast< size_t >( c ) ] = static_cast< float >( illumGain * ( 1.0 + params.illumGradient * ramp ) );
+                }
+                for ( int r = 0; r < img.rows; ++r )
+                {
+                    Vec3b *row = img.ptr< Vec3b >( r );
+                    for ( int c = 0; c < img.cols; ++c )
+                    {
+                        for ( int k = 0; k < 3; ++k )
+                            row[ c ][ k ] = saturate_cast< uchar >( row[ c ][ k ] * gains[ static_cast< size_t >( c ) ] );
+                    }
+                }
+            }
+
+            if ( 0.0 < params.blurSigma )
+            {
+                GaussianBlur( img, img, Size( 0, 0 ), params.blurSigma );
+            }
+
+            // noise in bands of rows to bound the extra memory on very large images
+            if ( 0.0 < params.noiseSigma )
+            {
+                RNG rng( static_cast< uint64 >( seed ) );
+                Mat noise, sum;
+                for ( int r = 0; r < img.rows; r += NOISE_BAND_ROWS )
+                {
+                    Mat band = img.rowRange( r, std::min( img.rows, r + NOISE_BAND_ROWS ) );
+                    noise.create( band.size(), CV_16SC3 );
+                    rng.fill( noise, RNG::NORMAL, Scalar::all( 0.0 ), Scalar::all( params.noiseSigma ) );
+                    band.convertTo( sum, CV_16SC3 );
+                    sum += noise;
+                    sum.convertTo( band, CV_8UC3 );
+                }
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[SyntheticScene::Render] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS SyntheticScene::RenderSequence( const SyntheticSceneParams &params, const std::string folder,
+                                          std::vector< SyntheticFrameTruth > &truths )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        truths.clear();
+        if ( !fs::is_directory( folder ) )
+        {
+            FILE_LOG( logERROR ) << "[SyntheticScene::RenderSequence] Output folder does not exist: " << folder;
+            retVal = GC_ERR;
+        }
+        else
+        {
+            RNG jitterRng( static_cast< uint64 >( params.seed ) + 1 );
+            Mat img;
+            for ( int i = 0; i < params.frames; ++i )
+            {
+                double t = 1 < params.frames ? static_cast< double >( i ) / static_cast< double >( params.frames - 1 ) : 0.0;
+                double waterLevel = params.waterLevelStart + ( params.waterLevelEnd - params.waterLevelStart ) * t;
+                double illumGain = params.illumGainStart + ( params.illumGainEnd - params.illumGainStart ) * t;
+                Point2d shift( 0.0, 0.0 );
+                if ( 0.0 < params.jitterPixels )
+                {
+                    shift = Point2d( jitterRng.uniform( -params.jitterPixels, params.jitterPixels ),
+                                     jitterRng.uniform( -params.jitterPixels, params.jitterPixels ) );
+                }
+
+                SyntheticFrameTruth truth;
+                retVal = Render( params, waterLevel, illumGain, shift, params.seed + i, img, truth );
+                if ( GC_OK != retVal )
+                    break;
+
+                // the timestamp is in the filename for --timestamp_from_filename at position 6
+                truth.timestamp = FrameTimestamp( params.startTime, i * params.intervalMinutes );
+                string stamp = truth.timestamp.substr( 0, 16 );
+                replace( stamp.begin(), stamp.end(), 'T', '-' );
+                replace( stamp.begin(), stamp.end(), ':', '-' );
+                truth.imagePath = ( fs::path( folder ) / ( "synth_" + stamp + "." + params.imageFormat ) ).string();
+                if ( !imwrite( truth.imagePath, img ) )
+                {
+                    FILE_LOG( logERROR ) << "[SyntheticScene::RenderSequence] Could not write " << truth.imagePath;
+                    retVal = GC_ERR;
+                    break;
+                }
+                truths.push_back( truth );
+            }
+
+            if ( GC_OK == retVal )
+            {
+                string json;
+                retVal = TruthToJson( params, truths, json );
+                if ( GC_OK == retVal )
+                {
+                    string truthPath = ( fs::path( folder ) / "ground_truth.json" ).string();
+                    ofstream truthFile( truthPath );
+                    truthFile << json;
+                    if ( !truthFile )
+                    {
+                        FILE_LOG( logERROR ) << "[SyntheticScene::RenderSequence] Could not write " << truthPath;
+                        retVal = GC_ERR;
+                    }
+                }
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[SyntheticScene::RenderSequence] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+GC_STATUS SyntheticScene::CalibRegions( const SyntheticSceneParams &params, cv::Rect &calibRoi, LineSearchRoi &waterlineRoi )
+{
+    Matx33d H;
+    GC_STATUS retVal = WorldToPixelHomography( params, Point2d( 0.0, 0.0 ), H );
+    if ( GC_OK == retVal )
+    {
+        const double side = params.facetLength;
+        const double corner = sqrt( side * side / 2.0 );
+        const double apothem = side / 2.0 + corner;
+
+        // target search region: the rim with a quarter of its size around it
+        vector< Point2f > rimPixels;
+        for ( const auto &pt : OctagonWorldPoints( side, params.zeroOffset, ( apothem + RIM_FRACTION * side ) / apothem ) )
+            rimPixels.push_back( Point2f( Project( H, pt ) ) );
+        Rect rimRect = boundingRect( rimPixels );
+        calibRoi = Rect( rimRect.x - rimRect.width / 4 - cvCeil( params.jitterPixels ), rimRect.y - rimRect.height / 4 - cvCeil( params.jitterPixels ),
+                         rimRect.width * 3 / 2 + 2 * cvCeil( params.jitterPixels ), rimRect.height * 3 / 2 + 2 * cvCeil( params.jitterPixels ) );
+        calibRoi &= Rect( Point( 0, 0 ), params.imageSize );
+
+        // line search region: below the octagon and down past the lowest water level
+        double top = params.zeroOffset - 2.0 * apothem - 0.25 * side;
+        double bot = std::min( params.waterLevelStart, params.waterLevelEnd ) - 1.0 * side;
+        double lft = -corner / 2.0, rgt = side + corner / 2.0;
+        auto toPixel = [ & ]( const double x, const double y )
+        {
+            Point2d pt = Project( H, Point2d( x, y ) );
+            return Point( std::clamp( cvRound( pt.x ), 0, params.imageSize.width - 1 ),
+                          std::clamp( cvRound( pt.y ), 0, params.imageSize.height - 1 ) );
+        };
+        waterlineRoi = LineSearchRoi( toPixel( lft, top ), toPixel( rgt, top ), toPixel( rgt, bot ), toPixel( lft, bot ) );
+    }
+    return retVal;
+}
+GC_STATUS SyntheticScene::TruthToJson( const SyntheticSceneParams &params, const std::vector< SyntheticFrameTruth > &truths,
+                                       std::string &json )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        Rect calibRoi;
+        LineSearchRoi roi;
+        retVal = CalibRegions( params, calibRoi, roi );
+        if ( GC_OK == retVal )
+        {
+            stringstream ss;
+            ss << fixed << setprecision( 4 );
+            ss << "{" << endl;
+            ss << "  \"params\": {\"width\": " << params.imageSize.width << ", \"height\": " << params.imageSize.height
+               << ", \"frames\": " << params.frames << ", \"facet_length\": " << params.facetLength
+               << ", \"zero_offset\": " << params.zeroOffset << ", \"pixels_per_unit\": " << params.pixelsPerUnit
+               << ", \"target_x\": " << params.targetCenter.x << ", \"target_y\": " << params.targetCenter.y
+               << ", \"roll_deg\": " << params.rollDeg << ", \"tilt_deg\": " << params.tiltDeg << ", \"pan_deg\": " << params.panDeg
+               << ", \"water_level_start\": " << params.waterLevelStart << ", \"water_level_end\": " << params.waterLevelEnd
+               << ", \"blur_sigma\": " << params.blurSigma << ", \"noise_sigma\": " << params.noiseSigma
+               << ", \"illum_gain_start\": " << params.illumGainStart << ", \"illum_gain_end\": " << params.illumGainEnd
+               << ", \"illum_gradient\": " << params.illumGradient << ", \"jitter_pixels\": " << params.jitterPixels
+               << ", \"seed\": " << params.seed << ", \"image_format\": \"" << params.imageFormat << "\""
+               << ", \"start_time\": \"" << params.startTime << "\", \"interval_minutes\": " << params.intervalMinutes << "}," << endl;
+
+            // arguments to calibrate on the first image and run the sequence with grime2cli
+            ss << "  \"create_calib_args\": \"--create_calib Octagon --facet_length " << params.facetLength
+               << " --zero_offset " << params.zeroOffset
+               << " --calib_roi " << calibRoi.x << " " << calibRoi.y << " " << calibRoi.width << " " << calibRoi.height
+               << " --waterline_roi " << roi.lftTop.x << " " << roi.lftTop.y << " " << roi.rgtTop.x << " " << roi.rgtTop.y
+               << " " << roi.lftBot.x << " " << roi.lftBot.y << " " << roi.rgtBot.x << " " << roi.rgtBot.y << "\"," << endl;
+            ss << "  \"find_line_args\": \"--timestamp_from_filename --timestamp_start_pos 6 --timestamp_format yyyy-mm-dd-HH-MM\"," << endl;
+
+            ss << "  \"frames\": [" << endl;
+            for ( size_t i = 0; i < truths.size(); ++i )
+            {
+                const SyntheticFrameTruth &truth = truths[ i ];
+                ss << "    {\"image\": \"" << fs::path( truth.imagePath ).filename().string() << "\""
+                   << ", \"timestamp\": \"" << truth.timestamp << "\""
+                   << ", \"water_level\": " << truth.waterLevel << "," << endl;
+                ss << "     \"waterline_pixel\": {\"lft_x\": " << truth.waterline.lftPixel.x << ", \"lft_y\": " << truth.waterline.lftPixel.y
+                   << ", \"ctr_x\": " << truth.waterline.ctrPixel.x << ", \"ctr_y\": " << truth.waterline.ctrPixel.y
+                   << ", \"rgt_x\": " << truth.waterline.rgtPixel.x << ", \"rgt_y\": " << truth.waterline.rgtPixel.y
+                   << ", \"angle\": " << truth.waterline.anglePixel << "}," << endl;
+                ss << "     \"octagon_pixel\": [";
+                for ( size_t j = 0; j < truth.octagonPixel.size(); ++j )
+                {
+                    ss << "{\"x\": " << truth.octagonPixel[ j ].x << ", \"y\": " << truth.octagonPixel[ j ].y << "}"
+                       << ( truth.octagonPixel.size() - 1 == j ? "" : ", " );
+                }
+                ss << "]," << endl;
+                ss << "     \"world_to_pixel\": [" << setprecision( 9 );
+                for ( int j = 0; j < 9; ++j )
+                {
+                    ss << truth.worldToPixel( j / 3, j % 3 ) << ( 8 == j ? "" : ", " );
+                }
+                ss << "]}" << setprecision( 4 ) << ( truths.size() - 1 == i ? "" : "," ) << endl;
+            }
+            ss << "  ]" << endl;
+            ss << "}" << endl;
+            json = ss.str();
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[SyntheticScene::TruthToJson] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+
+} // namespace gc
@@ -0,0 +1,202 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/** \file syntheticscene.h
+ * @brief A file for a class that renders images of an octagon calibration target and a water
+ *        surface at known world positions, along with the ground truth of each image
+ *
+ * The target follows the world point model of CalibOctagon (top left vertex at x=0, world y
+ * pointing up and shifted by the zero offset), so the ground truth can be compared directly with
+ * calibration and line find results.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef SYNTHETICSCENE_H
+#define SYNTHETICSCENE_H
+
+#include "gc_types.h"
+#include "calibexecutive.h"
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief Data class that holds the settings of a rendered scene or sequence of scenes
+ */
+class SyntheticSceneParams
+{
+public:
+    /**
+     * @brief Constructor sets a 3 MP scene similar to the demo images
+     */
+    SyntheticSceneParams() :
+        imageSize( 2304, 1296 ),
+        frames( 1 ),
+        facetLength( 0.6 ),
+        zeroOffset( 3.5 ),
+        pixelsPerUnit( 150.0 ),
+        targetCenter( 1152.0, 500.0 ),
+        rollDeg( 0.0 ),
+        tiltDeg( 0.0 ),
+        panDeg( 0.0 ),
+        waterLevelStart( 1.5 ),
+        waterLevelEnd( 1.5 ),
+        blurSigma( 1.0 ),
+        noiseSigma( 3.0 ),
+        illumGainStart( 1.0 ),
+        illumGainEnd( 1.0 ),
+        illumGradient( 0.0 ),
+        jitterPixels( 0.0 ),
+        seed( 1 ),
+        imageFormat( "png" ),
+        startTime( "2024-01-01T00:00:00" ),
+        intervalMinutes( 15 )
+    {}
+
+    cv::Size imageSize;         ///< Size of the rendered images
+    int frames;                 ///< Number of images in a sequence
+    double facetLength;         ///< Length of one octagon side in world units
+    double zeroOffset;          ///< World y of the top octagon side
+    double pixelsPerUnit;       ///< Image scale at the octagon center with no tilt or pan
+    cv::Point2d targetCenter;   ///< Pixel position of the octagon center
+    double rollDeg;             ///< Rotation of the target about the camera axis
+    double tiltDeg;             ///< Rotation of the target about its horizontal axis (perspective)
+    double panDeg;              ///< Rotation of the target about its vertical axis (perspective)
+    double waterLevelStart;     ///< World y of the water surface in the first image of a sequence
+    double waterLevelEnd;       ///< World y of the water surface in the last image of a sequence
+    double blurSigma;           ///< Gaussian blur sigma in pixels (0=no blur)
+    double noiseSigma;          ///< Gaussian noise sigma in gray levels (0=no noise)
+    double illumGainStart;      ///< Brightness multiplier of the first image of a sequence
+    double illumGainEnd;        ///< Brightness multiplier of the last image of a sequence
+    double illumGradient;       ///< Left to right brightness change as a fraction of the gain (e.g. 0.2 = -20% to +20%)
+    double jitterPixels;        ///< Maximum random shift of the target per image to simulate camera movement
+    int seed;                   ///< Random seed for the background, jitter, and noise
+    std::string imageFormat;    ///< Image file extension (png or jpg)
+    std::string startTime;      ///< Timestamp of the first image in the form yyyy-mm-ddTHH:MM:SS
+    int intervalMinutes;        ///< Minutes between the timestamps of consecutive images
+};
+
+/**
+ * @brief Data class that holds the ground truth of one rendered image
+ */
+class SyntheticFrameTruth
+{
+public:
+    SyntheticFrameTruth() :
+        waterLevel( 0.0 )
+    {}
+
+    std::string imagePath;                  ///< Path the image was written to (empty=not written)
+    std::string timestamp;                  ///< Timestamp of the image in the form yyyy-mm-ddTHH:MM:SS
+    double waterLevel;                      ///< World y of the water surface
+    cv::Matx33d worldToPixel;               ///< Homography from world to pixel coordinates
+    std::vector< cv::Point2d > octagonPixel;///< Octagon vertices in the order of CalibOctagon world points
+    FindPointSet waterline;                 ///< Waterline ends and center across the line search region
+};
+
+/**
+ * @brief Renders octagon target and water surface images with known ground truth
+ */
+class SyntheticScene
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    SyntheticScene() :
+        m_backgroundSeed( -1 )
+    {}
+
+    /**
+     * @brief Read scene settings from a json file, keeping the defaults of missing keys. A target
+     *        without target_x/target_y is placed at the horizontal center, 40% down the image,
+     *        and missing end values of the water level and gain equal their start values
+     * @param jsonPath Path of the settings json file
+     * @param params Object to hold the settings
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    static GC_STATUS ReadParams( const std::string jsonPath, SyntheticSceneParams &params );
+
+    /**
+     * @brief Calculate the world to pixel homography of a scene
+     * @param params Scene settings
+     * @param targetShift Pixel shift of the target from its configured position
+     * @param worldToPixel Homography from world to pixel coordinates
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    static GC_STATUS WorldToPixelHomography( const SyntheticSceneParams &params, const cv::Point2d targetShift,
+                                             cv::Matx33d &worldToPixel );
+
+    /**
+     * @brief Render one image
+     * @param params Scene settings
+     * @param waterLevel World y of the water surface
+     * @param illumGain Brightness multiplier
+     * @param targetShift Pixel shift of the target from its configured position
+     * @param seed Random seed of the image noise
+     * @param img Rendered BGR image
+     * @param truth Ground truth of the image
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Render( const SyntheticSceneParams &params, const double waterLevel, const double illumGain,
+                      const cv::Point2d targetShift, const int seed, cv::Mat &img, SyntheticFrameTruth &truth );
+
+    /**
+     * @brief Render a sequence of images into a folder along with a ground_truth.json file
+     * @param params Scene settings
+     * @param folder Folder to write the images and ground truth to (must exist)
+     * @param truths Vector to hold the ground truth of each image
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS RenderSequence( const SyntheticSceneParams &params, const std::string folder,
+                              std::vector< SyntheticFrameTruth > &truths );
+
+    /**
+     * @brief Form the ground truth json of a sequence
+     * @param params Scene settings
+     * @param truths Ground truth of each image
+     * @param json String to hold the json
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    static GC_STATUS TruthToJson( const SyntheticSceneParams &params, const std::vector< SyntheticFrameTruth > &truths,
+                                  std::string &json );
+
+    /**
+     * @brief Calculate the calibration target search region and the waterline search region of a scene
+     * @param params Scene settings
+     * @param calibRoi Target search region with room for the configured jitter
+     * @param waterlineRoi Waterline search region from below the octagon to past the lowest water level
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    static GC_STATUS CalibRegions( const SyntheticSceneParams &params, cv::Rect &calibRoi, LineSearchRoi &waterlineRoi );
+
+private:
+    cv::Mat m_background;
+    int m_backgroundSeed;
+};
+
+} // namespace gc
+
+#endif // SYNTHETICSCENE_H
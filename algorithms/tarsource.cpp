@@ -0,0 +1,336 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "log.h"
+#include "tarsource.h"
+#include "folderwatcher.h"
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <filesystem>
+#ifdef GC_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace std;
+
+static const size_t TAR_BLOCK_SIZE = 512;
+static const uint64_t MAX_IMAGE_ENTRY_SIZE = 1ULL << 30;        // 1 GiB
+static const uint64_t MAX_EXTENDED_HEADER_SIZE = 1ULL << 20;    // 1 MiB
+
+static string ToLower( string str )
+{
+    transform( str.begin(), str.end(), str.begin(), []( unsigned char c ) { return static_cast< char >( tolower( c ) ); } );
+    return str;
+}
+
+namespace gc
+{
+
+TarImageSource::TarImageSource() :
+    m_file( nullptr ),
+    m_streamSize( 0 ),
+    m_position( 0 ),
+    m_hasFailed( false )
+{
+}
+TarImageSource::~TarImageSource()
+{
+    Close();
+}
+bool TarImageSource::IsTarPath( const std::string &filepath )
+{
+    string lower = ToLower( filepath );
+    auto endsWith = [ &lower ]( const string &suffix )
+    {
+        return lower.size() >= suffix.size() && 0 == lower.compare( lower.size() - suffix.size(), suffix.size(), suffix );
+    };
+    return endsWith( ".tar" ) || endsWith( ".tar.gz" ) || endsWith( ".tgz" );
+}
+GC_STATUS TarImageSource::Open( const std::string tarPath )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        Close();
+#ifdef GC_HAVE_ZLIB
+        // gzread passes uncompressed files through unchanged, so one path handles both
+        gzFile gz = gzopen( tarPath.c_str(), "rb" );
+        if ( nullptr != gz )
+        {
+            gzbuffer( gz, 256 * 1024 );
+        }
+        m_file = gz;
+
+        // entry sizes can only be checked against the archive size when it is not compressed
+        if ( nullptr != gz && 1 == gzdirect( gz ) )
+        {
+            std::error_code ec;
+            m_streamSize = static_cast< uint64_t >( std::filesystem::file_size( tarPath, ec ) );
+            m_streamSize = ec ? 0 : m_streamSize;
+        }
+#else
+        string lower = ToLower( tarPath );
+        auto endsWith = [ &lower ]( const string &suffix )
+        {
+            return lower.size() >= suffix.size() && 0 == lower.compare( lower.size() - suffix.size(), suffix.size(), suffix );
+        };
+        if ( endsWith( ".gz" ) || endsWith( ".tgz" ) )
+        {
+            FILE_LOG( logERROR ) << "[TarImageSource::Open] This build cannot read compressed archives: " << tarPath;
+            return GC_ERR;
+        }
+        m_file = fopen( tarPath.c_str(), "rb" );
+
+        std::error_code ec;
+        m_streamSize = static_cast< uint64_t >( std::filesystem::file_size( tarPath, ec ) );
+        m_streamSize = ec ? 0 : m_streamSize;
+#endif
+        if ( nullptr == m_file )
+        {
+            FILE_LOG( logERROR ) << "[TarImageSource::Open] Could not open " << tarPath;
+            retVal = GC_ERR;
+        }
+        else
+        {
+            m_filepath = tarPath;
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[TarImageSource::Open] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+void TarImageSource::Close()
+{
+    if ( nullptr != m_file )
+    {
+#ifdef GC_HAVE_ZLIB
+        gzclose( static_cast< gzFile >( m_file ) );
+#else
+        fclose( static_cast< FILE * >( m_file ) );
+#endif
+        m_file = nullptr;
+    }
+    m_filepath.clear();
+    m_streamSize = 0;
+    m_position = 0;
+    m_hasFailed = false;
+}
+size_t TarImageSource::ReadBytes( void *buffer, const size_t len )
+{
+    char *dst = static_cast< char * >( buffer );
+    size_t total = 0;
+    while ( total < len )
+    {
+#ifdef GC_HAVE_ZLIB
+        unsigned int chunk = static_cast< unsigned int >( std::min( len - total, static_cast< size_t >( 1 << 30 ) ) );
+        int cnt = gzread( static_cast< gzFile >( m_file ), dst + total, chunk );
+        bool isError = 0 > cnt;
+#else
+        size_t cnt = fread( dst + total, 1, len - total, static_cast< FILE * >( m_file ) );
+        bool isError = 0 != ferror( static_cast< FILE * >( m_file ) );
+#endif
+        if ( isError )
+        {
+            // a read error is never a clean end of the archive, even on a block boundary
+            FILE_LOG( logERROR ) << "[TarImageSource::ReadBytes] Read error at byte " << m_position << " of " << m_filepath;
+            m_hasFailed = true;
+            break;
+        }
+        if ( 0 == cnt )
+            break;
+        total += static_cast< size_t >( cnt );
+        m_position += static_cast< uint64_t >( cnt );
+    }
+    return total;
+}
+bool TarImageSource::SkipBytes( uint64_t len )
+{
+    char buffer[ 64 * 1024 ];
+    while ( 0 < len )
+    {
+        size_t chunk = static_cast< size_t >( std::min< uint64_t >( len, sizeof( buffer ) ) );
+        if ( chunk != ReadBytes( buffer, chunk ) )
+            return false;
+        len -= chunk;
+    }
+    return true;
+}
+uint64_t TarImageSource::ParseNumber( const char *field, const size_t len )
+{
+    uint64_t value = 0;
+    if ( 0 != ( static_cast< unsigned char >( field[ 0 ] ) & 0x80 ) )
+    {
+        // GNU base-256 encoding for sizes of 8GB and more
+        value = static_cast< unsigned char >( field[ 0 ] ) & 0x7f;
+        for ( size_t i = 1; i < len; ++i )
+            value = ( value << 8 ) | static_cast< unsigned char >( field[ i ] );
+    }
+    else
+    {
+        for ( size_t i = 0; i < len && '\0' != field[ i ]; ++i )
+        {
+            if ( '0' <= field[ i ] && '7' >= field[ i ] )
+                value = ( value << 3 ) | static_cast< uint64_t >( field[ i ] - '0' );
+        }
+    }
+    return value;
+}
+bool TarImageSource::Next( std::string &entryName, std::vector< unsigned char > &data )
+{
+    GC_STATUS retVal = GC_WARN;
+    try
+    {
+        retVal = ReadEntry( entryName, data );
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[TarImageSource::Next] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    m_hasFailed = m_hasFailed || ( GC_OK != retVal && GC_WARN != retVal );
+    return GC_OK == retVal;
+}
+GC_STATUS TarImageSource::ReadEntry( std::string &entryName, std::vector< unsigned char > &data )
+{
+    if ( nullptr == m_file )
+        return GC_WARN;
+
+    string longName;
+    uint64_t paxSize = 0;
+    bool hasPaxSize = false;
+    char header[ TAR_BLOCK_SIZE ];
+    for ( ;; )
+    {
+        // only running out of data exactly on a block boundary between entries is a clean end
+        size_t headerBytes = ReadBytes( header, TAR_BLOCK_SIZE );
+        if ( 0 == headerBytes && longName.empty() && !hasPaxSize )
+            return GC_WARN;
+        if ( TAR_BLOCK_SIZE != headerBytes )
+        {
+            FILE_LOG( logERROR ) << "[TarImageSource::Next] Archive ends inside an entry header in " << m_filepath;
+            return GC_ERR;
+        }
+
+        // an all zero block marks the end of the archive
+        if ( all_of( header, header + TAR_BLOCK_SIZE, []( char c ) { return '\0' == c; } ) )
+            return GC_WARN;
+
+        uint64_t checksum = 0;
+        for ( size_t i = 0; i < TAR_BLOCK_SIZE; ++i )
+            checksum += ( 148 <= i && 156 > i ) ? ' ' : static_cast< unsigned char >( header[ i ] );
+        if ( checksum != ParseNumber( header + 148, 8 ) )
+        {
+            FILE_LOG( logERROR ) << "[TarImageSource::Next] Corrupt entry header in " << m_filepath;
+            return GC_ERR;
+        }
+
+        uint64_t size = ParseNumber( header + 124, 12 );
+        char type = header[ 156 ];
+        if ( hasPaxSize && 'L' != type && 'x' != type )
+        {
+            size = paxSize;
+            hasPaxSize = false;
+        }
+        if ( 0 < m_streamSize && size > m_streamSize - std::min( m_streamSize, m_position ) )
+        {
+            FILE_LOG( logERROR ) << "[TarImageSource::Next] Entry size " << size << " is past the end of " << m_filepath;
+            return GC_ERR;
+        }
+        uint64_t padded = ( size + TAR_BLOCK_SIZE - 1 ) / TAR_BLOCK_SIZE * TAR_BLOCK_SIZE;
+
+        if ( 'L' == type || 'x' == type )
+        {
+            // GNU long name or pax extended header for the entry that follows
+            if ( MAX_EXTENDED_HEADER_SIZE < size )
+            {
+                FILE_LOG( logERROR ) << "[TarImageSource::Next] Extended header size " << size << " too large in " << m_filepath;
+                return GC_ERR;
+            }
+            string extended( static_cast< size_t >( size ), '\0' );
+            if ( extended.size() != ReadBytes( &extended[ 0 ], extended.size() ) || !SkipBytes( padded - size ) )
+            {
+                FILE_LOG( logERROR ) << "[TarImageSource::Next] Archive ends inside an extended header in " << m_filepath;
+                return GC_ERR;
+            }
+            if ( 'L' == type )
+            {
+                longName = extended.c_str();
+            }
+            else
+            {
+                size_t pos = 0;
+                while ( pos < extended.size() )
+                {
+                    size_t space = extended.find( ' ', pos );
+                    if ( string::npos == space )
+                        break;
+                    size_t recLen = static_cast< size_t >( strtoull( extended.c_str() + pos, nullptr, 10 ) );
+                    if ( 0 == recLen || pos + recLen > extended.size() )
+                        break;
+                    string record = extended.substr( space + 1, pos + recLen - space - 2 );
+                    if ( 0 == record.compare( 0, 5, "path=" ) )
+                        longName = record.substr( 5 );
+                    else if ( 0 == record.compare( 0, 5, "size=" ) )
+                    {
+                        paxSize = strtoull( record.c_str() + 5, nullptr, 10 );
+                        hasPaxSize = true;
+                    }
+                    pos += recLen;
+                }
+            }
+            continue;
+        }
+
+        string name = longName;
+        longName.clear();
+        if ( name.empty() )
+        {
+            name = string( header, strnlen( header, 100 ) );
+            if ( 0 == memcmp( header + 257, "ustar", 5 ) && '\0' != header[ 345 ] )
+            {
+                name = string( header + 345, strnlen( header + 345, 155 ) ) + "/" + name;
+            }
+        }
+
+        if ( ( '0' == type || '\0' == type ) && FolderWatcher::IsImageFile( name ) )
+        {
+            if ( MAX_IMAGE_ENTRY_SIZE < size )
+            {
+                FILE_LOG( logERROR ) << "[TarImageSource::Next] Image size " << size << " too large for " << name;
+                return GC_ERR;
+            }
+            data.resize( static_cast< size_t >( size ) );
+            if ( data.size() != ReadBytes( data.data(), data.size() ) || !SkipBytes( padded - size ) )
+            {
+                FILE_LOG( logERROR ) << "[TarImageSource::Next] Archive ends inside " << name;
+                return GC_ERR;
+            }
+            entryName = name;
+            return GC_OK;
+        }
+        if ( !SkipBytes( padded ) )
+        {
+            FILE_LOG( logERROR ) << "[TarImageSource::Next] Archive ends inside " << name;
+            return GC_ERR;
+        }
+    }
+}
+
+} // namespace gc
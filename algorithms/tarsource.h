@@ -0,0 +1,108 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/** \file tarsource.h
+ * @brief A file for a class that reads the image entries of a tar archive into memory one after
+ *        the other without extracting the archive to disk
+ *
+ * POSIX ustar, GNU long names, and pax path/size headers are understood. When built with
+ * GC_HAVE_ZLIB, gzip compressed archives (.tar.gz, .tgz) are decompressed as they are read.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef TARSOURCE_H
+#define TARSOURCE_H
+
+#include "gc_types.h"
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief Reads the .png and .jpg entries of a tar archive in archive order
+ */
+class TarImageSource
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    TarImageSource();
+
+    /**
+     * @brief Destructor, closes the archive
+     */
+    ~TarImageSource();
+
+    TarImageSource( const TarImageSource & ) = delete;
+    TarImageSource &operator=( const TarImageSource & ) = delete;
+
+    /**
+     * @brief Open a tar archive
+     * @param tarPath Path of the archive
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Open( const std::string tarPath );
+
+    /**
+     * @brief Read the next image entry
+     * @param entryName String to hold the path of the entry inside the archive
+     * @param data Vector to hold the encoded image bytes of the entry
+     * @return true=Entry returned, false=End of the archive or read error (see HasFailed)
+     */
+    bool Next( std::string &entryName, std::vector< unsigned char > &data );
+
+    /**
+     * @brief true if Next stopped on a corrupt, truncated, or oversized entry rather than the end of the archive
+     */
+    bool HasFailed() const { return m_hasFailed; }
+
+    /**
+     * @brief Close the archive
+     */
+    void Close();
+
+    /**
+     * @brief true if the path names a tar archive (.tar, .tar.gz, .tgz)
+     * @param filepath Path to test
+     */
+    static bool IsTarPath( const std::string &filepath );
+
+private:
+    void *m_file;
+    std::string m_filepath;
+    uint64_t m_streamSize;      ///< Size of an uncompressed archive (0=unknown)
+    uint64_t m_position;        ///< Bytes read from the archive
+    bool m_hasFailed;
+
+    GC_STATUS ReadEntry( std::string &entryName, std::vector< unsigned char > &data );
+    size_t ReadBytes( void *buffer, const size_t len );
+    bool SkipBytes( uint64_t len );
+    static uint64_t ParseNumber( const char *field, const size_t len );
+};
+
+} // namespace gc
+
+#endif // TARSOURCE_H
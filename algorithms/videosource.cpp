@@ -0,0 +1,121 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "log.h"
+#include "videosource.h"
+#include "resultlog.h"
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+using namespace cv;
+using namespace std;
+
+namespace gc
+{
+
+VideoFrameSource::VideoFrameSource() :
+    m_frameStep( 1 ),
+    m_nextIndex( 0 ),
+    m_startSecs( 0 ),
+    m_frameCount( 0 ),
+    m_fps( 0.0 )
+{
+}
+GC_STATUS VideoFrameSource::Open( const std::string videoPath, const std::string startTimestamp, const int frameStep )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        Close();
+        retVal = ResultLogReader::TimestampToSeconds( startTimestamp, m_startSecs );
+        if ( GC_OK != retVal )
+        {
+            FILE_LOG( logERROR ) << "[VideoFrameSource::Open] Invalid start time " << startTimestamp << " for " << videoPath;
+        }
+        else if ( !m_capture.open( videoPath, CAP_ANY ) || !m_capture.isOpened() )
+        {
+            FILE_LOG( logERROR ) << "[VideoFrameSource::Open] Could not open video " << videoPath;
+            retVal = GC_ERR;
+        }
+        else
+        {
+            m_frameStep = std::max( 1, frameStep );
+            m_nextIndex = 0;
+            m_fps = m_capture.get( CAP_PROP_FPS );
+            m_frameCount = static_cast< int64_t >( std::max( 0.0, m_capture.get( CAP_PROP_FRAME_COUNT ) ) );
+        }
+    }
+    catch( const cv::Exception &e )
+    {
+        FILE_LOG( logERROR ) << "[VideoFrameSource::Open] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+bool VideoFrameSource::Next( cv::Mat &frame, int64_t &frameIndex, std::string &timestamp )
+{
+    bool isOk = false;
+    try
+    {
+        if ( m_capture.isOpened() )
+        {
+            // stepped over frames are grabbed so the decoder stays in sync, but not converted to images
+            while ( 0 != m_nextIndex % m_frameStep )
+            {
+                if ( !m_capture.grab() )
+                    return false;
+                ++m_nextIndex;
+            }
+            if ( m_capture.grab() && m_capture.retrieve( frame ) && !frame.empty() )
+            {
+                frameIndex = m_nextIndex++;
+
+                double frameMsecs = m_capture.get( CAP_PROP_POS_MSEC );
+                if ( 0.0 >= frameMsecs && 0 < frameIndex && 0.0 < m_fps )
+                {
+                    frameMsecs = 1000.0 * static_cast< double >( frameIndex ) / m_fps;
+                }
+                timestamp = ResultLogReader::SecondsToTimestamp( m_startSecs + static_cast< int64_t >( floor( frameMsecs / 1000.0 ) ) );
+                isOk = true;
+            }
+        }
+    }
+    catch( const cv::Exception &e )
+    {
+        FILE_LOG( logERROR ) << "[VideoFrameSource::Next] " << e.what();
+        isOk = false;
+    }
+    return isOk;
+}
+void VideoFrameSource::Close()
+{
+    if ( m_capture.isOpened() )
+    {
+        m_capture.release();
+    }
+    m_nextIndex = 0;
+    m_frameCount = 0;
+    m_fps = 0.0;
+}
+std::string VideoFrameSource::FramePath( const std::string &videoPath, const int64_t frameIndex )
+{
+    char buf[ 32 ];
+    snprintf( buf, sizeof( buf ), "frame_%06lld", static_cast< long long >( frameIndex ) );
+    return videoPath + "/" + buf;
+}
+
+} // namespace gc
@@ -0,0 +1,108 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/** \file videosource.h
+ * @brief A file for a class that decodes the frames of a video or time-lapse file in order and
+ *        gives each one a timestamp
+ *
+ * The timestamp of a frame is the start time of the recording plus the presentation time of the
+ * frame in the container. If the backend does not report presentation times, the frame number
+ * divided by the frame rate is used instead.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef VIDEOSOURCE_H
+#define VIDEOSOURCE_H
+
+#include "gc_types.h"
+#include <string>
+#include <cstdint>
+#include <opencv2/videoio.hpp>
+
+//! GaugeCam classes, functions and variables
+namespace gc
+{
+
+/**
+ * @brief Reads every Nth frame of a video file with its timestamp
+ */
+class VideoFrameSource
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    VideoFrameSource();
+
+    /**
+     * @brief Open a video file
+     * @param videoPath Path of the video file (any container and codec the OpenCV build can read)
+     * @param startTimestamp Time of the first frame in the form yyyy-mm-ddTHH:MM:SS
+     * @param frameStep Return every frameStep-th frame, starting with the first (1=every frame)
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS Open( const std::string videoPath, const std::string startTimestamp, const int frameStep = 1 );
+
+    /**
+     * @brief Decode the next frame. Frames that are stepped over are only grabbed, not decoded
+     *        to an image.
+     * @param frame Image to hold the frame
+     * @param frameIndex Variable to hold the zero based frame number in the video
+     * @param timestamp String to hold the frame time in the form yyyy-mm-ddTHH:MM:SS
+     * @return true=Frame returned, false=End of the video or read error
+     */
+    bool Next( cv::Mat &frame, int64_t &frameIndex, std::string &timestamp );
+
+    /**
+     * @brief Close the video file
+     */
+    void Close();
+
+    /**
+     * @brief Frame rate reported by the container (0 if unknown)
+     */
+    double Fps() const { return m_fps; }
+
+    /**
+     * @brief Frame count reported by the container (may be an estimate, 0 if unknown)
+     */
+    int64_t FrameCount() const { return m_frameCount; }
+
+    /**
+     * @brief Form the path used to identify a frame in results, e.g. "/data/cam1.mp4/frame_000120",
+     *        so the stem of the path names the frame
+     * @param videoPath Path of the video file
+     * @param frameIndex Zero based frame number
+     * @return Frame path
+     */
+    static std::string FramePath( const std::string &videoPath, const int64_t frameIndex );
+
+private:
+    cv::VideoCapture m_capture;
+    int m_frameStep;
+    int64_t m_nextIndex;
+    int64_t m_startSecs;
+    int64_t m_frameCount;
+    double m_fps;
+};
+
+} // namespace gc
+
+#endif // VIDEOSOURCE_H
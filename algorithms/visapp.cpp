@@ -28,6 +28,10 @@
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/exception/diagnostic_information.hpp>
 #include "timestampconvert.h"
+#include "resultsink.h"
+#include "resultlog.h"
+#include "stagetimer.h"
+#include "memorybudget.h"
 
 using namespace cv;
 using namespace std;
@@ -294,9 +298,14 @@ GC_STATUS VisApp::AdjustSearchAreaForMovement( const std::vector< LineEnds > &se
     return retVal;
 }
 GC_STATUS VisApp::CalcFindLine( const Mat &img, FindLineResult &result )
+{
+    GC_STATUS retVal = CalcFindLine( m_calibExec, m_findLine, img, result );
+    return retVal;
+}
+GC_STATUS VisApp::CalcFindLine( CalibExecutive &calibExec, FindLine &findLine, const Mat &img, FindLineResult &result )
 {
     GC_STATUS retVal = GC_OK;
-    if ( !m_calibExec.isCalibrated() )
+    if ( !calibExec.isCalibrated() )
     {
         result.msgs.push_back( "Find line failure: System not calibrated" );
         retVal = GC_ERR;
@@ -309,65 +318,70 @@ GC_STATUS VisApp::CalcFindLine( const Mat &img, FindLineResult &result )
             snprintf( buffer, 256, "Timestamp: %s", result.timestamp.c_str() );
             result.msgs.push_back( buffer );
 
+            // the calibration and the line find share one grayscale conversion of the frame
+            FrameContext frame( img );
+            Mat gray;
+            retVal = frame.Gray( gray );
+
             vector< LineEnds > searchLinesAdj;
             if ( GC_OK == retVal )
             {
                 string err_msg;
                 double rmseDist, rmseX, rmseY;
-                retVal = m_calibExec.Calibrate( img, m_calibExec.CalibModel().controlJson, rmseDist, rmseX, rmseY, err_msg );
+                retVal = calibExec.Calibrate( gray, calibExec.CalibModel().controlJson, rmseDist, rmseX, rmseY, err_msg );
                 if ( GC_OK != retVal )
                 {
                     result.msgs.push_back( "Octagon calibration failed" );
                 }
                 else
                 {
-                    result.octoCenter = m_calibExec.CalibModel().OctoCenterPixel;
-                    Rect roi = m_calibExec.TargetRoi();
+                    result.octoCenter = calibExec.CalibModel().OctoCenterPixel;
+                    result.foundCalPts = calibExec.CalibModel().pixelPoints;
+                    Rect roi = calibExec.TargetRoi();
                     Point2d searchROICenter( ( roi.x + roi.width / 2.0 ), ( roi.y + roi.height / 2.0 ) );
-                    retVal = AdjustSearchAreaForMovement( m_calibExec.SearchLines(), searchLinesAdj, searchROICenter, result.octoCenter );
+                    retVal = AdjustSearchAreaForMovement( calibExec.SearchLines(), searchLinesAdj, searchROICenter, result.octoCenter );
                     if ( GC_OK == retVal )
                     {
-                        retVal = m_calibExec.SetAdjustedSearchROI( searchLinesAdj );
+                        retVal = calibExec.SetAdjustedSearchROI( searchLinesAdj );
                     }
                 }
             }
             else
             {
                 result.findSuccess = false;
-                result.msgs.push_back( "Invalid target type for line find" );
-                FILE_LOG( logERROR ) << "[VisApp::CalcLine] Invalid target typefor line find";
+                result.msgs.push_back( "Invalid image type for line find" );
+                FILE_LOG( logERROR ) << "[VisApp::CalcLine] Invalid image type for line find";
                 retVal = GC_ERR;
             }
 
             if ( GC_OK == retVal )
             {
-                retVal = m_findLine.Find( img, searchLinesAdj, result );
+                retVal = findLine.Find( frame, searchLinesAdj, result );
                 if ( GC_OK != retVal )
                 {
-                    m_findLineResult = result;
                     result.msgs.push_back( "Could not perform find with provided image and calibration" );
                     FILE_LOG( logERROR ) << "[VisApp::CalcLine] Could not perform find with provided image and calibration";
                     retVal = GC_ERR;
                 }
                 else
                 {
-                    if ( "Octagon" == m_calibExec.GetCalibType() )
+                    if ( "Octagon" == calibExec.GetCalibType() )
                     {
-                        retVal = m_calibExec.AdjustOctagonForRotation( img.size(), result.calcLinePts, result.symbolToWaterLineAngle );
+                        retVal = calibExec.AdjustOctagonForRotation( img.size(), result.calcLinePts, result.symbolToWaterLineAngle );
                     }
                     if ( GC_OK == retVal )
                     {
                         result.msgs.push_back( "FindStatus: " + string( GC_OK == retVal ? "SUCCESS" : "FAIL" ) );
 
-                        retVal = PixelToWorld( result.calcLinePts );
+                        retVal = PixelToWorld( calibExec, result.calcLinePts );
                         if ( GC_OK != retVal )
                         {
                             result.msgs.push_back( "Could not calculate world coordinates for found line points" );
                         }
                         else
                         {
-                            // snprintf( buffer, 256, "%s/waterline angle diff: %.3f", m_calibExec.GetCalibType().c_str(), result.symbolToWaterLineAngle );
-                            snprintf( buffer, 256, "CalibType: %s", m_calibExec.GetCalibType().c_str() );
+                            // snprintf( buffer, 256, "%s/waterline angle diff: %.3f", calibExec.GetCalibType().c_str(), result.symbolToWaterLineAngle );
+                            snprintf( buffer, 256, "CalibType: %s", calibExec.GetCalibType().c_str() );
                             result.msgs.push_back( buffer );
 
                             result.calcLinePts.angleWorld = atan2( result.calcLinePts.rgtWorld.y - result.calcLinePts.lftWorld.y,
@@ -379,7 +393,7 @@ GC_STATUS VisApp::CalcFindLine( const Mat &img, FindLineResult &result )
                             result.msgs.push_back( buffer );
 
                             Point2d reprojectPt;
-                            retVal = WorldToPixel( result.calcLinePts.ctrWorld, reprojectPt );
+                            retVal = calibExec.WorldToPixel( result.calcLinePts.ctrWorld, reprojectPt );
                             if ( GC_OK == retVal )
                             {
                                 result.calibReprojectOffset_x = result.calcLinePts.ctrPixel.x - reprojectPt.x;
@@ -460,40 +474,41 @@ GC_STATUS VisApp::CalcLine( const Mat &img, const string timestamp, const bool i
 
     return retVal;
 }
-GC_STATUS VisApp::SearchLineRoiResultToJsonString( const bool findSuccess, const cv::Rect roi, const std::vector< cv::Point > maskPoly,
-                                                   const std::vector< cv::Point > waterPoly, std::string &resultJson )
+GC_STATUS VisApp::SearchLineRoiResultToJsonString( const bool findSuccess, const cv::Rect roi, const std::vector< cv::Point > &maskPoly,
+                                                   const std::vector< cv::Point > &waterPoly, std::string &resultJson )
 {
     GC_STATUS retVal = GC_OK;
     try
     {
-        stringstream ss;
+        thread_local JsonWriter json;
+        json.Clear();
+        json.BeginObject();
         if ( 4 != maskPoly.size() )
         {
-            ss << "{\"STATUS\":\"FAILURE -- Invalid mask polyline point count\"}";
+            json.Member( "STATUS", "FAILURE -- Invalid mask polyline point count" );
         }
         else if ( 4 != waterPoly.size() )
         {
-            ss << "{\"STATUS\":\"FAILURE -- Invalid water polyline point count\"}";
+            json.Member( "STATUS", "FAILURE -- Invalid water polyline point count" );
         }
         else
         {
-            resultJson.clear();
-            ss << "{\"STATUS\": " << ( findSuccess ? "\"SUCCESS\"," : "\"FAILURE\"," );
-            ss << "\"ROI\":{";
-            ss << "\"left\":" << roi.x << ", \"top\":" << roi.y << ",";
-            ss << "\"width\":" << roi.width << ", \"height\":" << roi.height << "},";
-            ss << "\"mask_poly_points\":[";
-            ss << "{\"x\":" << maskPoly[0].x << ",\"y\":" << maskPoly[0].y << "},";
-            ss << "{\"x\":" << maskPoly[1].x << ",\"y\":" << maskPoly[1].y << "},";
-            ss << "{\"x\":" << maskPoly[2].x << ",\"y\":" << maskPoly[2].y << "},";
-            ss << "{\"x\":" << maskPoly[3].x << ",\"y\":" << maskPoly[3].y << "}],";
-            ss << "\"water_poly_points\":[";
-            ss << "{\"x\":" << waterPoly[0].x << ",\"y\":" << waterPoly[0].y << "},";
-            ss << "{\"x\":" << waterPoly[1].x << ",\"y\":" << waterPoly[1].y << "},";
-            ss << "{\"x\":" << waterPoly[2].x << ",\"y\":" << waterPoly[2].y << "},";
-            ss << "{\"x\":" << waterPoly[3].x << ",\"y\":" << waterPoly[3].y << "}]}";
+            json.Member( "STATUS", findSuccess ? "SUCCESS" : "FAILURE" );
+            json.Key( "ROI" ).BeginObject();
+            json.Member( "left", roi.x ).Member( "top", roi.y );
+            json.Member( "width", roi.width ).Member( "height", roi.height );
+            json.EndObject();
+            json.Key( "mask_poly_points" ).BeginArray();
+            for ( const auto &pt : maskPoly )
+                json.BeginObject().Member( "x", pt.x ).Member( "y", pt.y ).EndObject();
+            json.EndArray();
+            json.Key( "water_poly_points" ).BeginArray();
+            for ( const auto &pt : waterPoly )
+                json.BeginObject().Member( "x", pt.x ).Member( "y", pt.y ).EndObject();
+            json.EndArray();
         }
-        resultJson = ss.str();
+        json.EndObject();
+        resultJson.assign( json.data(), json.size() );
     }
     catch( std::exception &e )
     {
@@ -502,69 +517,94 @@ GC_STATUS VisApp::SearchLineRoiResultToJsonString( const bool findSuccess, const
     }
     return retVal;
 }
-GC_STATUS VisApp::ResultToJsonString( const FindLineResult result, const FindLineParams params, std::string &resultJson )
+GC_STATUS VisApp::ResultToJsonString( const FindLineResult &result, const FindLineParams &params, std::string &resultJson )
+{
+    // one writer per thread, so after the first few images the json is formed without allocating
+    thread_local JsonWriter json;
+    GC_STATUS retVal = ResultToJson( result, params, json );
+    if ( GC_OK == retVal )
+    {
+        resultJson.assign( json.data(), json.size() );
+    }
+    return retVal;
+}
+GC_STATUS VisApp::ResultToJson( const FindLineResult &result, const FindLineParams &params, JsonWriter &json )
 {
     GC_STATUS retVal = GC_OK;
     try
     {
-        stringstream ss;
-        resultJson.clear();
-        ss << "{\"STATUS\": " << ( result.findSuccess ? "\"SUCCESS\"," : "\"FAILURE\"," );
-        ss << "\"image_path\": \"" << params.imagePath << "\",";
-        ss << "\"calib_path\": \"" << params.calibFilepath << "\",";
-        ss << "\"result_path\": \"" << params.resultImagePath << "\",";
-        ss << "\"timestamp_type\": \"" << params.timeStampType << "\",";
-        ss << "\"timestamp_format\": \"" << params.timeStampFormat << "\",";
-        ss << "\"timestamp_start_pos\": " << params.timeStampStartPos << ",";
-        ss << "\"timestamp_length\": " << params.timeStampStartPos << ",";
-        ss << "\"timestamp\": \"" << result.timestamp << "\",";
-        if ( GC_OK == retVal )
-        {
-            ss << "\"searchROICenter_x\": " << result.octoToSearchROIOffsetPixel << ",";
-            ss << "\"searchROICenter_y\": " << result.octoToSearchROIOffsetWorld << ",";
-            ss << "\"octagonCenter_x\": " << result.octoCenter.x << ",";
-            ss << "\"octagonCenter_y\": " << result.octoCenter.y << ",";
+        json.Clear();
+        json.BeginObject();
+        json.Member( "STATUS", result.findSuccess ? "SUCCESS" : "FAILURE" );
+        json.Member( "image_path", params.imagePath );
+        json.Member( "calib_path", params.calibFilepath );
+        json.Member( "result_path", params.resultImagePath );
+        // quoted, as the stream output wrote it
+        json.Member( "timestamp_type", std::to_string( static_cast< int >( params.timeStampType ) ) );
+        json.Member( "timestamp_format", params.timeStampFormat );
+        json.Member( "timestamp_start_pos", params.timeStampStartPos );
+        // the timestamp is as long as its format (see GcTimestampConvert::GetTimestampFromString)
+        json.Member( "timestamp_length", static_cast< int >( params.timeStampFormat.size() ) );
+        json.Member( "timestamp", result.timestamp );
 
-            ss << "\"pixel_line_left_x\": " << result.calcLinePts.lftPixel.x << ",";
-            ss << "\"pixel_line_left_y\": " << result.calcLinePts.lftPixel.y << ",";
-            ss << "\"pixel_line_center_x\": " << result.calcLinePts.ctrPixel.x << ",";
-            ss << "\"pixel_line_center_y\": " << result.calcLinePts.ctrPixel.y << ",";
-            ss << "\"pixel_line_right_x\": " << result.calcLinePts.rgtPixel.x << ",";
-            ss << "\"pixel_line_right_y\": " << result.calcLinePts.rgtPixel.y << ",";
-            ss << "\"pixel_line_angle\": " << result.calcLinePts.anglePixel << ",";
+        json.Member( "searchROICenter_x", result.octoToSearchROIOffsetPixel );
+        json.Member( "searchROICenter_y", result.octoToSearchROIOffsetWorld );
+        json.Member( "octagonCenter_x", result.octoCenter.x );
+        json.Member( "octagonCenter_y", result.octoCenter.y );
 
-            ss << "\"world_line_left_x\": " << result.calcLinePts.lftWorld.x << ",";
-            ss << "\"world_line_left_y\": " << result.calcLinePts.lftWorld.y << ",";
-            ss << "\"world_line_center_x\": " << result.calcLinePts.ctrWorld.x << ",";
-            ss << "\"world_line_center_y\": " << result.calcLinePts.ctrWorld.y << ",";
-            ss << "\"world_line_right_x\": " << result.calcLinePts.rgtWorld.x << ",";
-            ss << "\"world_line_right_y\": " << result.calcLinePts.rgtWorld.y << ",";
-            ss << "\"world_line_angle\": " << result.calcLinePts.angleWorld << ",";
+        json.Member( "pixel_line_left_x", result.calcLinePts.lftPixel.x );
+        json.Member( "pixel_line_left_y", result.calcLinePts.lftPixel.y );
+        json.Member( "pixel_line_center_x", result.calcLinePts.ctrPixel.x );
+        json.Member( "pixel_line_center_y", result.calcLinePts.ctrPixel.y );
+        json.Member( "pixel_line_right_x", result.calcLinePts.rgtPixel.x );
+        json.Member( "pixel_line_right_y", result.calcLinePts.rgtPixel.y );
+        json.Member( "pixel_line_angle", result.calcLinePts.anglePixel );
 
-            ss << "\"found_pts\": [";
-            for ( size_t i = 0; i < result.foundPoints.size(); ++i )
+        json.Member( "world_line_left_x", result.calcLinePts.lftWorld.x );
+        json.Member( "world_line_left_y", result.calcLinePts.lftWorld.y );
+        json.Member( "world_line_center_x", result.calcLinePts.ctrWorld.x );
+        json.Member( "world_line_center_y", result.calcLinePts.ctrWorld.y );
+        json.Member( "world_line_right_x", result.calcLinePts.rgtWorld.x );
+        json.Member( "world_line_right_y", result.calcLinePts.rgtWorld.y );
+        json.Member( "world_line_angle", result.calcLinePts.angleWorld );
+
+        json.Key( "found_pts" ).BeginArray();
+        for ( const auto &pt : result.foundPoints )
+        {
+            json.BeginObject().Member( "x", pt.x ).Member( "y", pt.y ).EndObject();
+        }
+        json.EndArray();
+
+        if ( !result.stageTimes.empty() )
+        {
+            json.Key( "stage_ms" ).BeginObject();
+            for ( const auto &stage : result.stageTimes )
             {
-                ss << "{\"x\": " << result.foundPoints[ i ].x << ",";
-                ss <<  "\"y\": " << result.foundPoints[ i ].y << "}";
-                if ( result.foundPoints.size() - 1 != i )
-                    ss << ",";
+                json.Member( stage.first, stage.second );
             }
-            ss << "],";
+            json.EndObject();
         }
-        ss << "\"messages\": [";
-        for ( size_t i = 0; i < result.msgs.size(); ++i )
+        if ( !result.stageMemory.stageBytes.empty() )
         {
-            ss << "\"" << result.msgs[ i ] << "\"";
-            if ( result.msgs.size() - 1 != i )
-                ss << ",";
+            json.Key( "stage_bytes" ).BeginObject();
+            for ( const auto &stage : result.stageMemory.stageBytes )
+            {
+                json.Member( stage.first, static_cast< int64_t >( stage.second ) );
+            }
+            json.EndObject();
+            json.Member( "peak_bytes", static_cast< int64_t >( result.stageMemory.peakBytes ) );
         }
-        ss << "]";
-        ss << "}";
-        resultJson = ss.str();
+        json.Key( "messages" ).BeginArray();
+        for ( const auto &msg : result.msgs )
+        {
+            json.Value( msg );
+        }
+        json.EndArray();
+        json.EndObject();
     }
     catch( std::exception &e )
     {
-        FILE_LOG( logERROR ) << "[VisApp::ResultToJsonString] " << e.what();
+        FILE_LOG( logERROR ) << "[VisApp::ResultToJson] " << e.what();
         FILE_LOG( logERROR ) << "Image=" << params.imagePath << " calib=" << params.calibFilepath;
         retVal = GC_EXCEPT;
     }
@@ -592,11 +632,54 @@ GC_STATUS VisApp::CalcLine( const FindLineParams params, FindLineResult &result
     try
     {
         result.clear();
+        GC_STAGE_SINK( result.stageTimes );
         m_findLineResult.clear();
-        cv::Mat img = imread( params.imagePath, IMREAD_COLOR );
+        cv::Mat img;
+        retVal = ReadFindLineImage( params, img, result );
+        if ( GC_OK == retVal )
+        {
+            retVal = CalcLine( img, params, result );
+            if ( !params.resultCSVPath.empty() )
+            {
+                WriteFindlineResultToCSV( params.resultCSVPath, params.imagePath, result );
+            }
+            if ( !params.resultLogPath.empty() )
+            {
+                ResultLogWriter logWriter;
+                if ( GC_OK == logWriter.Open( params.resultLogPath ) )
+                {
+                    logWriter.Append( params.imagePath, result );
+                }
+            }
+            if ( !params.resultImagePath.empty() || !params.lineSearchROIFolder.empty() )
+            {
+                GC_STATUS retSave = SaveFindLineImages( img, params, result );
+                retVal = GC_OK == retVal ? retSave : retVal;
+            }
+        }
+    }
+    catch( Exception &e )
+    {
+        FILE_LOG( logERROR ) << "[VisApp::CalcLine] " << e.what();
+        FILE_LOG( logERROR ) << "Image=" << params.imagePath << " calib=" << params.calibFilepath;
+        retVal = GC_EXCEPT;
+    }
+
+    return retVal;
+}
+GC_STATUS VisApp::ReadFindLineImage( const FindLineParams params, cv::Mat &img, FindLineResult &result )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        GC_STAGE_SINK( result.stageTimes );
+        {
+            GC_STAGE_TIMER( "read" );
+            img = imread( params.imagePath, IMREAD_COLOR );
+        }
         if ( img.empty() )
         {
-            FILE_LOG( logERROR ) << "[VisApp::CalcLine] Empty image=" << params.imagePath ;
+            FILE_LOG( logERROR ) << "[VisApp::ReadFindLineImage] Empty image=" << params.imagePath ;
             retVal = GC_ERR;
         }
         else
@@ -609,7 +692,10 @@ GC_STATUS VisApp::CalcLine( const FindLineParams params, FindLineResult &result
             else if ( FROM_EXIF == params.timeStampType )
             {
                 string timestampTemp;
-                retVal = GetImageTimestamp( params.imagePath, timestampTemp );
+                {
+                    GC_STAGE_TIMER( "exif_timestamp" );
+                    retVal = GetImageTimestamp( params.imagePath, timestampTemp );
+                }
                 if ( GC_OK == retVal )
                 {
                     retVal = GcTimestampConvert::GetTimestampFromString( timestampTemp, params.timeStampStartPos,
@@ -628,90 +714,223 @@ GC_STATUS VisApp::CalcLine( const FindLineParams params, FindLineResult &result
             }
             else
             {
-                if ( GC_OK == retVal )
-                {
-                    if ( params.isOctagonCalib || ( params.calibFilepath != m_calibFilepath && !params.isOctagonCalib ) )
-                    {
-                        // retVal = m_calibExec.isCalibrated() ? m_calibExec.LoadFromJsonString() : m_calibExec.Load( params.calibFilepath );
-                        retVal = m_calibExec.Load( params.calibFilepath );
-                        if ( GC_OK != retVal )
-                        {
-                            result.calibSuccess = false;
-                            result.msgs.push_back( "Could not load calibration" );
-                            FILE_LOG( logERROR ) << "[VisApp::CalcLine] Could not load calibration=" << params.calibFilepath ;
-                            retVal = GC_ERR;
-                        }
-                    }
-                }
-                if ( GC_OK == retVal)
-                {
-                    retVal = GetIllumination( params.imagePath, result.illum_state );
-                    m_calibFilepath = params.calibFilepath;
+                GC_STAGE_TIMER( "illumination" );
+                GetIllumination( params.imagePath, result.illum_state );
+            }
+        }
+    }
+    catch( Exception &e )
+    {
+        FILE_LOG( logERROR ) << "[VisApp::ReadFindLineImage] " << e.what();
+        FILE_LOG( logERROR ) << "Image=" << params.imagePath;
+        retVal = GC_EXCEPT;
+    }
 
-                    retVal = CalcFindLine( img, result );
-                    if ( GC_OK == retVal )
-                    {
+    return retVal;
+}
+GC_STATUS VisApp::DecodeFindLineImage( const std::vector< uchar > &buffer, const FindLineParams params, cv::Mat &img, FindLineResult &result )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        GC_STAGE_SINK( result.stageTimes );
+        {
+            GC_STAGE_TIMER( "decode" );
+            img = imdecode( buffer, IMREAD_COLOR );
+        }
+        if ( img.empty() )
+        {
+            FILE_LOG( logERROR ) << "[VisApp::DecodeFindLineImage] Could not decode image=" << params.imagePath;
+            retVal = GC_ERR;
+        }
+        else if ( FROM_FILENAME != params.timeStampType )
+        {
+            FILE_LOG( logERROR ) << "[VisApp::DecodeFindLineImage] In-memory images need filename timestamps";
+            result.msgs.push_back( "Timestamp failure. Only filename timestamps are available for in-memory images" );
+            retVal = GC_ERR;
+        }
+        else
+        {
+            retVal = GcTimestampConvert::GetTimestampFromString( fs::path( params.imagePath ).filename().string(),
+                                                                 params.timeStampStartPos, params.timeStampFormat, result.timestamp );
+            if ( GC_OK != retVal )
+            {
+                result.msgs.push_back( "Timestamp failure. Check source, format, and start position of timestamp" );
+            }
+            result.illum_state = "N/A";
+        }
+    }
+    catch( Exception &e )
+    {
+        FILE_LOG( logERROR ) << "[VisApp::DecodeFindLineImage] " << e.what();
+        FILE_LOG( logERROR ) << "Image=" << params.imagePath;
+        retVal = GC_EXCEPT;
+    }
 
-                    }
-                    else
-                    {
-                        result.findSuccess = false;
-                        FILE_LOG( logERROR ) << "[VisApp::CalcLine] Could not calc line in image";
-                        retVal = GC_ERR;
-                    }
-                }
-                m_findLineResult = result;
-                if ( !params.resultCSVPath.empty() )
+    return retVal;
+}
+GC_STATUS VisApp::CalcLine( const cv::Mat &img, const FindLineParams params, FindLineResult &result )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        GC_STAGE_SINK( result.stageTimes );
+        GC_MEMORY_SINK( result.stageMemory );
+        if ( params.isOctagonCalib || params.calibFilepath != m_calibFilepath )
+        {
+            GC_STAGE_TIMER( "calib_load" );
+            retVal = m_calibExec.LoadCached( params.calibFilepath );
+            if ( GC_OK != retVal )
+            {
+                result.calibSuccess = false;
+                result.msgs.push_back( "Could not load calibration" );
+                FILE_LOG( logERROR ) << "[VisApp::CalcLine] Could not load calibration=" << params.calibFilepath ;
+                retVal = GC_ERR;
+            }
+        }
+        if ( GC_OK == retVal )
+        {
+            m_calibFilepath = params.calibFilepath;
+
+            retVal = CalcFindLine( img, result );
+            if ( GC_OK != retVal )
+            {
+                result.findSuccess = false;
+                FILE_LOG( logERROR ) << "[VisApp::CalcLine] Could not calc line in image";
+                retVal = GC_ERR;
+            }
+        }
+        m_findLineResult = result;
+    }
+    catch( Exception &e )
+    {
+        FILE_LOG( logERROR ) << "[VisApp::CalcLine] " << e.what();
+        FILE_LOG( logERROR ) << "Image=" << params.imagePath << " calib=" << params.calibFilepath;
+        retVal = GC_EXCEPT;
+    }
+
+    return retVal;
+}
+GC_STATUS VisApp::CalcLine( const std::shared_ptr< const CalibrationSnapshot > &snapshot, FindLineContext &context,
+                            const cv::Mat &img, FindLineResult &result )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        GC_STAGE_SINK( result.stageTimes );
+        GC_MEMORY_SINK( result.stageMemory );
+        {
+            GC_STAGE_TIMER( "calib_load" );
+            retVal = context.Bind( snapshot );
+        }
+        if ( GC_OK != retVal )
+        {
+            result.calibSuccess = false;
+            result.msgs.push_back( "Could not load calibration" );
+            FILE_LOG( logERROR ) << "[VisApp::CalcLine] Could not bind calibration snapshot";
+        }
+        else
+        {
+            retVal = CalcFindLine( context.calib, context.findLine, img, result );
+            if ( GC_OK != retVal )
+            {
+                result.findSuccess = false;
+                FILE_LOG( logERROR ) << "[VisApp::CalcLine] Could not calc line in image";
+                retVal = GC_ERR;
+            }
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[VisApp::CalcLine] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+
+    return retVal;
+}
+GC_STATUS VisApp::AttachCalibration( const std::shared_ptr< const CalibrationSnapshot > &snapshot )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( nullptr == snapshot )
+        {
+            FILE_LOG( logERROR ) << "[VisApp::AttachCalibration] No calibration snapshot";
+            retVal = GC_ERR;
+        }
+        else
+        {
+            m_calibExec = snapshot->Calib();
+            retVal = m_calibExec.Restore( snapshot->Calib() );
+            m_calibFilepath = GC_OK == retVal ? snapshot->CalibPath() : "";
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[VisApp::AttachCalibration] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+
+    return retVal;
+}
+GC_STATUS VisApp::SaveFindLineImages( const cv::Mat &img, const FindLineParams params, const FindLineResult &result )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( !params.resultImagePath.empty() )
+        {
+            string resultJson;
+            retVal = ResultToJsonString( result, params, resultJson );
+            if ( GC_OK != retVal )
+            {
+                resultJson = "{\"STATUS\": \"FAILURE -- Could not retrive result json string\"}";
+            }
+            else
+            {
+                Mat color;
+                GC_STATUS retVal1 = GC_OK;
                 {
-                    WriteFindlineResultToCSV( params.resultCSVPath, params.imagePath, result );
+                    GC_STAGE_TIMER( "overlay_draw" );
+                    retVal1 = DrawLineFindOverlay( img, color, result );
                 }
-
-                if ( !params.resultImagePath.empty() )
+                if ( GC_OK == retVal1 )
                 {
-                    string resultJson;
-                    retVal = ResultToJsonString( result, params, resultJson );
-                    if ( GC_OK != retVal )
+                    bool isOk = false;
                     {
-                        resultJson = "{\"STATUS\": \"FAILURE -- Could not retrive result json string\"}";
+                        GC_STAGE_TIMER( "png_encode" );
+                        isOk = imwrite( params.resultImagePath, color );
                     }
-                    else
+                    if ( isOk )
                     {
-                        Mat color;
-                        GC_STATUS retVal1 = DrawLineFindOverlay( img, color, result );
-                        if ( GC_OK == retVal1 )
-                        {
-                            bool isOk = imwrite( params.resultImagePath, color );
-                            if ( isOk )
-                            {
-                                retVal = m_metaData.WriteToImageDescription( params.resultImagePath, resultJson );
-                            }
-                            else
-                            {
-                                FILE_LOG( logERROR ) << "[VisApp::CalcLine] Could not write result image to " << params.resultImagePath;
-                                retVal1 = GC_ERR;
-                            }
-                        }
+                        GC_STAGE_TIMER( "exif_write" );
+                        retVal = m_metaData.WriteToImageDescription( params.resultImagePath, resultJson );
                     }
-                }
-
-                if ( !params.lineSearchROIFolder.empty() )
-                {
-                    string searchROIPath = params.lineSearchROIFolder;
-                    if ( '/' != searchROIPath[ searchROIPath.size() - 1 ] )
+                    else
                     {
-                        searchROIPath += '/';
+                        FILE_LOG( logERROR ) << "[VisApp::SaveFindLineImages] Could not write result image to " << params.resultImagePath;
                     }
-
-                    string outputROIPath = searchROIPath + fs::path( params.imagePath ).stem().string() + "_search_line_roi_and_mask.png";
-                    retVal = SaveLineFindSearchRoi( img, outputROIPath, result );
                 }
             }
         }
+
+        if ( !params.lineSearchROIFolder.empty() )
+        {
+            string searchROIPath = params.lineSearchROIFolder;
+            if ( '/' != searchROIPath[ searchROIPath.size() - 1 ] )
+            {
+                searchROIPath += '/';
+            }
+
+            string outputROIPath = searchROIPath + fs::path( params.imagePath ).stem().string() + "_search_line_roi_and_mask.png";
+            GC_STAGE_TIMER( "search_roi_image" );
+            retVal = SaveLineFindSearchRoi( img, outputROIPath, result );
+        }
     }
     catch( Exception &e )
     {
-        FILE_LOG( logERROR ) << "[VisApp::CalcLine] " << e.what();
-        FILE_LOG( logERROR ) << "Image=" << params.imagePath << " calib=" << params.calibFilepath;
+        FILE_LOG( logERROR ) << "[VisApp::SaveFindLineImages] " << e.what();
+        FILE_LOG( logERROR ) << "Image=" << params.imagePath;
         retVal = GC_EXCEPT;
     }
 
@@ -832,16 +1051,15 @@ GC_STATUS VisApp::WorldToPixel(const cv::Point2d worldPt, cv::Point2d &pixelPt )
     return retVal;
 }
 
-GC_STATUS VisApp::PixelToWorld( FindPointSet &ptSet )
+GC_STATUS VisApp::PixelToWorld( CalibExecutive &calibExec, FindPointSet &ptSet )
 {
-    GC_STATUS retVal = m_calibExec.PixelToWorld( ptSet.ctrPixel, ptSet.ctrWorld );
+    Point2d pts[ 3 ] = { ptSet.ctrPixel, ptSet.lftPixel, ptSet.rgtPixel };
+    GC_STATUS retVal = calibExec.PixelToWorld( pts, pts, 3 );
     if ( GC_OK == retVal )
     {
-        retVal = m_calibExec.PixelToWorld( ptSet.lftPixel, ptSet.lftWorld );
-        if ( GC_OK == retVal )
-        {
-            retVal = m_calibExec.PixelToWorld( ptSet.rgtPixel, ptSet.rgtWorld );
-        }
+        ptSet.ctrWorld = pts[ 0 ];
+        ptSet.lftWorld = pts[ 1 ];
+        ptSet.rgtWorld = pts[ 2 ];
     }
     return retVal;
 }
@@ -889,29 +1107,30 @@ GC_STATUS VisApp::DrawLineFindOverlay( const cv::Mat &img, cv::Mat &imgOut, cons
     GC_STATUS retVal = m_findLine.DrawResult( img, imgOut, findLineResult, overlayTypes );
     return retVal;
 }
-GC_STATUS VisApp::FindPtSet2JsonString( const FindPointSet set, const string set_type, string &json )
+GC_STATUS VisApp::FindPtSet2JsonString( const FindPointSet &set, const string &set_type, string &json )
 {
     GC_STATUS retVal = GC_OK;
     try
     {
-        json.clear();
-        stringstream ss;
-        ss << "\"set_type\": \"" << set_type << "\",";
-        ss << "\"anglePixel\":" << set.anglePixel << ",";
-        ss << "\"angleWorld\":" << set.angleWorld << ",";
-        ss << "\"lftPixel_x\":" << set.lftPixel.x << ",";
-        ss << "\"lftPixel_y\":" << set.lftPixel.y << ",";
-        ss << "\"lftWorld_x\":" << set.lftWorld.x << ",";
-        ss << "\"lftWorld_y\":" << set.lftWorld.y << ",";
-        ss << "\"ctrPixel_x\":" << set.ctrPixel.x << ",";
-        ss << "\"ctrPixel_y\":" << set.ctrPixel.y << ",";
-        ss << "\"ctrWorld_x\":" << set.ctrWorld.x << ",";
-        ss << "\"ctrWorld_y\":" << set.ctrWorld.y << ",";
-        ss << "\"rgtPixel_x\":" << set.rgtPixel.x << ",";
-        ss << "\"rgtPixel_y\":" << set.rgtPixel.y << ",";
-        ss << "\"rgtWorld_x\":" << set.rgtWorld.x << ",";
-        ss << "\"rgtWorld_y\":" << set.rgtWorld.y;
-        json = ss.str();
+        // members only, without braces, to be placed inside an object by the caller
+        thread_local JsonWriter writer;
+        writer.Clear();
+        writer.Member( "set_type", set_type );
+        writer.Member( "anglePixel", set.anglePixel );
+        writer.Member( "angleWorld", set.angleWorld );
+        writer.Member( "lftPixel_x", set.lftPixel.x );
+        writer.Member( "lftPixel_y", set.lftPixel.y );
+        writer.Member( "lftWorld_x", set.lftWorld.x );
+        writer.Member( "lftWorld_y", set.lftWorld.y );
+        writer.Member( "ctrPixel_x", set.ctrPixel.x );
+        writer.Member( "ctrPixel_y", set.ctrPixel.y );
+        writer.Member( "ctrWorld_x", set.ctrWorld.x );
+        writer.Member( "ctrWorld_y", set.ctrWorld.y );
+        writer.Member( "rgtPixel_x", set.rgtPixel.x );
+        writer.Member( "rgtPixel_y", set.rgtPixel.y );
+        writer.Member( "rgtWorld_x", set.rgtWorld.x );
+        writer.Member( "rgtWorld_y", set.rgtWorld.y );
+        json.assign( writer.data(), writer.size() );
     }
     catch( std::exception &e )
     {
@@ -941,70 +1160,14 @@ GC_STATUS VisApp::WriteFindlineResultToCSV( const std::string resultCSV, const s
         }
         else
         {
+            // single row writes, runs over many images should keep a CsvResultSink open instead
+            string csvLines;
             if ( addHeader )
             {
-                csvFile << "imgPath,";
-                csvFile << "findSuccess,";
-
-                csvFile << "timestamp,";
-                csvFile << "illum_state,";
-                csvFile << "waterLevel,";
-                csvFile << "waterLevelAdjusted,";
-                csvFile << "xRMSE, yRMSE, EuclidDistRMSE,";
-
-                csvFile << "waterLine-octagon-angle-diff,";
-                csvFile << "calcLinePts-angle,";
-                csvFile << "calcLinePts-lftPixel-x,"; csvFile << "calcLinePts-lftPixel-y,";
-                csvFile << "calcLinePts-ctrPixel-x,"; csvFile << "calcLinePts-ctrPixel-y,";
-                csvFile << "calcLinePts-rgtPixel-x,"; csvFile << "calcLinePts-rgtPixel-y,";
-                csvFile << "calcLinePts-lftWorld-x,"; csvFile << "calcLinePts-lftWorld-y,";
-                csvFile << "calcLinePts-ctrWorld-x,"; csvFile << "calcLinePts-ctrWorld-y,";
-                csvFile << "calcLinePts-rgtWorld-x,"; csvFile << "calcLinePts-rgtWorld-y,";
-
-                csvFile << "octoCenter-x,"; csvFile << "octoCenter-y,";
-                csvFile << "octoToSearchROIOffset-pixel," << "octoToSearchROIOffset-world,";
-
-                csvFile << "foundPts[0]-x,"; csvFile << "foundPts[0]-y,"; csvFile << "foundPts[1]-x,"; csvFile << "foundPts[1]-y,";
-                csvFile << "foundPts[2]-x,"; csvFile << "foundPts[2]-y,"; csvFile << "foundPts[3]-x,"; csvFile << "foundPts[3]-y,";
-                csvFile << "foundPts[4]-x,"; csvFile << "foundPts[4]-y,"; csvFile << "foundPts[5]-x,"; csvFile << "foundPts[5]-y,";
-                csvFile << "foundPts[6]-x,"; csvFile << "foundPts[6]-y,"; csvFile << "foundPts[7]-x,"; csvFile << "foundPts[7]-y,";
-                csvFile << "foundPts[8]-x,"; csvFile << "foundPts[8]-y,"; csvFile << "foundPts[9]-x,"; csvFile << "foundPts[9]-y,";
-                csvFile << "...";
-                csvFile << endl;
-            }
-            csvFile << imgPath << ",";
-            csvFile << ( result.findSuccess ? "true" : "false" ) << ",";
-            csvFile << result.timestamp << ",";
-            csvFile << result.illum_state << ",";
-
-            csvFile << fixed << setprecision( 3 );
-            csvFile << result.calcLinePts.ctrWorld.y << ",";
-            csvFile << result.waterLevelAdjusted.y << ",";
-
-            csvFile << result.calibReprojectOffset_x << ",";
-            csvFile << result.calibReprojectOffset_y << ",";
-            csvFile << result.calibReprojectOffset_dist << ",";
-
-            csvFile << result.symbolToWaterLineAngle << ",";
-
-            csvFile << result.calcLinePts.angleWorld << ",";
-            csvFile << result.calcLinePts.lftPixel.x << ","; csvFile << result.calcLinePts.lftPixel.y << ",";
-            csvFile << result.calcLinePts.ctrPixel.x << ","; csvFile << result.calcLinePts.ctrPixel.y << ",";
-            csvFile << result.calcLinePts.rgtPixel.x << ","; csvFile << result.calcLinePts.rgtPixel.y << ",";
-            csvFile << result.calcLinePts.lftWorld.x << ","; csvFile << result.calcLinePts.lftWorld.y << ",";
-            csvFile << result.calcLinePts.ctrWorld.x << ","; csvFile << result.calcLinePts.ctrWorld.y << ",";
-            csvFile << result.calcLinePts.rgtWorld.x << ","; csvFile << result.calcLinePts.rgtWorld.y << ",";
-
-            csvFile << result.octoCenter.x << ","; csvFile << result.octoCenter.y << ",";
-            csvFile << result.octoToSearchROIOffsetPixel << ","; csvFile << result.octoToSearchROIOffsetWorld << ",";
-
-            for ( size_t i = 0; i < result.foundPoints.size(); ++i )
-            {
-                csvFile << result.foundPoints[ i ].x << ","; csvFile << result.foundPoints[ i ].y;
-                if ( result.foundPoints.size() - 1 > i )
-                    csvFile << ",";
+                CsvResultSink::FormatHeader( csvLines );
             }
-            csvFile << endl;
+            CsvResultSink::FormatRow( imgPath, result, csvLines );
+            csvFile << csvLines;
         }
     }
     catch( Exception &e )
@@ -30,10 +30,12 @@
 #define VISAPP_H
 
 #include "calibexecutive.h"
+#include "calibsnapshot.h"
 #include "findline.h"
 #include "metadata.h"
 #include "animate.h"
 #include "gc_types.h"
+#include "jsonwriter.h"
 
 //! GaugeCam classes, functions and variables
 namespace gc
@@ -132,9 +134,18 @@ public:
     GC_STATUS DrawCalibOverlay( const cv::Mat matIn, cv::Mat &imgMatOut, const bool drawCalibScale,
                                 const bool drawCalibGrid, const bool drawSearchROI, const bool drawTargetROI );
     GC_STATUS DrawAssocPts( const cv::Mat &img, cv::Mat &overlay, std::string &err_msg );
-    GC_STATUS ResultToJsonString( const FindLineResult result, const FindLineParams params, std::string &resultJson );
-    GC_STATUS SearchLineRoiResultToJsonString( const bool findSuccess, const cv::Rect roi, const std::vector<cv::Point> maskPoly,
-                                               const std::vector<cv::Point> waterPoly, std::string &resultJson );
+    GC_STATUS ResultToJsonString( const FindLineResult &result, const FindLineParams &params, std::string &resultJson );
+
+    /**
+     * @brief Form the json of a line find result in a writer, for callers that keep their own buffer
+     * @param result Line find result
+     * @param params Line find parameters
+     * @param json Writer to hold the json, cleared first
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS ResultToJson( const FindLineResult &result, const FindLineParams &params, JsonWriter &json );
+    GC_STATUS SearchLineRoiResultToJsonString( const bool findSuccess, const cv::Rect roi, const std::vector<cv::Point> &maskPoly,
+                                               const std::vector<cv::Point> &waterPoly, std::string &resultJson );
 
     // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     // Findline methods
@@ -174,6 +185,75 @@ public:
      */
     GC_STATUS CalcLine( const FindLineParams params, FindLineResult &result, std::string &resultJson );
 
+    /**
+     * @brief Read the image specified in the FindLineParams and retrieve its timestamp and illumination
+     *        state. This is the i/o bound first step of CalcLine( params, result ) and can be run on a
+     *        different thread than the line find
+     * @param params Holds the image filepath and the timestamp parameters
+     * @param img OpenCV mat to hold the decoded image
+     * @param result Receives the timestamp, illumination state, and failure messages
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS ReadFindLineImage( const FindLineParams params, cv::Mat &img, FindLineResult &result );
+
+    /**
+     * @brief Decode an encoded image that is already in memory (e.g. a tar archive entry) and take its
+     *        timestamp from the filename part of params.imagePath. The counterpart of ReadFindLineImage()
+     *        for images that are not files, so EXIF timestamps and illumination are not available
+     * @param buffer Encoded .png or .jpg image bytes
+     * @param params Holds the image path and the timestamp parameters
+     * @param img OpenCV mat to hold the decoded image
+     * @param result Receives the timestamp and failure messages
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS DecodeFindLineImage( const std::vector< uchar > &buffer, const FindLineParams params, cv::Mat &img, FindLineResult &result );
+
+    /**
+     * @brief Find the water level in an image that has already been read with ReadFindLineImage(). The
+     *        calibration is loaded from params.calibFilepath when needed. No result files are written
+     * @param img OpenCV mat image to search for the waterline
+     * @param params Holds the calibration filepath and all other parameters need to perform a line find calculation
+     * @param result Holds the results of the line find calculation (timestamp already set by ReadFindLineImage())
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS CalcLine( const cv::Mat &img, const FindLineParams params, FindLineResult &result );
+
+    /**
+     * @brief Find the water level in an image against a shared calibration. Reentrant: it touches no
+     *        VisApp state, so any number of threads can call it with the same snapshot as long as
+     *        each uses its own context. No result files are written
+     * @param snapshot Calibration to find the line against
+     * @param context Per request state, reused from one image to the next by the calling thread
+     * @param img OpenCV mat image to search for the waterline
+     * @param result Holds the results of the line find calculation (timestamp already set by ReadFindLineImage())
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    static GC_STATUS CalcLine( const std::shared_ptr< const CalibrationSnapshot > &snapshot, FindLineContext &context,
+                               const cv::Mat &img, FindLineResult &result );
+
+    /**
+     * @brief Use a shared calibration instead of loading it from its file. Later calls to
+     *        CalcLine( img, params, result ) with the snapshot calibration path do not read the file
+     * @param snapshot Calibration to copy (the octagon search templates are shared, not copied)
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS AttachCalibration( const std::shared_ptr< const CalibrationSnapshot > &snapshot );
+
+    /**
+     * @brief Sets how much of a frame the line find preprocesses (see FindLine::SetMemoryMode)
+     * @param mode GC_MEMORY_FULL=Whole frame, GC_MEMORY_ROI=Only the region around the search lines
+     */
+    void SetMemoryMode( const GC_MEMORY_MODE mode ) { m_findLine.SetMemoryMode( mode ); }
+
+    /**
+     * @brief Write the optional overlay image and line search roi image specified in the FindLineParams
+     * @param img OpenCV mat image that was searched for the waterline
+     * @param params Holds the result image filepath and line search roi folder (either can be empty)
+     * @param result Line find result to draw
+     * @return GC_OK=Success, GC_FAIL=Failure, GC_EXCEPT=Exception thrown
+     */
+    GC_STATUS SaveFindLineImages( const cv::Mat &img, const FindLineParams params, const FindLineResult &result );
+
     /**
      * @brief Get image exif data used by GaugeCam as a human readable std::string
      * @param filepath Filepath of the image from which to retrieve the exif dat
@@ -277,10 +357,11 @@ private:
     Animate m_animate;
 
     GC_STATUS CalcFindLine( const cv::Mat &img, FindLineResult &result );
-    GC_STATUS AdjustSearchAreaForMovement( const std::vector< LineEnds > &searchLines, std::vector< LineEnds > &searchLinesAdj,
-                                           const cv::Point2d searchROIcenter , const cv::Point2d octoCenter);
-    GC_STATUS PixelToWorld( FindPointSet &ptSet );
-    GC_STATUS FindPtSet2JsonString( const FindPointSet set, const std::string set_type, std::string &json );
+    static GC_STATUS CalcFindLine( CalibExecutive &calibExec, FindLine &findLine, const cv::Mat &img, FindLineResult &result );
+    static GC_STATUS AdjustSearchAreaForMovement( const std::vector< LineEnds > &searchLines, std::vector< LineEnds > &searchLinesAdj,
+                                                  const cv::Point2d searchROIcenter , const cv::Point2d octoCenter);
+    static GC_STATUS PixelToWorld( CalibExecutive &calibExec, FindPointSet &ptSet );
+    GC_STATUS FindPtSet2JsonString( const FindPointSet &set, const std::string &set_type, std::string &json );
     GC_STATUS SaveLineFindSearchRoi(const cv::Mat &img, const std::string resultImgPath, const FindLineResult result );
     GC_STATUS LineIntersection( const LineEnds line1, const LineEnds line2, cv::Point2d &r );
 };
@@ -46,13 +46,19 @@ win32 {
 
 SOURCES += \
     ../algorithms/animate.cpp \
+    ../algorithms/calibcache.cpp \
+    ../algorithms/calibsnapshot.cpp \
     ../algorithms/calibexecutive.cpp \
     ../algorithms/caliboctagon.cpp \
     ../algorithms/findline.cpp \
+    ../algorithms/framecontext.cpp \
     ../algorithms/gifanim/gifanim.cpp \
+    ../algorithms/memorybudget.cpp \
     ../algorithms/metadata.cpp \
     ../algorithms/octagonsearch.cpp \
     ../algorithms/octorefine.cpp \
+    ../algorithms/resultlog.cpp \
+    ../algorithms/resultsink.cpp \
     ../algorithms/searchlines.cpp \
     ../algorithms/visapp.cpp \
     guivisapp.cpp \
@@ -63,18 +69,27 @@ SOURCES += \
 HEADERS += \
     ../algorithms/animate.h \
     ../algorithms/bresenham.h \
+    ../algorithms/calibcache.h \
+    ../algorithms/calibsnapshot.h \
     ../algorithms/calibexecutive.h \
     ../algorithms/caliboctagon.h \
     ../algorithms/csvreader.h \
     ../algorithms/findline.h \
+    ../algorithms/framecontext.h \
     ../algorithms/gc_types.h \
+    ../algorithms/homography.h \
+    ../algorithms/jsonwriter.h \
     ../algorithms/gifanim/gifanim.h \
     ../algorithms/labelroi.h \
     ../algorithms/log.h \
+    ../algorithms/memorybudget.h \
     ../algorithms/metadata.h \
     ../algorithms/octagonsearch.h \
     ../algorithms/octorefine.h \
+    ../algorithms/resultlog.h \
+    ../algorithms/resultsink.h \
     ../algorithms/searchlines.h \
+    ../algorithms/stagetimer.h \
     ../algorithms/timestampconvert.h \
     ../algorithms/visapp.h \
     ../algorithms/wincmd.h \
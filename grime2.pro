@@ -1,2 +1,6 @@
 TEMPLATE = subdirs
-SUBDIRS = grime2cli gcgui
+SUBDIRS = grime2cli gcgui grime2bench libgrime2 grime2test
+
+# the python module is only built when pybind11 is installed for the default python
+PYBIND11_CFLAGS = $$system(python3 -m pybind11 --includes)
+!isEmpty(PYBIND11_CFLAGS): SUBDIRS += grime2py
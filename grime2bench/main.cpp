@@ -0,0 +1,445 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <functional>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include "../algorithms/log.h"
+#include "../algorithms/visapp.h"
+#include "../algorithms/findline.h"
+#include "../algorithms/caliboctagon.h"
+#include "../algorithms/octagonsearch.h"
+#include "../algorithms/octorefine.h"
+
+#ifndef GRIME2BENCH_DATA_DIR
+#define GRIME2BENCH_DATA_DIR "./config"
+#endif
+#ifndef GRIME2BENCH_GIT_REV
+#define GRIME2BENCH_GIT_REV "unknown"
+#endif
+
+using namespace cv;
+using namespace std;
+using namespace gc;
+
+static const int PIXEL_TO_WORLD_POINTS = 10000;
+
+/**
+ * @brief Settings of a benchmark run
+ */
+class BenchConfig
+{
+public:
+    BenchConfig() :
+        imagePath( string( GRIME2BENCH_DATA_DIR ) + "/2022_demo/20220715_KOLA_GaugeCam_001.JPG" ),
+        calibPath( string( GRIME2BENCH_DATA_DIR ) + "/calib.json" ),
+        warmup( 3 ),
+        reps( 20 )
+    {}
+
+    string imagePath;       ///< Image with a calibration target in the position of the calibration
+    string calibPath;       ///< Octagon calibration json file of the image
+    vector< Size > sizes;   ///< Image sizes to run the component benchmarks on (empty=native size only)
+    int warmup;             ///< Untimed calls before the timed repetitions
+    int reps;               ///< Timed repetitions
+    string jsonPath;        ///< File to write the json results to (empty=stdout)
+    string label;           ///< Free text stored with the results (e.g. machine name)
+    string filter;          ///< Only run benchmarks whose name contains this string
+};
+
+/**
+ * @brief Timing of one benchmark at one image size
+ */
+class BenchResult
+{
+public:
+    BenchResult() :
+        items( 1 ),
+        reps( 0 ),
+        isOk( false ),
+        minMs( 0.0 ),
+        medianMs( 0.0 ),
+        meanMs( 0.0 ),
+        maxMs( 0.0 )
+    {}
+
+    string name;        ///< Benchmark name
+    Size size;          ///< Image size the benchmark ran on
+    int items;          ///< Calls of the benchmarked method per repetition
+    int reps;           ///< Timed repetitions
+    bool isOk;          ///< true=Every call returned GC_OK
+    double minMs;       ///< Fastest repetition in milliseconds
+    double medianMs;    ///< Median repetition in milliseconds
+    double meanMs;      ///< Mean repetition in milliseconds
+    double maxMs;       ///< Slowest repetition in milliseconds
+};
+
+static void PrintHelp()
+{
+    cout << "grime2bench: times the line find hot paths" << endl;
+    cout << "  --image <path>          Image with the calibration target (default " << BenchConfig().imagePath << ")" << endl;
+    cout << "  --calib_json <path>     Octagon calibration of the image (default " << BenchConfig().calibPath << ")" << endl;
+    cout << "  --sizes WxH[,WxH...]    Image sizes for the component benchmarks (default native size)" << endl;
+    cout << "  --warmup <n>            Untimed calls before timing (default 3)" << endl;
+    cout << "  --reps <n>              Timed repetitions (default 20)" << endl;
+    cout << "  --json <path>           Write results to a file instead of stdout" << endl;
+    cout << "  --label <text>          Label stored with the results" << endl;
+    cout << "  --filter <text>         Only run benchmarks whose name contains text" << endl;
+}
+static bool ParseSizes( const string &arg, vector< Size > &sizes )
+{
+    sizes.clear();
+    stringstream ss( arg );
+    string item;
+    while ( getline( ss, item, ',' ) )
+    {
+        int width = 0, height = 0;
+        char sep = '\0';
+        stringstream itemStream( item );
+        if ( !( itemStream >> width >> sep >> height ) || ( 'x' != sep && 'X' != sep ) || 0 >= width || 0 >= height )
+        {
+            return false;
+        }
+        sizes.push_back( Size( width, height ) );
+    }
+    return !sizes.empty();
+}
+static int GetArgs( int argc, char *argv[], BenchConfig &config )
+{
+    for ( int i = 1; i < argc; ++i )
+    {
+        string arg = argv[ i ];
+        bool hasValue = i + 1 < argc;
+        if ( "--help" == arg || "-h" == arg )
+        {
+            PrintHelp();
+            return 1;
+        }
+        else if ( !hasValue )
+        {
+            FILE_LOG( logERROR ) << "Missing value for " << arg;
+            return -1;
+        }
+
+        string value = argv[ ++i ];
+        if ( "--image" == arg )
+            config.imagePath = value;
+        else if ( "--calib_json" == arg )
+            config.calibPath = value;
+        else if ( "--json" == arg )
+            config.jsonPath = value;
+        else if ( "--label" == arg )
+            config.label = value;
+        else if ( "--filter" == arg )
+            config.filter = value;
+        else if ( "--warmup" == arg )
+            config.warmup = std::max( 0, atoi( value.c_str() ) );
+        else if ( "--reps" == arg )
+            config.reps = std::max( 1, atoi( value.c_str() ) );
+        else if ( "--sizes" == arg )
+        {
+            if ( !ParseSizes( value, config.sizes ) )
+            {
+                FILE_LOG( logERROR ) << "Invalid --sizes " << value << " (expected e.g. 1280x720,1920x1080)";
+                return -1;
+            }
+        }
+        else
+        {
+            FILE_LOG( logERROR ) << "Unknown argument " << arg;
+            return -1;
+        }
+    }
+    return 0;
+}
+static string JsonEscape( const string &str )
+{
+    string out;
+    for ( char c : str )
+    {
+        if ( '"' == c || '\\' == c )
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+static void RunBench( const BenchConfig &config, const string &name, const Size size, const int items,
+                      function< GC_STATUS() > fn, vector< BenchResult > &results )
+{
+    if ( !config.filter.empty() && string::npos == name.find( config.filter ) )
+        return;
+
+    BenchResult result;
+    result.name = name;
+    result.size = size;
+    result.items = items;
+    result.reps = config.reps;
+    result.isOk = true;
+    try
+    {
+        for ( int i = 0; i < config.warmup; ++i )
+        {
+            result.isOk = GC_OK == fn() && result.isOk;
+        }
+        vector< double > times;
+        for ( int i = 0; i < config.reps; ++i )
+        {
+            auto start = chrono::steady_clock::now();
+            GC_STATUS retVal = fn();
+            times.push_back( chrono::duration< double, milli >( chrono::steady_clock::now() - start ).count() );
+            result.isOk = GC_OK == retVal && result.isOk;
+        }
+        sort( times.begin(), times.end() );
+        result.minMs = times.front();
+        result.maxMs = times.back();
+        result.medianMs = 0 == times.size() % 2 ? ( times[ times.size() / 2 - 1 ] + times[ times.size() / 2 ] ) / 2.0 : times[ times.size() / 2 ];
+        result.meanMs = accumulate( times.begin(), times.end(), 0.0 ) / static_cast< double >( times.size() );
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[grime2bench::RunBench] " << name << ": " << e.what();
+        result.isOk = false;
+    }
+    cerr << left << setw( 24 ) << name << right << setw( 6 ) << size.width << "x" << left << setw( 6 ) << size.height << right
+         << fixed << setprecision( 3 ) << " median " << setw( 10 ) << result.medianMs << " ms  min " << setw( 10 ) << result.minMs
+         << " ms" << ( result.isOk ? "" : "  (calls failed)" ) << defaultfloat << endl;
+    results.push_back( result );
+}
+static Point2d ScalePoint( const Point2d pt, const double scaleX, const double scaleY )
+{
+    return Point2d( pt.x * scaleX, pt.y * scaleY );
+}
+static void RunComponentBenches( const BenchConfig &config, const Mat &native, CalibOctagon &calib, const Size size,
+                                 vector< BenchResult > &results )
+{
+    const double scaleX = static_cast< double >( size.width ) / static_cast< double >( native.cols );
+    const double scaleY = static_cast< double >( size.height ) / static_cast< double >( native.rows );
+
+    Mat img, gray;
+    if ( native.size() == size )
+        img = native;
+    else
+        resize( native, img, size, 0.0, 0.0, INTER_AREA );
+    cvtColor( img, gray, COLOR_BGR2GRAY );
+
+    // the target search region and octagon corners scaled with the image
+    CalibModelOctagon &model = calib.Model();
+    Rect roi = model.targetSearchRegion;
+    if ( 0 >= roi.width || 0 >= roi.height )
+        roi = Rect( 0, 0, native.cols, native.rows );
+    Rect roiScaled( cvRound( roi.x * scaleX ), cvRound( roi.y * scaleY ), cvRound( roi.width * scaleX ), cvRound( roi.height * scaleY ) );
+    roiScaled &= Rect( 0, 0, size.width, size.height );
+    Mat roiImg = img( roiScaled );
+
+    vector< Point2d > octoPts;
+    for ( const auto &pt : model.pixelPoints )
+        octoPts.push_back( ScalePoint( pt, scaleX, scaleY ) - Point2d( roiScaled.tl() ) );
+
+    OctagonSearch octagonSearch;
+    RunBench( config, "OctagonSearch::Find", size, 1, [ & ]()
+    {
+        vector< Point2d > pts;
+        return octagonSearch.Find( roiImg, pts, false );
+    }, results );
+
+    OctoRefine octoRefine;
+    RunBench( config, "OctoRefine::RefinePoints", size, 1, [ & ]()
+    {
+        vector< Point2d > vertices;
+        return octoRefine.RefinePoints( roiImg, octoPts, vertices );
+    }, results );
+
+    FindLine findLine;
+    Mat preprocessed;
+    RunBench( config, "FindLine::Preprocess", size, 1, [ & ]() { return findLine.Preprocess( gray, preprocessed ); }, results );
+    if ( preprocessed.empty() )
+        findLine.Preprocess( gray, preprocessed );
+
+    // one swath, a tenth of the search lines, as FindLine::Find evaluates them
+    vector< LineEnds > swath;
+    const vector< LineEnds > &lines = calib.SearchLineSet();
+    for ( size_t i = 0; i < std::max< size_t >( 1, lines.size() / 10 ) && i < lines.size(); ++i )
+    {
+        Point2d top = ScalePoint( Point2d( lines[ i ].top ), scaleX, scaleY );
+        Point2d bot = ScalePoint( Point2d( lines[ i ].bot ), scaleX, scaleY );
+        swath.push_back( LineEnds( Point( cvRound( top.x ), cvRound( top.y ) ), Point( cvRound( bot.x ), cvRound( bot.y ) ) ) );
+    }
+    RunBench( config, "FindLine::CalcRowSums", size, 1, [ & ]()
+    {
+        vector< uint > rowSums;
+        return findLine.CalcRowSums( preprocessed, swath, rowSums );
+    }, results );
+
+    mt19937 rng( 42 );
+    vector< uint > rawSums( swath.empty() ? static_cast< size_t >( size.height / 4 ) :
+                            static_cast< size_t >( std::max( 16, swath[ 0 ].bot.y - swath[ 0 ].top.y ) ) );
+    uniform_int_distribution< uint > sumDist( 0, 255 * static_cast< uint >( std::max< size_t >( 1, swath.size() ) ) );
+    for ( auto &sum : rawSums )
+        sum = sumDist( rng );
+    RunBench( config, "FindLine::MedianFilter", size, 1, [ & ]()
+    {
+        vector< uint > filtered;
+        return findLine.MedianFilter( 9, rawSums, filtered );
+    }, results );
+
+    // ten swath points along a slightly tilted waterline with one outlier, as FindLine::Find produces them
+    vector< Point2d > linePts;
+    normal_distribution< double > noise( 0.0, 0.5 );
+    for ( int i = 0; i < 10; ++i )
+    {
+        double x = size.width * ( 0.3 + 0.04 * i );
+        linePts.push_back( Point2d( x, size.height * 0.7 + 0.02 * x + noise( rng ) ) );
+    }
+    linePts[ 3 ].y -= size.height * 0.05;
+    double xCenter = size.width * 0.48;
+    RunBench( config, "FindLine::FitLineRANSAC", size, 1, [ & ]()
+    {
+        FindPointSet ptSet;
+        return findLine.FitLineRANSAC( linePts, ptSet, xCenter, preprocessed );
+    }, results );
+}
+static string ResultsToJson( const BenchConfig &config, const vector< BenchResult > &results )
+{
+    char dateBuf[ 32 ] = "";
+    time_t now = time( nullptr );
+    strftime( dateBuf, sizeof( dateBuf ), "%Y-%m-%dT%H:%M:%S", localtime( &now ) );
+
+    stringstream ss;
+    ss << fixed << setprecision( 4 );
+    ss << "{" << endl;
+    ss << "  \"git_rev\": \"" << GRIME2BENCH_GIT_REV << "\"," << endl;
+    ss << "  \"date\": \"" << dateBuf << "\"," << endl;
+    ss << "  \"label\": \"" << JsonEscape( config.label ) << "\"," << endl;
+    ss << "  \"hardware_threads\": " << thread::hardware_concurrency() << "," << endl;
+    ss << "  \"image\": \"" << JsonEscape( config.imagePath ) << "\"," << endl;
+    ss << "  \"calib_json\": \"" << JsonEscape( config.calibPath ) << "\"," << endl;
+    ss << "  \"warmup\": " << config.warmup << "," << endl;
+    ss << "  \"reps\": " << config.reps << "," << endl;
+    ss << "  \"results\": [" << endl;
+    for ( size_t i = 0; i < results.size(); ++i )
+    {
+        const BenchResult &r = results[ i ];
+        ss << "    {\"name\": \"" << r.name << "\", \"width\": " << r.size.width << ", \"height\": " << r.size.height
+           << ", \"items\": " << r.items << ", \"ok\": " << ( r.isOk ? "true" : "false" )
+           << ", \"min_ms\": " << r.minMs << ", \"median_ms\": " << r.medianMs
+           << ", \"mean_ms\": " << r.meanMs << ", \"max_ms\": " << r.maxMs << "}"
+           << ( results.size() - 1 == i ? "" : "," ) << endl;
+    }
+    ss << "  ]" << endl;
+    ss << "}" << endl;
+    return ss.str();
+}
+
+int main( int argc, char *argv[] )
+{
+    Output2FILE::Stream() = stderr;
+
+    BenchConfig config;
+    int ret = GetArgs( argc, argv, config );
+    if ( 0 != ret )
+        return 0 < ret ? 0 : ret;
+
+    Mat native = imread( config.imagePath, IMREAD_COLOR );
+    if ( native.empty() )
+    {
+        FILE_LOG( logERROR ) << "Could not read image " << config.imagePath;
+        return -1;
+    }
+
+    ifstream calibFile( config.calibPath );
+    stringstream calibJson;
+    calibJson << calibFile.rdbuf();
+    CalibOctagon calib;
+    if ( !calibFile.is_open() || GC_OK != calib.Load( calibJson.str() ) )
+    {
+        FILE_LOG( logERROR ) << "Could not load octagon calibration " << config.calibPath;
+        return -1;
+    }
+
+    vector< Size > sizes = config.sizes;
+    if ( sizes.empty() )
+        sizes.push_back( native.size() );
+
+    vector< BenchResult > results;
+    for ( const auto &size : sizes )
+    {
+        RunComponentBenches( config, native, calib, size, results );
+    }
+
+    // pixel to world conversion does not depend on the image size and the calibration holds
+    // pixel positions, so these run at the native size only
+    vector< Point2d > pixelPts;
+    mt19937 rng( 42 );
+    uniform_real_distribution< double > xDist( 0.0, native.cols - 1.0 ), yDist( 0.0, native.rows - 1.0 );
+    for ( int i = 0; i < PIXEL_TO_WORLD_POINTS; ++i )
+        pixelPts.push_back( Point2d( xDist( rng ), yDist( rng ) ) );
+    RunBench( config, "CalibOctagon::PixelToWorld", native.size(), PIXEL_TO_WORLD_POINTS, [ & ]()
+    {
+        GC_STATUS retVal = GC_OK;
+        Point2d worldPt;
+        for ( const auto &pt : pixelPts )
+        {
+            if ( GC_OK != calib.PixelToWorld( pt, worldPt ) )
+                retVal = GC_ERR;
+        }
+        return retVal;
+    }, results );
+    vector< Point2d > worldPts( pixelPts.size() );
+    RunBench( config, "CalibOctagon::PixelToWorld_batch", native.size(), PIXEL_TO_WORLD_POINTS, [ & ]()
+    {
+        return calib.PixelToWorld( pixelPts.data(), worldPts.data(), pixelPts.size() );
+    }, results );
+
+    VisApp visApp;
+    FindLineParams params;
+    params.imagePath = config.imagePath;
+    params.calibFilepath = config.calibPath;
+    RunBench( config, "VisApp::CalcLine", native.size(), 1, [ & ]()
+    {
+        FindLineResult result;
+        return visApp.CalcLine( native, params, result );
+    }, results );
+
+    string json = ResultsToJson( config, results );
+    if ( config.jsonPath.empty() )
+    {
+        cout << json;
+    }
+    else
+    {
+        ofstream jsonFile( config.jsonPath );
+        jsonFile << json;
+        if ( !jsonFile )
+        {
+            FILE_LOG( logERROR ) << "Could not write " << config.jsonPath;
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -2,6 +2,8 @@
 #define ARGHANDLER_H
 #include "../algorithms/log.h"
 #include "../algorithms/calibexecutive.h"
+#include "../algorithms/tarsource.h"
+#include "../algorithms/shardspec.h"
 #include <opencv2/core.hpp>
 #include <filesystem>
 #include <boost/exception/diagnostic_information.hpp>
@@ -22,9 +24,16 @@ typedef enum GRIME2_CLI_OPERATIONS
     CREATE_CALIB,
     FIND_LINE,
     RUN_FOLDER,
+    WATCH_FOLDER,
+    RUN_VIDEO,
+    RUN_BATCH,
     MAKE_GIF,
+    MAKE_SYNTH,
     SHOW_METADATA,
     SHOW_VERSION,
+    EXPORT_LOG,
+    SERVE,
+    MERGE_RESULTS,
     SHOW_HELP
 } GRIME2_CLI_OP;
 
@@ -46,7 +55,16 @@ public:
         facet_length(-1.0),
         zero_offset(-1.0),
         noCalibSave(false),
-        cache_result(false)
+        cache_result(false),
+        worker_threads(0),
+        read_threads(0),
+        fresh_engine(false),
+        watch_idleSecs(0),
+        scan_threads(0),
+        frame_step(1),
+        engine_cacheSize(8),
+        memory_budgetMB(0),
+        memory_stats(false)
     {}
     void clear()
     {
@@ -70,6 +88,24 @@ public:
         zero_offset = -1.0;
         noCalibSave = false;
         cache_result = false;
+        result_logPath.clear();
+        log_startTime.clear();
+        log_endTime.clear();
+        worker_threads = 0;
+        read_threads = 0;
+        fresh_engine = false;
+        watch_idleSecs = 0;
+        serve_socketPath.clear();
+        manifestPath.clear();
+        scan_threads = 0;
+        video_startTime.clear();
+        frame_step = 1;
+        engine_cacheSize = 8;
+        memory_budgetMB = 0;
+        memory_stats = false;
+        shard = gc::ShardSpec();
+        merge_outputPath.clear();
+        merge_inputs.clear();
     }
     bool verbose;
     GRIME2_CLI_OP opToPerform;
@@ -91,6 +127,24 @@ public:
     double zero_offset;
     bool noCalibSave;
     bool cache_result;
+    string result_logPath;
+    string log_startTime;
+    string log_endTime;
+    int worker_threads;
+    int read_threads;
+    bool fresh_engine;
+    int watch_idleSecs;
+    string serve_socketPath;
+    string manifestPath;
+    int scan_threads;
+    string video_startTime;
+    int frame_step;
+    int engine_cacheSize;
+    int memory_budgetMB;
+    bool memory_stats;
+    gc::ShardSpec shard;
+    string merge_outputPath;
+    vector< string > merge_inputs;
 
 };
 int GetArgs( int argc, char *argv[], Grime2CLIParams &params )
@@ -157,6 +211,71 @@ int GetArgs( int argc, char *argv[], Grime2CLIParams &params )
                 {
                     params.cache_result = true;
                 }
+                else if ( "fresh_engine" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    params.fresh_engine = true;
+                }
+                else if ( "memory_stats" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    params.memory_stats = true;
+                }
+                else if ( "result_log" == string( argv[ i ] ).substr( 2 ) ||
+                          "export_log" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    if ( "export_log" == string( argv[ i ] ).substr( 2 ) )
+                    {
+                        params.opToPerform = EXPORT_LOG;
+                    }
+                    if ( i + 1 < argc )
+                    {
+                        params.result_logPath = string( argv[ ++i ] );
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] No value supplied on --" << string( argv[ i ] ).substr( 2 ) << " request";
+                        retVal = -1;
+                        break;
+                    }
+                }
+                else if ( "manifest" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    if ( i + 1 < argc )
+                    {
+                        params.manifestPath = string( argv[ ++i ] );
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] No value supplied on --manifest request";
+                        retVal = -1;
+                        break;
+                    }
+                }
+                else if ( "start_time" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    if ( i + 1 < argc )
+                    {
+                        params.log_startTime = string( argv[ ++i ] );
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] No value supplied on --start_time request";
+                        retVal = -1;
+                        break;
+                    }
+                }
+                else if ( "end_time" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    if ( i + 1 < argc )
+                    {
+                        params.log_endTime = string( argv[ ++i ] );
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] No value supplied on --end_time request";
+                        retVal = -1;
+                        break;
+                    }
+                }
                 else if ( "create_calib" == string( argv[ i ] ).substr( 2 ) )
                 {
                     if ( i + 1 < argc )
@@ -180,10 +299,153 @@ int GetArgs( int argc, char *argv[], Grime2CLIParams &params )
                 {
                     params.opToPerform = RUN_FOLDER;
                 }
+                else if ( "run_video" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    params.opToPerform = RUN_VIDEO;
+                }
+                else if ( "run_batch" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    params.opToPerform = RUN_BATCH;
+                }
+                else if ( "shard" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    if ( i + 1 < argc )
+                    {
+                        if ( gc::GC_OK != gc::ShardSpec::Parse( argv[ ++i ], params.shard ) )
+                        {
+                            retVal = -1;
+                            break;
+                        }
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] No value supplied on --shard request";
+                        retVal = -1;
+                        break;
+                    }
+                }
+                else if ( "shard_by" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    if ( i + 1 < argc && ( "hash" == string( argv[ i + 1 ] ) || "time" == string( argv[ i + 1 ] ) ) )
+                    {
+                        params.shard.byTime = "time" == string( argv[ ++i ] );
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] --shard_by needs hash or time";
+                        retVal = -1;
+                        break;
+                    }
+                }
+                else if ( "merge" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    params.opToPerform = MERGE_RESULTS;
+                    if ( i + 1 < argc )
+                    {
+                        params.merge_outputPath = string( argv[ ++i ] );
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] No output path supplied on --merge request";
+                        retVal = -1;
+                        break;
+                    }
+                }
+                else if ( "memory_budget_mb" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    if ( i + 1 < argc )
+                    {
+                        params.memory_budgetMB = stoi( argv[ ++i ] );
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] No value supplied on --memory_budget_mb request";
+                        retVal = -1;
+                        break;
+                    }
+                }
+                else if ( "engine_cache" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    if ( i + 1 < argc )
+                    {
+                        params.engine_cacheSize = stoi( argv[ ++i ] );
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] No value supplied on --engine_cache request";
+                        retVal = -1;
+                        break;
+                    }
+                }
+                else if ( "video_start" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    if ( i + 1 < argc )
+                    {
+                        params.video_startTime = string( argv[ ++i ] );
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] No value supplied on --video_start request";
+                        retVal = -1;
+                        break;
+                    }
+                }
+                else if ( "frame_step" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    if ( i + 1 < argc )
+                    {
+                        params.frame_step = stoi( argv[ ++i ] );
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] No value supplied on --frame_step request";
+                        retVal = -1;
+                        break;
+                    }
+                }
+                else if ( "watch" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    params.opToPerform = WATCH_FOLDER;
+                }
+                else if ( "watch_idle_secs" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    if ( i + 1 < argc )
+                    {
+                        params.watch_idleSecs = stoi( argv[ ++i ] );
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] No value supplied on --watch_idle_secs request";
+                        retVal = -1;
+                        break;
+                    }
+                }
+                else if ( "serve" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    params.opToPerform = SERVE;
+                }
+                else if ( "serve_socket" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    if ( i + 1 < argc )
+                    {
+                        params.opToPerform = SERVE;
+                        params.serve_socketPath = string( argv[ ++i ] );
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] No value supplied on --serve_socket request";
+                        retVal = -1;
+                        break;
+                    }
+                }
                 else if ( "make_gif" == string( argv[ i ] ).substr( 2 ) )
                 {
                     params.opToPerform = MAKE_GIF;
                 }
+                else if ( "make_synth" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    params.opToPerform = MAKE_SYNTH;
+                }
                 else if ( "show_metadata" == string( argv[ i ] ).substr( 2 ) )
                 {
                     params.opToPerform = SHOW_METADATA;
@@ -209,6 +471,45 @@ int GetArgs( int argc, char *argv[], Grime2CLIParams &params )
                         break;
                     }
                 }
+                else if ( "threads" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    if ( i + 1 < argc )
+                    {
+                        params.worker_threads = stoi( argv[ ++i ] );
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] No value supplied on --threads request";
+                        retVal = -1;
+                        break;
+                    }
+                }
+                else if ( "scan_threads" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    if ( i + 1 < argc )
+                    {
+                        params.scan_threads = stoi( argv[ ++i ] );
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] No value supplied on --scan_threads request";
+                        retVal = -1;
+                        break;
+                    }
+                }
+                else if ( "read_threads" == string( argv[ i ] ).substr( 2 ) )
+                {
+                    if ( i + 1 < argc )
+                    {
+                        params.read_threads = stoi( argv[ ++i ] );
+                    }
+                    else
+                    {
+                        FILE_LOG( logERROR ) << "[ArgHandler] No value supplied on --read_threads request";
+                        retVal = -1;
+                        break;
+                    }
+                }
                 else if ( "scale" == string( argv[ i ] ).substr( 2 ) )
                 {
                     if ( i + 1 < argc )
@@ -414,8 +715,45 @@ int GetArgs( int argc, char *argv[], Grime2CLIParams &params )
                                 break;
                             }
                         }
+                        else if ( RUN_VIDEO == params.opToPerform )
+                        {
+                            if ( !fs::is_regular_file( params.src_imagePath ) )
+                            {
+                                FILE_LOG( logERROR ) << "Source video does not exist: " << params.src_imagePath;
+                                retVal = -1;
+                                break;
+                            }
+                        }
+                        else if ( MAKE_SYNTH == params.opToPerform )
+                        {
+                            if ( !fs::is_regular_file( params.src_imagePath ) )
+                            {
+                                FILE_LOG( logERROR ) << "Synthetic scene settings file does not exist: " << params.src_imagePath;
+                                retVal = -1;
+                                break;
+                            }
+                        }
+                        else if ( RUN_BATCH == params.opToPerform )
+                        {
+                            if ( !fs::is_regular_file( params.src_imagePath ) )
+                            {
+                                FILE_LOG( logERROR ) << "Batch manifest does not exist: " << params.src_imagePath;
+                                retVal = -1;
+                                break;
+                            }
+                        }
+                        else if ( RUN_FOLDER == params.opToPerform )
+                        {
+                            if ( !fs::is_directory( params.src_imagePath ) &&
+                                 !( fs::is_regular_file( params.src_imagePath ) && gc::TarImageSource::IsTarPath( params.src_imagePath ) ) )
+                            {
+                                FILE_LOG( logERROR ) << "Source path is not a folder or tar archive: " << params.src_imagePath;
+                                retVal = -1;
+                                break;
+                            }
+                        }
                         else if ( MAKE_GIF == params.opToPerform ||
-                                 RUN_FOLDER == params.opToPerform )
+                                 WATCH_FOLDER == params.opToPerform )
                         {
                             if ( !fs::is_directory( params.src_imagePath ) )
                             {
@@ -507,6 +845,10 @@ int GetArgs( int argc, char *argv[], Grime2CLIParams &params )
                     break;
                 }
             }
+            else if ( MERGE_RESULTS == params.opToPerform )
+            {
+                params.merge_inputs.push_back( argv[ i ] );
+            }
             else
             {
                 FILE_LOG( logWARNING ) << "[ArgHandler] Extraneous command line item " << argv[ i ];
@@ -582,24 +924,135 @@ void PrintHelp()
         "                  [--csv_file <Path of csv file to create or append with find line result> OPTIONAL]" << endl <<
         "                  [--result_image <Path of result overlay image> OPTIONAL]" << endl <<
         "                  [--line_roi_folder <Path of line roi image folder> OPTIONAL]" << endl <<
+        "                  [--result_log <Path of binary result log to create or append> OPTIONAL]" << endl <<
         "        Loads the specified image and calibration file, extracts the image using the specified" << endl <<
         "        timestamp parameters, calculates the line position, returns a json string with the find line" << endl <<
         "        results to stdout, and creates the optional overlay result image if specified" << endl;
     cout << "FORMAT: grime2cli --run_folder --timestamp_from_filename or --timestamp_from_exif " << endl <<
         "                   --timestamp_start_pos <position of the first timestamp char of source string>" << endl <<
         "                   --timestamp_format <y-m-d H:M format string for timestamp, e.g., yyyy-mm-ddTMM:HH>" << endl <<
-        "                   <Folder path of images to be analyzed> --calib_json <Calibration json file path>" << endl <<
+        "                   <Folder path or .tar/.tar.gz/.tgz archive of images to be analyzed>" << endl <<
+        "                   --calib_json <Calibration json file path>" << endl <<
         "                   [--csv_file <Path of csv file to create or append with find line results> OPTIONAL]" << endl <<
         "                   [--result_folder <Path of folder to hold result overlay images> OPTIONAL]" << endl <<
         "                   [--line_roi_folder <Path of line roi image folder> OPTIONAL]" << endl <<
+        "                   [--result_log <Path of binary result log to create or append> OPTIONAL]" << endl <<
+        "                   [--threads <Number of line find threads> OPTIONAL default=hardware thread count]" << endl <<
+        "                   [--memory_budget_mb <Target process memory, fewer finds run at once and large frames" << endl <<
+        "                                        are preprocessed only around the search lines to stay under it> OPTIONAL]" << endl <<
+        "                   [--memory_stats Add the image memory of each stage to the results and summary OPTIONAL]" << endl <<
+        "                   [--read_threads <Number of image read threads> OPTIONAL default=half hardware thread count]" << endl <<
+        "                   [--scan_threads <Number of folder listing threads> OPTIONAL default=8]" << endl <<
+        "                   [--fresh_engine Reload the calibration into a new engine for every image OPTIONAL]" << endl <<
+        "                   [--manifest <Path of run manifest to create or resume> OPTIONAL]" << endl <<
+        "                   [--shard <i/N, run only shard i of N> OPTIONAL]" << endl <<
+        "                   [--shard_by <hash or time> OPTIONAL default=hash]" << endl <<
         "        Loads the specified images and calibration file, extracts the timestamps using the specified" << endl <<
         "        timestamp parameters, calculates the line positions,  and creates the optional overlay result" << endl <<
-        "        image if specified" << endl;
+        "        image if specified. Folders are listed, and images read, searched, and written concurrently," << endl <<
+        "        but results are written to stdout and the csv file in sorted order (the entries of each" << endl <<
+        "        folder by name, subfolders in place). Each find thread keeps one" << endl <<
+        "        calibrated engine for the whole run unless --fresh_engine is set. A timing summary with" << endl <<
+        "        the per image cost of each stage is written to stderr when the run is done. With a" << endl <<
+        "        manifest, each completed image is recorded by path, size, modification time, and" << endl <<
+        "        calibration file hash, and a rerun skips the images that match a record. An archive" << endl <<
+        "        source is read in archive order and its entries are decoded from memory without being" << endl <<
+        "        extracted. Timestamps must come from the entry names (--timestamp_from_filename), and" << endl <<
+        "        --manifest is not used. With --shard, the images are split between N runs (processes or" << endl <<
+        "        machines) the same way on every machine: by a hash of the path relative to the source" << endl <<
+        "        folder, or by cutting the filename time order into N contiguous ranges (needs" << endl <<
+        "        --timestamp_from_filename, not available for archives). Use --merge to combine the results" << endl;
+    cout << "FORMAT: grime2cli --run_video <Path of video or time-lapse file> --calib_json <Calibration json file path>" << endl <<
+        "                   --video_start <yyyy-mm-ddTHH:MM:SS time of the first frame> or" << endl <<
+        "                   --timestamp_from_filename --timestamp_start_pos <position> --timestamp_format <format>" << endl <<
+        "                   [--frame_step <Search every Nth frame> OPTIONAL default=1]" << endl <<
+        "                   [--csv_file <Path of csv file to create or append with find line results> OPTIONAL]" << endl <<
+        "                   [--result_folder <Path of folder to hold result overlay images> OPTIONAL]" << endl <<
+        "                   [--line_roi_folder <Path of line roi image folder> OPTIONAL]" << endl <<
+        "                   [--result_log <Path of binary result log to create or append> OPTIONAL]" << endl <<
+        "                   [--threads <Number of line find threads> OPTIONAL default=hardware thread count]" << endl <<
+        "                   [--memory_budget_mb <Target process memory, fewer finds run at once and large frames" << endl <<
+        "                                        are preprocessed only around the search lines to stay under it> OPTIONAL]" << endl <<
+        "                   [--memory_stats Add the image memory of each stage to the results and summary OPTIONAL]" << endl <<
+        "        Decodes the frames of the video in order and calculates the line position in every Nth" << endl <<
+        "        frame without writing the frames to disk. The timestamp of a frame is the start time" << endl <<
+        "        plus the frame time in the container. Results name frames as <video path>/frame_<number>" << endl;
+    cout << "FORMAT: grime2cli --run_batch <Path of batch manifest json file> --timestamp_from_filename or --timestamp_from_exif" << endl <<
+        "                   --timestamp_start_pos <position of the first timestamp char of source string>" << endl <<
+        "                   --timestamp_format <y-m-d H:M format string for timestamp, e.g., yyyy-mm-ddTMM:HH>" << endl <<
+        "                   [--csv_file <Default csv file for sites without a csv_file> OPTIONAL]" << endl <<
+        "                   [--result_folder <Default overlay folder for sites without a result_folder> OPTIONAL]" << endl <<
+        "                   [--result_log <Default result log for sites without a result_log> OPTIONAL]" << endl <<
+        "                   [--threads <Number of line find threads> OPTIONAL default=hardware thread count]" << endl <<
+        "                   [--memory_budget_mb <Target process memory, fewer finds run at once and large frames" << endl <<
+        "                                        are preprocessed only around the search lines to stay under it> OPTIONAL]" << endl <<
+        "                   [--memory_stats Add the image memory of each stage to the results and summary OPTIONAL]" << endl <<
+        "                   [--read_threads <Number of image read threads> OPTIONAL default=half hardware thread count]" << endl <<
+        "                   [--engine_cache <Calibrated engines kept per find thread> OPTIONAL default=8]" << endl <<
+        "                   [--shard <i/N> --shard_by <hash or time> OPTIONAL, as for --run_folder, per site]" << endl <<
+        "        Runs the images of every site in the manifest, e.g." << endl <<
+        "          {\"sites\": [{\"name\": \"kola\", \"source\": \"/data/kola/img_*.jpg\", \"calib_json\": \"/cfg/kola.json\"," << endl <<
+        "                      \"csv_file\": \"/out/kola.csv\", \"result_log\": \"/out/kola.gclog\"}]}" << endl <<
+        "        A source is a folder or a glob with wildcards in its last component, optionally after a" << endl <<
+        "        component of two asterisks to include subfolders. Globs ignore case, like the image" << endl <<
+        "        extension check, so *.jpg also takes IMG_001.JPG. All sites share one set of threads and" << endl <<
+        "        the next site is listed while the current one runs, so small sites do not leave threads" << endl <<
+        "        idle. Each find thread keeps the most recently used calibrations loaded, keyed by the" << endl <<
+        "        contents of the calibration file, so sites are not recalibrated as the run moves on" << endl;
+    cout << "FORMAT: grime2cli --watch --timestamp_from_filename or --timestamp_from_exif " << endl <<
+        "                   --timestamp_start_pos <position of the first timestamp char of source string>" << endl <<
+        "                   --timestamp_format <y-m-d H:M format string for timestamp, e.g., yyyy-mm-ddTMM:HH>" << endl <<
+        "                   <Folder path to watch for new images> --calib_json <Calibration json file path>" << endl <<
+        "                   [--csv_file <Path of csv file to append with find line results> OPTIONAL]" << endl <<
+        "                   [--result_folder <Path of folder to hold result overlay images> OPTIONAL]" << endl <<
+        "                   [--line_roi_folder <Path of line roi image folder> OPTIONAL]" << endl <<
+        "                   [--result_log <Path of binary result log to create or append> OPTIONAL]" << endl <<
+        "                   [--threads <Number of line find threads> OPTIONAL default=hardware thread count]" << endl <<
+        "                   [--memory_budget_mb <Target process memory, fewer finds run at once and large frames" << endl <<
+        "                                        are preprocessed only around the search lines to stay under it> OPTIONAL]" << endl <<
+        "                   [--memory_stats Add the image memory of each stage to the results and summary OPTIONAL]" << endl <<
+        "                   [--watch_idle_secs <Stop after this many seconds without a new image> OPTIONAL default=0, never]" << endl <<
+        "        Runs until interrupted (Ctrl-C or SIGTERM), calculating the line position of each image" << endl <<
+        "        written or moved into the folder or its subfolders once the image is complete. Images" << endl <<
+        "        already in the folder are not processed. The calibrated engines stay loaded between images," << endl <<
+        "        results are written to stdout and appended to the csv file and result log as they are found" << endl;
     cout << "FORMAT: grime2cli --make_gif <Folder path of images> --result_image <File path of GIF to create>" << endl <<
         "                   [--delay_ms <Animation frames per second> OPTIONAL default=250]" << endl <<
         "                   [--scale <Animation image scale from original> OPTIONAL default=0.2]" << endl <<
         "        Creates a gif animation with the images in the specifed folder at the specified scale and" << endl <<
         "        frame rate" << endl;
+    cout << "FORMAT: grime2cli --make_synth --result_folder <Existing folder to hold the images and ground_truth.json>" << endl <<
+        "                   [--source <Path of scene settings json file> OPTIONAL default=built in scene]" << endl <<
+        "        Renders a sequence of octagon target images with a water surface at known world levels" << endl <<
+        "        for accuracy and scale testing, e.g." << endl <<
+        "          {\"width\": 4096, \"height\": 3072, \"frames\": 500, \"water_level_start\": 0.5," << endl <<
+        "           \"water_level_end\": 2.0, \"tilt_deg\": 10, \"blur_sigma\": 1.5, \"noise_sigma\": 4}" << endl <<
+        "        Other settings: facet_length, zero_offset, pixels_per_unit, target_x, target_y, roll_deg," << endl <<
+        "        pan_deg, illum_gain_start, illum_gain_end, illum_gradient, jitter_pixels, seed," << endl <<
+        "        image_format, start_time, and interval_minutes. ground_truth.json holds the water level," << endl <<
+        "        waterline and octagon pixel positions, and world to pixel homography of every image, with" << endl <<
+        "        the --create_calib and --find_line arguments that calibrate and search the sequence" << endl;
+    cout << "FORMAT: grime2cli --export_log <Path of binary result log> --csv_file <Path of csv file to create>" << endl <<
+        "                   [--start_time <yyyy-mm-ddTHH:MM:SS> OPTIONAL default=first result]" << endl <<
+        "                   [--end_time <yyyy-mm-ddTHH:MM:SS> OPTIONAL default=last result]" << endl <<
+        "        Writes the results in the binary result log with timestamps in the specified range" << endl <<
+        "        to a csv file" << endl;
+    cout << "FORMAT: grime2cli --merge <Path of merged csv file or result log to create> <Paths of shard results to merge>" << endl <<
+        "        Combines the csv files (when the output ends in .csv) or binary result logs of the shards" << endl <<
+        "        of a run into one output ordered by timestamp, then image path. A row with the same image" << endl <<
+        "        and timestamp as an earlier one is dropped. Dropped rows whose values differ are reported" << endl <<
+        "        as conflicts and the merge returns a failure" << endl;
+    cout << "FORMAT: grime2cli --serve [--serve_socket <Path of local socket to listen on> OPTIONAL default=stdin/stdout]" << endl <<
+        "                   [--threads <Number of request threads> OPTIONAL default=hardware thread count]" << endl <<
+        "        Answers newline delimited json requests until end of input (stdin) or until interrupted" << endl <<
+        "        (socket). Each request names an op and the options of the matching command, e.g." << endl <<
+        "          {\"id\": 1, \"op\": \"find_line\", \"source\": \"img.jpg\", \"calib_json\": \"calib.json\"," << endl <<
+        "           \"timestamp_type\": \"from_filename\", \"timestamp_format\": \"yyyy-mm-dd-HH-MM\", \"timestamp_start_pos\": 0}" << endl <<
+        "          {\"id\": 2, \"op\": \"calibrate\", \"source\": \"img.jpg\", \"calib_json\": \"calib.json\"}" << endl <<
+        "          {\"id\": 3, \"op\": \"show_metadata\", \"source\": \"img.jpg\"}" << endl <<
+        "        find_line also accepts csv_file, result_log, result_image, and line_roi_folder. Requests are" << endl <<
+        "        processed concurrently by threads that keep their calibrations loaded, and each response" << endl <<
+        "        is one json line with the id of its request, written in completion order" << endl;
     cout << "FORMAT: grime2cli --show_metadata <Image filepath>" << endl;
     cout << "     Returns metadata extracted from the image to stdout" << endl;
     cout << "--verbose" << endl;
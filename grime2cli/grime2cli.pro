@@ -1,10 +1,13 @@
 TEMPLATE = app
-CONFIG += console c++17
+CONFIG += console c++17 thread
 CONFIG -= app_bundle
 CONFIG -= qt
 
 DEFINES += BOOST_ALL_NO_LIB BOOST_BIND_GLOBAL_PLACEHOLDERS
 
+# per stage line find timings in the result json and the run summary (remove to compile the timers out)
+DEFINES += GC_STAGE_TIMING
+
 win32 {
     DEFINES += NOMINMAX
     DEFINES += WIN32_LEAN_AND_MEAN
@@ -17,39 +20,82 @@ win32 {
 
 SOURCES += \
     ../algorithms/animate.cpp \
+    ../algorithms/batchmanifest.cpp \
+    ../algorithms/calibcache.cpp \
+    ../algorithms/calibsnapshot.cpp \
     ../algorithms/calibexecutive.cpp \
     ../algorithms/caliboctagon.cpp \
+    ../algorithms/enginecache.cpp \
     ../algorithms/findline.cpp \
+    ../algorithms/findlinepipeline.cpp \
+    ../algorithms/folderscanner.cpp \
+    ../algorithms/folderwatcher.cpp \
+    ../algorithms/framecontext.cpp \
     ../algorithms/gifanim/gifanim.cpp \
+    ../algorithms/memorybudget.cpp \
     ../algorithms/metadata.cpp \
     ../algorithms/octorefine.cpp \
+    ../algorithms/requestserver.cpp \
+    ../algorithms/resultlog.cpp \
+    ../algorithms/resultmerge.cpp \
+    ../algorithms/resultsink.cpp \
+    ../algorithms/runmanifest.cpp \
     ../algorithms/searchlines.cpp \
+    ../algorithms/shardspec.cpp \
+    ../algorithms/syntheticscene.cpp \
     ../algorithms/octagonsearch.cpp \
+    ../algorithms/tarsource.cpp \
+    ../algorithms/videosource.cpp \
     ../algorithms/visapp.cpp \
     main.cpp
 
 HEADERS += \
     ../algorithms/animate.h \
+    ../algorithms/batchmanifest.h \
+    ../algorithms/boundedqueue.h \
     ../algorithms/bresenham.h \
+    ../algorithms/calibcache.h \
+    ../algorithms/calibsnapshot.h \
     ../algorithms/calibexecutive.h \
     ../algorithms/caliboctagon.h \
     ../algorithms/csvreader.h \
+    ../algorithms/enginecache.h \
     ../algorithms/findline.h \
+    ../algorithms/findlinepipeline.h \
+    ../algorithms/folderscanner.h \
+    ../algorithms/folderwatcher.h \
+    ../algorithms/framecontext.h \
     ../algorithms/gifanim/gifanim.h \
     ../algorithms/gc_types.h \
+    ../algorithms/homography.h \
+    ../algorithms/jsonwriter.h \
     ../algorithms/labelroi.h \
     ../algorithms/log.h \
+    ../algorithms/memorybudget.h \
     ../algorithms/metadata.h \
     ../algorithms/octorefine.h \
+    ../algorithms/requestserver.h \
+    ../algorithms/resultlog.h \
+    ../algorithms/resultmerge.h \
+    ../algorithms/resultsink.h \
+    ../algorithms/runmanifest.h \
     ../algorithms/timestampconvert.h \
     ../algorithms/searchlines.h \
+    ../algorithms/shardspec.h \
+    ../algorithms/stagetimer.h \
+    ../algorithms/syntheticscene.h \
     ../algorithms/octagonsearch.h \
+    ../algorithms/tarsource.h \
+    ../algorithms/videosource.h \
     ../algorithms/visapp.h \
     ../gcgui/wincmd.h \
     arghandler.h \
     arghandler.h
 
 unix:!macx {
+    # zlib lets --run_folder read gzip compressed tar archives
+    DEFINES += GC_HAVE_ZLIB
+
     INCLUDEPATH +=  /usr/local/include \
                     /usr/local/include/opencv4
 
@@ -62,7 +108,8 @@ unix:!macx {
             -lopencv_video \
             -lboost_date_time \
             -lboost_system \
-            -lboost_chrono
+            -lboost_chrono \
+            -lz
 }
 else {
     INCLUDEPATH += $$BOOST_INCLUDES \
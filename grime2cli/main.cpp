@@ -16,12 +16,29 @@
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <iomanip>
+#include <limits>
+#include <csignal>
+#include <future>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <filesystem>
 #include "arghandler.h"
 #include "../algorithms/visapp.h"
 #include "../algorithms/calibexecutive.h"
+#include "../algorithms/findlinepipeline.h"
+#include "../algorithms/resultlog.h"
+#include "../algorithms/folderwatcher.h"
+#include "../algorithms/folderscanner.h"
+#include "../algorithms/requestserver.h"
+#include "../algorithms/runmanifest.h"
+#include "../algorithms/videosource.h"
+#include "../algorithms/tarsource.h"
+#include "../algorithms/batchmanifest.h"
+#include "../algorithms/shardspec.h"
+#include "../algorithms/resultmerge.h"
+#include "../algorithms/timestampconvert.h"
+#include "../algorithms/syntheticscene.h"
 
 using namespace gc;
 using namespace std;
@@ -39,6 +56,15 @@ namespace fs = std::filesystem;
 // --calibrate --source "./config/2022_demo/20220715_KOLA_GaugeCam_001.JPG" --calib_json "./config/calib_stopsign.json" --result_image "/var/tmp/gaugecam/calib_result_stopsign.png"
 // --find_line --timestamp_from_exif --timestamp_start_pos 0 --timestamp_format "yyyy-mm-dd-HH-MM" --source "./config/2022_demo/20220715_KOLA_GaugeCam_001.JPG" --calib_json "./config/calib.json" --csv_file "/var/tmp/gaugecam/folder_result.csv" --result_image "/var/tmp/gaugecam/find_line_result.png"
 // --run_folder --timestamp_from_exif --timestamp_start_pos 0 --timestamp_format "yyyy-mm-dd-HH-MM" --source "./config/2022_demo/" --calib_json "./config/calib.json" --csv_file "/var/tmp/gaugecam/folder_result.csv" --result_folder "/var/tmp/gaugecam/" --line_roi_folder "/var/tmp/gaugecam/line_roi/"
+// --run_folder --timestamp_from_filename --timestamp_start_pos 0 --timestamp_format "yyyy-mm-dd-HH-MM" --source "/var/tmp/gaugecam/2022-07-15.tar.gz" --calib_json "./config/calib.json" --csv_file "/var/tmp/gaugecam/archive_result.csv"
+// --run_video --source "/var/tmp/gaugecam/timelapse.mp4" --video_start "2022-07-15T08:00:00" --frame_step 10 --calib_json "./config/calib.json" --csv_file "/var/tmp/gaugecam/video_result.csv"
+// --run_batch --source "./config/sites.json" --timestamp_from_filename --timestamp_start_pos 0 --timestamp_format "yyyy-mm-dd-HH-MM" --engine_cache 8
+// --run_folder --shard 0/4 --shard_by time --timestamp_from_filename --timestamp_start_pos 0 --timestamp_format "yyyy-mm-dd-HH-MM" --source "./config/2022_demo/" --calib_json "./config/calib.json" --csv_file "/var/tmp/gaugecam/shard_0.csv"
+// --merge "/var/tmp/gaugecam/merged.csv" "/var/tmp/gaugecam/shard_0.csv" "/var/tmp/gaugecam/shard_1.csv" "/var/tmp/gaugecam/shard_2.csv" "/var/tmp/gaugecam/shard_3.csv"
+// --make_synth --result_folder "/var/tmp/gaugecam/synth/"
+// --serve --threads 4 < requests.jsonl
+// --serve --serve_socket "/var/tmp/gaugecam/grime2.sock"
+// --watch --timestamp_from_filename --timestamp_start_pos 0 --timestamp_format "yyyy-mm-dd-HH-MM" --source "/var/tmp/gaugecam/incoming/" --calib_json "./config/calib.json" --csv_file "/var/tmp/gaugecam/watch_result.csv" --result_log "/var/tmp/gaugecam/watch_result.gclog"
 
 // forward declarations
 void ShowVersion();
@@ -46,8 +72,20 @@ GC_STATUS Calibrate( const Grime2CLIParams cliParams );
 GC_STATUS CreateCalibrate( const Grime2CLIParams cliParams );
 GC_STATUS FindWaterLevel( const Grime2CLIParams cliParams );
 GC_STATUS RunFolder( const Grime2CLIParams cliParams );
+GC_STATUS RunArchive( const Grime2CLIParams cliParams );
+GC_STATUS WatchFolder( const Grime2CLIParams cliParams );
+GC_STATUS RunVideo( const Grime2CLIParams cliParams );
+GC_STATUS RunBatch( const Grime2CLIParams cliParams );
+GC_STATUS ServeRequests( const Grime2CLIParams cliParams );
+GC_STATUS MergeResults( const Grime2CLIParams cliParams );
+GC_STATUS SelectShard( const Grime2CLIParams &cliParams, const string &sourceFolder, vector< string > &images );
 GC_STATUS CreateGIF( const Grime2CLIParams cliParams );
+GC_STATUS MakeSynthetic( const Grime2CLIParams cliParams );
 GC_STATUS FormCalibJsonString( const Grime2CLIParams cliParams, string &json );
+void FormFindLineParams( const Grime2CLIParams cliParams, FindLineParams &params );
+void OutputFindLineResult( const Grime2CLIParams &cliParams, const string &resultJson );
+void PrintRunSummary( const FindLinePipelineStats &stats, const size_t skippedCount = 0 );
+GC_STATUS ExportResultLog( const Grime2CLIParams cliParams );
 
 /** \file main.cpp
  * @brief Holds the main() function for command line use of the gaugecam libraries.
@@ -95,10 +133,26 @@ int main( int argc, char *argv[] )
             {
                 retVal = RunFolder( params );
             }
+            else if ( RUN_VIDEO == params.opToPerform )
+            {
+                retVal = RunVideo( params );
+            }
+            else if ( RUN_BATCH == params.opToPerform )
+            {
+                retVal = RunBatch( params );
+            }
+            else if ( WATCH_FOLDER == params.opToPerform )
+            {
+                retVal = WatchFolder( params );
+            }
             else if ( MAKE_GIF == params.opToPerform )
             {
                 retVal = CreateGIF( params );
             }
+            else if ( MAKE_SYNTH == params.opToPerform )
+            {
+                retVal = MakeSynthetic( params );
+            }
             else if ( SHOW_METADATA == params.opToPerform )
             {
                 VisApp vis;
@@ -116,6 +170,18 @@ int main( int argc, char *argv[] )
             {
                 ShowVersion();
             }
+            else if ( EXPORT_LOG == params.opToPerform )
+            {
+                retVal = ExportResultLog( params );
+            }
+            else if ( SERVE == params.opToPerform )
+            {
+                retVal = ServeRequests( params );
+            }
+            else if ( MERGE_RESULTS == params.opToPerform )
+            {
+                retVal = MergeResults( params );
+            }
             else
             {
                 if ( SHOW_HELP != params.opToPerform )
@@ -265,55 +331,235 @@ GC_STATUS RunFolder( const Grime2CLIParams cliParams )
     GC_STATUS retVal = GC_OK;
     try
     {
-        if ( !fs::is_directory( cliParams.src_imagePath ) )
+        if ( fs::is_regular_file( cliParams.src_imagePath ) && TarImageSource::IsTarPath( cliParams.src_imagePath ) )
+        {
+            retVal = RunArchive( cliParams );
+        }
+        else if ( !fs::is_directory( cliParams.src_imagePath ) )
         {
             FILE_LOG( logERROR ) << "Path specified is not a folder: " << cliParams.src_imagePath << endl;
             retVal = GC_ERR;
         }
         else
         {
-            string ext;
-            vector< string > images;
-            for ( auto& p: fs::recursive_directory_iterator( cliParams.src_imagePath ) )
+            string result_folder = cliParams.result_imagePath;
+            if ( !result_folder.empty() )
             {
-                ext = p.path().extension().string();
-                if ( ext == ".png" || ext == ".jpg" || ext == ".PNG" || ext == ".JPG" )
+                if ( '/' != result_folder[ result_folder.size() - 1 ] )
+                    result_folder += '/';
+            }
+
+            FindLinePipelineConfig config;
+            config.workerThreads = cliParams.worker_threads;
+            config.memoryBudgetBytes = static_cast< size_t >( std::max( 0, cliParams.memory_budgetMB ) ) << 20;
+            config.trackMemory = cliParams.memory_stats;
+            config.readThreads = cliParams.read_threads;
+            config.freshEngine = cliParams.fresh_engine;
+
+            // a manifest lets an interrupted run pick up where it left off
+            RunManifest manifest;
+            string calibHash;
+            if ( !cliParams.manifestPath.empty() )
+            {
+                retVal = RunManifest::HashFile( cliParams.calib_jsonPath, calibHash );
+                if ( GC_OK == retVal )
                 {
-                    images.push_back( p.path().string() );
+                    retVal = manifest.Open( cliParams.manifestPath );
+                    config.manifest = &manifest;
                 }
             }
 
-            sort( images.begin(), images.end() );
+            // images are pushed as the scanner finds them, so the first results do not wait
+            // for the whole archive to be listed
+            FolderScanner scanner;
+            if ( GC_OK == retVal )
+            {
+                retVal = scanner.Start( cliParams.src_imagePath, cliParams.scan_threads );
+            }
 
-            if ( images.empty() )
+            FindLinePipeline pipeline;
+            if ( GC_OK == retVal )
             {
-                FILE_LOG( logERROR ) << "No images found in " << cliParams.src_imagePath << endl;
-                retVal = GC_ERR;
+                retVal = pipeline.Start( config, [ &cliParams ]( const FindLineParams &, const FindLineResult &,
+                                                                 const string &resultJson, const GC_STATUS )
+                                                                 { OutputFindLineResult( cliParams, resultJson ); } );
             }
-            else
+            if ( GC_OK == retVal )
             {
-                string result_folder = cliParams.result_imagePath;
-                if ( !result_folder.empty() )
+                size_t foundCount = 0;
+                size_t skippedCount = 0;
+                string imgPath;
+                string manifestKey;
+                FindLineParams params;
+                FormFindLineParams( cliParams, params );
+
+                // a time shard needs the whole listing to find its range, a hash shard picks its
+                // images as they are found
+                bool isTimeShard = cliParams.shard.IsSharded() && cliParams.shard.byTime;
+                vector< string > timeShard;
+                size_t timeShardPos = 0;
+                if ( isTimeShard )
                 {
-                    if ( '/' != result_folder[ result_folder.size() - 1 ] )
-                        result_folder += '/';
+                    while ( scanner.Next( imgPath ) )
+                        timeShard.push_back( imgPath );
+                    foundCount = timeShard.size();
+                    retVal = SelectShard( cliParams, cliParams.src_imagePath, timeShard );
                 }
+                auto nextImage = [ & ]( string &path )
+                {
+                    if ( isTimeShard )
+                    {
+                        if ( GC_OK != retVal || timeShardPos >= timeShard.size() )
+                            return false;
+                        path = timeShard[ timeShardPos++ ];
+                        return true;
+                    }
+                    while ( scanner.Next( path ) )
+                    {
+                        ++foundCount;
+                        if ( cliParams.shard.OwnsHash( ShardSpec::ShardKey( path, cliParams.src_imagePath ) ) )
+                            return true;
+                    }
+                    return false;
+                };
+                while ( nextImage( imgPath ) )
+                {
+                    manifestKey.clear();
+                    if ( manifest.IsOpen() && GC_OK == RunManifest::MakeKey( imgPath, calibHash, manifestKey ) &&
+                         manifest.IsComplete( manifestKey ) )
+                    {
+                        ++skippedCount;
+                        continue;
+                    }
+                    if ( !result_folder.empty() )
+                    {
+                        params.resultImagePath = result_folder +
+                                fs::path( imgPath ).stem().string() + "_overlay.png";
+                    }
+                    params.imagePath = imgPath;
+                    retVal = pipeline.Push( params, manifestKey );
+                    if ( GC_OK != retVal )
+                        break;
+                }
+                scanner.Stop();
+                GC_STATUS retFinish = pipeline.Finish();
+                retVal = GC_OK == retVal ? retFinish : retVal;
 
-                string lineRoiFolder = cliParams.line_roi_folder;
+                if ( 0 == foundCount )
+                {
+                    FILE_LOG( logERROR ) << "No images found in " << cliParams.src_imagePath << endl;
+                    retVal = GC_ERR;
+                }
+                else
+                {
+                    PrintRunSummary( pipeline.Stats(), skippedCount );
+                }
+            }
+            if ( manifest.IsOpen() )
+            {
+                GC_STATUS retClose = manifest.Close();
+                retVal = GC_OK == retVal ? retClose : retVal;
+            }
+            cout << endl;
+        }
+    }
+    catch( const boost::exception &e )
+    {
+        FILE_LOG( logERROR ) << diagnostic_information( e );
+        retVal = GC_EXCEPT;
+    }
+
+    return retVal;
+}
+GC_STATUS RunArchive( const Grime2CLIParams cliParams )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        if ( "from_filename" != cliParams.timestamp_type )
+        {
+            FILE_LOG( logERROR ) << "Archive entries need --timestamp_from_filename: " << cliParams.src_imagePath;
+            retVal = GC_ERR;
+        }
+        else if ( cliParams.shard.IsSharded() && cliParams.shard.byTime )
+        {
+            FILE_LOG( logERROR ) << "Archive sources can only be sharded by hash: " << cliParams.src_imagePath;
+            retVal = GC_ERR;
+        }
+        if ( !cliParams.manifestPath.empty() )
+        {
+            FILE_LOG( logWARNING ) << "--manifest is not used for archive sources";
+        }
 
-                Grime2CLIParams cliParamsAdj = cliParams;
-                for ( size_t i = 0; i < images.size(); ++i )
+        TarImageSource archive;
+        if ( GC_OK == retVal )
+        {
+            retVal = archive.Open( cliParams.src_imagePath );
+        }
+        if ( GC_OK == retVal )
+        {
+            string result_folder = cliParams.result_imagePath;
+            if ( !result_folder.empty() )
+            {
+                if ( '/' != result_folder[ result_folder.size() - 1 ] )
+                    result_folder += '/';
+            }
+
+            FindLinePipelineConfig config;
+            config.workerThreads = cliParams.worker_threads;
+            config.memoryBudgetBytes = static_cast< size_t >( std::max( 0, cliParams.memory_budgetMB ) ) << 20;
+            config.trackMemory = cliParams.memory_stats;
+            config.readThreads = cliParams.read_threads;
+            config.freshEngine = cliParams.fresh_engine;
+
+            FindLinePipeline pipeline;
+            retVal = pipeline.Start( config, [ &cliParams ]( const FindLineParams &, const FindLineResult &,
+                                                             const string &resultJson, const GC_STATUS )
+                                                             { OutputFindLineResult( cliParams, resultJson ); } );
+            if ( GC_OK == retVal )
+            {
+                // entries go from the archive straight to the decode threads, nothing is extracted
+                size_t foundCount = 0;
+                string entryName;
+                vector< uchar > encoded;
+                FindLineParams params;
+                FormFindLineParams( cliParams, params );
+                while ( archive.Next( entryName, encoded ) )
                 {
+                    ++foundCount;
+                    if ( !cliParams.shard.OwnsHash( entryName ) )
+                        continue;
+                    params.imagePath = cliParams.src_imagePath + "/" + entryName;
                     if ( !result_folder.empty() )
                     {
-                        cliParamsAdj.result_imagePath = result_folder +
-                                fs::path( images[ i ] ).stem().string() + "_overlay.png";
+                        params.resultImagePath = result_folder +
+                                fs::path( entryName ).stem().string() + "_overlay.png";
                     }
-                    cliParamsAdj.src_imagePath = images[ i ];
-                    retVal = FindWaterLevel( cliParamsAdj );
+                    retVal = pipeline.PushEncoded( params, std::move( encoded ) );
+                    if ( GC_OK != retVal )
+                        break;
+                    encoded.clear();
+                }
+                GC_STATUS retFinish = pipeline.Finish();
+                retVal = GC_OK == retVal ? retFinish : retVal;
+                if ( archive.HasFailed() )
+                {
+                    FILE_LOG( logERROR ) << "Stopped at a bad entry in " << cliParams.src_imagePath;
+                    retVal = GC_OK == retVal ? GC_ERR : retVal;
+                }
+
+                if ( 0 == foundCount )
+                {
+                    FILE_LOG( logERROR ) << "No images found in " << cliParams.src_imagePath << endl;
+                    retVal = GC_ERR;
+                }
+                else
+                {
+                    PrintRunSummary( pipeline.Stats() );
                 }
-                cout << endl;
             }
+            archive.Close();
+            cout << endl;
         }
     }
     catch( const boost::exception &e )
@@ -321,13 +567,422 @@ GC_STATUS RunFolder( const Grime2CLIParams cliParams )
         FILE_LOG( logERROR ) << diagnostic_information( e );
         retVal = GC_EXCEPT;
     }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[RunArchive] " << e.what();
+        retVal = GC_EXCEPT;
+    }
 
     return retVal;
 }
-GC_STATUS FindWaterLevel(const Grime2CLIParams cliParams )
+GC_STATUS RunBatch( const Grime2CLIParams cliParams )
 {
-    FindLineParams params;
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        BatchManifest batch;
+        retVal = batch.Load( cliParams.src_imagePath );
+        if ( GC_OK == retVal )
+        {
+            const vector< BatchSite > &sites = batch.Sites();
+
+            FindLinePipelineConfig config;
+            config.workerThreads = cliParams.worker_threads;
+            config.memoryBudgetBytes = static_cast< size_t >( std::max( 0, cliParams.memory_budgetMB ) ) << 20;
+            config.trackMemory = cliParams.memory_stats;
+            config.readThreads = cliParams.read_threads;
+            config.freshEngine = cliParams.fresh_engine;
+            config.engineCacheSize = cliParams.engine_cacheSize;
+
+            // one pipeline for all sites, so the find threads move straight on to the next
+            // site instead of waiting for the last images of the current one
+            FindLinePipeline pipeline;
+            retVal = pipeline.Start( config, [ &cliParams ]( const FindLineParams &, const FindLineResult &,
+                                                             const string &resultJson, const GC_STATUS )
+                                                             { OutputFindLineResult( cliParams, resultJson ); } );
+            if ( GC_OK == retVal )
+            {
+                auto listSite = [ &sites, &cliParams ]( const size_t idx, vector< string > &images )
+                {
+                    return BatchManifest::ExpandSource( sites[ idx ].source, images, cliParams.scan_threads );
+                };
+
+                size_t failedSites = 0;
+                vector< string > images;
+                vector< string > nextImages;
+                future< GC_STATUS > nextListed = async( launch::async, listSite, 0, std::ref( nextImages ) );
+                for ( size_t i = 0; i < sites.size() && GC_OK == retVal; ++i )
+                {
+                    // the next site is listed while the images of this one are pushed
+                    GC_STATUS retList = nextListed.get();
+                    images.swap( nextImages );
+                    if ( i + 1 < sites.size() )
+                    {
+                        nextListed = async( launch::async, listSite, i + 1, std::ref( nextImages ) );
+                    }
+
+                    const BatchSite &site = sites[ i ];
+                    if ( GC_OK != retList || images.empty() )
+                    {
+                        FILE_LOG( logERROR ) << "No images found for site " << site.name << " in " << site.source;
+                        ++failedSites;
+                        continue;
+                    }
+
+                    Grime2CLIParams siteParams = cliParams;
+                    siteParams.calib_jsonPath = site.calibPath;
+                    if ( !site.csvPath.empty() )
+                        siteParams.csvPath = site.csvPath;
+                    if ( !site.resultLogPath.empty() )
+                        siteParams.result_logPath = site.resultLogPath;
+                    string result_folder = site.resultFolder.empty() ? cliParams.result_imagePath : site.resultFolder;
+                    if ( !result_folder.empty() )
+                    {
+                        if ( '/' != result_folder[ result_folder.size() - 1 ] )
+                            result_folder += '/';
+                    }
+
+                    retVal = SelectShard( cliParams, BatchManifest::SourceFolder( site.source ), images );
+                    if ( GC_OK != retVal )
+                        break;
+
+                    FindLineParams params;
+                    FormFindLineParams( siteParams, params );
+                    for ( size_t j = 0; j < images.size(); ++j )
+                    {
+                        params.imagePath = images[ j ];
+                        if ( !result_folder.empty() )
+                        {
+                            params.resultImagePath = result_folder +
+                                    fs::path( images[ j ] ).stem().string() + "_overlay.png";
+                        }
+                        retVal = pipeline.Push( params );
+                        if ( GC_OK != retVal )
+                            break;
+                    }
+                }
+                if ( nextListed.valid() )
+                {
+                    nextListed.wait();
+                }
+                GC_STATUS retFinish = pipeline.Finish();
+                retVal = GC_OK == retVal ? retFinish : retVal;
+
+                if ( failedSites == sites.size() )
+                {
+                    retVal = GC_ERR;
+                }
+                else
+                {
+                    if ( 0 < failedSites )
+                        cerr << "Sites without images: " << failedSites << " of " << sites.size() << endl;
+                    PrintRunSummary( pipeline.Stats() );
+                }
+            }
+            cout << endl;
+        }
+    }
+    catch( const boost::exception &e )
+    {
+        FILE_LOG( logERROR ) << diagnostic_information( e );
+        retVal = GC_EXCEPT;
+    }
+
+    return retVal;
+}
+GC_STATUS SelectShard( const Grime2CLIParams &cliParams, const string &sourceFolder, vector< string > &images )
+{
+    GC_STATUS retVal = GC_OK;
+    if ( !cliParams.shard.IsSharded() )
+    {
+        return retVal;
+    }
+
+    vector< string > selected;
+    if ( !cliParams.shard.byTime )
+    {
+        for ( size_t i = 0; i < images.size(); ++i )
+        {
+            if ( cliParams.shard.OwnsHash( ShardSpec::ShardKey( images[ i ], sourceFolder ) ) )
+                selected.push_back( images[ i ] );
+        }
+    }
+    else if ( "from_filename" != cliParams.timestamp_type )
+    {
+        FILE_LOG( logERROR ) << "--shard_by time needs --timestamp_from_filename";
+        retVal = GC_ERR;
+    }
+    else
+    {
+        // images whose names hold no timestamp cannot be put in a time range, so they go by hash
+        vector< ShardItem > items;
+        vector< string > untimed;
+        string timestamp;
+        int64_t secs = 0;
+        for ( size_t i = 0; i < images.size(); ++i )
+        {
+            string key = ShardSpec::ShardKey( images[ i ], sourceFolder );
+            if ( GC_OK == GcTimestampConvert::GetTimestampFromString( fs::path( images[ i ] ).filename().string(), cliParams.timestamp_startPos,
+                                                                      cliParams.timestamp_format, timestamp ) &&
+                 GC_OK == ResultLogReader::TimestampToSeconds( timestamp, secs ) )
+            {
+                items.push_back( ShardItem( secs, images[ i ], key ) );
+            }
+            else if ( cliParams.shard.OwnsHash( key ) )
+            {
+                untimed.push_back( images[ i ] );
+            }
+        }
+        cliParams.shard.SelectTimeRange( items );
+        for ( size_t i = 0; i < items.size(); ++i )
+            selected.push_back( items[ i ].path );
+        if ( !untimed.empty() )
+        {
+            FILE_LOG( logWARNING ) << untimed.size() << " images without a filename timestamp were sharded by hash";
+            selected.insert( selected.end(), untimed.begin(), untimed.end() );
+        }
+    }
+    images.swap( selected );
+    return retVal;
+}
+GC_STATUS MergeResults( const Grime2CLIParams cliParams )
+{
+    GC_STATUS retVal = GC_OK;
+    if ( cliParams.merge_inputs.empty() )
+    {
+        FILE_LOG( logERROR ) << "No shard results to merge into " << cliParams.merge_outputPath;
+        retVal = GC_ERR;
+    }
+    else
+    {
+        ResultMergeStats stats;
+        string ext = fs::path( cliParams.merge_outputPath ).extension().string();
+        transform( ext.begin(), ext.end(), ext.begin(), []( unsigned char c ) { return static_cast< char >( tolower( c ) ); } );
+        if ( ".csv" == ext )
+        {
+            retVal = ResultMerger::MergeCSV( cliParams.merge_inputs, cliParams.merge_outputPath, stats );
+        }
+        else
+        {
+            retVal = ResultMerger::MergeLogs( cliParams.merge_inputs, cliParams.merge_outputPath, stats );
+        }
+        if ( GC_OK == retVal )
+        {
+            cerr << "Merged " << cliParams.merge_inputs.size() << " inputs: " << stats.inputRows << " rows in, " << stats.outputRows << " rows out, "
+                 << stats.duplicateRows << " duplicates, " << stats.conflictRows << " conflicts" << endl;
+            if ( 0 < stats.conflictRows )
+            {
+                FILE_LOG( logERROR ) << stats.conflictRows << " rows had the same image and timestamp as a kept row but different values";
+                retVal = GC_ERR;
+            }
+        }
+    }
+    cout << "Merge: " << ( GC_OK == retVal ? "SUCCESS" : "FAILURE" ) << endl;
+    return retVal;
+}
+GC_STATUS RunVideo( const Grime2CLIParams cliParams )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        string startTime = cliParams.video_startTime;
+        if ( cliParams.shard.IsSharded() )
+        {
+            FILE_LOG( logERROR ) << "--shard is not supported for video sources, split the video with --video_start instead";
+            retVal = GC_ERR;
+        }
+        else if ( startTime.empty() && "from_filename" == cliParams.timestamp_type )
+        {
+            retVal = GcTimestampConvert::GetTimestampFromString( fs::path( cliParams.src_imagePath ).filename().string(),
+                                                                 cliParams.timestamp_startPos, cliParams.timestamp_format, startTime );
+        }
+        if ( GC_OK == retVal && startTime.empty() )
+        {
+            FILE_LOG( logERROR ) << "No start time for " << cliParams.src_imagePath << ", use --video_start or --timestamp_from_filename";
+            retVal = GC_ERR;
+        }
+
+        VideoFrameSource video;
+        if ( GC_OK == retVal )
+        {
+            retVal = video.Open( cliParams.src_imagePath, startTime, cliParams.frame_step );
+        }
+        if ( GC_OK == retVal )
+        {
+            string result_folder = cliParams.result_imagePath;
+            if ( !result_folder.empty() )
+            {
+                if ( '/' != result_folder[ result_folder.size() - 1 ] )
+                    result_folder += '/';
+            }
+
+            FindLinePipelineConfig config;
+            config.workerThreads = cliParams.worker_threads;
+            config.memoryBudgetBytes = static_cast< size_t >( std::max( 0, cliParams.memory_budgetMB ) ) << 20;
+            config.trackMemory = cliParams.memory_stats;
+            config.freshEngine = cliParams.fresh_engine;
+
+            FindLinePipeline pipeline;
+            retVal = pipeline.Start( config, [ &cliParams ]( const FindLineParams &, const FindLineResult &,
+                                                             const string &resultJson, const GC_STATUS )
+                                                             { OutputFindLineResult( cliParams, resultJson ); } );
+            if ( GC_OK == retVal )
+            {
+                cv::Mat frame;
+                int64_t frameIndex = 0;
+                string timestamp;
+                string videoStem = fs::path( cliParams.src_imagePath ).stem().string();
+                FindLineParams params;
+                FormFindLineParams( cliParams, params );
+                while ( video.Next( frame, frameIndex, timestamp ) )
+                {
+                    params.imagePath = VideoFrameSource::FramePath( cliParams.src_imagePath, frameIndex );
+                    if ( !result_folder.empty() )
+                    {
+                        params.resultImagePath = result_folder + videoStem + "_" +
+                                fs::path( params.imagePath ).filename().string() + "_overlay.png";
+                    }
+                    retVal = pipeline.PushImage( params, frame, timestamp );
+                    if ( GC_OK != retVal )
+                        break;
 
+                    // the queued frame keeps this buffer, so the next frame must be decoded into a new one
+                    frame.release();
+                }
+                GC_STATUS retFinish = pipeline.Finish();
+                retVal = GC_OK == retVal ? retFinish : retVal;
+                PrintRunSummary( pipeline.Stats() );
+            }
+            video.Close();
+            cout << endl;
+        }
+    }
+    catch( const boost::exception &e )
+    {
+        FILE_LOG( logERROR ) << diagnostic_information( e );
+        retVal = GC_EXCEPT;
+    }
+
+    return retVal;
+}
+static volatile sig_atomic_t g_stopRequested = 0;
+static void StopRequestHandler( int )
+{
+    g_stopRequested = 1;
+}
+GC_STATUS WatchFolder( const Grime2CLIParams cliParams )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        string result_folder = cliParams.result_imagePath;
+        if ( !result_folder.empty() )
+        {
+            if ( '/' != result_folder[ result_folder.size() - 1 ] )
+                result_folder += '/';
+        }
+
+        FindLinePipelineConfig config;
+        config.workerThreads = cliParams.worker_threads;
+        config.memoryBudgetBytes = static_cast< size_t >( std::max( 0, cliParams.memory_budgetMB ) ) << 20;
+        config.trackMemory = cliParams.memory_stats;
+        config.readThreads = cliParams.read_threads;
+        config.freshEngine = cliParams.fresh_engine;
+
+        FolderWatcher watcher;
+        retVal = watcher.Start( cliParams.src_imagePath );
+        if ( GC_OK == retVal )
+        {
+            FindLinePipeline pipeline;
+            retVal = pipeline.Start( config, [ &cliParams ]( const FindLineParams &, const FindLineResult &,
+                                                             const string &resultJson, const GC_STATUS )
+                                                             { OutputFindLineResult( cliParams, resultJson ); } );
+            if ( GC_OK == retVal )
+            {
+                g_stopRequested = 0;
+                signal( SIGINT, StopRequestHandler );
+                signal( SIGTERM, StopRequestHandler );
+                FILE_LOG( logINFO ) << "Watching " << cliParams.src_imagePath << " for new images";
+
+                FindLineParams params;
+                FormFindLineParams( cliParams, params );
+                vector< string > images;
+                auto lastImageTime = chrono::steady_clock::now();
+                while ( !g_stopRequested )
+                {
+                    retVal = watcher.WaitForFiles( images, 500 );
+                    if ( GC_OK != retVal )
+                        break;
+
+                    for ( size_t i = 0; i < images.size(); ++i )
+                    {
+                        if ( !result_folder.empty() )
+                        {
+                            params.resultImagePath = result_folder +
+                                    fs::path( images[ i ] ).stem().string() + "_overlay.png";
+                        }
+                        params.imagePath = images[ i ];
+                        retVal = pipeline.Push( params );
+                        if ( GC_OK != retVal )
+                            break;
+                    }
+                    if ( GC_OK != retVal )
+                        break;
+
+                    if ( !images.empty() )
+                    {
+                        lastImageTime = chrono::steady_clock::now();
+                    }
+                    else if ( 0 < cliParams.watch_idleSecs &&
+                              cliParams.watch_idleSecs <= chrono::duration_cast< chrono::seconds >(
+                                  chrono::steady_clock::now() - lastImageTime ).count() )
+                    {
+                        break;
+                    }
+                }
+                signal( SIGINT, SIG_DFL );
+                signal( SIGTERM, SIG_DFL );
+
+                GC_STATUS retFinish = pipeline.Finish();
+                retVal = GC_OK == retVal ? retFinish : retVal;
+                PrintRunSummary( pipeline.Stats() );
+            }
+            watcher.Stop();
+        }
+    }
+    catch( const boost::exception &e )
+    {
+        FILE_LOG( logERROR ) << diagnostic_information( e );
+        retVal = GC_EXCEPT;
+    }
+
+    return retVal;
+}
+GC_STATUS ServeRequests( const Grime2CLIParams cliParams )
+{
+    GC_STATUS retVal = GC_OK;
+    RequestServerConfig config;
+    config.workerThreads = cliParams.worker_threads;
+
+    RequestServer server;
+    if ( cliParams.serve_socketPath.empty() )
+    {
+        retVal = server.ServeStream( cin, cout, config );
+    }
+    else
+    {
+        g_stopRequested = 0;
+        signal( SIGINT, StopRequestHandler );
+        signal( SIGTERM, StopRequestHandler );
+        retVal = server.ServeSocket( cliParams.serve_socketPath, config, []{ return 0 != g_stopRequested; } );
+        signal( SIGINT, SIG_DFL );
+        signal( SIGTERM, SIG_DFL );
+    }
+    FILE_LOG( logINFO ) << "Answered " << server.AnsweredCount() << " requests";
+    return retVal;
+}
+void FormFindLineParams( const Grime2CLIParams cliParams, FindLineParams &params )
+{
     params.imagePath = cliParams.src_imagePath;
     params.calibFilepath = cliParams.calib_jsonPath;
     params.resultImagePath = cliParams.result_imagePath;
@@ -336,11 +991,42 @@ GC_STATUS FindWaterLevel(const Grime2CLIParams cliParams )
     params.timeStampType = cliParams.timestamp_type == "from_filename" ? FROM_FILENAME : FROM_EXIF;
     params.timeStampStartPos = cliParams.timestamp_startPos;
     params.lineSearchROIFolder = cliParams.line_roi_folder;
-
-    VisApp visApp;
-    string resultJson;
-    FindLineResult result;
-    GC_STATUS retVal = visApp.CalcLine( params, result, resultJson );
+    params.resultLogPath = cliParams.result_logPath;
+}
+GC_STATUS ExportResultLog( const Grime2CLIParams cliParams )
+{
+    GC_STATUS retVal = GC_OK;
+    if ( cliParams.csvPath.empty() )
+    {
+        FILE_LOG( logERROR ) << "No csv file specified for result log export";
+        retVal = GC_ERR;
+    }
+    else
+    {
+        int64_t startSecs = numeric_limits< int64_t >::min();
+        int64_t endSecs = numeric_limits< int64_t >::max();
+        if ( !cliParams.log_startTime.empty() )
+        {
+            retVal = ResultLogReader::TimestampToSeconds( cliParams.log_startTime, startSecs );
+        }
+        if ( GC_OK == retVal && !cliParams.log_endTime.empty() )
+        {
+            retVal = ResultLogReader::TimestampToSeconds( cliParams.log_endTime, endSecs );
+        }
+        if ( GC_OK == retVal )
+        {
+            ResultLogReader reader;
+            retVal = reader.Open( cliParams.result_logPath );
+            if ( GC_OK == retVal )
+            {
+                retVal = reader.ExportCSV( cliParams.csvPath, startSecs, endSecs );
+            }
+        }
+    }
+    return retVal;
+}
+void OutputFindLineResult( const Grime2CLIParams &cliParams, const string &resultJson )
+{
     if ( cliParams.cache_result )
     {
         ofstream cache_file( TEMP_CACHE );
@@ -350,6 +1036,69 @@ GC_STATUS FindWaterLevel(const Grime2CLIParams cliParams )
         }
     }
     cout << resultJson << endl;
+}
+void PrintRunSummary( const FindLinePipelineStats &stats, const size_t skippedCount )
+{
+    // stdout carries the json results, so the summary goes to stderr
+    double perImageMs = 0 == stats.imageCount ? 0.0 : 1000.0 / static_cast< double >( stats.imageCount );
+    cerr << "~~~~~~~~~~~~~~~~~~~~" << endl;
+    cerr << "Run summary" << endl;
+    cerr << "~~~~~~~~~~~~~~~~~~~~" << endl;
+    cerr << fixed << setprecision( 3 );
+    cerr << "Images:          " << stats.imageCount << endl;
+    if ( 0 < skippedCount )
+        cerr << "Skipped:         " << skippedCount << " (already in manifest)" << endl;
+    cerr << "Run time:        " << stats.runSecs << " s";
+    if ( 0.0 < stats.runSecs )
+        cerr << " (" << static_cast< double >( stats.imageCount ) / stats.runSecs << " images/s)";
+    cerr << endl;
+    cerr << "Engines created: " << stats.engineCount << " (" << stats.engineSecs * 1000.0 << " ms total)" << endl;
+    if ( 0 < stats.engineEvictions )
+        cerr << "Engines evicted: " << stats.engineEvictions << " (raise --engine_cache to keep more calibrations loaded)" << endl;
+    cerr << "Per image engine setup: " << stats.engineSecs * perImageMs << " ms" << endl;
+    cerr << "Per image read:         " << stats.readSecs * perImageMs << " ms" << endl;
+    cerr << "Per image calib+find:   " << stats.findSecs * perImageMs << " ms" << endl;
+    cerr << "Per image write:        " << stats.writeSecs * perImageMs << " ms" << endl;
+    if ( !stats.stageTimes.empty() )
+    {
+        cerr << "Stage (ms)           images       p50       p95       max" << endl;
+        for ( const auto &stage : stats.stageTimes )
+        {
+            cerr << "  " << left << setw( 16 ) << stage.first << right
+                 << setw( 9 ) << stage.second.Count()
+                 << setw( 10 ) << stage.second.Percentile( 0.50 )
+                 << setw( 10 ) << stage.second.Percentile( 0.95 )
+                 << setw( 10 ) << stage.second.Max() << endl;
+        }
+    }
+    if ( 0 < stats.roiFindCount )
+        cerr << "Region finds:    " << stats.roiFindCount << " (preprocessed only around the search lines to fit --memory_budget_mb)" << endl;
+    if ( !stats.stageBytes.empty() )
+    {
+        cerr << "Stage (MB)           largest" << endl;
+        for ( const auto &stage : stats.stageBytes )
+        {
+            cerr << "  " << left << setw( 16 ) << stage.first << right
+                 << setw( 9 ) << static_cast< double >( stage.second ) / 1048576.0 << endl;
+        }
+        cerr << "Peak image memory:      " << static_cast< double >( stats.peakFindBytes ) / 1048576.0 << " MB per find, "
+             << static_cast< double >( stats.peakImageBytes ) / 1048576.0 << " MB total" << endl;
+    }
+    if ( 0 < stats.peakRssBytes )
+        cerr << "Peak resident memory:   " << static_cast< double >( stats.peakRssBytes ) / 1048576.0 << " MB" << endl;
+    cerr << "~~~~~~~~~~~~~~~~~~~~" << endl;
+    cerr << defaultfloat;
+}
+GC_STATUS FindWaterLevel(const Grime2CLIParams cliParams )
+{
+    FindLineParams params;
+    FormFindLineParams( cliParams, params );
+
+    VisApp visApp;
+    string resultJson;
+    FindLineResult result;
+    GC_STATUS retVal = visApp.CalcLine( params, result, resultJson );
+    OutputFindLineResult( cliParams, resultJson );
     return retVal;
 }
 GC_STATUS CreateGIF( const Grime2CLIParams cliParams )
@@ -433,6 +1182,40 @@ GC_STATUS CreateGIF( const Grime2CLIParams cliParams )
 
     return retVal;
 }
+GC_STATUS MakeSynthetic( const Grime2CLIParams cliParams )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        SyntheticSceneParams sceneParams;
+        if ( !cliParams.src_imagePath.empty() )
+        {
+            retVal = SyntheticScene::ReadParams( cliParams.src_imagePath, sceneParams );
+        }
+        if ( GC_OK == retVal )
+        {
+            if ( cliParams.result_imagePath.empty() )
+            {
+                FILE_LOG( logERROR ) << "[MakeSynthetic] No --result_folder specified";
+                retVal = GC_ERR;
+            }
+            else
+            {
+                SyntheticScene scene;
+                vector< SyntheticFrameTruth > truths;
+                retVal = scene.RenderSequence( sceneParams, cliParams.result_imagePath, truths );
+                cout << "{\"status\": \"" << ( GC_OK == retVal ? "SUCCESS" : "FAILURE" ) << "\", \"images\": " << truths.size()
+                     << ", \"ground_truth\": \"" << ( fs::path( cliParams.result_imagePath ) / "ground_truth.json" ).string() << "\"}" << endl;
+            }
+        }
+    }
+    catch( const std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[MakeSynthetic] " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
 
 void ShowVersion()
 {
@@ -0,0 +1,30 @@
+# Finds the water level in every image of a folder with the grime2 python module
+#
+#   python3 example.py calib.json image_folder
+#
+# Images are read with OpenCV (BGR, as the engine expects) and are passed to the
+# engine without being copied. Capture times can be given with the timestamp
+# argument of find() and the timestamps argument of find_batch().
+
+import sys
+import glob
+import os
+import cv2
+import grime2
+
+engine = grime2.Engine(sys.argv[1])
+
+paths = sorted(glob.glob(os.path.join(sys.argv[2], '*.png')) + glob.glob(os.path.join(sys.argv[2], '*.jpg')))
+imgs = [cv2.imread(p) for p in paths]
+
+# one image, result as a dict
+result = engine.find(imgs[0])
+print(os.path.basename(paths[0]), result['status'], result['level'], result['msgs'])
+
+# all images on all cores, result as a numpy record array
+records = engine.find_batch(imgs)
+for path, rec in zip(paths, records):
+    if grime2.GC_OK == rec['status']:
+        print('%s level=%.3f angle=%.3f' % (os.path.basename(path), rec['level'], rec['angle']))
+    else:
+        print('%s find failed' % os.path.basename(path))
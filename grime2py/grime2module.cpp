@@ -0,0 +1,256 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/** \file grime2module.cpp
+ * @brief Python bindings for the GRIME2 line find
+ *
+ * The grime2 module exposes an Engine that is created from a calibration file and finds the
+ * water line in NumPy images. Images are wrapped in cv::Mat headers without being copied, and
+ * the GIL is released while the line finds run, so other Python threads keep running and
+ * find_batch() spreads a batch over several native threads.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include "../algorithms/log.h"
+#include "../algorithms/visapp.h"
+#include "../algorithms/calibsnapshot.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace py = pybind11;
+using namespace gc;
+
+namespace
+{
+
+/**
+ * @brief One row of the record array returned by Engine.find_batch()
+ */
+struct FindRecord
+{
+    int32_t status;             ///< GC_OK=Success, GC_ERR=Failure, GC_EXCEPT=Exception thrown
+    bool find_success;          ///< true=Water line found
+    bool calib_success;         ///< true=Calibration target found
+    char timestamp[ 24 ];       ///< Timestamp given with the image (yyyy-mm-ddTHH:MM:SS)
+    double level;               ///< Water level (world units)
+    double angle;               ///< Angle of the water line (world, degrees)
+    double ctr_x;               ///< Water line center (pixels)
+    double ctr_y;
+    double lft_x;               ///< Water line left end (pixels)
+    double lft_y;
+    double rgt_x;               ///< Water line right end (pixels)
+    double rgt_y;
+    double octo_x;              ///< Octagon target center (pixels)
+    double octo_y;
+    double reproject_offset;    ///< Distance between the water line center and its reprojected world position (pixels)
+};
+
+void FillRecord( const GC_STATUS status, const FindLineResult &result, FindRecord &rec )
+{
+    rec.status = static_cast< int32_t >( status );
+    rec.find_success = result.findSuccess;
+    rec.calib_success = result.calibSuccess;
+    memset( rec.timestamp, 0, sizeof( rec.timestamp ) );
+    strncpy( rec.timestamp, result.timestamp.c_str(), sizeof( rec.timestamp ) - 1 );
+    rec.level = result.calcLinePts.ctrWorld.y;
+    rec.angle = result.calcLinePts.angleWorld;
+    rec.ctr_x = result.calcLinePts.ctrPixel.x;
+    rec.ctr_y = result.calcLinePts.ctrPixel.y;
+    rec.lft_x = result.calcLinePts.lftPixel.x;
+    rec.lft_y = result.calcLinePts.lftPixel.y;
+    rec.rgt_x = result.calcLinePts.rgtPixel.x;
+    rec.rgt_y = result.calcLinePts.rgtPixel.y;
+    rec.octo_x = result.octoCenter.x;
+    rec.octo_y = result.octoCenter.y;
+    rec.reproject_offset = result.calibReprojectOffset_dist;
+}
+
+// wraps the array data in a cv::Mat header; layouts a header cannot describe are refused
+// rather than silently copied
+cv::Mat MatFromArray( const py::array &arr )
+{
+    if ( !arr.dtype().is( py::dtype::of< uint8_t >() ) )
+        throw py::type_error( "image must be a uint8 array" );
+
+    const int channels = 2 == arr.ndim() ? 1 : ( 3 == arr.ndim() ? static_cast< int >( arr.shape( 2 ) ) : 0 );
+    if ( 1 != channels && 3 != channels && 4 != channels )
+        throw py::value_error( "image must have the shape (rows, cols) or (rows, cols, 1|3|4)" );
+
+    const py::ssize_t rows = arr.shape( 0 );
+    const py::ssize_t cols = arr.shape( 1 );
+    if ( 0 >= rows || 0 >= cols )
+        throw py::value_error( "image is empty" );
+    if ( arr.strides( 1 ) != channels || ( 3 == arr.ndim() && 1 != arr.strides( 2 ) ) || arr.strides( 0 ) < cols * channels )
+        throw py::value_error( "image pixels must be contiguous within each row (use numpy.ascontiguousarray)" );
+
+    return cv::Mat( static_cast< int >( rows ), static_cast< int >( cols ), CV_8UC( channels ),
+                    const_cast< void * >( arr.data() ), static_cast< size_t >( arr.strides( 0 ) ) );
+}
+
+py::dict ResultToDict( const GC_STATUS status, const FindLineResult &result )
+{
+    py::dict d;
+    d[ "status" ] = static_cast< int >( status );
+    d[ "find_success" ] = result.findSuccess;
+    d[ "calib_success" ] = result.calibSuccess;
+    d[ "timestamp" ] = result.timestamp;
+    d[ "level" ] = result.calcLinePts.ctrWorld.y;
+    d[ "angle" ] = result.calcLinePts.angleWorld;
+    d[ "ctr" ] = py::make_tuple( result.calcLinePts.ctrPixel.x, result.calcLinePts.ctrPixel.y );
+    d[ "lft" ] = py::make_tuple( result.calcLinePts.lftPixel.x, result.calcLinePts.lftPixel.y );
+    d[ "rgt" ] = py::make_tuple( result.calcLinePts.rgtPixel.x, result.calcLinePts.rgtPixel.y );
+    d[ "ctr_world" ] = py::make_tuple( result.calcLinePts.ctrWorld.x, result.calcLinePts.ctrWorld.y );
+    d[ "lft_world" ] = py::make_tuple( result.calcLinePts.lftWorld.x, result.calcLinePts.lftWorld.y );
+    d[ "rgt_world" ] = py::make_tuple( result.calcLinePts.rgtWorld.x, result.calcLinePts.rgtWorld.y );
+    d[ "octo_center" ] = py::make_tuple( result.octoCenter.x, result.octoCenter.y );
+    d[ "reproject_offset" ] = result.calibReprojectOffset_dist;
+    d[ "msgs" ] = result.msgs;
+    return d;
+}
+
+/**
+ * @brief Calibrated line find engine. All methods may be called from several Python threads at
+ *        once, each call finds against the same shared calibration with its own context
+ */
+class Engine
+{
+public:
+    explicit Engine( const std::string &calibPath )
+    {
+        if ( GC_OK != CalibrationSnapshot::Create( calibPath, m_snapshot ) )
+            throw std::runtime_error( "could not load calibration " + calibPath );
+    }
+
+    std::string CalibPath() const { return m_snapshot->CalibPath(); }
+
+    py::dict Find( const py::array &img, const std::string &timestamp )
+    {
+        cv::Mat mat = MatFromArray( img );
+        FindLineResult result;
+        if ( !timestamp.empty() )
+            result.timestamp = timestamp;
+
+        GC_STATUS status = GC_OK;
+        {
+            py::gil_scoped_release release;
+            FindLineContextLease lease( m_contexts );
+            status = VisApp::CalcLine( m_snapshot, lease.Context(), mat, result );
+        }
+        return ResultToDict( status, result );
+    }
+
+    py::array_t< FindRecord > FindBatch( const py::list &imgs, const py::object &timestamps, const int threads )
+    {
+        // the arrays are held here so their buffers outlive the native threads
+        std::vector< py::array > arrays;
+        std::vector< cv::Mat > mats;
+        std::vector< std::string > stamps;
+        for ( const py::handle item : imgs )
+        {
+            if ( !py::isinstance< py::array >( item ) )
+                throw py::type_error( "imgs must be a list of numpy arrays" );
+            arrays.push_back( py::reinterpret_borrow< py::array >( item ) );
+            mats.push_back( MatFromArray( arrays.back() ) );
+        }
+        if ( !timestamps.is_none() )
+        {
+            stamps = timestamps.cast< std::vector< std::string > >();
+            if ( stamps.size() != mats.size() )
+                throw py::value_error( "timestamps must have one entry per image" );
+        }
+
+        py::array_t< FindRecord > records( static_cast< py::ssize_t >( mats.size() ) );
+        FindRecord *recs = records.mutable_data();
+        {
+            py::gil_scoped_release release;
+            size_t threadCnt = 0 < threads ? static_cast< size_t >( threads ) : std::max( 1u, std::thread::hardware_concurrency() );
+            threadCnt = std::min( threadCnt, std::max( static_cast< size_t >( 1 ), mats.size() ) );
+
+            std::atomic< size_t > next( 0 );
+            auto work = [ & ]()
+            {
+                FindLineContextLease lease( m_contexts );
+                for ( size_t i = next++; i < mats.size(); i = next++ )
+                {
+                    FindLineResult result;
+                    GC_STATUS status = GC_OK;
+                    try
+                    {
+                        if ( !stamps.empty() && !stamps[ i ].empty() )
+                            result.timestamp = stamps[ i ];
+                        status = VisApp::CalcLine( m_snapshot, lease.Context(), mats[ i ], result );
+                    }
+                    catch( std::exception &e )
+                    {
+                        FILE_LOG( logERROR ) << "[grime2.Engine.find_batch] " << e.what();
+                        status = GC_EXCEPT;
+                    }
+                    FillRecord( status, result, recs[ i ] );
+                }
+            };
+
+            std::vector< std::thread > pool;
+            for ( size_t i = 1; i < threadCnt; ++i )
+                pool.emplace_back( work );
+            work();
+            for ( auto &t : pool )
+                t.join();
+        }
+        return records;
+    }
+
+private:
+    std::shared_ptr< const CalibrationSnapshot > m_snapshot;
+    FindLineContextPool m_contexts;
+};
+
+} // namespace
+
+PYBIND11_MODULE( grime2, m )
+{
+    m.doc() = "GaugeCam GRIME2 water level line find";
+    m.attr( "__version__" ) = GAUGECAM_VISAPP_VERSION;
+    m.attr( "GC_OK" ) = static_cast< int >( GC_OK );
+    m.attr( "GC_WARN" ) = static_cast< int >( GC_WARN );
+    m.attr( "GC_ERR" ) = static_cast< int >( GC_ERR );
+    m.attr( "GC_EXCEPT" ) = static_cast< int >( GC_EXCEPT );
+
+    PYBIND11_NUMPY_DTYPE( FindRecord, status, find_success, calib_success, timestamp, level, angle,
+                          ctr_x, ctr_y, lft_x, lft_y, rgt_x, rgt_y, octo_x, octo_y, reproject_offset );
+
+    py::class_< Engine >( m, "Engine", "Line find engine for one calibration, safe to share between threads" )
+        .def( py::init< const std::string & >(), py::arg( "calib_path" ),
+              "Load a calibration json file and build its octagon search templates" )
+        .def_property_readonly( "calib_path", &Engine::CalibPath )
+        .def( "find", &Engine::Find, py::arg( "img" ), py::arg( "timestamp" ) = "",
+              "Find the water line in a uint8 gray, BGR, or BGRA image. Returns a dict" )
+        .def( "find_batch", &Engine::FindBatch, py::arg( "imgs" ), py::arg( "timestamps" ) = py::none(),
+              py::arg( "threads" ) = 0,
+              "Find the water line in a list of images on several threads (0=one per core). "
+              "Returns a record array with one row per image" );
+}
@@ -0,0 +1,115 @@
+TEMPLATE = lib
+CONFIG += plugin no_plugin_name_prefix c++17 thread
+CONFIG -= qt
+CONFIG += release
+CONFIG -= debug
+
+# python imports the module as grime2 (grime2.so, grime2.pyd on Windows)
+TARGET = grime2
+
+DEFINES += BOOST_ALL_NO_LIB BOOST_BIND_GLOBAL_PLACEHOLDERS
+
+# log messages are written by the calling thread, a library cannot safely stop the log
+# drain thread from a static destructor (see algorithms/log.h)
+DEFINES += FILELOG_SYNCHRONOUS
+
+# the python the module is built for, override with qmake PYTHON=/path/to/python3
+isEmpty(PYTHON): PYTHON = python3
+PYBIND11_CFLAGS = $$system($$PYTHON -m pybind11 --includes)
+isEmpty(PYBIND11_CFLAGS): error("pybind11 not found for $$PYTHON (pip install pybind11)")
+QMAKE_CXXFLAGS += $$PYBIND11_CFLAGS
+
+# pybind11 needs its symbols hidden so modules built against other versions do not clash
+!win32: QMAKE_CXXFLAGS += -fvisibility=hidden
+
+win32 {
+    DEFINES += NOMINMAX
+    DEFINES += WIN32_LEAN_AND_MEAN
+    DEFINES += _WIN32_WINNT=0x0501
+    OPENCV_INCLUDES = c:/opencv/opencv_4.10.0/include
+    OPENCV_LIBS = C:/opencv/opencv_4.10.0/x64/vc19/lib
+    BOOST_INCLUDES = C:/Boost/boost_1_86/include
+    BOOST_LIBS = C:/Boost/boost_1_86/lib
+    PYTHON_LIBS = $$system($$PYTHON -c \"import sys; print(sys.base_prefix)\")/libs
+    QMAKE_EXTENSION_SHLIB = pyd
+}
+
+SOURCES += \
+    ../algorithms/animate.cpp \
+    ../algorithms/calibcache.cpp \
+    ../algorithms/calibexecutive.cpp \
+    ../algorithms/caliboctagon.cpp \
+    ../algorithms/calibsnapshot.cpp \
+    ../algorithms/findline.cpp \
+    ../algorithms/framecontext.cpp \
+    ../algorithms/gifanim/gifanim.cpp \
+    ../algorithms/memorybudget.cpp \
+    ../algorithms/metadata.cpp \
+    ../algorithms/octagonsearch.cpp \
+    ../algorithms/octorefine.cpp \
+    ../algorithms/resultlog.cpp \
+    ../algorithms/resultsink.cpp \
+    ../algorithms/searchlines.cpp \
+    ../algorithms/visapp.cpp \
+    grime2module.cpp
+
+HEADERS += \
+    ../algorithms/animate.h \
+    ../algorithms/bresenham.h \
+    ../algorithms/calibcache.h \
+    ../algorithms/calibexecutive.h \
+    ../algorithms/caliboctagon.h \
+    ../algorithms/calibsnapshot.h \
+    ../algorithms/findline.h \
+    ../algorithms/framecontext.h \
+    ../algorithms/gc_types.h \
+    ../algorithms/homography.h \
+    ../algorithms/jsonwriter.h \
+    ../algorithms/gifanim/gifanim.h \
+    ../algorithms/log.h \
+    ../algorithms/memorybudget.h \
+    ../algorithms/metadata.h \
+    ../algorithms/octagonsearch.h \
+    ../algorithms/octorefine.h \
+    ../algorithms/resultlog.h \
+    ../algorithms/resultsink.h \
+    ../algorithms/searchlines.h \
+    ../algorithms/stagetimer.h \
+    ../algorithms/visapp.h
+
+DISTFILES += \
+    example.py
+
+unix:!macx {
+    INCLUDEPATH +=  /usr/local/include \
+                    /usr/local/include/opencv4
+
+    LIBS += -L/usr/local/lib \
+            -lopencv_core \
+            -lopencv_imgproc \
+            -lopencv_imgcodecs \
+            -lopencv_calib3d \
+            -lboost_date_time \
+            -lboost_system \
+            -lboost_chrono
+}
+else {
+    INCLUDEPATH += $$BOOST_INCLUDES \
+                   $$OPENCV_INCLUDES
+    DEPENDPATH += $$BOOST_INCLUDES \
+                  $$BOOST_LIBS \
+                  $$OPENCV_INCLUDES \
+                  $$OPENCV_LIBS
+
+    LIBS += -L$$BOOST_LIBS \
+            -L$$OPENCV_LIBS \
+            -L$$PYTHON_LIBS \
+            -lopencv_core4100 \
+            -lopencv_imgproc4100 \
+            -lopencv_imgcodecs4100 \
+            -lopencv_calib3d4100 \
+            -llibboost_date_time-vc143-mt-x64-1_86 \
+            -llibboost_system-vc143-mt-x64-1_86 \
+            -llibboost_chrono-vc143-mt-x64-1_86 \
+            -ladvapi32
+}
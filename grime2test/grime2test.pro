@@ -0,0 +1,108 @@
+TEMPLATE = app
+CONFIG += console c++17 thread
+CONFIG -= app_bundle
+CONFIG -= qt
+
+# make check runs the suite, with the timing checks against an optimized build
+CONFIG += testcase
+CONFIG += release
+CONFIG -= debug
+
+DEFINES += BOOST_ALL_NO_LIB BOOST_BIND_GLOBAL_PLACEHOLDERS
+
+# per stage timings compared against the stored baseline
+DEFINES += GC_STAGE_TIMING
+
+# field frames and calibration, the golden and baseline files, and the commit they are recorded against
+DEFINES += GRIME2TEST_DATA_DIR=\\\"$$PWD/../gcgui/config\\\"
+DEFINES += GRIME2TEST_SOURCE_DIR=\\\"$$PWD\\\"
+GIT_REV = $$system(git -C $$PWD rev-parse --short HEAD)
+!isEmpty(GIT_REV): DEFINES += GRIME2TEST_GIT_REV=\\\"$$GIT_REV\\\"
+
+win32 {
+    DEFINES += NOMINMAX
+    DEFINES += WIN32_LEAN_AND_MEAN
+    DEFINES += _WIN32_WINNT=0x0501
+    OPENCV_INCLUDES = c:/opencv/opencv_4.10.0/include
+    OPENCV_LIBS = C:/opencv/opencv_4.10.0/x64/vc19/lib
+    BOOST_INCLUDES = C:/Boost/boost_1_86/include
+    BOOST_LIBS = C:/Boost/boost_1_86/lib
+}
+
+SOURCES += \
+    ../algorithms/animate.cpp \
+    ../algorithms/calibcache.cpp \
+    ../algorithms/calibsnapshot.cpp \
+    ../algorithms/calibexecutive.cpp \
+    ../algorithms/caliboctagon.cpp \
+    ../algorithms/findline.cpp \
+    ../algorithms/framecontext.cpp \
+    ../algorithms/gifanim/gifanim.cpp \
+    ../algorithms/memorybudget.cpp \
+    ../algorithms/metadata.cpp \
+    ../algorithms/octagonsearch.cpp \
+    ../algorithms/octorefine.cpp \
+    ../algorithms/resultlog.cpp \
+    ../algorithms/resultsink.cpp \
+    ../algorithms/searchlines.cpp \
+    ../algorithms/syntheticscene.cpp \
+    ../algorithms/visapp.cpp \
+    main.cpp
+
+HEADERS += \
+    ../algorithms/animate.h \
+    ../algorithms/bresenham.h \
+    ../algorithms/calibcache.h \
+    ../algorithms/calibsnapshot.h \
+    ../algorithms/calibexecutive.h \
+    ../algorithms/caliboctagon.h \
+    ../algorithms/findline.h \
+    ../algorithms/framecontext.h \
+    ../algorithms/gc_types.h \
+    ../algorithms/homography.h \
+    ../algorithms/jsonwriter.h \
+    ../algorithms/gifanim/gifanim.h \
+    ../algorithms/log.h \
+    ../algorithms/memorybudget.h \
+    ../algorithms/metadata.h \
+    ../algorithms/octagonsearch.h \
+    ../algorithms/octorefine.h \
+    ../algorithms/resultlog.h \
+    ../algorithms/resultsink.h \
+    ../algorithms/searchlines.h \
+    ../algorithms/stagetimer.h \
+    ../algorithms/syntheticscene.h \
+    ../algorithms/visapp.h
+
+unix:!macx {
+    INCLUDEPATH +=  /usr/local/include \
+                    /usr/local/include/opencv4
+
+    LIBS += -L/usr/local/lib \
+            -lopencv_core \
+            -lopencv_imgproc \
+            -lopencv_imgcodecs \
+            -lopencv_calib3d \
+            -lboost_date_time \
+            -lboost_system \
+            -lboost_chrono
+}
+else {
+    INCLUDEPATH += $$BOOST_INCLUDES \
+                   $$OPENCV_INCLUDES
+    DEPENDPATH += $$BOOST_INCLUDES \
+                  $$BOOST_LIBS \
+                  $$OPENCV_INCLUDES \
+                  $$OPENCV_LIBS
+
+    LIBS += -L$$BOOST_LIBS \
+            -L$$OPENCV_LIBS \
+            -lopencv_core4100 \
+            -lopencv_imgproc4100 \
+            -lopencv_imgcodecs4100 \
+            -lopencv_calib3d4100 \
+            -llibboost_date_time-vc143-mt-x64-1_86 \
+            -llibboost_system-vc143-mt-x64-1_86 \
+            -llibboost_chrono-vc143-mt-x64-1_86 \
+            -ladvapi32
+}
@@ -0,0 +1,826 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+// Regression suite of the line find: the fields of the result json, accuracy on synthetic scenes
+// against their ground truth, accuracy on checked-in field frames against golden values, and per
+// stage timings against a stored baseline. Returns 0 when every check passes and 1 otherwise, so "make check" fails.
+//
+// ./grime2test                                       run all checks
+// ./grime2test --update_golden --update_baseline     record new golden values and timing baseline
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <thread>
+#include <filesystem>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include "../algorithms/log.h"
+#include "../algorithms/visapp.h"
+#include "../algorithms/calibexecutive.h"
+#include "../algorithms/stagetimer.h"
+#include "../algorithms/syntheticscene.h"
+
+#ifndef GRIME2TEST_DATA_DIR
+#define GRIME2TEST_DATA_DIR "./config"
+#endif
+#ifndef GRIME2TEST_SOURCE_DIR
+#define GRIME2TEST_SOURCE_DIR "."
+#endif
+#ifndef GRIME2TEST_GIT_REV
+#define GRIME2TEST_GIT_REV "unknown"
+#endif
+
+using namespace cv;
+using namespace std;
+using namespace gc;
+namespace fs = std::filesystem;
+namespace pt = boost::property_tree;
+
+static const char TOTAL_STAGE[] = "total";
+
+/**
+ * @brief Allowed differences between a find and its expected result
+ */
+class TestTolerance
+{
+public:
+    TestTolerance( const double level, const double angle, const double vertex ) :
+        levelWorld( level ),
+        angleDeg( angle ),
+        vertexPixels( vertex )
+    {}
+
+    double levelWorld;      ///< Water level difference in world units
+    double angleDeg;        ///< Pixel line angle difference in degrees
+    double vertexPixels;    ///< Distance of each octagon vertex in pixels
+};
+
+/**
+ * @brief Settings of a test run
+ */
+class TestConfig
+{
+public:
+    TestConfig() :
+        dataDir( GRIME2TEST_DATA_DIR ),
+        calibPath( string( GRIME2TEST_DATA_DIR ) + "/calib.json" ),
+        goldenPath( string( GRIME2TEST_SOURCE_DIR ) + "/golden.json" ),
+        baselinePath( string( GRIME2TEST_SOURCE_DIR ) + "/baseline.json" ),
+        workFolder( ( fs::temp_directory_path() / "grime2test" ).string() ),
+        frames( { "2022_demo/20220715_KOLA_GaugeCam_001.JPG",
+                  "2022_demo/20220715_KOLA_GaugeCam_002.JPG",
+                  "2022_demo/20220715_KOLA_GaugeCam_003.JPG",
+                  "2022_demo/20220715_KOLA_GaugeCam_034.JPG",
+                  "2022_demo/20220715_KOLA_GaugeCam_037.JPG" } ),
+        reps( 5 ),
+        timeBudget( 1.5 ),
+        timeSlackMs( 1.0 ),
+        updateGolden( false ),
+        updateBaseline( false ),
+        skipSynthetic( false ),
+        skipTiming( false )
+    {}
+
+    string dataDir;         ///< Folder the field frame paths are relative to
+    string calibPath;       ///< Octagon calibration of the field frames
+    string goldenPath;      ///< Golden results of the field frames
+    string baselinePath;    ///< Per stage timing baseline
+    string workFolder;      ///< Folder for the calibrations of the synthetic scenes
+    vector< string > frames;///< Field frames relative to the data folder
+    int reps;               ///< Timed passes over the field frames
+    double timeBudget;      ///< Allowed ratio of a stage median to its baseline median
+    double timeSlackMs;     ///< Allowed absolute increase of a stage median so very short stages do not fail on noise
+    bool updateGolden;      ///< true=Write the field frame results as the new golden values
+    bool updateBaseline;    ///< true=Write the stage medians as the new timing baseline
+    bool skipSynthetic;     ///< true=Do not run the synthetic scene checks
+    bool skipTiming;        ///< true=Do not compare timings against the baseline
+};
+
+/**
+ * @brief Values of one find that are compared against the expected values
+ */
+class FindOutcome
+{
+public:
+    FindOutcome() :
+        findOk( false ),
+        level( 0.0 ),
+        angle( 0.0 )
+    {}
+
+    bool findOk;                ///< true=The find returned GC_OK with a successful find
+    double level;               ///< Found world water level
+    double angle;               ///< Found pixel line angle in degrees
+    vector< Point2d > octagon;  ///< Found octagon vertices in the order of the calibration world points
+    FindPointSet line;          ///< Found line ends and center in pixel and world coordinates
+};
+
+/**
+ * @brief Counts and prints the outcome of the checks
+ */
+class TestReport
+{
+public:
+    TestReport() :
+        checks( 0 ),
+        failures( 0 )
+    {}
+
+    void Check( const bool isOk, const string &name, const string &detail )
+    {
+        ++checks;
+        if ( !isOk )
+            ++failures;
+        cout << ( isOk ? "PASS " : "FAIL " ) << left << setw( 48 ) << name << right << " " << detail << endl;
+    }
+    void Note( const string &name, const string &detail )
+    {
+        cout << "NOTE " << left << setw( 48 ) << name << right << " " << detail << endl;
+    }
+
+    int checks;
+    int failures;
+};
+
+/**
+ * @brief A synthetic scene and the target movement between its calibration and its find
+ */
+class SyntheticCase
+{
+public:
+    string name;                    ///< Name in the report
+    SyntheticSceneParams params;    ///< Scene settings, rendered at waterLevelStart and illumGainStart
+    Point2d shift;                  ///< Target shift of the found image from the calibration image
+};
+
+static void PrintHelp()
+{
+    TestConfig config;
+    cout << "grime2test: line find accuracy and stage timing regression checks" << endl;
+    cout << "  --data_dir <path>       Folder of the field frames (default " << config.dataDir << ")" << endl;
+    cout << "  --calib_json <path>     Calibration of the field frames (default " << config.calibPath << ")" << endl;
+    cout << "  --golden <path>         Golden field frame results (default " << config.goldenPath << ")" << endl;
+    cout << "  --baseline <path>       Stage timing baseline (default " << config.baselinePath << ")" << endl;
+    cout << "  --work_folder <path>    Folder for synthetic scene calibrations (default " << config.workFolder << ")" << endl;
+    cout << "  --reps <n>              Timed passes over the field frames (default " << config.reps << ")" << endl;
+    cout << "  --time_budget <ratio>   Allowed stage median over the baseline median (default " << config.timeBudget << ")" << endl;
+    cout << "  --time_slack_ms <ms>    Allowed absolute stage median increase (default " << config.timeSlackMs << ")" << endl;
+    cout << "  --update_golden         Write the field frame results to the golden file" << endl;
+    cout << "  --update_baseline       Write the stage medians to the baseline file" << endl;
+    cout << "  --skip_synthetic        Do not run the synthetic scene checks" << endl;
+    cout << "  --skip_timing           Do not compare stage timings against the baseline" << endl;
+}
+static int GetArgs( int argc, char *argv[], TestConfig &config )
+{
+    for ( int i = 1; i < argc; ++i )
+    {
+        string arg = argv[ i ];
+        bool hasValue = i + 1 < argc;
+        if ( "--help" == arg || "-h" == arg )
+        {
+            PrintHelp();
+            return 1;
+        }
+        else if ( "--update_golden" == arg )
+        {
+            config.updateGolden = true;
+            continue;
+        }
+        else if ( "--update_baseline" == arg )
+        {
+            config.updateBaseline = true;
+            continue;
+        }
+        else if ( "--skip_synthetic" == arg )
+        {
+            config.skipSynthetic = true;
+            continue;
+        }
+        else if ( "--skip_timing" == arg )
+        {
+            config.skipTiming = true;
+            continue;
+        }
+        else if ( !hasValue )
+        {
+            FILE_LOG( logERROR ) << "Missing value for " << arg;
+            return -1;
+        }
+
+        string value = argv[ ++i ];
+        if ( "--data_dir" == arg )
+            config.dataDir = value;
+        else if ( "--calib_json" == arg )
+            config.calibPath = value;
+        else if ( "--golden" == arg )
+            config.goldenPath = value;
+        else if ( "--baseline" == arg )
+            config.baselinePath = value;
+        else if ( "--work_folder" == arg )
+            config.workFolder = value;
+        else if ( "--reps" == arg )
+            config.reps = std::max( 1, atoi( value.c_str() ) );
+        else if ( "--time_budget" == arg )
+            config.timeBudget = std::max( 1.0, atof( value.c_str() ) );
+        else if ( "--time_slack_ms" == arg )
+            config.timeSlackMs = std::max( 0.0, atof( value.c_str() ) );
+        else
+        {
+            FILE_LOG( logERROR ) << "Unknown argument " << arg;
+            return -1;
+        }
+    }
+    return 0;
+}
+static string JsonEscape( const string &str )
+{
+    string out;
+    for ( char c : str )
+    {
+        if ( '"' == c || '\\' == c )
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+static string Format( const double value, const int precision = 4 )
+{
+    stringstream ss;
+    ss << fixed << setprecision( precision ) << value;
+    return ss.str();
+}
+static GC_STATUS FindOnce( VisApp &visApp, const Mat &img, const string &calibPath, FindOutcome &outcome,
+                           StageTimeList &stageTimes, double &totalMs )
+{
+    FindLineParams params;
+    params.calibFilepath = calibPath;
+    FindLineResult result;
+
+    auto start = chrono::steady_clock::now();
+    GC_STATUS retVal = visApp.CalcLine( img, params, result );
+    totalMs = chrono::duration< double, milli >( chrono::steady_clock::now() - start ).count();
+
+    outcome.findOk = GC_OK == retVal && result.findSuccess;
+    outcome.level = result.calcLinePts.ctrWorld.y;
+    outcome.angle = result.calcLinePts.anglePixel;
+    outcome.octagon = result.foundCalPts;
+    outcome.line = result.calcLinePts;
+    stageTimes = result.stageTimes;
+    return retVal;
+}
+static void CompareOutcome( const string &name, const FindOutcome &found, const FindOutcome &expected,
+                            const TestTolerance &tol, TestReport &report )
+{
+    report.Check( found.findOk == expected.findOk, name + " find_success",
+                  string( "found " ) + ( found.findOk ? "true" : "false" ) + " expected " + ( expected.findOk ? "true" : "false" ) );
+    if ( !found.findOk || !expected.findOk )
+        return;
+
+    double levelDiff = fabs( found.level - expected.level );
+    report.Check( levelDiff <= tol.levelWorld, name + " level",
+                  "found " + Format( found.level ) + " expected " + Format( expected.level ) + " tol " + Format( tol.levelWorld ) );
+
+    double angleDiff = fabs( found.angle - expected.angle );
+    report.Check( angleDiff <= tol.angleDeg, name + " angle",
+                  "found " + Format( found.angle ) + " expected " + Format( expected.angle ) + " tol " + Format( tol.angleDeg ) );
+
+    double worstVertex = 0.0;
+    bool vertexOk = found.octagon.size() == expected.octagon.size() && !expected.octagon.empty();
+    for ( size_t i = 0; vertexOk && i < expected.octagon.size(); ++i )
+    {
+        worstVertex = std::max( worstVertex, norm( found.octagon[ i ] - expected.octagon[ i ] ) );
+    }
+    vertexOk = vertexOk && worstVertex <= tol.vertexPixels;
+    report.Check( vertexOk, name + " octagon",
+                  found.octagon.size() == expected.octagon.size() ?
+                      "worst vertex " + Format( worstVertex, 3 ) + " px tol " + Format( tol.vertexPixels, 3 ) :
+                      "found " + to_string( found.octagon.size() ) + " vertices expected " + to_string( expected.octagon.size() ) );
+}
+static void CompareMemoryModes( const string &name, const FindOutcome &full, const FindOutcome &roi, TestReport &report )
+{
+    const double tolPixels = 0.01;
+    report.Check( full.findOk == roi.findOk, name + " roi find_success",
+                  string( "roi " ) + ( roi.findOk ? "true" : "false" ) + " full " + ( full.findOk ? "true" : "false" ) );
+    if ( !full.findOk || !roi.findOk )
+        return;
+
+    const vector< pair< string, pair< Point2d, Point2d > > > points = {
+        { "left", { roi.line.lftPixel, full.line.lftPixel } },
+        { "center", { roi.line.ctrPixel, full.line.ctrPixel } },
+        { "right", { roi.line.rgtPixel, full.line.rgtPixel } } };
+    for ( const auto &pt : points )
+    {
+        double diff = norm( pt.second.first - pt.second.second );
+        report.Check( diff <= tolPixels, name + " roi " + pt.first,
+                      "roi (" + Format( pt.second.first.x, 2 ) + ", " + Format( pt.second.first.y, 2 ) + ") full (" +
+                      Format( pt.second.second.x, 2 ) + ", " + Format( pt.second.second.y, 2 ) + ")" );
+    }
+    report.Check( fabs( roi.angle - full.angle ) <= tolPixels, name + " roi angle",
+                  "roi " + Format( roi.angle ) + " full " + Format( full.angle ) );
+    report.Check( fabs( roi.level - full.level ) <= tolPixels, name + " roi level",
+                  "roi " + Format( roi.level ) + " full " + Format( full.level ) );
+}
+static vector< SyntheticCase > SyntheticCases()
+{
+    vector< SyntheticCase > cases;
+
+    SyntheticCase nominal;
+    nominal.name = "nominal";
+    cases.push_back( nominal );
+
+    SyntheticCase low = nominal;
+    low.name = "low_water";
+    low.params.waterLevelStart = low.params.waterLevelEnd = 0.8;
+    cases.push_back( low );
+
+    SyntheticCase roll = nominal;
+    roll.name = "roll";
+    roll.params.rollDeg = 3.0;
+    cases.push_back( roll );
+
+    SyntheticCase perspective = nominal;
+    perspective.name = "perspective";
+    perspective.params.tiltDeg = 10.0;
+    perspective.params.panDeg = 8.0;
+    cases.push_back( perspective );
+
+    SyntheticCase dim = nominal;
+    dim.name = "dim_gradient";
+    dim.params.illumGainStart = dim.params.illumGainEnd = 0.6;
+    dim.params.illumGradient = 0.25;
+    cases.push_back( dim );
+
+    // the target moves after calibration, so the find has to follow it
+    SyntheticCase moved = nominal;
+    moved.name = "moved";
+    moved.params.jitterPixels = 12.0;
+    moved.shift = Point2d( 8.0, -5.0 );
+    cases.push_back( moved );
+
+    return cases;
+}
+static void RunResultJson( TestReport &report )
+{
+    // every field gets a distinct value, so a field written from the wrong member shows up
+    FindLineParams params;
+    params.imagePath = "/data/kola/20220715_KOLA_GaugeCam_001.JPG";
+    params.calibFilepath = "/cfg/calib \"kola\".json";
+    params.resultImagePath = "/out/overlay.png";
+    params.timeStampType = FROM_FILENAME;
+    params.timeStampStartPos = 3;
+    params.timeStampFormat = "yyyymmdd";
+
+    FindLineResult result;
+    result.findSuccess = true;
+    result.timestamp = "2022-07-15T12:00:00";
+    result.octoToSearchROIOffsetPixel = 11.5;
+    result.octoToSearchROIOffsetWorld = 12.25;
+    result.octoCenter = Point2d( 13.5, 14.75 );
+    result.calcLinePts = FindPointSet( 1.5, 2.5, Point2d( 21.0, 22.5 ), Point2d( 23.25, 24.0 ),
+                                       Point2d( 25.5, 26.0 ), Point2d( 27.75, 28.0 ),
+                                       Point2d( 29.5, 30.0 ), Point2d( 31.25, 32.5 ) );
+    result.foundPoints = { Point2d( 41.0, 42.5 ), Point2d( 43.5, 44.0 ) };
+    result.stageTimes = { { "find_line", 3.5 } };
+    result.stageMemory.stageBytes = { { "find_line", 4096 } };
+    result.stageMemory.peakBytes = 8192;
+    result.msgs = { "first message", "second message" };
+
+    VisApp visApp;
+    string resultJson;
+    GC_STATUS retVal = visApp.ResultToJsonString( result, params, resultJson );
+    report.Check( GC_OK == retVal, "result_json/serialize", GC_OK == retVal ? "" : "ResultToJsonString failed" );
+    if ( GC_OK != retVal )
+        return;
+
+    pt::ptree top;
+    try
+    {
+        stringstream ss( resultJson );
+        pt::read_json( ss, top );
+    }
+    catch( std::exception &e )
+    {
+        report.Check( false, "result_json/parse", e.what() );
+        return;
+    }
+
+    auto checkString = [ &top, &report ]( const string &key, const string &expected )
+    {
+        string found = top.get< string >( key, "<missing>" );
+        report.Check( found == expected, "result_json/" + key, "found " + found + " expected " + expected );
+    };
+    auto checkNumber = [ &top, &report ]( const string &key, const double expected )
+    {
+        double found = top.get< double >( key, -1.0e9 );
+        report.Check( found == expected, "result_json/" + key, "found " + Format( found ) + " expected " + Format( expected ) );
+    };
+    checkString( "STATUS", "SUCCESS" );
+    checkString( "image_path", params.imagePath );
+    checkString( "calib_path", params.calibFilepath );
+    checkString( "result_path", params.resultImagePath );
+    checkString( "timestamp_type", "0" );
+    checkString( "timestamp_format", params.timeStampFormat );
+    checkNumber( "timestamp_start_pos", params.timeStampStartPos );
+    checkNumber( "timestamp_length", static_cast< double >( params.timeStampFormat.size() ) );
+    checkString( "timestamp", result.timestamp );
+    checkNumber( "searchROICenter_x", result.octoToSearchROIOffsetPixel );
+    checkNumber( "searchROICenter_y", result.octoToSearchROIOffsetWorld );
+    checkNumber( "octagonCenter_x", result.octoCenter.x );
+    checkNumber( "octagonCenter_y", result.octoCenter.y );
+    checkNumber( "pixel_line_left_x", result.calcLinePts.lftPixel.x );
+    checkNumber( "pixel_line_left_y", result.calcLinePts.lftPixel.y );
+    checkNumber( "pixel_line_center_x", result.calcLinePts.ctrPixel.x );
+    checkNumber( "pixel_line_center_y", result.calcLinePts.ctrPixel.y );
+    checkNumber( "pixel_line_right_x", result.calcLinePts.rgtPixel.x );
+    checkNumber( "pixel_line_right_y", result.calcLinePts.rgtPixel.y );
+    checkNumber( "pixel_line_angle", result.calcLinePts.anglePixel );
+    checkNumber( "world_line_left_x", result.calcLinePts.lftWorld.x );
+    checkNumber( "world_line_left_y", result.calcLinePts.lftWorld.y );
+    checkNumber( "world_line_center_x", result.calcLinePts.ctrWorld.x );
+    checkNumber( "world_line_center_y", result.calcLinePts.ctrWorld.y );
+    checkNumber( "world_line_right_x", result.calcLinePts.rgtWorld.x );
+    checkNumber( "world_line_right_y", result.calcLinePts.rgtWorld.y );
+    checkNumber( "world_line_angle", result.calcLinePts.angleWorld );
+    checkNumber( "stage_ms.find_line", 3.5 );
+    checkNumber( "stage_bytes.find_line", 4096.0 );
+    checkNumber( "peak_bytes", 8192.0 );
+
+    vector< Point2d > foundPts;
+    for ( const auto &node : top.get_child( "found_pts", pt::ptree() ) )
+    {
+        foundPts.push_back( Point2d( node.second.get< double >( "x", -1.0 ), node.second.get< double >( "y", -1.0 ) ) );
+    }
+    report.Check( foundPts == result.foundPoints, "result_json/found_pts",
+                  to_string( foundPts.size() ) + " points, expected " + to_string( result.foundPoints.size() ) );
+
+    vector< string > msgs;
+    for ( const auto &node : top.get_child( "messages", pt::ptree() ) )
+    {
+        msgs.push_back( node.second.data() );
+    }
+    report.Check( msgs == result.msgs, "result_json/messages",
+                  to_string( msgs.size() ) + " messages, expected " + to_string( result.msgs.size() ) );
+}
+static void RunSynthetic( const TestConfig &config, TestReport &report )
+{
+    const TestTolerance tol( 0.02, 0.5, 1.5 );
+
+    error_code ec;
+    fs::create_directories( config.workFolder, ec );
+    for ( const auto &synth : SyntheticCases() )
+    {
+        const string name = "synthetic/" + synth.name;
+        const SyntheticSceneParams &params = synth.params;
+        try
+        {
+            SyntheticScene scene;
+            Mat calibImg, img;
+            SyntheticFrameTruth calibTruth, truth;
+            GC_STATUS retVal = scene.Render( params, params.waterLevelStart, params.illumGainStart, Point2d( 0.0, 0.0 ),
+                                             params.seed, calibImg, calibTruth );
+            if ( GC_OK == retVal )
+            {
+                retVal = scene.Render( params, params.waterLevelStart, params.illumGainStart, synth.shift,
+                                       params.seed + 1, img, truth );
+            }
+
+            Rect calibRoi;
+            LineSearchRoi waterlineRoi;
+            if ( GC_OK == retVal )
+            {
+                retVal = SyntheticScene::CalibRegions( params, calibRoi, waterlineRoi );
+            }
+
+            VisApp visApp;
+            string calibPath = ( fs::path( config.workFolder ) / ( "synth_" + synth.name + ".json" ) ).string();
+            if ( GC_OK == retVal )
+            {
+                string jsonControl, err_msg;
+                double rmseDist, rmseX, rmseY;
+                CalibJsonItems items( calibPath, true, calibRoi, params.facetLength, params.zeroOffset, waterlineRoi );
+                retVal = CalibExecutive::FormOctagonCalibJsonString( items, jsonControl );
+                if ( GC_OK == retVal )
+                {
+                    retVal = visApp.Calibrate( calibImg, jsonControl, rmseDist, rmseX, rmseY, err_msg, true );
+                }
+            }
+            report.Check( GC_OK == retVal, name + " calibrate", GC_OK == retVal ? calibPath : "could not render or calibrate the scene" );
+            if ( GC_OK != retVal )
+                continue;
+
+            FindOutcome found, expected;
+            StageTimeList stageTimes;
+            double totalMs = 0.0;
+            FindOnce( visApp, img, calibPath, found, stageTimes, totalMs );
+
+            expected.findOk = true;
+            expected.level = truth.waterLevel;
+            expected.angle = truth.waterline.anglePixel;
+            expected.octagon = truth.octagonPixel;
+            CompareOutcome( name, found, expected, tol, report );
+
+            // preprocessing only the search region must not change the result
+            FindOutcome foundRoi;
+            visApp.SetMemoryMode( GC_MEMORY_ROI );
+            FindOnce( visApp, img, calibPath, foundRoi, stageTimes, totalMs );
+            visApp.SetMemoryMode( GC_MEMORY_FULL );
+            CompareMemoryModes( name, found, foundRoi, report );
+        }
+        catch( std::exception &e )
+        {
+            FILE_LOG( logERROR ) << "[grime2test::RunSynthetic] " << name << ": " << e.what();
+            report.Check( false, name, "exception" );
+        }
+    }
+}
+static GC_STATUS ReadGolden( const string &goldenPath, TestTolerance &tol, map< string, FindOutcome > &golden )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        pt::ptree top;
+        pt::read_json( goldenPath, top );
+
+        tol.levelWorld = top.get< double >( "tolerance.level", tol.levelWorld );
+        tol.angleDeg = top.get< double >( "tolerance.angle", tol.angleDeg );
+        tol.vertexPixels = top.get< double >( "tolerance.vertex_pixels", tol.vertexPixels );
+
+        for ( const auto &frame : top.get_child( "frames" ) )
+        {
+            FindOutcome outcome;
+            outcome.findOk = frame.second.get< bool >( "find_success" );
+            outcome.level = frame.second.get< double >( "level", 0.0 );
+            outcome.angle = frame.second.get< double >( "angle", 0.0 );
+            if ( frame.second.get_child_optional( "octagon" ) )
+            {
+                for ( const auto &vertex : frame.second.get_child( "octagon" ) )
+                {
+                    outcome.octagon.push_back( Point2d( vertex.second.get< double >( "x" ), vertex.second.get< double >( "y" ) ) );
+                }
+            }
+            golden[ frame.second.get< string >( "image" ) ] = outcome;
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[grime2test::ReadGolden] " << goldenPath << ": " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+static GC_STATUS WriteGolden( const TestConfig &config, const TestTolerance &tol, const vector< FindOutcome > &outcomes )
+{
+    char dateBuf[ 32 ] = "";
+    time_t now = time( nullptr );
+    strftime( dateBuf, sizeof( dateBuf ), "%Y-%m-%dT%H:%M:%S", localtime( &now ) );
+
+    stringstream ss;
+    ss << fixed << setprecision( 4 );
+    ss << "{" << endl;
+    ss << "  \"git_rev\": \"" << GRIME2TEST_GIT_REV << "\"," << endl;
+    ss << "  \"date\": \"" << dateBuf << "\"," << endl;
+    ss << "  \"calib_json\": \"" << JsonEscape( fs::path( config.calibPath ).filename().string() ) << "\"," << endl;
+    ss << "  \"tolerance\": {\"level\": " << tol.levelWorld << ", \"angle\": " << tol.angleDeg
+       << ", \"vertex_pixels\": " << tol.vertexPixels << "}," << endl;
+    ss << "  \"frames\": [" << endl;
+    for ( size_t i = 0; i < outcomes.size(); ++i )
+    {
+        const FindOutcome &outcome = outcomes[ i ];
+        ss << "    {\"image\": \"" << JsonEscape( config.frames[ i ] ) << "\", \"find_success\": " << ( outcome.findOk ? "true" : "false" )
+           << ", \"level\": " << outcome.level << ", \"angle\": " << outcome.angle << "," << endl;
+        ss << "     \"octagon\": [";
+        for ( size_t j = 0; j < outcome.octagon.size(); ++j )
+        {
+            ss << "{\"x\": " << outcome.octagon[ j ].x << ", \"y\": " << outcome.octagon[ j ].y << "}"
+               << ( outcome.octagon.size() - 1 == j ? "" : ", " );
+        }
+        ss << "]}" << ( outcomes.size() - 1 == i ? "" : "," ) << endl;
+    }
+    ss << "  ]" << endl;
+    ss << "}" << endl;
+
+    ofstream goldenFile( config.goldenPath );
+    goldenFile << ss.str();
+    if ( !goldenFile )
+    {
+        FILE_LOG( logERROR ) << "[grime2test::WriteGolden] Could not write " << config.goldenPath;
+        return GC_ERR;
+    }
+    return GC_OK;
+}
+static GC_STATUS ReadBaseline( const string &baselinePath, map< string, double > &baseline )
+{
+    GC_STATUS retVal = GC_OK;
+    try
+    {
+        pt::ptree top;
+        pt::read_json( baselinePath, top );
+        for ( const auto &stage : top.get_child( "stages" ) )
+        {
+            baseline[ stage.first ] = stage.second.get_value< double >();
+        }
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[grime2test::ReadBaseline] " << baselinePath << ": " << e.what();
+        retVal = GC_EXCEPT;
+    }
+    return retVal;
+}
+static GC_STATUS WriteBaseline( const TestConfig &config, const vector< pair< string, double > > &medians )
+{
+    char dateBuf[ 32 ] = "";
+    time_t now = time( nullptr );
+    strftime( dateBuf, sizeof( dateBuf ), "%Y-%m-%dT%H:%M:%S", localtime( &now ) );
+
+    stringstream ss;
+    ss << fixed << setprecision( 4 );
+    ss << "{" << endl;
+    ss << "  \"git_rev\": \"" << GRIME2TEST_GIT_REV << "\"," << endl;
+    ss << "  \"date\": \"" << dateBuf << "\"," << endl;
+    ss << "  \"hardware_threads\": " << thread::hardware_concurrency() << "," << endl;
+    ss << "  \"frames\": " << config.frames.size() << "," << endl;
+    ss << "  \"reps\": " << config.reps << "," << endl;
+    ss << "  \"stages\": {" << endl;
+    for ( size_t i = 0; i < medians.size(); ++i )
+    {
+        ss << "    \"" << medians[ i ].first << "\": " << medians[ i ].second << ( medians.size() - 1 == i ? "" : "," ) << endl;
+    }
+    ss << "  }" << endl;
+    ss << "}" << endl;
+
+    ofstream baselineFile( config.baselinePath );
+    baselineFile << ss.str();
+    if ( !baselineFile )
+    {
+        FILE_LOG( logERROR ) << "[grime2test::WriteBaseline] Could not write " << config.baselinePath;
+        return GC_ERR;
+    }
+    return GC_OK;
+}
+static void RunField( const TestConfig &config, TestReport &report )
+{
+    TestTolerance tol( 0.01, 0.25, 1.0 );
+    map< string, FindOutcome > golden;
+    bool hasGolden = false;
+    if ( !config.updateGolden && !fs::exists( config.goldenPath ) )
+    {
+        // without golden values the field frames cannot be checked, so the run fails rather than
+        // passing with nothing asserted
+        report.Check( false, "field golden values", config.goldenPath + " missing (record it with --update_golden)" );
+    }
+    else if ( !config.updateGolden )
+    {
+        hasGolden = GC_OK == ReadGolden( config.goldenPath, tol, golden );
+        report.Check( hasGolden, "field golden values", hasGolden ? config.goldenPath : config.goldenPath + " invalid" );
+    }
+
+    vector< Mat > images;
+    for ( const auto &frame : config.frames )
+    {
+        string imgPath = ( fs::path( config.dataDir ) / frame ).string();
+        images.push_back( imread( imgPath, IMREAD_COLOR ) );
+        if ( images.back().empty() )
+        {
+            report.Check( false, "field/" + frame, "could not read " + imgPath );
+        }
+    }
+
+    // the first pass is compared against the golden values and warms the calibration cache,
+    // the remaining passes are timed
+    VisApp visApp;
+    vector< FindOutcome > outcomes( config.frames.size() );
+    map< string, StageTimeSummary > summaries;
+    vector< string > stageOrder;
+    for ( int rep = 0; rep <= config.reps; ++rep )
+    {
+        for ( size_t i = 0; i < config.frames.size(); ++i )
+        {
+            if ( images[ i ].empty() )
+                continue;
+
+            FindOutcome outcome;
+            StageTimeList stageTimes;
+            double totalMs = 0.0;
+            FindOnce( visApp, images[ i ], config.calibPath, outcome, stageTimes, totalMs );
+            if ( 0 == rep )
+            {
+                outcomes[ i ] = outcome;
+                continue;
+            }
+            stageTimes.push_back( make_pair( string( TOTAL_STAGE ), totalMs ) );
+            for ( const auto &stage : stageTimes )
+            {
+                if ( summaries.end() == summaries.find( stage.first ) )
+                    stageOrder.push_back( stage.first );
+                summaries[ stage.first ].Add( stage.second );
+            }
+        }
+    }
+
+    if ( hasGolden )
+    {
+        for ( size_t i = 0; i < config.frames.size(); ++i )
+        {
+            if ( images[ i ].empty() )
+                continue;
+            const string name = "field/" + fs::path( config.frames[ i ] ).filename().string();
+            auto expected = golden.find( config.frames[ i ] );
+            if ( golden.end() == expected )
+                report.Check( false, name, "no golden value (record it with --update_golden)" );
+            else
+                CompareOutcome( name, outcomes[ i ], expected->second, tol, report );
+        }
+    }
+    if ( config.updateGolden )
+    {
+        GC_STATUS retVal = WriteGolden( config, tol, outcomes );
+        report.Check( GC_OK == retVal, "field golden values", "wrote " + config.goldenPath );
+    }
+
+    vector< pair< string, double > > medians;
+    for ( const auto &stage : stageOrder )
+    {
+        medians.push_back( make_pair( stage, summaries[ stage ].Percentile( 0.5 ) ) );
+    }
+    if ( config.updateBaseline )
+    {
+        GC_STATUS retVal = WriteBaseline( config, medians );
+        report.Check( GC_OK == retVal, "timing baseline", "wrote " + config.baselinePath );
+    }
+    else if ( !config.skipTiming )
+    {
+        // a missing baseline fails the run like a missing golden file, a machine without a
+        // baseline of its own records one or runs with --skip_timing
+        map< string, double > baseline;
+        if ( !fs::exists( config.baselinePath ) )
+        {
+            report.Check( false, "timing baseline", config.baselinePath + " missing (record it with --update_baseline or use --skip_timing)" );
+        }
+        else if ( GC_OK != ReadBaseline( config.baselinePath, baseline ) )
+        {
+            report.Check( false, "timing baseline", config.baselinePath + " invalid" );
+        }
+        else
+        {
+            for ( const auto &stage : medians )
+            {
+                auto base = baseline.find( stage.first );
+                if ( baseline.end() == base )
+                {
+                    report.Note( "timing/" + stage.first, "median " + Format( stage.second, 3 ) + " ms, not in the baseline" );
+                    continue;
+                }
+                double limit = base->second * config.timeBudget + config.timeSlackMs;
+                report.Check( stage.second <= limit, "timing/" + stage.first,
+                              "median " + Format( stage.second, 3 ) + " ms baseline " + Format( base->second, 3 ) +
+                              " ms limit " + Format( limit, 3 ) + " ms" );
+            }
+        }
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    Output2FILE::Stream() = stderr;
+
+    TestConfig config;
+    int ret = GetArgs( argc, argv, config );
+    if ( 0 != ret )
+        return 0 < ret ? 0 : ret;
+
+    TestReport report;
+    RunResultJson( report );
+    if ( !config.skipSynthetic )
+    {
+        RunSynthetic( config, report );
+    }
+    RunField( config, report );
+
+    cout << "grime2test (" << GRIME2TEST_GIT_REV << "): " << report.checks << " checks, " << report.failures << " failures" << endl;
+    return 0 == report.failures ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#include "grime2.h"
+#include "../algorithms/log.h"
+#include "../algorithms/visapp.h"
+#include "../algorithms/calibsnapshot.h"
+#include <opencv2/imgcodecs.hpp>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace gc;
+
+struct grime2_engine
+{
+    shared_ptr< const CalibrationSnapshot > snapshot;
+    FindLineContextPool contexts;
+};
+
+namespace
+{
+
+thread_local string g_lastError;
+
+grime2_status Fail( const grime2_status status, const string &msg )
+{
+    g_lastError = msg;
+    return status;
+}
+
+void CopyString( char *dst, const size_t dstSize, const string &src )
+{
+    memset( dst, 0, dstSize );
+    strncpy( dst, src.c_str(), dstSize - 1 );
+}
+
+void FillResult( const GC_STATUS status, const FindLineResult &findResult, grime2_result &result )
+{
+    result.status = static_cast< int >( status );
+    result.find_success = findResult.findSuccess ? 1 : 0;
+    result.calib_success = findResult.calibSuccess ? 1 : 0;
+    CopyString( result.timestamp, sizeof( result.timestamp ), findResult.timestamp );
+    result.level = findResult.calcLinePts.ctrWorld.y;
+    result.angle = findResult.calcLinePts.angleWorld;
+    result.ctr_x = findResult.calcLinePts.ctrPixel.x;
+    result.ctr_y = findResult.calcLinePts.ctrPixel.y;
+    result.lft_x = findResult.calcLinePts.lftPixel.x;
+    result.lft_y = findResult.calcLinePts.lftPixel.y;
+    result.rgt_x = findResult.calcLinePts.rgtPixel.x;
+    result.rgt_y = findResult.calcLinePts.rgtPixel.y;
+    result.octo_x = findResult.octoCenter.x;
+    result.octo_y = findResult.octoCenter.y;
+    result.reproject_offset = findResult.calibReprojectOffset_dist;
+
+    string msg;
+    for ( const string &m : findResult.msgs )
+        msg += ( msg.empty() ? "" : "; " ) + m;
+    CopyString( result.message, sizeof( result.message ), msg );
+}
+
+// every find entry point ends here so the result is always filled, even for rejected input
+grime2_status Find( grime2_engine *engine, const cv::Mat &img, const char *timestamp, grime2_result *result )
+{
+    FindLineResult findResult;
+    if ( nullptr != timestamp && '\0' != timestamp[ 0 ] )
+        findResult.timestamp = timestamp;
+
+    FindLineContextLease lease( engine->contexts );
+    GC_STATUS status = VisApp::CalcLine( engine->snapshot, lease.Context(), img, findResult );
+    FillResult( status, findResult, *result );
+    if ( GC_OK != status )
+        return Fail( GRIME2_ERR, findResult.msgs.empty() ? string( "Line find failed" ) : findResult.msgs.back() );
+    return GRIME2_OK;
+}
+
+} // namespace
+
+grime2_status grime2_engine_create( const char *calib_path, grime2_engine **engine )
+{
+    g_lastError.clear();
+    if ( nullptr == engine )
+        return Fail( GRIME2_ERR, "engine is NULL" );
+    *engine = nullptr;
+    if ( nullptr == calib_path )
+        return Fail( GRIME2_ERR, "calib_path is NULL" );
+
+    try
+    {
+        unique_ptr< grime2_engine > created( new grime2_engine );
+        if ( GC_OK != CalibrationSnapshot::Create( calib_path, created->snapshot ) )
+            return Fail( GRIME2_ERR, string( "Could not load calibration " ) + calib_path );
+        *engine = created.release();
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[grime2_engine_create] " << e.what();
+        return Fail( GRIME2_EXCEPT, e.what() );
+    }
+    catch( ... )
+    {
+        return Fail( GRIME2_EXCEPT, "Unknown exception creating the engine" );
+    }
+    return GRIME2_OK;
+}
+
+void grime2_engine_destroy( grime2_engine *engine )
+{
+    try
+    {
+        delete engine;
+    }
+    catch( ... )
+    {
+    }
+}
+
+grime2_status grime2_find_encoded( grime2_engine *engine, const unsigned char *data, size_t size,
+                                   const char *timestamp, grime2_result *result )
+{
+    g_lastError.clear();
+    if ( nullptr == result )
+        return Fail( GRIME2_ERR, "result is NULL" );
+    memset( result, 0, sizeof( grime2_result ) );
+    result->status = GRIME2_ERR;
+    if ( nullptr == engine || nullptr == data || 0 == size )
+        return Fail( GRIME2_ERR, "engine and image data are required" );
+    if ( static_cast< size_t >( INT_MAX ) < size )
+        return Fail( GRIME2_ERR, "Encoded image is too large" );
+
+    try
+    {
+        // imdecode only reads the buffer, the header just lets it see the caller's bytes
+        const cv::Mat buf( 1, static_cast< int >( size ), CV_8UC1, const_cast< unsigned char * >( data ) );
+        cv::Mat img = cv::imdecode( buf, cv::IMREAD_COLOR );
+        if ( img.empty() )
+            return Fail( GRIME2_ERR, "Could not decode image" );
+        return Find( engine, img, timestamp, result );
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[grime2_find_encoded] " << e.what();
+        result->status = GRIME2_EXCEPT;
+        return Fail( GRIME2_EXCEPT, e.what() );
+    }
+    catch( ... )
+    {
+        result->status = GRIME2_EXCEPT;
+        return Fail( GRIME2_EXCEPT, "Unknown exception in line find" );
+    }
+}
+
+grime2_status grime2_find_raw( grime2_engine *engine, const unsigned char *pixels, int width, int height,
+                               size_t stride, grime2_pixel_format format, const char *timestamp,
+                               grime2_result *result )
+{
+    g_lastError.clear();
+    if ( nullptr == result )
+        return Fail( GRIME2_ERR, "result is NULL" );
+    memset( result, 0, sizeof( grime2_result ) );
+    result->status = GRIME2_ERR;
+    if ( nullptr == engine || nullptr == pixels )
+        return Fail( GRIME2_ERR, "engine and pixels are required" );
+
+    const int channels = static_cast< int >( format );
+    if ( GRIME2_PIXEL_GRAY8 != format && GRIME2_PIXEL_BGR8 != format && GRIME2_PIXEL_BGRA8 != format )
+        return Fail( GRIME2_ERR, "Unsupported pixel format" );
+    if ( 0 >= width || 0 >= height || stride < static_cast< size_t >( width ) * static_cast< size_t >( channels ) )
+        return Fail( GRIME2_ERR, "Invalid image dimensions or stride" );
+
+    try
+    {
+        const cv::Mat img( height, width, CV_8UC( channels ), const_cast< unsigned char * >( pixels ), stride );
+        return Find( engine, img, timestamp, result );
+    }
+    catch( std::exception &e )
+    {
+        FILE_LOG( logERROR ) << "[grime2_find_raw] " << e.what();
+        result->status = GRIME2_EXCEPT;
+        return Fail( GRIME2_EXCEPT, e.what() );
+    }
+    catch( ... )
+    {
+        result->status = GRIME2_EXCEPT;
+        return Fail( GRIME2_EXCEPT, "Unknown exception in line find" );
+    }
+}
+
+const char *grime2_last_error( void )
+{
+    return g_lastError.c_str();
+}
+
+const char *grime2_version( void )
+{
+    return GAUGECAM_VISAPP_VERSION.c_str();
+}
+
+int grime2_abi_version( void )
+{
+    return GRIME2_ABI_VERSION;
+}
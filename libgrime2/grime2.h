@@ -0,0 +1,170 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   Copyright 2021 Kenneth W. Chapman
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/** \file grime2.h
+ * @brief C interface of the GRIME2 water level line find, for services that link the engine
+ *        in-process (libgrime2 shared library, or libgrime2_static)
+ *
+ * Thread safety: an engine may be shared by any number of threads. Every function may be
+ * called concurrently on the same engine except grime2_engine_destroy(), which must not race
+ * with other calls on that engine. The calibration is loaded once when the engine is created
+ * and each find works in its own per call state, so concurrent finds do not lock each other.
+ *
+ * Errors: no C++ exception crosses this interface. Every function that can fail returns a
+ * grime2_status, and grime2_last_error() gives a description of the last failure on the
+ * calling thread.
+ *
+ * \author Kenneth W. Chapman
+ * \copyright Copyright (C) 2010-2024, Kenneth W. Chapman <coffeesig@gmail.com>, all rights reserved.\n
+ * This project is released under the Apache License, Version 2.0.
+ * \bug No known bugs.
+ */
+
+#ifndef GRIME2_H
+#define GRIME2_H
+
+#include <stddef.h>
+
+#if defined( GRIME2_STATIC )
+#define GRIME2_API
+#elif defined( _WIN32 )
+#if defined( GRIME2_BUILD_SHARED )
+#define GRIME2_API __declspec( dllexport )
+#else
+#define GRIME2_API __declspec( dllimport )
+#endif
+#else
+#define GRIME2_API __attribute__( ( visibility( "default" ) ) )
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Version of the interface, incremented when a declaration in this file changes incompatibly */
+#define GRIME2_ABI_VERSION 1
+
+/**
+ * @brief Status values returned by the interface (the same values as the GaugeCam GC_STATUS)
+ */
+typedef enum
+{
+    GRIME2_EXCEPT = -2,     ///< An unexpected error was caught inside the library
+    GRIME2_ERR = -1,        ///< Error (invalid argument, unreadable calibration or image, failed find)
+    GRIME2_OK = 0,          ///< Ok
+    GRIME2_WARN = 1         ///< Warning
+} grime2_status;
+
+/**
+ * @brief Pixel layouts accepted by grime2_find_raw()
+ */
+typedef enum
+{
+    GRIME2_PIXEL_GRAY8 = 1, ///< 8-bit gray
+    GRIME2_PIXEL_BGR8 = 3,  ///< 8-bit blue, green, red
+    GRIME2_PIXEL_BGRA8 = 4  ///< 8-bit blue, green, red, alpha
+} grime2_pixel_format;
+
+/** Opaque engine that holds one loaded calibration */
+typedef struct grime2_engine grime2_engine;
+
+/**
+ * @brief Result of one line find. Coordinates are pixels unless named world
+ */
+typedef struct
+{
+    int status;                     ///< grime2_status of the find
+    int find_success;               ///< 1=Water line found, 0=Not found
+    int calib_success;              ///< 1=Calibration target found, 0=Not found
+    char timestamp[ 24 ];           ///< Timestamp given with the image (yyyy-mm-ddTHH:MM:SS)
+    double level;                   ///< Water level (world units)
+    double angle;                   ///< Angle of the water line (world, degrees)
+    double ctr_x;                   ///< Water line center
+    double ctr_y;
+    double lft_x;                   ///< Water line left end
+    double lft_y;
+    double rgt_x;                   ///< Water line right end
+    double rgt_y;
+    double octo_x;                  ///< Octagon target center
+    double octo_y;
+    double reproject_offset;        ///< Distance between the line center and its reprojected world position
+    char message[ 256 ];            ///< Messages of the find separated by "; " (truncated to fit)
+} grime2_result;
+
+/**
+ * @brief Create an engine from a calibration json file
+ * @param calib_path Path of the calibration file
+ * @param engine Receives the new engine, NULL on failure
+ * @return GRIME2_OK=Success, GRIME2_ERR=Failure, GRIME2_EXCEPT=Unexpected error
+ */
+GRIME2_API grime2_status grime2_engine_create( const char *calib_path, grime2_engine **engine );
+
+/**
+ * @brief Destroy an engine. NULL is ignored
+ * @param engine Engine created with grime2_engine_create()
+ */
+GRIME2_API void grime2_engine_destroy( grime2_engine *engine );
+
+/**
+ * @brief Find the water line in an encoded (.png or .jpg) image
+ * @param engine Engine to find with
+ * @param data Encoded image bytes
+ * @param size Number of bytes
+ * @param timestamp Timestamp copied into the result (NULL=none)
+ * @param result Receives the result
+ * @return GRIME2_OK=Success, GRIME2_ERR=Failure, GRIME2_EXCEPT=Unexpected error
+ */
+GRIME2_API grime2_status grime2_find_encoded( grime2_engine *engine, const unsigned char *data, size_t size,
+                                              const char *timestamp, grime2_result *result );
+
+/**
+ * @brief Find the water line in a raw image. The pixels are read in place, not copied
+ * @param engine Engine to find with
+ * @param pixels First byte of the top row
+ * @param width Image width in pixels
+ * @param height Image height in pixels
+ * @param stride Bytes from the start of one row to the start of the next
+ * @param format Pixel layout
+ * @param timestamp Timestamp copied into the result (NULL=none)
+ * @param result Receives the result
+ * @return GRIME2_OK=Success, GRIME2_ERR=Failure, GRIME2_EXCEPT=Unexpected error
+ */
+GRIME2_API grime2_status grime2_find_raw( grime2_engine *engine, const unsigned char *pixels, int width, int height,
+                                          size_t stride, grime2_pixel_format format, const char *timestamp,
+                                          grime2_result *result );
+
+/**
+ * @brief Description of the last failure on the calling thread (empty if there was none). Valid
+ *        until the next call on the same thread
+ */
+GRIME2_API const char *grime2_last_error( void );
+
+/**
+ * @brief Version of the line find (e.g. "0.0.1.0")
+ */
+GRIME2_API const char *grime2_version( void );
+
+/**
+ * @brief GRIME2_ABI_VERSION the library was built with, to check against the header at run time
+ */
+GRIME2_API int grime2_abi_version( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GRIME2_H
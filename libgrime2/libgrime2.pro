@@ -0,0 +1,111 @@
+TEMPLATE = lib
+CONFIG += c++17 thread
+CONFIG -= qt
+CONFIG += release
+CONFIG -= debug
+
+# C interface to the line find for services that link it in-process (see grime2.h)
+# builds libgrime2 as a shared library, qmake CONFIG+=grime2_static builds a static library
+TARGET = grime2
+
+DEFINES += BOOST_ALL_NO_LIB BOOST_BIND_GLOBAL_PLACEHOLDERS
+
+# log messages are written by the calling thread, a library cannot safely stop the log
+# drain thread from a static destructor (see algorithms/log.h)
+DEFINES += FILELOG_SYNCHRONOUS
+
+grime2_static {
+    CONFIG += staticlib
+    DEFINES += GRIME2_STATIC
+} else {
+    DEFINES += GRIME2_BUILD_SHARED
+    # only the grime2_ functions are exported, the C++ classes stay internal
+    !win32: QMAKE_CXXFLAGS += -fvisibility=hidden -fvisibility-inlines-hidden
+}
+
+win32 {
+    DEFINES += NOMINMAX
+    DEFINES += WIN32_LEAN_AND_MEAN
+    DEFINES += _WIN32_WINNT=0x0501
+    OPENCV_INCLUDES = c:/opencv/opencv_4.10.0/include
+    OPENCV_LIBS = C:/opencv/opencv_4.10.0/x64/vc19/lib
+    BOOST_INCLUDES = C:/Boost/boost_1_86/include
+    BOOST_LIBS = C:/Boost/boost_1_86/lib
+}
+
+SOURCES += \
+    ../algorithms/animate.cpp \
+    ../algorithms/calibcache.cpp \
+    ../algorithms/calibexecutive.cpp \
+    ../algorithms/caliboctagon.cpp \
+    ../algorithms/calibsnapshot.cpp \
+    ../algorithms/findline.cpp \
+    ../algorithms/framecontext.cpp \
+    ../algorithms/gifanim/gifanim.cpp \
+    ../algorithms/memorybudget.cpp \
+    ../algorithms/metadata.cpp \
+    ../algorithms/octagonsearch.cpp \
+    ../algorithms/octorefine.cpp \
+    ../algorithms/resultlog.cpp \
+    ../algorithms/resultsink.cpp \
+    ../algorithms/searchlines.cpp \
+    ../algorithms/visapp.cpp \
+    grime2.cpp
+
+HEADERS += \
+    ../algorithms/animate.h \
+    ../algorithms/bresenham.h \
+    ../algorithms/calibcache.h \
+    ../algorithms/calibexecutive.h \
+    ../algorithms/caliboctagon.h \
+    ../algorithms/calibsnapshot.h \
+    ../algorithms/findline.h \
+    ../algorithms/framecontext.h \
+    ../algorithms/gc_types.h \
+    ../algorithms/homography.h \
+    ../algorithms/jsonwriter.h \
+    ../algorithms/gifanim/gifanim.h \
+    ../algorithms/log.h \
+    ../algorithms/memorybudget.h \
+    ../algorithms/metadata.h \
+    ../algorithms/octagonsearch.h \
+    ../algorithms/octorefine.h \
+    ../algorithms/resultlog.h \
+    ../algorithms/resultsink.h \
+    ../algorithms/searchlines.h \
+    ../algorithms/stagetimer.h \
+    ../algorithms/visapp.h \
+    grime2.h
+
+unix:!macx {
+    INCLUDEPATH +=  /usr/local/include \
+                    /usr/local/include/opencv4
+
+    LIBS += -L/usr/local/lib \
+            -lopencv_core \
+            -lopencv_imgproc \
+            -lopencv_imgcodecs \
+            -lopencv_calib3d \
+            -lboost_date_time \
+            -lboost_system \
+            -lboost_chrono
+}
+else {
+    INCLUDEPATH += $$BOOST_INCLUDES \
+                   $$OPENCV_INCLUDES
+    DEPENDPATH += $$BOOST_INCLUDES \
+                  $$BOOST_LIBS \
+                  $$OPENCV_INCLUDES \
+                  $$OPENCV_LIBS
+
+    LIBS += -L$$BOOST_LIBS \
+            -L$$OPENCV_LIBS \
+            -lopencv_core4100 \
+            -lopencv_imgproc4100 \
+            -lopencv_imgcodecs4100 \
+            -lopencv_calib3d4100 \
+            -llibboost_date_time-vc143-mt-x64-1_86 \
+            -llibboost_system-vc143-mt-x64-1_86 \
+            -llibboost_chrono-vc143-mt-x64-1_86 \
+            -ladvapi32
+}